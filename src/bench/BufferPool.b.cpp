@@ -0,0 +1,86 @@
+// Request-style buffer churn: each iteration takes a buffer of 256 KiB to
+// 8 MiB, writes every byte, and lets it go, from several threads at once.
+// Buffers are new Vectors or leases from a BufferPool.
+//
+// glibc raises its mmap threshold to the size of each mmapped chunk it
+// frees, up to 32 MiB, so by default these sizes soon come from the heap,
+// which hands the same cache-warm memory to every size. Run with a fixed
+// threshold (MALLOC_MMAP_THRESHOLD_=131072), as setting it by mallopt()
+// does, to see each new Vector cost an mmap, a fault per page and an
+// munmap, as buffers above 32 MiB always do.
+//
+// Usage: BufferPool_bench [iterations=2000] [threads=4]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+
+#include "src/stl/BufferPool.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::BufferPool;
+using ecx::stl::Vector;
+
+template <typename Fn>
+double timeMs(Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Runs use(buffer, bytes) for random sizes, iterations per thread.
+template <typename Use>
+double run(std::size_t iterations, unsigned threads, Use&& use) {
+  return timeMs([&] {
+    Vector<std::jthread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        std::mt19937_64 rng(t);
+        for (std::size_t i = 0; i < iterations; ++i) {
+          use(std::size_t{256} << 10 << rng() % 6);
+        }
+      });
+    }
+  });
+}
+
+void fill(Vector<std::byte>& buffer, std::size_t bytes) {
+  buffer.reserve(bytes);
+  std::memset(buffer.data(), 1, bytes);
+  asm volatile("" : : "r"(buffer.data()) : "memory");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t iterations =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 2000;
+  const unsigned threads =
+      argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 4;
+
+  const double freshMs = run(iterations, threads, [](std::size_t bytes) {
+    Vector<std::byte> buffer;
+    fill(buffer, bytes);
+  });
+  std::printf("Vector      %8.1f ms\n", freshMs);
+
+  BufferPool pool;
+  const double pooledMs = run(iterations, threads, [&](std::size_t bytes) {
+    BufferPool::Lease lease = pool.acquire(bytes);
+    fill(*lease, bytes);
+  });
+  const auto stats = pool.stats();
+  std::printf("BufferPool  %8.1f ms  (%zu of %zu hits, %zu steals, "
+              "%.1f MiB retained)\n",
+              pooledMs, stats.hits, stats.acquires, stats.steals,
+              static_cast<double>(stats.retainedBytes) / (1 << 20));
+  return 0;
+}
@@ -0,0 +1,88 @@
+// "Sum the price of orders with quantity >= 5": a loop over Vector<Row>, as
+// the analytics step used to do, against filter() and aggregate() over a
+// ColumnTable holding the same data, with a materialised SelectionVector and
+// with the fused per-batch kernel.
+//
+// Usage: ColumnTable_bench [rows=10000000]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "src/stl/ColumnTable.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::aggregate;
+using ecx::stl::aggregateWhere;
+using ecx::stl::ColumnTable;
+using ecx::stl::CompareOp;
+using ecx::stl::filter;
+using ecx::stl::Vector;
+
+struct Row {
+  std::int64_t id;
+  std::int64_t customer;
+  double price;
+  double discount;
+  std::int32_t quantity;
+  std::int32_t region;
+};
+
+template <typename Fn>
+void report(const char* name, std::size_t rows, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  const double sum = fn();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  const double ns =
+      std::chrono::duration<double, std::nano>(elapsed).count() /
+      static_cast<double>(rows);
+  std::printf("%-12s %zu rows: %6.2f ns/row sum=%.0f\n", name, rows, ns, sum);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t rows =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 10'000'000;
+
+  Vector<Row> rowStore;
+  rowStore.reserve(rows);
+  ColumnTable table;
+  table.addColumn<double>("price");
+  table.addColumn<std::int32_t>("quantity");
+  auto& price = table.column<double>("price");
+  auto& quantity = table.column<std::int32_t>("quantity");
+  for (std::size_t i = 0; i < rows; ++i) {
+    const auto id = static_cast<std::int64_t>(i);
+    const double p = static_cast<double>(i % 1000);
+    const auto q = static_cast<std::int32_t>(i * 7 % 10);
+    rowStore.push_back(Row{id, id % 977, p, 0.0, q, 0});
+    price.append(p);
+    quantity.append(q);
+  }
+
+  report("Vector<Row>", rows, [&] {
+    double sum = 0;
+    for (const Row& row : rowStore) {
+      if (row.quantity >= 5) {
+        sum += row.price;
+      }
+    }
+    return sum;
+  });
+
+  report("two passes", rows, [&] {
+    const auto selected = filter(quantity, CompareOp::kGe, 5);
+    return aggregate(price, selected).sum;
+  });
+
+  report("fused", rows, [&] {
+    return aggregateWhere(price, quantity, CompareOp::kGe, 5).sum;
+  });
+  return 0;
+}
@@ -0,0 +1,70 @@
+// Swapping out a large object graph (an index of many small Vectors) on a
+// request thread: the time reset() takes there with the default deleter,
+// which tears the graph down in place, and with DeferredDeleter, which
+// queues it for the reclaimer thread. Building each index is not timed.
+//
+// Usage: DeferredDeleter_bench [swaps=50] [lists=100000]
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "src/stl/DeferredDeleter.hpp"
+#include "src/stl/UniquePointer.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::DeferredDeleter;
+using ecx::stl::DeferredReclaimer;
+using ecx::stl::UniquePointer;
+using ecx::stl::Vector;
+
+struct Index {
+  Vector<Vector<int>> lists;
+};
+
+Index* buildIndex(std::size_t lists) {
+  auto* index = new Index;
+  index->lists.reserve(lists);
+  for (std::size_t i = 0; i < lists; ++i) {
+    index->lists.emplace_back(1 + i % 32, static_cast<int>(i));
+  }
+  return index;
+}
+
+template <typename Deleter>
+void run(const char* name, std::size_t swaps, std::size_t lists) {
+  UniquePointer<Index, Deleter> index(buildIndex(lists));
+  double totalMs = 0;
+  double maxMs = 0;
+  for (std::size_t i = 0; i < swaps; ++i) {
+    Index* next = buildIndex(lists);
+    const auto start = std::chrono::steady_clock::now();
+    index.reset(next);
+    const double ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    totalMs += ms;
+    maxMs = std::max(maxMs, ms);
+  }
+  std::printf("%-16s reset mean %8.4f ms  max %8.4f ms\n", name,
+              totalMs / static_cast<double>(swaps), maxMs);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t swaps =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 50;
+  const std::size_t lists =
+      argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 100'000;
+
+  run<std::default_delete<Index>>("default_delete", swaps, lists);
+  run<DeferredDeleter<Index>>("DeferredDeleter", swaps, lists);
+  DeferredReclaimer::instance().drain();
+  return 0;
+}
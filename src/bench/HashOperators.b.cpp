@@ -0,0 +1,85 @@
+// Group-by sum over uint64 keys: std::unordered_map against groupBy(), with
+// one table, radix-partitioned, and partitioned over every hardware thread;
+// then a join of the keys against themselves.
+//
+// Usage: HashOperators_bench [rows=10000000] [distinct=2000000]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unordered_map>
+
+#include "src/stl/HashOperators.hpp"
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::groupBy;
+using ecx::stl::hashJoin;
+using ecx::stl::HashOptions;
+using ecx::stl::Span;
+using ecx::stl::Vector;
+
+template <typename Fn>
+void report(const char* name, std::size_t rows, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  const std::size_t out = fn();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  const double ns =
+      std::chrono::duration<double, std::nano>(elapsed).count() /
+      static_cast<double>(rows);
+  std::printf("%-16s %zu rows: %6.2f ns/row out=%zu\n", name, rows, ns, out);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t rows =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 10'000'000;
+  const std::size_t distinct =
+      argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 2'000'000;
+
+  Vector<std::uint64_t> keys;
+  Vector<std::int64_t> values;
+  for (std::size_t i = 0; i < rows; ++i) {
+    keys.push_back(i * 0x9e3779b97f4a7c15ULL % distinct);
+    values.push_back(static_cast<std::int64_t>(i % 100));
+  }
+  const Span<const std::uint64_t> keySpan(keys);
+  const Span<const std::int64_t> valueSpan(values);
+  const unsigned threads = std::thread::hardware_concurrency();
+
+  report("unordered_map", rows, [&] {
+    std::unordered_map<std::uint64_t, std::int64_t> sums;
+    for (std::size_t i = 0; i < rows; ++i) {
+      sums[keys[i]] += values[i];
+    }
+    return sums.size();
+  });
+
+  report("one table", rows, [&] {
+    const HashOptions options{.partitionBytes = SIZE_MAX};
+    return groupBy(keySpan, valueSpan, options).keys.size();
+  });
+
+  report("partitioned", rows, [&] {
+    return groupBy(keySpan, valueSpan).keys.size();
+  });
+
+  report("threaded", rows, [&] {
+    return groupBy(keySpan, valueSpan, HashOptions{.threads = threads})
+        .keys.size();
+  });
+
+  report("join", rows, [&] {
+    const Span<const std::uint64_t> build(keys.data(), distinct);
+    return hashJoin(build, keySpan, HashOptions{.threads = threads})
+        .probeRows.size();
+  });
+  return 0;
+}
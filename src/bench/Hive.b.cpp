@@ -0,0 +1,144 @@
+// Entity-style churn: n elements are inserted, a random half erased and
+// replaced, and the survivors summed, in Hive, in std::list (the usual
+// container with stable addresses) and in a Vector erased by swap-and-pop,
+// which moves elements and so gives no stability, as the baseline for
+// iteration speed.
+//
+// Usage: Hive_bench [elements=1000000]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <random>
+
+#include "src/stl/Hive.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::Hive;
+using ecx::stl::Vector;
+
+struct Entity {
+  std::uint64_t id;
+  double position[3];
+};
+
+template <typename T>
+void keep(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename Fn>
+double timeMs(Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+template <typename Container>
+double sumMs(const Container& entities) {
+  std::uint64_t sum = 0;
+  const double ms = timeMs([&] {
+    for (const Entity& entity : entities) {
+      sum += entity.id;
+    }
+  });
+  keep(sum);
+  return ms;
+}
+
+void report(const char* name, double insertMs, double churnMs,
+            double iterateMs) {
+  std::printf(
+      "%-8s insert %7.1f ms  erase+insert %7.1f ms  iterate %6.2f ms\n",
+      name, insertMs, churnMs, iterateMs);
+}
+
+// Erases each element with probability 1/2, then inserts as many.
+template <typename Container, typename Erase, typename Insert>
+void churn(Container& entities, std::size_t n, Erase&& erase,
+           Insert&& insert) {
+  std::mt19937_64 rng(7);
+  std::size_t erased = 0;
+  for (auto it = entities.begin(); it != entities.end();) {
+    if (rng() % 2 == 0) {
+      it = erase(it);
+      ++erased;
+    } else {
+      ++it;
+    }
+  }
+  for (std::size_t i = 0; i < erased; ++i) {
+    insert(Entity{n + i, {}});
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t n =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 1'000'000;
+
+  {
+    Hive<Entity> entities;
+    const double insertMs = timeMs([&] {
+      for (std::size_t i = 0; i < n; ++i) {
+        entities.insert(Entity{i, {}});
+      }
+    });
+    const double churnMs = timeMs([&] {
+      churn(
+          entities, n, [&](auto it) { return entities.erase(it); },
+          [&](const Entity& entity) { entities.insert(entity); });
+    });
+    report("Hive", insertMs, churnMs, sumMs(entities));
+  }
+
+  {
+    std::list<Entity> entities;
+    const double insertMs = timeMs([&] {
+      for (std::size_t i = 0; i < n; ++i) {
+        entities.push_back(Entity{i, {}});
+      }
+    });
+    const double churnMs = timeMs([&] {
+      churn(
+          entities, n, [&](auto it) { return entities.erase(it); },
+          [&](const Entity& entity) { entities.push_back(entity); });
+    });
+    report("list", insertMs, churnMs, sumMs(entities));
+  }
+
+  {
+    Vector<Entity> entities;
+    const double insertMs = timeMs([&] {
+      for (std::size_t i = 0; i < n; ++i) {
+        entities.push_back(Entity{i, {}});
+      }
+    });
+    const double churnMs = timeMs([&] {
+      std::mt19937_64 rng(7);
+      std::size_t erased = 0;
+      for (std::size_t i = 0; i < entities.size();) {
+        if (rng() % 2 == 0) {
+          entities[i] = entities[entities.size() - 1];
+          entities.pop_back();
+          ++erased;
+        } else {
+          ++i;
+        }
+      }
+      for (std::size_t i = 0; i < erased; ++i) {
+        entities.push_back(Entity{n + i, {}});
+      }
+    });
+    report("Vector", insertMs, churnMs, sumMs(entities));
+  }
+  return 0;
+}
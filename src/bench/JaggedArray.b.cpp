@@ -0,0 +1,153 @@
+// Adjacency lists of a random graph as Vector<Vector<T>> and as a
+// JaggedArray built in two passes, on one thread and on several: build
+// time, the time to scan every edge, and the footprint (headers, offsets
+// and element capacity, without allocator overhead).
+//
+// Usage: JaggedArray_bench [nodes=1000000] [edges=10000000] [threads=4]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+#include "src/stl/JaggedArray.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::JaggedArray;
+using ecx::stl::Vector;
+
+using Graph = JaggedArray<std::uint32_t>;
+
+template <typename T>
+void keep(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename Fn>
+double timeMs(Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void report(const char* name, double buildMs, double scanMs,
+            std::size_t bytes) {
+  std::printf("%-18s build %8.1f ms  scan %6.1f ms  %7.1f MiB\n", name,
+              buildMs, scanMs, static_cast<double>(bytes) / (1 << 20));
+}
+
+// Runs perEdge(e) over [0, edges), split across threads.
+template <typename PerEdge>
+void forEachEdge(std::size_t edges, unsigned threads, PerEdge&& perEdge) {
+  Vector<std::jthread> workers;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      const std::size_t first = edges * t / threads;
+      const std::size_t last = edges * (t + 1) / threads;
+      for (std::size_t e = first; e < last; ++e) {
+        perEdge(e);
+      }
+    });
+  }
+}
+
+Graph buildGraph(const Vector<std::uint32_t>& from,
+                 const Vector<std::uint32_t>& to, std::size_t nodes,
+                 unsigned threads) {
+  Graph::Builder builder(nodes);
+  if (threads == 1) {
+    for (std::size_t e = 0; e < from.size(); ++e) {
+      builder.count(from[e]);
+    }
+    builder.allocate();
+    for (std::size_t e = 0; e < from.size(); ++e) {
+      builder.fill(from[e], to[e]);
+    }
+    return std::move(builder).build();
+  }
+
+  forEachEdge(from.size(), threads,
+              [&](std::size_t e) { builder.countConcurrent(from[e]); });
+  builder.allocate();
+  forEachEdge(from.size(), threads,
+              [&](std::size_t e) { builder.fillConcurrent(from[e], to[e]); });
+  return std::move(builder).build();
+}
+
+void runGraph(const char* name, const Vector<std::uint32_t>& from,
+              const Vector<std::uint32_t>& to, std::size_t nodes,
+              unsigned threads) {
+  Graph graph;
+  const double buildMs =
+      timeMs([&] { graph = buildGraph(from, to, nodes, threads); });
+  std::uint64_t sum = 0;
+  const double scanMs = timeMs([&] {
+    for (std::size_t r = 0; r < graph.rows(); ++r) {
+      for (std::uint32_t v : graph[r]) {
+        sum += v;
+      }
+    }
+  });
+  keep(sum);
+  report(name, buildMs, scanMs,
+         (graph.rows() + 1) * sizeof(std::size_t) +
+             graph.size() * sizeof(std::uint32_t));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t nodes =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 1'000'000;
+  const std::size_t edges =
+      argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 10'000'000;
+  const unsigned threads =
+      argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 4;
+
+  std::mt19937_64 rng(42);
+  Vector<std::uint32_t> from;
+  Vector<std::uint32_t> to;
+  from.reserve(edges);
+  to.reserve(edges);
+  for (std::size_t e = 0; e < edges; ++e) {
+    from.push_back(static_cast<std::uint32_t>(rng() % nodes));
+    to.push_back(static_cast<std::uint32_t>(rng() % nodes));
+  }
+
+  {
+    Vector<Vector<std::uint32_t>> lists;
+    const double buildMs = timeMs([&] {
+      lists.resize(nodes);
+      for (std::size_t e = 0; e < edges; ++e) {
+        lists[from[e]].push_back(to[e]);
+      }
+    });
+    std::uint64_t sum = 0;
+    const double scanMs = timeMs([&] {
+      for (const auto& list : lists) {
+        for (std::uint32_t v : list) {
+          sum += v;
+        }
+      }
+    });
+    keep(sum);
+    std::size_t bytes = nodes * sizeof(Vector<std::uint32_t>);
+    for (const auto& list : lists) {
+      bytes += list.capacity() * sizeof(std::uint32_t);
+    }
+    report("Vector<Vector>", buildMs, scanMs, bytes);
+  }
+
+  runGraph("JaggedArray (1)", from, to, nodes, 1);
+  char name[32];
+  std::snprintf(name, sizeof(name), "JaggedArray (%u)", threads);
+  runGraph(name, from, to, nodes, threads);
+  return 0;
+}
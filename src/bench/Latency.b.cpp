@@ -0,0 +1,144 @@
+// Per-operation latency of push_back, emplace_back and makeUnique, as
+// percentiles rather than a mean: the amortised cost of push_back is a few
+// ns, but every doubling copies the whole Vector, and that shows at the tail.
+// Each operation is timed with the TSC; each thread records into its own
+// histogram, and those are merged. The "timer" row is the cost of timing an
+// empty region, included in every other row.
+//
+// Usage: Latency_bench [operations=1000000] [threads=1]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "src/stl/HdrHistogram.hpp"
+#include "src/stl/UniquePointer.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::HdrHistogram;
+using ecx::stl::makeUnique;
+using ecx::stl::UniquePointer;
+using ecx::stl::Vector;
+
+using Histogram = HdrHistogram<>;
+
+std::uint64_t ticks() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+struct Record {
+  std::uint64_t id;
+  double weight;
+  std::string label;
+
+  Record(std::uint64_t id, double weight) : id(id), weight(weight) {}
+};
+
+template <typename Op>
+void timeEach(std::size_t operations, Histogram& histogram, Op&& op) {
+  for (std::size_t i = 0; i < operations; ++i) {
+    const std::uint64_t start = ticks();
+    op(i);
+    histogram.record(ticks() - start);
+  }
+}
+
+// Runs body(histogram) on each thread and merges what they recorded.
+template <typename Body>
+Histogram onThreads(unsigned threads, Body&& body) {
+  Vector<Histogram> perThread(threads);
+  {
+    Vector<std::jthread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] { body(perThread[t]); });
+    }
+  }
+  Histogram merged;
+  for (const Histogram& histogram : perThread) {
+    merged.merge(histogram);
+  }
+  return merged;
+}
+
+void report(const char* name, const Histogram& histogram,
+            double nsPerTick) {
+  const auto ns = [&](std::uint64_t t) {
+    return static_cast<double>(t) * nsPerTick;
+  };
+  std::printf(
+      "%-14s p50 %8.1f  p99 %8.1f  p99.9 %10.1f  max %12.1f  mean %7.1f ns\n",
+      name, ns(histogram.valueAtPercentile(50)),
+      ns(histogram.valueAtPercentile(99)),
+      ns(histogram.valueAtPercentile(99.9)), ns(histogram.max()),
+      histogram.mean() * nsPerTick);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t operations =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 1'000'000;
+  const unsigned threads =
+      argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 1;
+
+  const auto wallStart = std::chrono::steady_clock::now();
+  const std::uint64_t tickStart = ticks();
+
+  const Histogram timer = onThreads(threads, [&](Histogram& histogram) {
+    timeEach(operations, histogram, [](std::size_t) {});
+  });
+
+  const Histogram pushBack = onThreads(threads, [&](Histogram& histogram) {
+    Vector<std::uint64_t> values;
+    timeEach(operations, histogram,
+             [&](std::size_t i) { values.push_back(i); });
+  });
+
+  const Histogram reserved = onThreads(threads, [&](Histogram& histogram) {
+    Vector<std::uint64_t> values;
+    values.reserve(operations);
+    timeEach(operations, histogram,
+             [&](std::size_t i) { values.push_back(i); });
+  });
+
+  const Histogram emplaceBack = onThreads(threads, [&](Histogram& histogram) {
+    Vector<Record> records;
+    timeEach(operations, histogram, [&](std::size_t i) {
+      records.emplace_back(i, static_cast<double>(i));
+    });
+  });
+
+  const Histogram unique = onThreads(threads, [&](Histogram& histogram) {
+    // Kept alive, so that frees stay out of the timed region.
+    Vector<UniquePointer<Record>> owned;
+    owned.reserve(operations);
+    timeEach(operations, histogram, [&](std::size_t i) {
+      owned.push_back(makeUnique<Record>(i, 0.0));
+    });
+  });
+
+  const double nsPerTick =
+      std::chrono::duration<double, std::nano>(
+          std::chrono::steady_clock::now() - wallStart)
+          .count() /
+      static_cast<double>(ticks() - tickStart);
+
+  std::printf("%zu operations on %u thread(s)\n", operations, threads);
+  report("timer", timer, nsPerTick);
+  report("push_back", pushBack, nsPerTick);
+  report("push_back (r)", reserved, nsPerTick);
+  report("emplace_back", emplaceBack, nsPerTick);
+  report("makeUnique", unique, nsPerTick);
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Square float matrix product: the naive triple loop over
+// Vector<Vector<float>> that scoring code used to do, against multiply() on
+// one thread and on all hardware threads.
+//
+// Usage: Matrix_bench [n=1024]
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "src/stl/Matrix.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::GemmOptions;
+using ecx::stl::Matrix;
+using ecx::stl::Vector;
+
+template <typename Fn>
+void report(const char* name, std::size_t n, Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  const float checksum = fn();
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  const double seconds = std::chrono::duration<double>(elapsed).count();
+  const double flops = 2.0 * static_cast<double>(n) * static_cast<double>(n) *
+                       static_cast<double>(n);
+  std::printf("%-22s n=%zu: %9.2f ms (%7.2f GFLOP/s) checksum=%g\n", name, n,
+              seconds * 1e3, flops / seconds * 1e-9,
+              static_cast<double>(checksum));
+}
+
+float value(std::size_t i, std::size_t j) {
+  return static_cast<float>((i * 31 + j * 17) % 13) * 0.25F;
+}
+
+void runNaive(std::size_t n) {
+  Vector<Vector<float>> a(n, Vector<float>(n));
+  Vector<Vector<float>> b(n, Vector<float>(n));
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      a[i][j] = value(i, j);
+      b[i][j] = value(j, i);
+    }
+  }
+
+  report("Vector<Vector<float>>", n, [&] {
+    Vector<Vector<float>> c(n, Vector<float>(n));
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t j = 0; j < n; ++j) {
+        float sum = 0;
+        for (std::size_t p = 0; p < n; ++p) {
+          sum += a[i][p] * b[p][j];
+        }
+        c[i][j] = sum;
+      }
+    }
+    return c[n / 2][n / 3];
+  });
+}
+
+void runMatrix(std::size_t n, unsigned threads) {
+  Matrix<float> a(n, n);
+  Matrix<float> b(n, n);
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j < n; ++j) {
+      a[i, j] = value(i, j);
+      b[i, j] = value(j, i);
+    }
+  }
+
+  char name[32];
+  std::snprintf(name, sizeof(name), "Matrix %u threads", threads);
+  report(name, n, [&] {
+    const auto c = multiply(a, b, GemmOptions{.threads = threads});
+    return c[n / 2, n / 3];
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t n =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 1024;
+
+  runNaive(n);
+  runMatrix(n, 1);
+  runMatrix(n, std::max(std::thread::hardware_concurrency(), 1U));
+  return 0;
+}
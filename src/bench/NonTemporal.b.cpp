@@ -0,0 +1,90 @@
+// Cost of a large copy to the caller's working set: a hot table is summed,
+// a large buffer is copied with memcpy or streamingCopy, and the table is
+// summed again. With memcpy the copy's destination evicts the table, and the
+// second sum runs from memory; non-temporal stores leave it in the cache.
+// The copies themselves are timed too, as streaming stores to memory that is
+// read back straight away would be slower.
+//
+// Usage: NonTemporal_bench [copyMiB=256] [hotKiB=1024] [threads=1]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+
+#include "src/stl/NonTemporal.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::streamingCopy;
+using ecx::stl::Vector;
+
+template <typename T>
+void keep(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename Fn>
+double timeMs(Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+double sumNs(const Vector<std::uint64_t>& hot) {
+  std::uint64_t sum = 0;
+  const double ms = timeMs([&] {
+    for (std::uint64_t value : hot) {
+      sum += value;
+    }
+  });
+  keep(sum);
+  return ms * 1e6 / static_cast<double>(hot.size());
+}
+
+template <typename Copy>
+void run(const char* name, Vector<std::uint64_t>& hot,
+         Vector<std::uint8_t>& dst, const Vector<std::uint8_t>& src,
+         Copy&& copy) {
+  sumNs(hot);
+  const double before = sumNs(hot);
+  const double ms = timeMs([&] { copy(dst.data(), src.data(), src.size()); });
+  const double after = sumNs(hot);
+  std::printf("%-18s copy %8.2f ms (%6.2f GB/s)  hot sum %5.2f -> %5.2f ns\n",
+              name, ms, static_cast<double>(src.size()) / ms / 1e6, before,
+              after);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t copyBytes =
+      (argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 256) << 20;
+  const std::size_t hotBytes =
+      (argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 1024) << 10;
+  const unsigned threads =
+      argc > 3 ? static_cast<unsigned>(std::atoi(argv[3])) : 1;
+
+  Vector<std::uint64_t> hot(hotBytes / sizeof(std::uint64_t));
+  std::iota(hot.begin(), hot.end(), 0u);
+  const Vector<std::uint8_t> src(copyBytes, 1);
+  // Touched first, so that page faults stay out of the timings.
+  Vector<std::uint8_t> dst(copyBytes, 0);
+
+  for (int round = 0; round < 2; ++round) {
+    run("memcpy", hot, dst, src, [](void* d, const void* s, std::size_t n) {
+      std::memcpy(d, s, n);
+    });
+    run("streamingCopy", hot, dst, src,
+        [&](void* d, const void* s, std::size_t n) {
+          streamingCopy(d, s, n, threads);
+        });
+  }
+  return 0;
+}
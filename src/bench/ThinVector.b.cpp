@@ -0,0 +1,106 @@
+// Per-node adjacency lists of a sparse graph, as Vector, CompactVector and
+// ThinVector: total footprint (the vectors themselves plus their heap
+// buffers, with allocator overhead left out) and the time to build the lists
+// and to traverse every edge. Most nodes have no or few edges, which is where
+// the 24-byte header dominates.
+//
+// Usage: ThinVector_bench [nodes=1000000] [edges=2000000]
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "src/stl/ThinVector.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::CompactVector;
+using ecx::stl::ThinVector;
+using ecx::stl::Vector;
+
+template <typename T>
+void keep(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename Fn>
+double timeMs(Fn&& fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Heap bytes behind one list: capacity, plus ThinVector's header.
+template <typename List>
+std::size_t heapBytes(const List& list, std::size_t header) {
+  return list.capacity() == 0
+             ? 0
+             : list.capacity() * sizeof(std::uint32_t) + header;
+}
+
+template <typename List>
+void run(const char* name, const Vector<std::uint32_t>& from,
+         const Vector<std::uint32_t>& to, std::size_t nodes,
+         std::size_t header) {
+  Vector<List> lists;
+  const double buildMs = timeMs([&] {
+    lists.resize(nodes);
+    for (std::size_t e = 0; e < from.size(); ++e) {
+      lists[from[e]].push_back(to[e]);
+    }
+  });
+
+  std::uint64_t sum = 0;
+  const double traverseMs = timeMs([&] {
+    for (const List& list : lists) {
+      for (std::uint32_t v : list) {
+        sum += v;
+      }
+    }
+  });
+  keep(sum);
+
+  std::size_t bytes = nodes * sizeof(List);
+  for (const List& list : lists) {
+    bytes += heapBytes(list, header);
+  }
+  std::printf(
+      "%-14s %2zu B/list  %8.1f MiB  build %7.1f ms  traverse %6.1f ms\n",
+      name, sizeof(List), static_cast<double>(bytes) / (1 << 20), buildMs,
+      traverseMs);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t nodes =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 1'000'000;
+  const std::size_t edges =
+      argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 2'000'000;
+
+  // Skewed sources: a few hubs, and a long tail of nodes with 0-2 edges.
+  std::mt19937_64 rng(42);
+  std::geometric_distribution<std::uint32_t> skew(0.3);
+  Vector<std::uint32_t> from;
+  Vector<std::uint32_t> to;
+  from.reserve(edges);
+  to.reserve(edges);
+  for (std::size_t e = 0; e < edges; ++e) {
+    const std::uint32_t hub = skew(rng) % 16;
+    from.push_back(static_cast<std::uint32_t>(
+        hub == 0 ? rng() % 64 : rng() % nodes));
+    to.push_back(static_cast<std::uint32_t>(rng() % nodes));
+  }
+
+  run<Vector<std::uint32_t>>("Vector", from, to, nodes, 0);
+  run<CompactVector<std::uint32_t>>("CompactVector", from, to, nodes, 0);
+  run<ThinVector<std::uint32_t>>("ThinVector", from, to, nodes,
+                                 2 * sizeof(std::size_t));
+  return 0;
+}
@@ -0,0 +1,151 @@
+// Producer/consumer churn: half of the threads allocate blocks and hand them
+// to a paired consumer thread, which frees them. Every object is thus freed by
+// a different thread than the one that allocated it, which is the worst case
+// for thread caches, since memory has to flow back through the central lists.
+//
+// Usage: ThreadCachingAllocator_bench [threads=32] [objectsPerProducer=1000000]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "src/stl/ThreadCachingAllocator.hpp"
+#include "src/stl/UniquePointer.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace {
+
+using ecx::stl::makeUnique;
+using ecx::stl::ThreadCachingHeap;
+using ecx::stl::UniquePointer;
+using ecx::stl::Vector;
+
+struct Block {
+  void* ptr;
+  std::size_t size;
+};
+
+// Bounded single-producer single-consumer ring.
+class Channel {
+ public:
+  static constexpr std::size_t kCapacity = 1024;
+
+  bool tryPush(Block block) {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == kCapacity) {
+      return false;
+    }
+    slots_[tail % kCapacity] = block;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool tryPop(Block& block) {
+    const auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    block = slots_[head % kCapacity];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  Block slots_[kCapacity];
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+struct Malloc {
+  static constexpr const char* kName = "glibc malloc";
+
+  static void* allocate(std::size_t size) { return std::malloc(size); }
+  static void deallocate(void* p, std::size_t) { std::free(p); }
+};
+
+struct ThreadCaching {
+  static constexpr const char* kName = "ThreadCachingHeap";
+
+  static void* allocate(std::size_t size) {
+    return ThreadCachingHeap::instance().allocate(size);
+  }
+  static void deallocate(void* p, std::size_t size) {
+    ThreadCachingHeap::instance().deallocate(p, size);
+  }
+};
+
+// Sizes skewed towards small objects, as in typical request handling.
+std::size_t nextSize(std::uint64_t& state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  const auto r = static_cast<std::size_t>(state >> 33);
+  return r % 4 == 0 ? 16 + r % 2048 : 16 + r % 256;
+}
+
+template <typename Backend>
+void run(unsigned threads, std::size_t objectsPerProducer) {
+  const unsigned pairs = std::max(threads / 2, 1U);
+  Vector<UniquePointer<Channel>> channels;
+  for (unsigned p = 0; p < pairs; ++p) {
+    channels.push_back(makeUnique<Channel>());
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  {
+    Vector<std::jthread> workers;
+    for (unsigned p = 0; p < pairs; ++p) {
+      workers.emplace_back([&, p] {
+        std::uint64_t rng = p + 1;
+        for (std::size_t i = 0; i < objectsPerProducer; ++i) {
+          const std::size_t size = nextSize(rng);
+          auto* ptr = static_cast<unsigned char*>(Backend::allocate(size));
+          ptr[0] = static_cast<unsigned char>(i);
+          while (!channels[p]->tryPush(Block{ptr, size})) {
+            std::this_thread::yield();
+          }
+        }
+      });
+      workers.emplace_back([&, p] {
+        Block block;
+        for (std::size_t i = 0; i < objectsPerProducer; ++i) {
+          while (!channels[p]->tryPop(block)) {
+            std::this_thread::yield();
+          }
+          Backend::deallocate(block.ptr, block.size);
+        }
+      });
+    }
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  const double ops = 2.0 * pairs * static_cast<double>(objectsPerProducer);
+  const double ns =
+      std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+  std::printf("%-18s %u threads: %8.2f ns/op (%.0f Mops/s)\n", Backend::kName,
+              2 * pairs, ns, 1e3 / ns);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const unsigned threads =
+      argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 32;
+  const std::size_t objects =
+      argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 1'000'000;
+
+  run<Malloc>(threads, objects);
+  run<ThreadCaching>(threads, objects);
+
+  const auto stats = ThreadCachingHeap::instance().stats();
+  std::printf(
+      "ThreadCachingHeap stats: allocations=%zu deallocations=%zu "
+      "centralFetches=%zu centralReleases=%zu largeAllocations=%zu "
+      "spanBytes=%zu\n",
+      stats.allocations, stats.deallocations, stats.centralFetches,
+      stats.centralReleases, stats.largeAllocations, stats.spanBytes);
+  return 0;
+}
@@ -0,0 +1,79 @@
+// Vector growth and iteration, with hardware counters beside wall time, so a
+// regression can be told apart as more instructions (e.g. a lost
+// vectorisation), more misses (e.g. a changed growth factor) or more
+// branch mispredictions. Counters the machine does not expose print "n/a".
+//
+// Usage: Vector_bench [elements=10000000]
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include "src/stl/Vector.hpp"
+#include "src/testutil/PerfCounters.hpp"
+
+namespace {
+
+using ecx::stl::Vector;
+
+// Keeps the optimiser from discarding a result.
+template <typename T>
+void keep(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t n =
+      argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 10'000'000;
+
+  PerfCounters counters;
+  if (!counters.anyAvailable()) {
+    std::printf("hardware counters unavailable; wall time only\n");
+  }
+
+  Vector<std::uint64_t> values;
+  printPerfSample(stdout, "push_back (grow)", counters.measure(n, [&] {
+                    for (std::size_t i = 0; i < n; ++i) {
+                      values.push_back(i);
+                    }
+                  }));
+
+  Vector<std::uint64_t> reserved;
+  printPerfSample(stdout, "push_back (reserved)", counters.measure(n, [&] {
+                    reserved.reserve(n);
+                    for (std::size_t i = 0; i < n; ++i) {
+                      reserved.push_back(i);
+                    }
+                  }));
+
+  printPerfSample(stdout, "iterate", counters.measure(n, [&] {
+                    std::uint64_t sum = 0;
+                    for (std::uint64_t value : values) {
+                      sum += value;
+                    }
+                    keep(sum);
+                  }));
+
+  // The first copy allocates; the second reuses the storage and memcpys.
+  Vector<std::uint64_t> copy;
+  printPerfSample(stdout, "copy-assign", counters.measure(n, [&] {
+                    copy = values;
+                  }));
+  printPerfSample(stdout, "copy-assign (reuse)", counters.measure(n, [&] {
+                    copy = values;
+                  }));
+
+  // Every 8th element of a permutation: a cache miss per step once values
+  // outgrows the LLC.
+  printPerfSample(stdout, "strided", counters.measure(n / 8, [&] {
+                    std::uint64_t sum = 0;
+                    for (std::size_t i = 0; i < n; i += 8) {
+                      sum += values[i * 7919 % n];
+                    }
+                    keep(sum);
+                  }));
+  return 0;
+}
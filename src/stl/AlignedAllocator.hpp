@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+namespace ecx::stl {
+
+/**
+ * Allocator handing out storage aligned to Alignment bytes (a cache line by
+ * default), e.g. for a Vector whose rows are loaded with aligned SIMD
+ * instructions, or which must not share cache lines with its neighbours.
+ *
+ * Stateless, so it costs no space in a Vector. Supports Vector::try* through
+ * tryAllocate.
+ */
+template <typename T, std::size_t Alignment = 64>
+class AlignedAllocator {
+  static_assert((Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two");
+
+ public:
+  using value_type = T;
+
+  static constexpr std::size_t kAlignment =
+      Alignment < alignof(T) ? alignof(T) : Alignment;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  constexpr AlignedAllocator() noexcept = default;
+
+  template <typename U>
+  constexpr AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    if (n > std::allocator_traits<AlignedAllocator>::max_size(*this)) {
+#if defined(__cpp_exceptions)
+      throw std::bad_array_new_length();
+#else
+      std::abort();
+#endif
+    }
+    return static_cast<T*>(
+        ::operator new(n * sizeof(T), std::align_val_t(kAlignment)));
+  }
+
+  T* tryAllocate(std::size_t n) noexcept {
+    return static_cast<T*>(::operator new(
+        n * sizeof(T), std::align_val_t(kAlignment), std::nothrow));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    ::operator delete(p, n * sizeof(T), std::align_val_t(kAlignment));
+  }
+
+  template <typename U>
+  constexpr bool operator==(
+      const AlignedAllocator<U, Alignment>&) const noexcept {
+    return true;
+  }
+};
+
+}  // namespace ecx::stl
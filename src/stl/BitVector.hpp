@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Dynamically sized sequence of bits, packed 64 to a word.
+ *
+ * Bits past size() in the last word are kept clear, so whole-word operations
+ * (count, allSet, or a caller scanning words()) need no masking at the end.
+ */
+class BitVector {
+ public:
+  using SizeT = std::size_t;
+  using WordT = std::uint64_t;
+
+  static constexpr SizeT kWordBits = 64;
+
+  BitVector() = default;
+
+  explicit BitVector(SizeT size, bool value = false)
+      : words_(wordsFor(size), value ? ~WordT{0} : WordT{0}), size_(size) {
+    clearTail();
+  }
+
+  SizeT size() const noexcept { return size_; }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  bool test(SizeT i) const noexcept {
+    return (words_[i / kWordBits] >> (i % kWordBits)) & 1;
+  }
+
+  bool operator[](SizeT i) const noexcept { return test(i); }
+
+  void set(SizeT i, bool value = true) noexcept {
+    const WordT bit = WordT{1} << (i % kWordBits);
+    WordT& word = words_[i / kWordBits];
+    word = value ? word | bit : word & ~bit;
+  }
+
+  void reset(SizeT i) noexcept { set(i, false); }
+
+  void pushBack(bool value) {
+    if (size_ % kWordBits == 0) {
+      words_.push_back(0);
+    }
+    ++size_;
+    set(size_ - 1, value);
+  }
+
+  // Makes room for bits, so that pushBack does not reallocate below that.
+  void reserve(SizeT bits) { words_.reserve(wordsFor(bits)); }
+
+  void resize(SizeT size, bool value = false) {
+    const SizeT oldSize = size_;
+    words_.resize(wordsFor(size), value ? ~WordT{0} : WordT{0});
+    size_ = size;
+    // Bits from oldSize up to the end of its word were clear.
+    if (value && oldSize < size && oldSize % kWordBits != 0) {
+      words_[oldSize / kWordBits] |= ~WordT{0} << (oldSize % kWordBits);
+    }
+    clearTail();
+  }
+
+  void clear() noexcept {
+    words_.clear();
+    size_ = 0;
+  }
+
+  // The number of set bits.
+  SizeT count() const noexcept {
+    SizeT n = 0;
+    for (WordT word : words_) {
+      n += static_cast<SizeT>(std::popcount(word));
+    }
+    return n;
+  }
+
+  /**
+   * Whether every bit in [first, last) is set, a word at a time.
+   */
+  bool allSet(SizeT first, SizeT last) const noexcept {
+    while (first < last) {
+      const SizeT offset = first % kWordBits;
+      const SizeT bits = std::min(kWordBits - offset, last - first);
+      const WordT mask =
+          (bits == kWordBits ? ~WordT{0} : (WordT{1} << bits) - 1) << offset;
+      if ((words_[first / kWordBits] & mask) != mask) {
+        return false;
+      }
+      first += bits;
+    }
+    return true;
+  }
+
+  Span<const WordT> words() const noexcept {
+    return Span<const WordT>(words_);
+  }
+
+  friend bool operator==(const BitVector& lhs, const BitVector& rhs) noexcept {
+    if (lhs.size_ != rhs.size_) {
+      return false;
+    }
+    for (SizeT i = 0; i < lhs.words_.size(); ++i) {
+      if (lhs.words_[i] != rhs.words_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  static constexpr SizeT wordsFor(SizeT bits) noexcept {
+    return (bits + kWordBits - 1) / kWordBits;
+  }
+
+  void clearTail() noexcept {
+    if (size_ % kWordBits != 0) {
+      words_[size_ / kWordBits] &= (WordT{1} << (size_ % kWordBits)) - 1;
+    }
+  }
+
+  Vector<WordT> words_;
+  SizeT size_ = 0;
+};
+
+}  // namespace ecx::stl
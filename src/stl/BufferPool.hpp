@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "src/stl/Exceptions.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+struct BufferPoolOptions {
+  // Capacities are rounded up to powers of two in [minCapacity,
+  // maxCapacity]; larger requests are served, but not retained.
+  std::size_t minCapacity = std::size_t{4} << 10;
+  std::size_t maxCapacity = std::size_t{64} << 20;
+  // Capacity kept for reuse, over all classes and shards. Buffers returned
+  // beyond it are freed.
+  std::size_t maxRetainedBytes = std::size_t{256} << 20;
+};
+
+struct BufferPoolStats {
+  std::size_t acquires = 0;
+  // Acquires served by a retained buffer: from the caller's shard, or
+  // another's.
+  std::size_t hits = 0;
+  std::size_t steals = 0;
+  // Buffers freed on return: above maxCapacity, or over maxRetainedBytes.
+  std::size_t drops = 0;
+  std::size_t retainedBytes = 0;
+};
+
+/**
+ * Recycles large Vector<std::byte> buffers, such as per-request I/O buffers,
+ * so that a steady load stops allocating. Above glibc's mmap threshold
+ * (128 KiB to 32 MiB, adaptively), every such buffer is otherwise a fresh
+ * mmap that faults in each page it touches, and an munmap when freed.
+ *
+ *   BufferPool pool;
+ *   BufferPool::Lease buffer = pool.acquire(1 << 20);
+ *   buffer->resize(read(fd, ...));
+ *   // Returned to the pool when buffer goes out of scope.
+ *
+ * A leased Vector is empty, with a capacity of at least the requested bytes
+ * (the next power of two), and is the caller's to resize, grow or keep for
+ * good with Lease::release(). On return, it is cleared and filed under the
+ * largest class its capacity covers.
+ *
+ * Retained buffers are kept in kShards shards, each a mutex and a free list
+ * per class; a thread uses the shard its id hashes to, so the lock is
+ * uncontended unless more threads than shards hash together, and a thread
+ * that finds its shard empty takes a buffer from another before allocating.
+ * The pool must outlive its leases.
+ */
+class BufferPool {
+ public:
+  using SizeT = std::size_t;
+  using BufferT = Vector<std::byte>;
+
+  static constexpr SizeT kShards = 16;
+  static constexpr SizeT kMaxClasses = 48;
+
+  /**
+   * Move-only ownership of a leased buffer, as UniquePointer is of an
+   * object: the buffer goes back to the pool when the lease is destroyed,
+   * reset, or assigned over.
+   */
+  class Lease {
+   public:
+    Lease() noexcept = default;
+
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+
+    Lease(Lease&& other) noexcept
+        : pool_(std::exchange(other.pool_, nullptr)),
+          buffer_(std::move(other.buffer_)) {}
+
+    Lease& operator=(Lease&& other) noexcept {
+      if (this == &other) {
+        return *this;
+      }
+      reset();
+      pool_ = std::exchange(other.pool_, nullptr);
+      buffer_ = std::move(other.buffer_);
+      return *this;
+    }
+
+    ~Lease() { reset(); }
+
+    // Returns the buffer to the pool now.
+    void reset() noexcept {
+      if (BufferPool* pool = std::exchange(pool_, nullptr)) {
+        pool->recycle(std::move(buffer_));
+      }
+    }
+
+    /**
+     * Takes the buffer out of the pool's hands for good.
+     */
+    BufferT release() noexcept {
+      pool_ = nullptr;
+      return std::move(buffer_);
+    }
+
+    BufferT& operator*() noexcept { return buffer_; }
+    const BufferT& operator*() const noexcept { return buffer_; }
+    BufferT* operator->() noexcept { return &buffer_; }
+    const BufferT* operator->() const noexcept { return &buffer_; }
+    BufferT* get() noexcept { return pool_ ? &buffer_ : nullptr; }
+
+    explicit operator bool() const noexcept { return pool_ != nullptr; }
+
+   private:
+    friend class BufferPool;
+
+    Lease(BufferPool* pool, BufferT&& buffer) noexcept
+        : pool_(pool), buffer_(std::move(buffer)) {}
+
+    BufferPool* pool_ = nullptr;
+    BufferT buffer_;
+  };
+
+  explicit BufferPool(BufferPoolOptions options = {})
+      : minShift_(ceilLog2(options.minCapacity)),
+        classes_(std::min<SizeT>(
+            kMaxClasses,
+            ceilLog2(std::max(options.maxCapacity, options.minCapacity)) -
+                minShift_ + 1)),
+        maxRetainedBytes_(options.maxRetainedBytes) {}
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  /**
+   * An empty buffer with capacity() >= bytes: a retained one if any, or
+   * else a new allocation.
+   */
+  Lease acquire(SizeT bytes) {
+    acquires_.fetch_add(1, std::memory_order_relaxed);
+    const SizeT cls = classOf(bytes);
+    if (cls >= classes_) {
+      BufferT buffer;
+      buffer.reserve(bytes);
+      return Lease(this, std::move(buffer));
+    }
+
+    const SizeT home = localShard();
+    for (SizeT i = 0; i < kShards; ++i) {
+      Shard& shard = shards_[(home + i) % kShards];
+      // Other shards are only searched if free, rather than waited for.
+      std::unique_lock lock(shard.mutex, std::defer_lock);
+      if (i == 0) {
+        lock.lock();
+      } else if (!lock.try_lock()) {
+        continue;
+      }
+      Vector<BufferT>& list = shard.lists[cls];
+      if (!list.empty()) {
+        BufferT buffer = std::move(list[list.size() - 1]);
+        list.pop_back();
+        lock.unlock();
+        retainedBytes_.fetch_sub(buffer.capacity(),
+                                 std::memory_order_relaxed);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        if (i != 0) {
+          steals_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return Lease(this, std::move(buffer));
+      }
+    }
+
+    BufferT buffer;
+    buffer.reserve(classCapacity(cls));
+    return Lease(this, std::move(buffer));
+  }
+
+  BufferPoolStats stats() const noexcept {
+    return BufferPoolStats{
+        .acquires = acquires_.load(std::memory_order_relaxed),
+        .hits = hits_.load(std::memory_order_relaxed),
+        .steals = steals_.load(std::memory_order_relaxed),
+        .drops = drops_.load(std::memory_order_relaxed),
+        .retainedBytes = retainedBytes_.load(std::memory_order_relaxed),
+    };
+  }
+
+  /**
+   * Frees every retained buffer.
+   */
+  void trim() noexcept {
+    for (Shard& shard : shards_) {
+      std::lock_guard lock(shard.mutex);
+      for (SizeT cls = 0; cls < classes_; ++cls) {
+        for (const BufferT& buffer : shard.lists[cls]) {
+          retainedBytes_.fetch_sub(buffer.capacity(),
+                                   std::memory_order_relaxed);
+        }
+        shard.lists[cls].clear();
+      }
+    }
+  }
+
+  SizeT classCapacity(SizeT cls) const noexcept {
+    return SizeT{1} << (minShift_ + cls);
+  }
+
+ private:
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::array<Vector<BufferT>, kMaxClasses> lists;
+  };
+
+  static unsigned ceilLog2(SizeT n) noexcept {
+    return static_cast<unsigned>(std::bit_width(std::max<SizeT>(n, 1) - 1));
+  }
+
+  // The smallest class holding bytes.
+  SizeT classOf(SizeT bytes) const noexcept {
+    const unsigned shift = ceilLog2(bytes);
+    return shift <= minShift_ ? 0 : shift - minShift_;
+  }
+
+  static SizeT localShard() noexcept {
+    thread_local const SizeT shard =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) % kShards;
+    return shard;
+  }
+
+  void recycle(BufferT&& buffer) noexcept {
+    const SizeT capacity = buffer.capacity();
+    // Filed under the largest class it covers, so that it satisfies any
+    // request of that class.
+    const auto shift = static_cast<unsigned>(std::bit_width(capacity));
+    if (shift <= minShift_ || shift - minShift_ > classes_) {
+      drop(std::move(buffer));
+      return;
+    }
+    const SizeT cls = shift - minShift_ - 1;
+
+    if (retainedBytes_.fetch_add(capacity, std::memory_order_relaxed) +
+            capacity >
+        maxRetainedBytes_) {
+      retainedBytes_.fetch_sub(capacity, std::memory_order_relaxed);
+      drop(std::move(buffer));
+      return;
+    }
+
+    buffer.clear();
+    Shard& shard = shards_[localShard()];
+    std::lock_guard lock(shard.mutex);
+    // Growing the list may throw; the buffer is then freed instead.
+    ECX_TRY {
+      shard.lists[cls].push_back(std::move(buffer));
+    } ECX_CATCH_ALL {
+      retainedBytes_.fetch_sub(capacity, std::memory_order_relaxed);
+      drops_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void drop(BufferT&& buffer) noexcept {
+    BufferT freed(std::move(buffer));
+    drops_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  const unsigned minShift_;
+  const SizeT classes_;
+  const SizeT maxRetainedBytes_;
+  std::array<Shard, kShards> shards_;
+
+  std::atomic<SizeT> acquires_{0};
+  std::atomic<SizeT> hits_{0};
+  std::atomic<SizeT> steals_{0};
+  std::atomic<SizeT> drops_{0};
+  std::atomic<SizeT> retainedBytes_{0};
+};
+
+}  // namespace ecx::stl
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Buffered reader over a file descriptor, splitting its contents into records
+ * without copying them.
+ *
+ * Input is read in large chunks into one reusable buffer, and records are
+ * returned as string_views into it; a view is only valid until the next call
+ * on the reader. The buffer grows (doubling) only when a single record does
+ * not fit.
+ *
+ * Delimiters are found with memchr, which glibc vectorises (SSE2/AVX2/EVEX,
+ * picked at load time), and every byte is scanned at most once, even when a
+ * record straddles reads.
+ *
+ * Read errors throw std::system_error; EINTR is retried.
+ */
+class ByteStreamReader {
+ public:
+  using SizeT = std::size_t;
+
+  static constexpr SizeT kDefaultChunkSize = SizeT{1} << 20;
+
+  explicit ByteStreamReader(int fd, SizeT chunkSize = kDefaultChunkSize)
+      : fd_(fd), buffer_(std::max<SizeT>(chunkSize, 1)) {}
+
+  ByteStreamReader(const ByteStreamReader&) = delete;
+  ByteStreamReader& operator=(const ByteStreamReader&) = delete;
+
+  /**
+   * The next record terminated by delimiter, excluding it. A final record
+   * without a delimiter is returned as-is; nullopt once the input is
+   * exhausted.
+   */
+  std::optional<std::string_view> nextRecord(char delimiter) {
+    while (true) {
+      const char* first = buffer_.data() + begin_;
+      const char* found = static_cast<const char*>(std::memchr(
+          buffer_.data() + scanned_, delimiter, end_ - scanned_));
+      if (found) {
+        const auto length = static_cast<SizeT>(found - first);
+        begin_ = scanned_ = begin_ + length + 1;
+        return std::string_view(first, length);
+      }
+      scanned_ = end_;
+
+      if (!fill()) {
+        if (begin_ == end_) {
+          return std::nullopt;
+        }
+        std::string_view last(buffer_.data() + begin_, end_ - begin_);
+        begin_ = scanned_ = end_;
+        return last;
+      }
+    }
+  }
+
+  /**
+   * The next '\n'-terminated line, without the terminator (or a preceding
+   * '\r').
+   */
+  std::optional<std::string_view> nextLine() {
+    auto line = nextRecord('\n');
+    if (line && line->ends_with('\r')) {
+      line->remove_suffix(1);
+    }
+    return line;
+  }
+
+  /**
+   * The next n bytes, for fixed-size records. At the end of the input, the
+   * remaining bytes if fewer; nullopt once the input is exhausted.
+   */
+  std::optional<std::string_view> nextBytes(SizeT n) {
+    while (end_ - begin_ < n && fill()) {
+    }
+    if (begin_ == end_) {
+      return std::nullopt;
+    }
+    const SizeT length = std::min(n, end_ - begin_);
+    std::string_view record(buffer_.data() + begin_, length);
+    begin_ += length;
+    scanned_ = std::max(scanned_, begin_);
+    return record;
+  }
+
+ private:
+  // Reads more input after the unconsumed bytes, compacting or growing the
+  // buffer to make room. Returns false at end of input.
+  bool fill() {
+    if (eof_) {
+      return false;
+    }
+    if (begin_ > 0) {
+      std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+      end_ -= begin_;
+      scanned_ -= begin_;
+      begin_ = 0;
+    }
+    if (end_ == buffer_.size()) {
+      buffer_.resize(buffer_.size() * 2);
+    }
+
+    while (true) {
+      const ssize_t n =
+          ::read(fd_, buffer_.data() + end_, buffer_.size() - end_);
+      if (n > 0) {
+        end_ += static_cast<SizeT>(n);
+        return true;
+      }
+      if (n == 0) {
+        eof_ = true;
+        return false;
+      }
+      if (errno != EINTR) {
+        throw std::system_error(errno, std::system_category(), "read");
+      }
+    }
+  }
+
+  int fd_;
+  Vector<char> buffer_;
+  // Unconsumed bytes are [begin_, end_); [begin_, scanned_) holds no
+  // delimiter.
+  SizeT begin_ = 0;
+  SizeT scanned_ = 0;
+  SizeT end_ = 0;
+  bool eof_ = false;
+};
+
+/**
+ * Buffered writer to a file descriptor, the counterpart of ByteStreamReader.
+ *
+ * Writes are gathered in one buffer and flushed with a single write() when it
+ * fills; a write larger than the buffer goes out together with the pending
+ * bytes in a single writev(), without being copied.
+ *
+ * Write errors throw std::system_error; EINTR and short writes are retried.
+ * The destructor flushes, but swallows errors, so call flush() to see them.
+ */
+class ByteStreamWriter {
+ public:
+  using SizeT = std::size_t;
+
+  static constexpr SizeT kDefaultBufferSize = SizeT{1} << 20;
+
+  explicit ByteStreamWriter(int fd, SizeT bufferSize = kDefaultBufferSize)
+      : fd_(fd), buffer_(std::max<SizeT>(bufferSize, 1)) {}
+
+  ByteStreamWriter(const ByteStreamWriter&) = delete;
+  ByteStreamWriter& operator=(const ByteStreamWriter&) = delete;
+
+  ~ByteStreamWriter() {
+    try {
+      flush();
+    } catch (const std::system_error&) {
+    }
+  }
+
+  void write(std::string_view bytes) {
+    if (bytes.size() <= buffer_.size() - used_) {
+      std::memcpy(buffer_.data() + used_, bytes.data(), bytes.size());
+      used_ += bytes.size();
+      return;
+    }
+    if (bytes.size() < buffer_.size()) {
+      flush();
+      write(bytes);
+      return;
+    }
+
+    iovec parts[] = {{buffer_.data(), used_},
+                     {const_cast<char*>(bytes.data()), bytes.size()}};
+    writeAll(parts);
+    used_ = 0;
+  }
+
+  void writeRecord(std::string_view record, char delimiter = '\n') {
+    write(record);
+    write(std::string_view(&delimiter, 1));
+  }
+
+  void flush() {
+    if (used_ == 0) {
+      return;
+    }
+    iovec parts[] = {{buffer_.data(), used_}, {nullptr, 0}};
+    writeAll(parts);
+    used_ = 0;
+  }
+
+  // Bytes written but not yet flushed.
+  SizeT pending() const noexcept { return used_; }
+
+ private:
+  void writeAll(iovec (&parts)[2]) {
+    iovec* first = parts;
+    int count = 2;
+    while (count > 0) {
+      if (first->iov_len == 0) {
+        ++first;
+        --count;
+        continue;
+      }
+      const ssize_t n = ::writev(fd_, first, count);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::system_error(errno, std::system_category(), "writev");
+      }
+
+      // Skip past what was written, which may end mid-part.
+      auto written = static_cast<SizeT>(n);
+      while (count > 0 && written >= first->iov_len) {
+        written -= first->iov_len;
+        ++first;
+        --count;
+      }
+      if (count > 0) {
+        first->iov_base = static_cast<char*>(first->iov_base) + written;
+        first->iov_len -= written;
+      }
+    }
+  }
+
+  int fd_;
+  Vector<char> buffer_;
+  SizeT used_ = 0;
+};
+
+}  // namespace ecx::stl
@@ -0,0 +1,491 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "src/stl/BitVector.hpp"
+#include "src/stl/Optional.hpp"
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Row indices into a ColumnTable, ascending: the output of a filter, and the
+ * input to further filters, aggregates and take(). Tables are thus limited
+ * to 2^32 rows, halving the selection's footprint.
+ */
+using SelectionVector = Vector<std::uint32_t>;
+
+template <typename T>
+concept ColumnValue =
+    std::same_as<T, std::int32_t> || std::same_as<T, std::int64_t> ||
+    std::same_as<T, std::uint32_t> || std::same_as<T, std::uint64_t> ||
+    std::same_as<T, float> || std::same_as<T, double>;
+
+/**
+ * One column: the values, contiguous, and a validity bit per row (clear for
+ * null). A null row still has a value slot, holding T{}, so that kernels can
+ * read every slot and mask instead of branching.
+ */
+template <ColumnValue T>
+class Column {
+ public:
+  using SizeT = std::size_t;
+  using ValueT = T;
+
+  SizeT size() const noexcept { return values_.size(); }
+
+  const Vector<T>& values() const noexcept { return values_; }
+
+  const BitVector& validity() const noexcept { return validity_; }
+
+  bool isValid(SizeT row) const noexcept { return validity_.test(row); }
+
+  SizeT nullCount() const noexcept { return size() - validity_.count(); }
+
+  void append(T value) {
+    values_.push_back(value);
+    validity_.pushBack(true);
+  }
+
+  void appendNull() {
+    values_.push_back(T{});
+    validity_.pushBack(false);
+  }
+
+  void reserve(SizeT rows) {
+    values_.reserve(rows);
+    validity_.reserve(rows);
+  }
+
+ private:
+  Vector<T> values_;
+  BitVector validity_;
+};
+
+using AnyColumn =
+    std::variant<Column<std::int32_t>, Column<std::int64_t>,
+                 Column<std::uint32_t>, Column<std::uint64_t>, Column<float>,
+                 Column<double>>;
+
+/**
+ * Table stored column by column, so that a scan over one field reads only
+ * that field's values, densely, instead of striding over whole rows.
+ *
+ * Columns are looked up by name and type; asking for a column with the wrong
+ * type throws std::bad_variant_access, and for a missing one,
+ * std::out_of_range. All columns are expected to have the same length.
+ * References to columns are invalidated by adding a column.
+ */
+class ColumnTable {
+ public:
+  using SizeT = std::size_t;
+
+  template <ColumnValue T>
+  Column<T>& addColumn(std::string name) {
+    if (hasColumn(name)) {
+      throw std::invalid_argument("duplicate column: " + name);
+    }
+    names_.push_back(std::move(name));
+    columns_.emplace_back(std::in_place_type<Column<T>>);
+    return std::get<Column<T>>(columns_.back());
+  }
+
+  bool hasColumn(std::string_view name) const noexcept {
+    return std::find(names_.begin(), names_.end(), name) != names_.end();
+  }
+
+  template <ColumnValue T>
+  Column<T>& column(std::string_view name) {
+    return std::get<Column<T>>(columns_[indexOf(name)]);
+  }
+
+  template <ColumnValue T>
+  const Column<T>& column(std::string_view name) const {
+    return std::get<Column<T>>(columns_[indexOf(name)]);
+  }
+
+  const AnyColumn& anyColumn(std::string_view name) const {
+    return columns_[indexOf(name)];
+  }
+
+  SizeT columnCount() const noexcept { return columns_.size(); }
+
+  Span<const std::string> columnNames() const noexcept {
+    return Span<const std::string>(names_);
+  }
+
+  SizeT rows() const noexcept {
+    return columns_.size() == 0
+               ? 0
+               : std::visit([](const auto& c) { return c.size(); },
+                            columns_[0]);
+  }
+
+  /**
+   * A table of just the named columns, in the given order.
+   */
+  ColumnTable project(std::initializer_list<std::string_view> names) const {
+    ColumnTable result;
+    for (std::string_view name : names) {
+      result.names_.emplace_back(name);
+      result.columns_.push_back(columns_[indexOf(name)]);
+    }
+    return result;
+  }
+
+  /**
+   * A table of the selected rows, in selection order.
+   */
+  ColumnTable take(const SelectionVector& rows) const {
+    ColumnTable result;
+    for (SizeT c = 0; c < columns_.size(); ++c) {
+      result.names_.push_back(names_[c]);
+      result.columns_.push_back(std::visit(
+          [&]<typename T>(const Column<T>& source) -> AnyColumn {
+            Column<T> gathered;
+            gathered.reserve(rows.size());
+            for (std::uint32_t row : rows) {
+              if (source.isValid(row)) {
+                gathered.append(source.values()[row]);
+              } else {
+                gathered.appendNull();
+              }
+            }
+            return gathered;
+          },
+          columns_[c]));
+    }
+    return result;
+  }
+
+ private:
+  SizeT indexOf(std::string_view name) const {
+    const auto it = std::find(names_.begin(), names_.end(), name);
+    if (it == names_.end()) {
+      throw std::out_of_range("no such column: " + std::string(name));
+    }
+    return static_cast<SizeT>(it - names_.begin());
+  }
+
+  Vector<std::string> names_;
+  Vector<AnyColumn> columns_;
+};
+
+enum class CompareOp : std::uint8_t { kEq, kNe, kLt, kLe, kGt, kGe };
+
+/**
+ * Result of aggregate(): the sum is widened (int64/uint64/double) so that it
+ * does not overflow the column type; min and max are empty if no non-null
+ * rows were aggregated.
+ */
+template <ColumnValue T>
+struct AggregateResult {
+  using SumT = std::conditional_t<
+      std::is_floating_point_v<T>, double,
+      std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>;
+
+  SumT sum{};
+  Optional<T> min;
+  Optional<T> max;
+  std::size_t count = 0;
+};
+
+namespace detail::columnar {
+
+using SizeT = std::size_t;
+
+// Rows per batch: a batch of the widest values and its selection fit in L1.
+inline constexpr SizeT kBatchSize = 1024;
+// Independent accumulators per aggregate, so that the loops vectorise
+// without reassociating floating-point sums.
+inline constexpr SizeT kLanes = 8;
+
+template <CompareOp Op, typename T>
+constexpr bool compare(T lhs, T rhs) noexcept {
+  if constexpr (Op == CompareOp::kEq) {
+    return lhs == rhs;
+  } else if constexpr (Op == CompareOp::kNe) {
+    return lhs != rhs;
+  } else if constexpr (Op == CompareOp::kLt) {
+    return lhs < rhs;
+  } else if constexpr (Op == CompareOp::kLe) {
+    return lhs <= rhs;
+  } else if constexpr (Op == CompareOp::kGt) {
+    return lhs > rhs;
+  } else {
+    return lhs >= rhs;
+  }
+}
+
+/**
+ * Appends to out each row in [begin, end) that passes, without branching on
+ * the outcome: every row index is written, and the cursor only advances over
+ * the passing ones. Returns the new cursor.
+ */
+template <CompareOp Op, bool kCheckValidity, typename T>
+SizeT filterRange(const Column<T>& column, SizeT begin, SizeT end, T operand,
+                  std::uint32_t* out) noexcept {
+  const T* values = column.values().data();
+  SizeT n = 0;
+  for (SizeT row = begin; row < end; ++row) {
+    out[n] = static_cast<std::uint32_t>(row);
+    bool pass = compare<Op>(values[row], operand);
+    if constexpr (kCheckValidity) {
+      pass &= column.isValid(row);
+    }
+    n += pass;
+  }
+  return n;
+}
+
+template <CompareOp Op, typename T>
+SizeT filterSelected(const Column<T>& column, Span<const std::uint32_t> rows,
+                     T operand, std::uint32_t* out) noexcept {
+  const T* values = column.values().data();
+  SizeT n = 0;
+  for (std::uint32_t row : rows) {
+    out[n] = row;
+    n += compare<Op>(values[row], operand) & column.isValid(row);
+  }
+  return n;
+}
+
+template <CompareOp Op, typename T>
+SelectionVector filterBy(const Column<T>& column, T operand,
+                         const SelectionVector* input) {
+  SelectionVector selection(input == nullptr ? column.size() : input->size());
+  std::uint32_t* out = selection.data();
+  SizeT n = 0;
+  if (input != nullptr) {
+    for (SizeT i = 0; i < input->size(); i += kBatchSize) {
+      const SizeT count = std::min(kBatchSize, input->size() - i);
+      n += filterSelected<Op>(
+          column, Span<const std::uint32_t>(input->data() + i, count),
+          operand, out + n);
+    }
+  } else {
+    for (SizeT begin = 0; begin < column.size(); begin += kBatchSize) {
+      const SizeT end = std::min(column.size(), begin + kBatchSize);
+      n += column.validity().allSet(begin, end)
+               ? filterRange<Op, false>(column, begin, end, operand, out + n)
+               : filterRange<Op, true>(column, begin, end, operand, out + n);
+    }
+  }
+  selection.resize(n);
+  return selection;
+}
+
+// The values of the valid rows among rows, packed into out; returns how
+// many there were.
+template <typename T>
+SizeT gatherValid(const Column<T>& column, Span<const std::uint32_t> rows,
+                  T* out) noexcept {
+  const T* values = column.values().data();
+  SizeT n = 0;
+  for (std::uint32_t row : rows) {
+    out[n] = values[row];
+    n += column.isValid(row);
+  }
+  return n;
+}
+
+template <CompareOp Op>
+struct OpTag {};
+
+// Calls fn(OpTag<op>{}), turning the runtime operator into a template
+// argument so that each kernel is compiled per operator.
+template <typename Fn>
+decltype(auto) withOp(CompareOp op, Fn&& fn) {
+  switch (op) {
+    case CompareOp::kEq:
+      return fn(OpTag<CompareOp::kEq>{});
+    case CompareOp::kNe:
+      return fn(OpTag<CompareOp::kNe>{});
+    case CompareOp::kLt:
+      return fn(OpTag<CompareOp::kLt>{});
+    case CompareOp::kLe:
+      return fn(OpTag<CompareOp::kLe>{});
+    case CompareOp::kGt:
+      return fn(OpTag<CompareOp::kGt>{});
+    case CompareOp::kGe:
+      break;
+  }
+  return fn(OpTag<CompareOp::kGe>{});
+}
+
+template <typename T>
+struct Accumulator {
+  using SumT = typename AggregateResult<T>::SumT;
+
+  static constexpr T kMinIdentity = std::numeric_limits<T>::has_infinity
+                                        ? std::numeric_limits<T>::infinity()
+                                        : std::numeric_limits<T>::max();
+  static constexpr T kMaxIdentity = std::numeric_limits<T>::has_infinity
+                                        ? -std::numeric_limits<T>::infinity()
+                                        : std::numeric_limits<T>::lowest();
+
+  /**
+   * Folds n contiguous non-null values in, in kLanes interleaved streams
+   * that the compiler keeps in vector registers.
+   */
+  void addDense(const T* values, SizeT n) noexcept {
+    SumT sums[kLanes] = {};
+    T mins[kLanes];
+    T maxs[kLanes];
+    std::fill(std::begin(mins), std::end(mins), kMinIdentity);
+    std::fill(std::begin(maxs), std::end(maxs), kMaxIdentity);
+
+    SizeT i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+      for (SizeT lane = 0; lane < kLanes; ++lane) {
+        const T value = values[i + lane];
+        sums[lane] += value;
+        mins[lane] = std::min(mins[lane], value);
+        maxs[lane] = std::max(maxs[lane], value);
+      }
+    }
+    for (SizeT lane = 0; i < n; ++i, ++lane) {
+      sums[lane] += values[i];
+      mins[lane] = std::min(mins[lane], values[i]);
+      maxs[lane] = std::max(maxs[lane], values[i]);
+    }
+
+    for (SizeT lane = 0; lane < kLanes; ++lane) {
+      sum += sums[lane];
+      min = std::min(min, mins[lane]);
+      max = std::max(max, maxs[lane]);
+    }
+    count += n;
+  }
+
+  AggregateResult<T> result() const {
+    AggregateResult<T> r;
+    r.sum = sum;
+    r.count = count;
+    if (count > 0) {
+      r.min = min;
+      r.max = max;
+    }
+    return r;
+  }
+
+  SumT sum{};
+  T min = kMinIdentity;
+  T max = kMaxIdentity;
+  SizeT count = 0;
+};
+
+}  // namespace detail::columnar
+
+/**
+ * The rows of column (or, given input, of those rows) whose value compares
+ * to operand as op says; null rows never pass. Runs a batch at a time, and
+ * skips validity checks in batches without nulls.
+ */
+template <ColumnValue T>
+SelectionVector filter(const Column<T>& column, CompareOp op, T operand,
+                       const SelectionVector* input = nullptr) {
+  using detail::columnar::OpTag;
+  return detail::columnar::withOp(op, [&]<CompareOp Op>(OpTag<Op>) {
+    return detail::columnar::filterBy<Op>(column, operand, input);
+  });
+}
+
+template <ColumnValue T>
+SelectionVector filter(const Column<T>& column, CompareOp op, T operand,
+                       const SelectionVector& input) {
+  return filter(column, op, operand, &input);
+}
+
+/**
+ * Sum, min, max and count over the non-null rows of column, or of the
+ * selected rows. Null-free batches are folded straight from the column;
+ * otherwise a batch's valid values are first gathered into a buffer.
+ */
+template <ColumnValue T>
+AggregateResult<T> aggregate(const Column<T>& column,
+                             const SelectionVector* rows = nullptr) {
+  using detail::columnar::kBatchSize;
+  using SizeT = std::size_t;
+
+  detail::columnar::Accumulator<T> acc;
+  T buffer[kBatchSize];
+
+  if (rows == nullptr) {
+    for (SizeT begin = 0; begin < column.size(); begin += kBatchSize) {
+      const SizeT end = std::min(column.size(), begin + kBatchSize);
+      if (column.validity().allSet(begin, end)) {
+        acc.addDense(column.values().data() + begin, end - begin);
+        continue;
+      }
+      SizeT n = 0;
+      for (SizeT row = begin; row < end; ++row) {
+        buffer[n] = column.values()[row];
+        n += column.isValid(row);
+      }
+      acc.addDense(buffer, n);
+    }
+    return acc.result();
+  }
+
+  for (SizeT i = 0; i < rows->size(); i += kBatchSize) {
+    const SizeT count = std::min(kBatchSize, rows->size() - i);
+    const SizeT n = detail::columnar::gatherValid(
+        column, Span<const std::uint32_t>(rows->data() + i, count), buffer);
+    acc.addDense(buffer, n);
+  }
+  return acc.result();
+}
+
+template <ColumnValue T>
+AggregateResult<T> aggregate(const Column<T>& column,
+                             const SelectionVector& rows) {
+  return aggregate(column, &rows);
+}
+
+/**
+ * aggregate(column, filter(predicate, op, operand)), fused: each batch's
+ * selection lives in a stack buffer and is consumed while it is still in L1,
+ * instead of a whole-table SelectionVector being written out and read back.
+ */
+template <ColumnValue T, ColumnValue P>
+AggregateResult<T> aggregateWhere(const Column<T>& column,
+                                  const Column<P>& predicate, CompareOp op,
+                                  P operand) {
+  using detail::columnar::kBatchSize;
+  using detail::columnar::OpTag;
+  using SizeT = std::size_t;
+
+  return detail::columnar::withOp(op, [&]<CompareOp Op>(OpTag<Op>) {
+    detail::columnar::Accumulator<T> acc;
+    std::uint32_t selection[kBatchSize];
+    T buffer[kBatchSize];
+    for (SizeT begin = 0; begin < predicate.size(); begin += kBatchSize) {
+      const SizeT end = std::min(predicate.size(), begin + kBatchSize);
+      const SizeT selected =
+          predicate.validity().allSet(begin, end)
+              ? detail::columnar::filterRange<Op, false>(predicate, begin, end,
+                                                        operand, selection)
+              : detail::columnar::filterRange<Op, true>(predicate, begin, end,
+                                                       operand, selection);
+      const SizeT n = detail::columnar::gatherValid(
+          column, Span<const std::uint32_t>(selection, selected), buffer);
+      acc.addDense(buffer, n);
+    }
+    return acc.result();
+  });
+}
+
+}  // namespace ecx::stl
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace ecx::stl {
+
+/**
+ * Base for promise types that lets the caller choose where the coroutine frame
+ * is allocated, following the std::generator convention: a coroutine whose
+ * leading parameters are (std::allocator_arg, alloc) has its frame allocated
+ * through alloc, e.g.
+ *
+ *   Generator<int> iota(std::allocator_arg_t, PolymorphicAllocator<> alloc);
+ *
+ * Without one, the frame comes from global operator new as usual.
+ *
+ * As operator delete only receives the frame size, a trailer after the frame
+ * records how to free it, along with the (rebound) allocator itself.
+ *
+ * GCC (12, without optimisation) warns -Wmismatched-new-delete where such a
+ * coroutine is defined: it pairs allocation and deallocation functions by
+ * name, and the template arguments of the allocator_arg overloads below set
+ * them apart from the usual operator delete, which is the only one a
+ * coroutine frame is ever freed with. Placement operator delete overloads
+ * would not be called, so the warning has to be silenced at the coroutine.
+ */
+class AllocatorAwarePromise {
+ public:
+  using SizeT = std::size_t;
+
+  void* operator new(SizeT size) {
+    return allocateFrame(std::allocator<FrameBlock>(), size);
+  }
+
+  template <typename Allocator, typename... Args>
+  void* operator new(SizeT size, std::allocator_arg_t, const Allocator& alloc,
+                     const Args&...) {
+    return allocateFrame(alloc, size);
+  }
+
+  // Member function coroutines receive the object as the first argument.
+  template <typename This, typename Allocator, typename... Args>
+  void* operator new(SizeT size, const This&, std::allocator_arg_t,
+                     const Allocator& alloc, const Args&...) {
+    return allocateFrame(alloc, size);
+  }
+
+  void operator delete(void* frame, SizeT size) noexcept {
+    auto* bytes = static_cast<std::byte*>(frame);
+    DeallocateFn deallocate = *std::launder(
+        reinterpret_cast<DeallocateFn*>(bytes + trailerOffset(size)));
+    deallocate(frame, size);
+  }
+
+ private:
+  // Unit of allocation, so that frames are aligned like operator new's.
+  struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) FrameBlock {
+    std::byte bytes[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+  };
+
+  using DeallocateFn = void (*)(void*, SizeT) noexcept;
+
+  static constexpr SizeT alignUp(SizeT n, SizeT alignment) noexcept {
+    return (n + alignment - 1) & ~(alignment - 1);
+  }
+
+  static constexpr SizeT trailerOffset(SizeT size) noexcept {
+    return alignUp(size, alignof(DeallocateFn));
+  }
+
+  template <typename BlockAllocator>
+  static constexpr SizeT allocatorOffset(SizeT size) noexcept {
+    return alignUp(trailerOffset(size) + sizeof(DeallocateFn),
+                   alignof(BlockAllocator));
+  }
+
+  template <typename BlockAllocator>
+  static constexpr SizeT blocks(SizeT size) noexcept {
+    const SizeT bytes =
+        allocatorOffset<BlockAllocator>(size) + sizeof(BlockAllocator);
+    return (bytes + sizeof(FrameBlock) - 1) / sizeof(FrameBlock);
+  }
+
+  template <typename Allocator>
+  static void* allocateFrame(const Allocator& alloc, SizeT size) {
+    using BlockAllocator = typename std::allocator_traits<
+        Allocator>::template rebind_alloc<FrameBlock>;
+    using AllocTraits = std::allocator_traits<BlockAllocator>;
+
+    BlockAllocator blockAlloc(alloc);
+    FrameBlock* frame =
+        AllocTraits::allocate(blockAlloc, blocks<BlockAllocator>(size));
+
+    auto* bytes = reinterpret_cast<std::byte*>(frame);
+    ::new (bytes + trailerOffset(size))
+        DeallocateFn(&deallocateFrame<BlockAllocator>);
+    ::new (bytes + allocatorOffset<BlockAllocator>(size))
+        BlockAllocator(std::move(blockAlloc));
+    return frame;
+  }
+
+  template <typename BlockAllocator>
+  static void deallocateFrame(void* frame, SizeT size) noexcept {
+    using AllocTraits = std::allocator_traits<BlockAllocator>;
+
+    auto* bytes = static_cast<std::byte*>(frame);
+    auto* stored = std::launder(reinterpret_cast<BlockAllocator*>(
+        bytes + allocatorOffset<BlockAllocator>(size)));
+    BlockAllocator blockAlloc(std::move(*stored));
+    stored->~BlockAllocator();
+
+    AllocTraits::deallocate(blockAlloc, static_cast<FrameBlock*>(frame),
+                            blocks<BlockAllocator>(size));
+  }
+};
+
+}  // namespace ecx::stl
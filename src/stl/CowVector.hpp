@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+#include "src/stl/Exceptions.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Copy-on-write Vector: copies share one reference-counted buffer, so taking
+ * a snapshot is O(1). The first mutation through a copy that shares its
+ * buffer detaches it, copying the elements once; later mutations are as
+ * cheap as on a Vector.
+ *
+ * The count is atomic, so copies may be taken, read and destroyed on
+ * different threads, as with std::shared_ptr. A single CowVector object is
+ * not itself thread-safe: a writer publishes a snapshot by copying under
+ * whatever synchronises it with its readers, and then keeps mutating while
+ * the readers use their copy without locks.
+ *
+ * Reads are only available on a const CowVector, so that they never detach;
+ * writes go through the mutating members, or edit() for the whole Vector.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class CowVector {
+ public:
+  using VectorT = Vector<T, Allocator>;
+  using SizeT = std::size_t;
+  using ValueT = T;
+  using ConstIteratorT = typename VectorT::ConstIteratorT;
+  using AllocatorT = Allocator;
+
+  CowVector() noexcept = default;
+
+  explicit CowVector(const Allocator& alloc) noexcept : alloc_(alloc) {}
+
+  CowVector(std::initializer_list<T> init,
+            const Allocator& alloc = Allocator())
+      : CowVector(VectorT(init, alloc)) {}
+
+  /**
+   * Takes over the elements of vector, without copying them.
+   */
+  explicit CowVector(VectorT&& vector)
+      : alloc_(vector.getAllocator()),
+        block_(makeBlock(alloc_, std::move(vector))) {}
+
+  CowVector(const CowVector& other) noexcept
+      : alloc_(other.alloc_), block_(other.block_) {
+    if (block_ != nullptr) {
+      block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  CowVector(CowVector&& other) noexcept
+      : alloc_(other.alloc_), block_(std::exchange(other.block_, nullptr)) {}
+
+  CowVector& operator=(const CowVector& other) noexcept {
+    CowVector(other).swap(*this);
+    return *this;
+  }
+
+  CowVector& operator=(CowVector&& other) noexcept {
+    CowVector(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~CowVector() { release(); }
+
+  SizeT size() const noexcept {
+    return block_ == nullptr ? 0 : block_->items.size();
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  SizeT capacity() const noexcept {
+    return block_ == nullptr ? 0 : block_->items.capacity();
+  }
+
+  const T* data() const noexcept {
+    return block_ == nullptr ? nullptr : block_->items.data();
+  }
+
+  const T& operator[](SizeT i) const noexcept { return data()[i]; }
+
+  const T& front() const noexcept { return data()[0]; }
+
+  const T& back() const noexcept { return data()[size() - 1]; }
+
+  ConstIteratorT begin() const noexcept { return ConstIteratorT(data()); }
+
+  ConstIteratorT end() const noexcept {
+    return ConstIteratorT(data() + size());
+  }
+
+  /**
+   * The number of CowVectors sharing this one's buffer, itself included; 0
+   * if it has none.
+   */
+  SizeT useCount() const noexcept {
+    return block_ == nullptr ? 0
+                             : block_->refs.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * The elements, for arbitrary mutation, after detaching from any other
+   * CowVector. The reference is invalidated by copying this CowVector.
+   */
+  VectorT& edit() {
+    detach(0);
+    return block_->items;
+  }
+
+  T& mutableAt(SizeT i) { return edit()[i]; }
+
+  void push_back(const T& value) {
+    detach(1);
+    block_->items.push_back(value);
+  }
+
+  void push_back(T&& value) {
+    detach(1);
+    block_->items.push_back(std::move(value));
+  }
+
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    detach(1);
+    return block_->items.emplace_back(std::forward<Args>(args)...);
+  }
+
+  void pop_back() { edit().pop_back(); }
+
+  void reserve(SizeT newCapacity) {
+    detach(newCapacity > size() ? newCapacity - size() : 0);
+    block_->items.reserve(newCapacity);
+  }
+
+  void resize(SizeT newSize) {
+    detach(newSize > size() ? newSize - size() : 0);
+    block_->items.resize(newSize);
+  }
+
+  /**
+   * Empties this CowVector without touching the elements other copies still
+   * share.
+   */
+  void clear() noexcept {
+    if (block_ != nullptr && !isUnique()) {
+      release();
+      return;
+    }
+    if (block_ != nullptr) {
+      block_->items.clear();
+    }
+  }
+
+  /**
+   * Exchanges the buffers only: each CowVector keeps the allocator it was
+   * constructed with for the buffers it allocates later, and a buffer is
+   * freed with the allocator that allocated it.
+   */
+  void swap(CowVector& other) noexcept { std::swap(block_, other.block_); }
+
+  friend bool operator==(const CowVector& lhs, const CowVector& rhs) noexcept {
+    return lhs.block_ == rhs.block_ ||
+           std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+ private:
+  struct Block;
+
+  using BlockAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+  using BlockTraits = std::allocator_traits<BlockAllocator>;
+
+  struct Block {
+    template <typename... Args>
+    explicit Block(const BlockAllocator& alloc, Args&&... args)
+        : alloc(alloc), items(std::forward<Args>(args)...) {}
+
+    std::atomic<SizeT> refs{1};
+    // The allocator this block came from, to free it with whichever
+    // CowVector lets go last.
+    [[no_unique_address]] BlockAllocator alloc;
+    VectorT items;
+  };
+
+  template <typename... Args>
+  static Block* makeBlock(BlockAllocator alloc, Args&&... args) {
+    Block* block = BlockTraits::allocate(alloc, 1);
+    ECX_TRY {
+      std::construct_at(block, alloc, std::forward<Args>(args)...);
+    }
+    ECX_CATCH_ALL {
+      BlockTraits::deallocate(alloc, block, 1);
+      ECX_RETHROW;
+    }
+    return block;
+  }
+
+  bool isUnique() const noexcept {
+    // Acquire, so that the reads of other copies that have since let go
+    // happen before this one's writes.
+    return block_->refs.load(std::memory_order_acquire) == 1;
+  }
+
+  /**
+   * Ensures this CowVector is the sole owner of its buffer, copying the
+   * shared elements if needed, into room for extra more.
+   */
+  void detach(SizeT extra) {
+    if (block_ == nullptr) {
+      block_ = makeBlock(alloc_, Allocator(alloc_));
+      return;
+    }
+    if (isUnique()) {
+      return;
+    }
+    const VectorT& shared = block_->items;
+    VectorT copy{Allocator(alloc_)};
+    copy.reserve(shared.size() + extra);
+    for (const T& value : shared) {
+      copy.push_back(value);
+    }
+    Block* block = makeBlock(alloc_, std::move(copy));
+    release();
+    block_ = block;
+  }
+
+  void release() noexcept {
+    if (block_ == nullptr) {
+      return;
+    }
+    if (block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      BlockAllocator alloc(block_->alloc);
+      std::destroy_at(block_);
+      BlockTraits::deallocate(alloc, block_, 1);
+    }
+    block_ = nullptr;
+  }
+
+  [[no_unique_address]] BlockAllocator alloc_;
+  Block* block_ = nullptr;
+};
+
+}  // namespace ecx::stl
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#include "src/stl/UniquePointer.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+struct DeferredReclaimerStats {
+  std::size_t retired = 0;
+  std::size_t reclaimed = 0;
+  // Batches the reclaimer took, each the whole queue at the time.
+  std::size_t batches = 0;
+  // retire() calls that found the queue full and waited for room.
+  std::size_t stalls = 0;
+};
+
+/**
+ * Destroys retired objects on a background thread, so that letting go of a
+ * large object graph costs its owner a queue push instead of the whole
+ * teardown.
+ *
+ * The queue is bounded: retire() blocks while capacity objects are pending,
+ * so a producer outrunning the reclaimer slows to its pace instead of
+ * piling up garbage. The reclaimer takes the whole queue under one lock
+ * acquisition, then destroys the batch outside it. Objects retired from the
+ * reclaimer thread itself, by a destructor it is running, are destroyed in
+ * place.
+ *
+ * Destructors run on the reclaimer thread, after retire() returns: they
+ * must not touch state the retiring thread assumes is gone, or is still its
+ * own. The destructor of a DeferredReclaimer finishes every pending object
+ * before returning.
+ */
+class DeferredReclaimer {
+ public:
+  using SizeT = std::size_t;
+  using DestroyFn = void (*)(void*) noexcept;
+
+  static constexpr SizeT kDefaultCapacity = 4096;
+
+  explicit DeferredReclaimer(SizeT capacity = kDefaultCapacity)
+      : capacity_(capacity == 0 ? 1 : capacity) {
+    // Both sides are swapped whole, so neither ever grows past capacity_.
+    pending_.reserve(capacity_);
+    thread_ = std::jthread([this](std::stop_token stop) { work(stop); });
+  }
+
+  DeferredReclaimer(const DeferredReclaimer&) = delete;
+  DeferredReclaimer& operator=(const DeferredReclaimer&) = delete;
+
+  ~DeferredReclaimer() {
+    thread_.request_stop();
+    thread_.join();
+  }
+
+  /**
+   * The process-wide reclaimer behind DeferredDeleter. Leaked, so that it
+   * keeps accepting objects during static destruction; objects still
+   * pending at exit are not destroyed.
+   */
+  static DeferredReclaimer& instance() {
+    static auto* reclaimer = new DeferredReclaimer();
+    return *reclaimer;
+  }
+
+  /**
+   * Queues destroy(ptr) to run on the reclaimer thread, waiting first if
+   * the queue is full.
+   */
+  void retire(void* ptr, DestroyFn destroy) noexcept {
+    if (std::this_thread::get_id() == thread_.get_id()) {
+      destroy(ptr);
+      std::lock_guard lock(mutex_);
+      ++retired_;
+      ++reclaimed_;
+      return;
+    }
+
+    std::unique_lock lock(mutex_);
+    if (pending_.size() == capacity_) {
+      ++stalls_;
+      progressCv_.wait(lock, [this] { return pending_.size() < capacity_; });
+    }
+    const bool wasEmpty = pending_.empty();
+    // Cannot throw: capacity_ entries are reserved.
+    pending_.push_back(Retired{ptr, destroy});
+    ++retired_;
+    ++enqueued_;
+    lock.unlock();
+    // The reclaimer only waits on an empty queue.
+    if (wasEmpty) {
+      retiredCv_.notify_one();
+    }
+  }
+
+  /**
+   * Blocks until every object retired before the call has been destroyed.
+   *
+   * Waits on the queued objects alone: those destroyed in place are done
+   * before their retire() returns, and counting them would let one retired
+   * by a destructor after the call stand in for an earlier queued object.
+   */
+  void drain() {
+    if (std::this_thread::get_id() == thread_.get_id()) {
+      return;
+    }
+    std::unique_lock lock(mutex_);
+    const SizeT target = enqueued_;
+    progressCv_.wait(lock, [&] { return finished_ >= target; });
+  }
+
+  DeferredReclaimerStats stats() const {
+    std::lock_guard lock(mutex_);
+    return DeferredReclaimerStats{
+        .retired = retired_,
+        .reclaimed = reclaimed_,
+        .batches = batches_,
+        .stalls = stalls_,
+    };
+  }
+
+  SizeT capacity() const noexcept { return capacity_; }
+
+ private:
+  struct Retired {
+    void* ptr;
+    DestroyFn destroy;
+  };
+
+  void work(std::stop_token stop) {
+    Vector<Retired> batch;
+    batch.reserve(capacity_);
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        // Returns false once stop is requested and nothing is pending.
+        if (!retiredCv_.wait(lock, stop,
+                              [this] { return !pending_.empty(); })) {
+          return;
+        }
+        std::swap(batch, pending_);
+        ++batches_;
+      }
+      // Room for waiting producers, before the batch is destroyed.
+      progressCv_.notify_all();
+
+      for (const Retired& retired : batch) {
+        retired.destroy(retired.ptr);
+      }
+      {
+        std::lock_guard lock(mutex_);
+        reclaimed_ += batch.size();
+        finished_ += batch.size();
+      }
+      batch.clear();
+      progressCv_.notify_all();
+    }
+  }
+
+  const SizeT capacity_;
+  mutable std::mutex mutex_;
+  std::condition_variable_any retiredCv_;
+  std::condition_variable progressCv_;
+  Vector<Retired> pending_;
+  // Including the objects destroyed in place, which drain() ignores.
+  SizeT retired_ = 0;
+  SizeT reclaimed_ = 0;
+  // The objects that went through the queue, and those of them destroyed.
+  SizeT enqueued_ = 0;
+  SizeT finished_ = 0;
+  SizeT batches_ = 0;
+  SizeT stalls_ = 0;
+  std::jthread thread_;
+};
+
+/**
+ * Deleter handing objects to DeferredReclaimer::instance(), so that
+ * UniquePointer::reset() and the destructor take constant time whatever T
+ * owns:
+ *
+ *   UniquePointer<Index, DeferredDeleter<Index>> index(new Index(...));
+ *   index.reset(new Index(...));  // The old index dies in the background.
+ *
+ * Stateless, so that it costs UniquePointer no space.
+ */
+template <typename T>
+struct DeferredDeleter {
+  constexpr DeferredDeleter() noexcept = default;
+
+  void operator()(T* ptr) const noexcept {
+    DeferredReclaimer::instance().retire(ptr, &destroy);
+  }
+
+ private:
+  static void destroy(void* ptr) noexcept {
+    std::default_delete<T>()(static_cast<T*>(ptr));
+  }
+};
+
+}  // namespace ecx::stl
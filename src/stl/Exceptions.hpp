@@ -0,0 +1,26 @@
+#pragma once
+
+/**
+ * Exception handling spelled so that it compiles away under -fno-exceptions,
+ * in the manner of libstdc++'s __try/__catch:
+ *
+ *   ECX_TRY {
+ *     construct();
+ *   } ECX_CATCH_ALL {
+ *     rollback();
+ *     ECX_RETHROW;
+ *   }
+ *
+ * Without exceptions, the try block runs unconditionally and the handler is
+ * dead code, as nothing can throw into it; failures that would have thrown
+ * (e.g. std::bad_alloc) terminate instead.
+ */
+#if defined(__cpp_exceptions)
+#define ECX_TRY try
+#define ECX_CATCH_ALL catch (...)
+#define ECX_RETHROW throw
+#else
+#define ECX_TRY if constexpr (true)
+#define ECX_CATCH_ALL else
+#define ECX_RETHROW static_cast<void>(0)
+#endif
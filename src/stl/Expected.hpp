@@ -0,0 +1,312 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "src/stl/Exceptions.hpp"
+#include "src/stl/Optional.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Failures reported by the fallible (try*) allocation entry points, in place
+ * of std::bad_alloc and std::length_error.
+ */
+enum class AllocError : std::uint8_t {
+  // The allocator could not provide the memory.
+  kOutOfMemory,
+  // The requested size exceeds what the allocator can address.
+  kLengthError,
+};
+
+/**
+ * The error alternative of an Expected, wrapped so that constructing an
+ * Expected from it is unambiguous even when T and E are related types:
+ *   return Unexpected(AllocError::kOutOfMemory);
+ */
+template <typename E>
+class Unexpected {
+ public:
+  constexpr explicit Unexpected(const E& error) : error_(error) {}
+
+  constexpr explicit Unexpected(E&& error) : error_(std::move(error)) {}
+
+  constexpr const E& error() const& noexcept { return error_; }
+
+  constexpr E&& error() && noexcept { return std::move(error_); }
+
+ private:
+  E error_;
+};
+
+template <typename E>
+Unexpected(E) -> Unexpected<E>;
+
+namespace detail {
+
+template <typename T, typename E>
+inline constexpr bool kTriviallyCopyable =
+    (std::is_void_v<T> || std::is_trivially_copyable_v<T>) &&
+    std::is_trivially_copyable_v<E>;
+
+template <typename T>
+inline constexpr bool kTriviallyDestructible =
+    std::is_void_v<T> || std::is_trivially_destructible_v<T>;
+
+}  // namespace detail
+
+/**
+ * Either a T or an error E, stored inline, for reporting failures through the
+ * return value instead of exceptions: no unwinding tables, no try/catch, and
+ * an ordinary branch at the call site.
+ *
+ * As with Optional, the special members are trivial whenever T's and E's
+ * are; an Expected<int, AllocError> is trivially copyable and returned in a
+ * register.
+ *
+ * Accessing the alternative that is not held is undefined. Expected<void, E>
+ * holds no value, only success or an error.
+ */
+template <typename T, typename E>
+class [[nodiscard]] Expected {
+  static_assert(std::is_void_v<T> || (std::is_object_v<T> &&
+                                      !std::is_array_v<T>),
+                "Expected<T, E> requires a non-array object type or void");
+  static_assert(std::is_object_v<E> && !std::is_array_v<E>,
+                "Expected<T, E> requires a non-array object error type");
+
+  static constexpr bool kVoid = std::is_void_v<T>;
+  // Stand-in for T in the storage and signatures when T is void.
+  struct Empty {};
+  using StoredT = std::conditional_t<kVoid, Empty, T>;
+
+ public:
+  using ValueT = T;
+  using ErrorT = E;
+
+  constexpr Expected() noexcept(std::is_nothrow_default_constructible_v<
+                                StoredT>)
+    requires std::default_initializable<StoredT>
+      : value_(), hasValue_(true) {}
+
+  template <typename U = StoredT>
+    requires(!kVoid) && std::constructible_from<StoredT, U&&> &&
+            (!std::same_as<std::remove_cvref_t<U>, Expected>) &&
+            (!std::same_as<std::remove_cvref_t<U>, std::in_place_t>)
+  constexpr explicit(!std::convertible_to<U&&, StoredT>) Expected(U&& value)
+      : value_(std::forward<U>(value)), hasValue_(true) {}
+
+  template <typename... Args>
+  constexpr explicit Expected(std::in_place_t, Args&&... args)
+      : value_(std::forward<Args>(args)...), hasValue_(true) {}
+
+  template <typename G>
+    requires std::constructible_from<E, const G&>
+  constexpr Expected(const Unexpected<G>& unexpected)
+      : error_(unexpected.error()), hasValue_(false) {}
+
+  template <typename G>
+    requires std::constructible_from<E, G&&>
+  constexpr Expected(Unexpected<G>&& unexpected)
+      : error_(std::move(unexpected).error()), hasValue_(false) {}
+
+  Expected(const Expected&)
+    requires std::copy_constructible<StoredT> && std::copy_constructible<E> &&
+             detail::kTriviallyCopyable<T, E>
+  = default;
+
+  constexpr Expected(const Expected& other)
+    requires std::copy_constructible<StoredT> && std::copy_constructible<E>
+      : hasValue_(other.hasValue_) {
+    constructFrom(other);
+  }
+
+  Expected(Expected&&)
+    requires std::move_constructible<StoredT> && std::move_constructible<E> &&
+             detail::kTriviallyCopyable<T, E>
+  = default;
+
+  constexpr Expected(Expected&& other) noexcept(
+      std::is_nothrow_move_constructible_v<StoredT> &&
+      std::is_nothrow_move_constructible_v<E>)
+    requires std::move_constructible<StoredT> && std::move_constructible<E>
+      : hasValue_(other.hasValue_) {
+    constructFrom(std::move(other));
+  }
+
+  Expected& operator=(const Expected&)
+    requires detail::CopyConstructibleAndAssignable<StoredT> &&
+             detail::CopyConstructibleAndAssignable<E> &&
+             detail::kTriviallyCopyable<T, E>
+  = default;
+
+  constexpr Expected& operator=(const Expected& other)
+    requires detail::CopyConstructibleAndAssignable<StoredT> &&
+             detail::CopyConstructibleAndAssignable<E>
+  {
+    assign(other);
+    return *this;
+  }
+
+  Expected& operator=(Expected&&)
+    requires detail::MoveConstructibleAndAssignable<StoredT> &&
+             detail::MoveConstructibleAndAssignable<E> &&
+             detail::kTriviallyCopyable<T, E>
+  = default;
+
+  constexpr Expected& operator=(Expected&& other) noexcept(
+      std::is_nothrow_move_constructible_v<StoredT> &&
+      std::is_nothrow_move_assignable_v<StoredT> &&
+      std::is_nothrow_move_constructible_v<E> &&
+      std::is_nothrow_move_assignable_v<E>)
+    requires detail::MoveConstructibleAndAssignable<StoredT> &&
+             detail::MoveConstructibleAndAssignable<E>
+  {
+    assign(std::move(other));
+    return *this;
+  }
+
+  ~Expected()
+    requires detail::kTriviallyDestructible<T> &&
+             std::is_trivially_destructible_v<E>
+  = default;
+
+  constexpr ~Expected() { destroy(); }
+
+  constexpr bool hasValue() const noexcept { return hasValue_; }
+
+  constexpr explicit operator bool() const noexcept { return hasValue_; }
+
+  template <typename U = T>
+    requires(!std::is_void_v<U>)
+  constexpr U& operator*() & noexcept {
+    return value_;
+  }
+
+  template <typename U = T>
+    requires(!std::is_void_v<U>)
+  constexpr const U& operator*() const& noexcept {
+    return value_;
+  }
+
+  template <typename U = T>
+    requires(!std::is_void_v<U>)
+  constexpr U&& operator*() && noexcept {
+    return std::move(value_);
+  }
+
+  template <typename U = T>
+    requires(!std::is_void_v<U>)
+  constexpr U* operator->() noexcept {
+    return std::addressof(value_);
+  }
+
+  template <typename U = T>
+    requires(!std::is_void_v<U>)
+  constexpr const U* operator->() const noexcept {
+    return std::addressof(value_);
+  }
+
+  constexpr const E& error() const& noexcept { return error_; }
+
+  constexpr E&& error() && noexcept { return std::move(error_); }
+
+  template <typename U>
+    requires(!kVoid)
+  constexpr StoredT valueOr(U&& fallback) const& {
+    return hasValue_ ? value_ : static_cast<StoredT>(std::forward<U>(fallback));
+  }
+
+  template <typename U>
+    requires(!kVoid)
+  constexpr StoredT valueOr(U&& fallback) && {
+    return hasValue_ ? std::move(value_)
+                     : static_cast<StoredT>(std::forward<U>(fallback));
+  }
+
+  /**
+   * The value as an Optional, dropping the error.
+   */
+  constexpr Optional<StoredT> toOptional() && requires(!kVoid) {
+    if (hasValue_) {
+      return Optional<StoredT>(std::move(value_));
+    }
+    return kNullOpt;
+  }
+
+ private:
+  template <typename Other>
+  constexpr void constructFrom(Other&& other) {
+    if (hasValue_) {
+      std::construct_at(std::addressof(value_),
+                        std::forward<Other>(other).value_);
+    } else {
+      std::construct_at(std::addressof(error_),
+                        std::forward<Other>(other).error_);
+    }
+  }
+
+  template <typename Other>
+  constexpr void assign(Other&& other) {
+    if (hasValue_ && other.hasValue_) {
+      value_ = std::forward<Other>(other).value_;
+    } else if (!hasValue_ && !other.hasValue_) {
+      error_ = std::forward<Other>(other).error_;
+    } else if (other.hasValue_) {
+      reinit(value_, error_, std::forward<Other>(other).value_);
+      hasValue_ = true;
+    } else {
+      reinit(error_, value_, std::forward<Other>(other).error_);
+      hasValue_ = false;
+    }
+  }
+
+  /**
+   * Replaces oldValue with a newValue built from arg, as std::expected does:
+   * directly when that cannot throw, else through a temporary that is moved
+   * in without throwing, else by restoring oldValue if construction throws.
+   * Either way, a throwing constructor leaves *this as it was.
+   */
+  template <typename New, typename Old, typename Arg>
+  static constexpr void reinit(New& newValue, Old& oldValue, Arg&& arg) {
+    if constexpr (std::is_nothrow_constructible_v<New, Arg>) {
+      std::destroy_at(std::addressof(oldValue));
+      std::construct_at(std::addressof(newValue), std::forward<Arg>(arg));
+    } else if constexpr (std::is_nothrow_move_constructible_v<New>) {
+      New temp(std::forward<Arg>(arg));
+      std::destroy_at(std::addressof(oldValue));
+      std::construct_at(std::addressof(newValue), std::move(temp));
+    } else {
+      static_assert(std::is_nothrow_move_constructible_v<Old>,
+                    "Expected assignment requires T or E to be nothrow "
+                    "move constructible");
+      Old temp(std::move(oldValue));
+      std::destroy_at(std::addressof(oldValue));
+      ECX_TRY {
+        std::construct_at(std::addressof(newValue), std::forward<Arg>(arg));
+      } ECX_CATCH_ALL {
+        std::construct_at(std::addressof(oldValue), std::move(temp));
+        ECX_RETHROW;
+      }
+    }
+  }
+
+  constexpr void destroy() noexcept {
+    if (hasValue_) {
+      std::destroy_at(std::addressof(value_));
+    } else {
+      std::destroy_at(std::addressof(error_));
+    }
+  }
+
+  union {
+    StoredT value_;
+    E error_;
+  };
+  bool hasValue_;
+};
+
+}  // namespace ecx::stl
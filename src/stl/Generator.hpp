@@ -0,0 +1,398 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+#include "src/stl/CoroutineFrame.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+template <typename T>
+class Generator;
+
+/**
+ * Wraps a Generator to be yielded from another, as in
+ *   co_yield elementsOf(subtree(node->left));
+ * which yields every element of the nested generator in place.
+ */
+template <typename G>
+struct ElementsOf {
+  G generator;
+};
+
+template <typename T>
+ElementsOf<Generator<T>> elementsOf(Generator<T>&& generator) {
+  return {std::move(generator)};
+}
+
+/**
+ * Lazy, single-pass coroutine sequence, modelled on std::generator.
+ *
+ * Dereferencing yields ReferenceT: T&& for an object type T (so values can be
+ * moved out), or T itself for a reference type. Yielding an lvalue into a
+ * Generator<T> of object type copies it into the frame first.
+ *
+ * Nested generators (co_yield elementsOf(...)) are entered and left through
+ * symmetric transfer: the outermost generator tracks the innermost active one,
+ * which is resumed directly, so neither yielding from deep recursion nor
+ * unwinding it grows the stack.
+ *
+ * The frame allocation can be redirected, see AllocatorAwarePromise.
+ *
+ * A generator may carry a size hint, an upper bound on the number of elements
+ * it will yield, which collect() uses to reserve its Vector up front.
+ */
+template <typename T>
+class Generator : public std::ranges::view_interface<Generator<T>> {
+ public:
+  using SizeT = std::size_t;
+  using ValueT = std::remove_cvref_t<T>;
+  using ReferenceT = std::conditional_t<std::is_reference_v<T>, T, T&&>;
+  using PointerT = std::add_pointer_t<ReferenceT>;
+
+  class promise_type;
+  using HandleT = std::coroutine_handle<promise_type>;
+
+  class promise_type : public AllocatorAwarePromise {
+   public:
+    Generator get_return_object() noexcept {
+      return Generator(HandleT::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    auto final_suspend() noexcept { return FinalAwaiter{}; }
+
+    std::suspend_always yield_value(ReferenceT value) noexcept {
+      root_->value_ = std::addressof(value);
+      return {};
+    }
+
+    auto yield_value(const ValueT& value) noexcept(
+        std::is_nothrow_copy_constructible_v<ValueT>)
+      requires std::is_rvalue_reference_v<ReferenceT> &&
+               std::copy_constructible<ValueT>
+    {
+      return CopyAwaiter{value, root_};
+    }
+
+    auto yield_value(ElementsOf<Generator>&& nested) noexcept {
+      return NestedAwaiter{std::move(nested.generator)};
+    }
+
+    // Generators are synchronous; co_await is not allowed in their body.
+    template <typename U>
+    void await_transform(U&&) = delete;
+
+    void return_void() const noexcept {}
+
+    void unhandled_exception() {
+      if (root_ == this) {
+        throw;
+      }
+      // Rethrown in the parent, at its co_yield elementsOf(...).
+      exception_ = std::current_exception();
+    }
+
+   private:
+    friend class Generator;
+
+    struct FinalAwaiter {
+      bool await_ready() const noexcept { return false; }
+
+      std::coroutine_handle<> await_suspend(HandleT handle) noexcept {
+        promise_type& promise = handle.promise();
+        if (!promise.parent_) {
+          return std::noop_coroutine();
+        }
+        promise.root_->leaf_ = promise.parent_;
+        return promise.parent_;
+      }
+
+      void await_resume() const noexcept {}
+    };
+
+    struct CopyAwaiter {
+      ValueT copy;
+      promise_type* root;
+
+      bool await_ready() const noexcept { return false; }
+
+      void await_suspend(HandleT) noexcept { root->value_ = &copy; }
+
+      void await_resume() const noexcept {}
+    };
+
+    struct NestedAwaiter {
+      Generator nested;
+
+      bool await_ready() const noexcept { return !nested.handle_; }
+
+      std::coroutine_handle<> await_suspend(HandleT parent) noexcept {
+        promise_type& promise = nested.handle_.promise();
+        promise.root_ = parent.promise().root_;
+        promise.parent_ = parent;
+        promise.root_->leaf_ = nested.handle_;
+        return nested.handle_;
+      }
+
+      void await_resume() {
+        if (nested.handle_ && nested.handle_.promise().exception_) {
+          std::rethrow_exception(nested.handle_.promise().exception_);
+        }
+      }
+    };
+
+    promise_type* root_ = this;
+    // The generator this one was yielded from, if nested.
+    HandleT parent_{};
+    // Root only: the innermost active generator, and its current value.
+    HandleT leaf_ = HandleT::from_promise(*this);
+    PointerT value_ = nullptr;
+    std::exception_ptr exception_;
+  };
+
+  class Iterator {
+   public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type = ValueT;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+
+    explicit Iterator(HandleT root) noexcept : root_(root) {}
+
+    ReferenceT operator*() const noexcept {
+      return static_cast<ReferenceT>(*root_.promise().value_);
+    }
+
+    Iterator& operator++() {
+      root_.promise().leaf_.resume();
+      return *this;
+    }
+
+    void operator++(int) { ++*this; }
+
+    friend bool operator==(const Iterator& it, std::default_sentinel_t) {
+      return it.root_.done();
+    }
+
+   private:
+    HandleT root_{};
+  };
+
+  explicit Generator() noexcept = default;
+
+  Generator(const Generator&) = delete;
+  Generator& operator=(const Generator&) = delete;
+
+  Generator(Generator&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)),
+        sizeHint_(std::exchange(other.sizeHint_, std::nullopt)) {}
+
+  Generator& operator=(Generator&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+      sizeHint_ = std::exchange(other.sizeHint_, std::nullopt);
+    }
+    return *this;
+  }
+
+  ~Generator() { destroy(); }
+
+  /**
+   * Runs the generator up to its first element. Must be called once.
+   */
+  Iterator begin() {
+    handle_.promise().leaf_.resume();
+    return Iterator(handle_);
+  }
+
+  std::default_sentinel_t end() const noexcept { return {}; }
+
+  std::optional<SizeT> sizeHint() const noexcept { return sizeHint_; }
+
+  Generator& setSizeHint(std::optional<SizeT> hint) & noexcept {
+    sizeHint_ = hint;
+    return *this;
+  }
+
+  Generator&& setSizeHint(std::optional<SizeT> hint) && noexcept {
+    sizeHint_ = hint;
+    return std::move(*this);
+  }
+
+ private:
+  explicit Generator(HandleT handle) noexcept : handle_(handle) {}
+
+  void destroy() noexcept {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  HandleT handle_{};
+  std::optional<SizeT> sizeHint_;
+};
+
+namespace detail {
+
+template <typename R>
+Generator<const std::ranges::range_value_t<R>&> iterate(const R& range) {
+  for (const auto& elem : range) {
+    co_yield elem;
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Lazily yields the elements of range by const reference, with the range's
+ * size as the size hint if it has one. The range is not copied, so it must
+ * outlive the generator.
+ */
+template <std::ranges::input_range R>
+Generator<const std::ranges::range_value_t<R>&> iterate(const R& range) {
+  auto generator = detail::iterate(range);
+  if constexpr (std::ranges::sized_range<const R>) {
+    generator.setSizeHint(std::ranges::size(range));
+  }
+  return generator;
+}
+
+namespace detail {
+
+template <typename T, typename Fn>
+using MappedT = std::remove_cvref_t<
+    std::invoke_result_t<Fn&, typename Generator<T>::ReferenceT>>;
+
+template <typename T, typename Fn>
+Generator<MappedT<T, Fn>> map(Generator<T> source, Fn fn) {
+  for (auto&& elem : source) {
+    co_yield std::invoke(fn, std::forward<decltype(elem)>(elem));
+  }
+}
+
+template <typename T, typename Pred>
+Generator<T> filter(Generator<T> source, Pred pred) {
+  for (auto&& elem : source) {
+    if (std::invoke(pred, std::as_const(elem))) {
+      co_yield std::forward<decltype(elem)>(elem);
+    }
+  }
+}
+
+template <typename T>
+Generator<T> take(Generator<T> source, std::size_t n) {
+  // Checked before pulling the next element, so that exactly n elements are
+  // produced even from a generator with side effects.
+  if (n == 0) {
+    co_return;
+  }
+  for (auto&& elem : source) {
+    co_yield std::forward<decltype(elem)>(elem);
+    if (--n == 0) {
+      co_return;
+    }
+  }
+}
+
+template <typename Fn>
+struct MapClosure {
+  Fn fn;
+};
+
+template <typename Pred>
+struct FilterClosure {
+  Pred pred;
+};
+
+struct TakeClosure {
+  std::size_t n;
+};
+
+struct CollectClosure {};
+
+}  // namespace detail
+
+/**
+ * Pipeable lazy adaptors over a Generator:
+ *   auto squares = iterate(ids) | filter(isActive) | map(square) | take(10);
+ * Each stage is itself a generator pulling from the previous one, so no
+ * intermediate Vector is materialised.
+ */
+template <typename Fn>
+detail::MapClosure<std::decay_t<Fn>> map(Fn&& fn) {
+  return {std::forward<Fn>(fn)};
+}
+
+template <typename Pred>
+detail::FilterClosure<std::decay_t<Pred>> filter(Pred&& pred) {
+  return {std::forward<Pred>(pred)};
+}
+
+inline detail::TakeClosure take(std::size_t n) { return {n}; }
+
+template <typename T, typename Fn>
+Generator<detail::MappedT<T, Fn>> operator|(Generator<T>&& source,
+                                            detail::MapClosure<Fn> closure) {
+  const auto hint = source.sizeHint();
+  return detail::map(std::move(source), std::move(closure.fn))
+      .setSizeHint(hint);
+}
+
+template <typename T, typename Pred>
+Generator<T> operator|(Generator<T>&& source,
+                       detail::FilterClosure<Pred> closure) {
+  // The number of survivors is unknown, and reserving for all of them could
+  // grossly over-allocate.
+  return detail::filter(std::move(source), std::move(closure.pred));
+}
+
+template <typename T>
+Generator<T> operator|(Generator<T>&& source, detail::TakeClosure closure) {
+  // Without a hint, the source may run out long before n, e.g. a filter.
+  auto hint = source.sizeHint();
+  if (hint) {
+    hint = std::min(*hint, closure.n);
+  }
+  return detail::take(std::move(source), closure.n).setSizeHint(hint);
+}
+
+/**
+ * Drains the generator into a Vector, reserving for its size hint if it has
+ * one.
+ */
+template <typename T>
+Vector<std::remove_cvref_t<T>> collect(Generator<T>&& source) {
+  Vector<std::remove_cvref_t<T>> result;
+  if (auto hint = source.sizeHint()) {
+    result.reserve(*hint);
+  }
+  for (auto&& elem : source) {
+    result.push_back(std::forward<decltype(elem)>(elem));
+  }
+  return result;
+}
+
+inline detail::CollectClosure collect() { return {}; }
+
+template <typename T>
+Vector<std::remove_cvref_t<T>> operator|(Generator<T>&& source,
+                                         detail::CollectClosure) {
+  return collect(std::move(source));
+}
+
+}  // namespace ecx::stl
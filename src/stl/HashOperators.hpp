@@ -0,0 +1,575 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "src/stl/ColumnTable.hpp"
+#include "src/stl/Exceptions.hpp"
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+struct HashOptions {
+  // Worker threads for the partitioned mode.
+  unsigned threads = 1;
+  // Hash tables larger than this are split by radix partitioning into
+  // tables of about this size, so that each is built and probed within L2.
+  std::size_t partitionBytes = std::size_t{1} << 20;
+  // Distinct keys to size tables for; 0 to estimate it from the input.
+  std::size_t expectedGroups = 0;
+};
+
+/**
+ * One row per distinct key, in no particular order: the key, the sum of its
+ * values (widened as in AggregateResult), their count, min and max.
+ */
+template <std::integral K, typename V>
+struct GroupByResult {
+  using SumT = std::conditional_t<
+      std::is_floating_point_v<V>, double,
+      std::conditional_t<std::is_signed_v<V>, std::int64_t, std::uint64_t>>;
+
+  Vector<K> keys;
+  Vector<SumT> sums;
+  Vector<std::uint64_t> counts;
+  Vector<V> mins;
+  Vector<V> maxs;
+};
+
+/**
+ * The matching (build row, probe row) pairs of an inner equi-join, as two
+ * parallel selections, e.g. for ColumnTable::take.
+ */
+struct JoinResult {
+  SelectionVector buildRows;
+  SelectionVector probeRows;
+};
+
+namespace detail::hashing {
+
+using SizeT = std::size_t;
+
+// Rows whose buckets are prefetched together, ahead of being probed: enough
+// to cover a memory latency with independent misses.
+inline constexpr SizeT kBatch = 64;
+inline constexpr unsigned kMaxPartitionBits = 10;
+// Below this many rows per thread, partitioning for parallelism costs more
+// than it saves.
+inline constexpr SizeT kMinRowsPerThread = SizeT{1} << 16;
+
+// The murmur3 finaliser: every key bit affects every hash bit, so both the
+// low bits (bucket) and the high bits (partition) are well distributed.
+inline std::uint64_t mix(std::uint64_t h) noexcept {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+template <std::integral K>
+std::uint64_t hashOf(K key) noexcept {
+  return mix(static_cast<std::uint64_t>(key));
+}
+
+/**
+ * HyperLogLog over 2^12 registers (about 2% error), falling back to linear
+ * counting for small counts. Only sizes tables, which grow if it is low.
+ */
+template <std::integral K>
+SizeT estimateDistinct(Span<const K> keys) {
+  constexpr unsigned kIndexBits = 12;
+  constexpr SizeT kRegisters = SizeT{1} << kIndexBits;
+  if (keys.size() == 0) {
+    return 0;
+  }
+
+  std::uint8_t registers[kRegisters] = {};
+  for (K key : keys) {
+    const std::uint64_t h = hashOf(key);
+    const SizeT index = h >> (64 - kIndexBits);
+    // Rank from the low bits, independent of the index.
+    const auto rank = static_cast<std::uint8_t>(
+        std::countr_zero(h | std::uint64_t{1} << (64 - kIndexBits)) + 1);
+    registers[index] = std::max(registers[index], rank);
+  }
+
+  double inverseSum = 0;
+  SizeT zeros = 0;
+  for (std::uint8_t rank : registers) {
+    inverseSum += std::ldexp(1.0, -rank);
+    zeros += rank == 0;
+  }
+  const double m = kRegisters;
+  double estimate = 0.7213 / (1 + 1.079 / m) * m * m / inverseSum;
+  if (estimate <= 2.5 * m && zeros != 0) {
+    estimate = m * std::log(m / static_cast<double>(zeros));
+  }
+  return std::clamp<SizeT>(static_cast<SizeT>(estimate) + 1, 1, keys.size());
+}
+
+// Tables are at most 3/4 full: linear probing with a mixed hash still finds
+// most keys in their first cache line, and the table stays small.
+inline bool overloaded(SizeT entries, SizeT slots) noexcept {
+  return entries * 4 >= slots * 3;
+}
+
+inline SizeT capacityFor(SizeT entries) noexcept {
+  return std::bit_ceil(std::max<SizeT>(16, entries + entries / 3 + 1));
+}
+
+/**
+ * Radix bits to split a table of tableBytes by: enough for each part to fit
+ * options.partitionBytes, and, with threads, for each thread to get several.
+ */
+inline unsigned partitionBits(SizeT tableBytes, SizeT rows,
+                              const HashOptions& options) noexcept {
+  unsigned bits = 0;
+  while ((tableBytes >> bits) > options.partitionBytes &&
+         bits < kMaxPartitionBits) {
+    ++bits;
+  }
+  if (options.threads > 1 && rows >= kMinRowsPerThread * options.threads) {
+    while ((SizeT{1} << bits) < SizeT{4} * options.threads &&
+           bits < kMaxPartitionBits) {
+      ++bits;
+    }
+  }
+  return bits;
+}
+
+/**
+ * Rows scattered by the top bits of their key's hash, so that equal keys land
+ * in the same partition, each key with its payload (a value to aggregate, or
+ * the row it came from): partition p is [offsets[p], offsets[p + 1]).
+ */
+template <typename K, typename P>
+struct Partitions {
+  Vector<K> keys;
+  Vector<P> payloads;
+  Vector<SizeT> offsets;
+
+  SizeT count() const noexcept { return offsets.size() - 1; }
+
+  SizeT size(SizeT p) const noexcept { return offsets[p + 1] - offsets[p]; }
+};
+
+template <typename K, typename PayloadFn>
+auto partition(Span<const K> keys, unsigned bits, PayloadFn payloadOf) {
+  using P = std::invoke_result_t<PayloadFn&, SizeT>;
+  const SizeT parts = SizeT{1} << bits;
+  const unsigned shift = 64 - bits;
+
+  Partitions<K, P> out;
+  out.offsets = Vector<SizeT>(parts + 1);
+  for (K key : keys) {
+    ++out.offsets[(hashOf(key) >> shift) + 1];
+  }
+  for (SizeT p = 0; p < parts; ++p) {
+    out.offsets[p + 1] += out.offsets[p];
+  }
+
+  Vector<SizeT> cursor(parts);
+  std::copy_n(out.offsets.begin(), parts, cursor.begin());
+  out.keys = Vector<K>(keys.size());
+  out.payloads = Vector<P>(keys.size());
+  for (SizeT i = 0; i < keys.size(); ++i) {
+    const SizeT pos = cursor[hashOf(keys[i]) >> shift]++;
+    out.keys[pos] = keys[i];
+    out.payloads[pos] = payloadOf(i);
+  }
+  return out;
+}
+
+/**
+ * Hashes the keys of one batch, prefetching the slot each hash starts at, so
+ * that the misses of the whole batch overlap before any is probed.
+ */
+template <typename K, typename Slot>
+void hashBatch(const K* keys, SizeT n, const Vector<Slot>& slots,
+               std::uint64_t* hashes) noexcept {
+  const SizeT mask = slots.size() - 1;
+  for (SizeT i = 0; i < n; ++i) {
+    hashes[i] = hashOf(keys[i]);
+    __builtin_prefetch(slots.data() + (hashes[i] & mask));
+  }
+}
+
+/**
+ * Calls fn(p) for every partition, spread over up to threads workers that
+ * each take the next unclaimed partition.
+ *
+ * The first exception fn throws on a worker ends the claiming of partitions
+ * and is rethrown here, once every worker has finished.
+ */
+template <typename Fn>
+void forEachPartition(SizeT parts, unsigned threads, Fn&& fn) {
+  if (threads <= 1 || parts == 1) {
+    for (SizeT p = 0; p < parts; ++p) {
+      fn(p);
+    }
+    return;
+  }
+  std::atomic<SizeT> next{0};
+  std::mutex errorMutex;
+  std::exception_ptr error;
+  {
+    Vector<std::jthread> workers;
+    for (SizeT t = 0; t < std::min<SizeT>(threads, parts); ++t) {
+      workers.emplace_back([&] {
+        ECX_TRY {
+          for (SizeT p; (p = next.fetch_add(1, std::memory_order_relaxed)) <
+                        parts;) {
+            fn(p);
+          }
+        } ECX_CATCH_ALL {
+          next.store(parts, std::memory_order_relaxed);
+          std::lock_guard lock(errorMutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+      });
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+/**
+ * Open-addressing (linear probing) table from key to the aggregates of its
+ * group, held in the slot itself, so that a row touches one cache line.
+ */
+template <std::integral K, typename V>
+class AggregateTable {
+ public:
+  using ResultT = GroupByResult<K, V>;
+  using SumT = typename ResultT::SumT;
+
+  struct Slot {
+    K key;
+    SumT sum;
+    // Rows in the group, or 0 if the slot is empty.
+    std::uint64_t count;
+    V min;
+    V max;
+  };
+
+  static constexpr SizeT kBytesPerGroup = 3 * sizeof(Slot) / 2;
+
+  explicit AggregateTable(SizeT expectedGroups)
+      : slots_(capacityFor(expectedGroups)), mask_(slots_.size() - 1) {}
+
+  void add(const K* keys, const V* values, SizeT n) {
+    std::uint64_t hashes[kBatch];
+    for (SizeT begin = 0; begin < n; begin += kBatch) {
+      const SizeT batch = std::min(kBatch, n - begin);
+      hashBatch(keys + begin, batch, slots_, hashes);
+      for (SizeT i = 0; i < batch; ++i) {
+        update(keys[begin + i], hashes[i], values[begin + i]);
+      }
+    }
+  }
+
+  ResultT result() const {
+    ResultT result;
+    result.keys.reserve(groups_);
+    result.sums.reserve(groups_);
+    result.counts.reserve(groups_);
+    result.mins.reserve(groups_);
+    result.maxs.reserve(groups_);
+    for (const Slot& slot : slots_) {
+      if (slot.count != 0) {
+        result.keys.push_back(slot.key);
+        result.sums.push_back(slot.sum);
+        result.counts.push_back(slot.count);
+        result.mins.push_back(slot.min);
+        result.maxs.push_back(slot.max);
+      }
+    }
+    return result;
+  }
+
+ private:
+  void update(K key, std::uint64_t hash, V value) {
+    for (SizeT i = hash & mask_;; i = (i + 1) & mask_) {
+      Slot& slot = slots_[i];
+      if (slot.count == 0) {
+        if (overloaded(groups_ + 1, slots_.size())) {
+          // The estimate was low.
+          grow();
+          update(key, hash, value);
+          return;
+        }
+        slot = Slot{key, value, 1, value, value};
+        ++groups_;
+        return;
+      }
+      if (slot.key == key) {
+        slot.sum += value;
+        ++slot.count;
+        slot.min = std::min(slot.min, value);
+        slot.max = std::max(slot.max, value);
+        return;
+      }
+    }
+  }
+
+  void grow() {
+    Vector<Slot> slots(slots_.size() * 2);
+    const SizeT mask = slots.size() - 1;
+    for (const Slot& slot : slots_) {
+      if (slot.count != 0) {
+        SizeT i = hashOf(slot.key) & mask;
+        while (slots[i].count != 0) {
+          i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+      }
+    }
+    slots_ = std::move(slots);
+    mask_ = mask;
+  }
+
+  Vector<Slot> slots_;
+  SizeT mask_;
+  SizeT groups_ = 0;
+};
+
+/**
+ * Join hash table over build rows: one slot per distinct key, heading a
+ * chain of the rows with that key threaded through next_, so duplicate keys
+ * need no allocation either. Grows as AggregateTable does if expectedKeys
+ * was low; the chains, indexed by row, move with their slots.
+ */
+template <std::integral K>
+class JoinTable {
+ public:
+  struct Slot {
+    K key;
+    // 1 + the first build row with key, or 0 if the slot is empty.
+    std::uint32_t head;
+  };
+
+  static constexpr SizeT kBytesPerKey = 3 * sizeof(Slot) / 2 + 4;
+
+  /**
+   * Indexes the n build rows with the given keys, whose row numbers are
+   * rows[i], or i if rows is null.
+   */
+  JoinTable(const K* keys, const std::uint32_t* rows, SizeT n,
+            SizeT expectedKeys)
+      : slots_(capacityFor(expectedKeys)),
+        mask_(slots_.size() - 1),
+        next_(n),
+        rows_(rows) {
+    std::uint64_t hashes[kBatch];
+    // Inserted last to first, so that each chain lists rows in input order.
+    for (SizeT end = n; end > 0;) {
+      const SizeT begin = end > kBatch ? end - kBatch : 0;
+      hashBatch(keys + begin, end - begin, slots_, hashes);
+      for (SizeT i = end; i-- > begin;) {
+        Slot& slot = find(keys[i], hashes[i - begin]);
+        next_[i] = slot.head;
+        slot.head = static_cast<std::uint32_t>(i + 1);
+      }
+      end = begin;
+    }
+  }
+
+  /**
+   * Appends a pair to out for every build row matching each of the n probe
+   * rows, numbered as the build rows are.
+   */
+  void probe(const K* keys, const std::uint32_t* rows, SizeT n,
+             JoinResult& out) const {
+    std::uint64_t hashes[kBatch];
+    for (SizeT begin = 0; begin < n; begin += kBatch) {
+      const SizeT batch = std::min(kBatch, n - begin);
+      hashBatch(keys + begin, batch, slots_, hashes);
+      for (SizeT i = begin; i < begin + batch; ++i) {
+        const auto probeRow =
+            static_cast<std::uint32_t>(rows != nullptr ? rows[i] : i);
+        for (std::uint32_t r = lookup(keys[i], hashes[i - begin]); r != 0;
+             r = next_[r - 1]) {
+          out.buildRows.push_back(rows_ != nullptr
+                                      ? rows_[r - 1]
+                                      : static_cast<std::uint32_t>(r - 1));
+          out.probeRows.push_back(probeRow);
+        }
+      }
+    }
+  }
+
+ private:
+  Slot& find(K key, std::uint64_t hash) {
+    for (SizeT i = hash & mask_;; i = (i + 1) & mask_) {
+      Slot& slot = slots_[i];
+      if (slot.head == 0) {
+        if (overloaded(keys_ + 1, slots_.size())) {
+          // The estimate was low.
+          grow();
+          return find(key, hash);
+        }
+        slot.key = key;
+        ++keys_;
+        return slot;
+      }
+      if (slot.key == key) {
+        return slot;
+      }
+    }
+  }
+
+  void grow() {
+    Vector<Slot> slots(slots_.size() * 2);
+    const SizeT mask = slots.size() - 1;
+    for (const Slot& slot : slots_) {
+      if (slot.head != 0) {
+        SizeT i = hashOf(slot.key) & mask;
+        while (slots[i].head != 0) {
+          i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+      }
+    }
+    slots_ = std::move(slots);
+    mask_ = mask;
+  }
+
+  std::uint32_t lookup(K key, std::uint64_t hash) const noexcept {
+    for (SizeT i = hash & mask_;; i = (i + 1) & mask_) {
+      const Slot& slot = slots_[i];
+      if (slot.head == 0 || slot.key == key) {
+        return slot.head;
+      }
+    }
+  }
+
+  Vector<Slot> slots_;
+  SizeT mask_;
+  SizeT keys_ = 0;
+  Vector<std::uint32_t> next_;
+  const std::uint32_t* rows_;
+};
+
+template <typename T>
+void appendAll(Vector<T>& to, const Vector<T>& from) {
+  for (const T& value : from) {
+    to.push_back(value);
+  }
+}
+
+}  // namespace detail::hashing
+
+/**
+ * Groups values by the key in the same row, computing sum, count, min and
+ * max per key, with an open-addressing table sized from the (estimated)
+ * number of distinct keys.
+ *
+ * If that table would not fit in options.partitionBytes, or threads are
+ * given, rows are first radix-partitioned by hash, and each partition is
+ * aggregated separately (and concurrently) into its own small table.
+ */
+template <std::integral K, typename V>
+GroupByResult<K, V> groupBy(Span<const K> keys, Span<const V> values,
+                            const HashOptions& options = {}) {
+  using namespace detail::hashing;
+  using TableT = AggregateTable<K, V>;
+
+  const SizeT groups = options.expectedGroups != 0 ? options.expectedGroups
+                                                   : estimateDistinct(keys);
+  const unsigned bits = partitionBits(groups * TableT::kBytesPerGroup,
+                                      keys.size(), options);
+  if (bits == 0) {
+    TableT table(groups);
+    table.add(keys.data(), values.data(), keys.size());
+    return table.result();
+  }
+
+  const auto parts =
+      partition(keys, bits, [&](SizeT row) { return values[row]; });
+  Vector<GroupByResult<K, V>> partial(parts.count());
+  forEachPartition(parts.count(), options.threads, [&](SizeT p) {
+    const SizeT first = parts.offsets[p];
+    TableT table((groups >> bits) + 1);
+    table.add(parts.keys.data() + first, parts.payloads.data() + first,
+              parts.size(p));
+    partial[p] = table.result();
+  });
+
+  GroupByResult<K, V> result;
+  for (const auto& part : partial) {
+    appendAll(result.keys, part.keys);
+    appendAll(result.sums, part.sums);
+    appendAll(result.counts, part.counts);
+    appendAll(result.mins, part.mins);
+    appendAll(result.maxs, part.maxs);
+  }
+  return result;
+}
+
+/**
+ * Inner equi-join of the rows of buildKeys (the smaller side) with those of
+ * probeKeys: builds a table over buildKeys, then probes it with each row of
+ * probeKeys in batches, prefetching buckets ahead.
+ *
+ * Partitioned as groupBy is, by the same hash bits on both sides, so that
+ * each probe partition only meets its matching build partition. Pairs come
+ * out grouped by probe row within each partition.
+ */
+template <std::integral K>
+JoinResult hashJoin(Span<const K> buildKeys, Span<const K> probeKeys,
+                    const HashOptions& options = {}) {
+  using namespace detail::hashing;
+  using TableT = JoinTable<K>;
+
+  const SizeT distinct = options.expectedGroups != 0
+                             ? options.expectedGroups
+                             : estimateDistinct(buildKeys);
+  const unsigned bits =
+      partitionBits(distinct * TableT::kBytesPerKey,
+                    buildKeys.size() + probeKeys.size(), options);
+
+  JoinResult result;
+  if (bits == 0) {
+    const TableT table(buildKeys.data(), nullptr, buildKeys.size(), distinct);
+    table.probe(probeKeys.data(), nullptr, probeKeys.size(), result);
+    return result;
+  }
+
+  const auto rowOf = [](SizeT row) { return static_cast<std::uint32_t>(row); };
+  const auto build = partition(buildKeys, bits, rowOf);
+  const auto probe = partition(probeKeys, bits, rowOf);
+  Vector<JoinResult> partial(build.count());
+  forEachPartition(build.count(), options.threads, [&](SizeT p) {
+    const SizeT b = build.offsets[p];
+    const SizeT q = probe.offsets[p];
+    const TableT table(build.keys.data() + b, build.payloads.data() + b,
+                       build.size(p), (distinct >> bits) + 1);
+    table.probe(probe.keys.data() + q, probe.payloads.data() + q,
+                probe.size(p), partial[p]);
+  });
+
+  for (const JoinResult& part : partial) {
+    appendAll(result.buildRows, part.buildRows);
+    appendAll(result.probeRows, part.probeRows);
+  }
+  return result;
+}
+
+}  // namespace ecx::stl
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * High-dynamic-range histogram of uint64 values (typically latencies in ns or
+ * ticks), for percentiles that a mean would hide, e.g. the reallocations
+ * among a million push_backs.
+ *
+ * Buckets are log-linear: values below 2^PrecisionBits each get their own
+ * bucket, and every power of two above is split into 2^(PrecisionBits - 1)
+ * equal buckets. Any value up to 2^64 - 1 is thus recorded in constant time
+ * to a relative error below 2^-(PrecisionBits - 1), in a fixed array of
+ * about (64 - PrecisionBits) * 2^(PrecisionBits - 1) counters (30 KiB for
+ * the default of 7 bits, with an error below 1/64, about 1.6%).
+ *
+ * Not synchronised: each thread records into its own histogram, and the
+ * results are merged, as merge is exact.
+ */
+template <unsigned PrecisionBits = 7>
+class HdrHistogram {
+  static_assert(PrecisionBits >= 2 && PrecisionBits <= 20);
+
+ public:
+  using SizeT = std::size_t;
+  using ValueT = std::uint64_t;
+
+  // Buckets per power of two.
+  static constexpr SizeT kSubBuckets = SizeT{1} << PrecisionBits;
+  static constexpr SizeT kHalf = kSubBuckets / 2;
+  static constexpr SizeT kBuckets =
+      kSubBuckets + (64 - PrecisionBits) * kHalf;
+
+  HdrHistogram() : counts_(kBuckets) {}
+
+  void record(ValueT value) noexcept { record(value, 1); }
+
+  /**
+   * Records count occurrences of value, as for a sample standing in for
+   * several.
+   */
+  void record(ValueT value, std::uint64_t count) noexcept {
+    if (count == 0) {
+      return;
+    }
+    counts_[indexOf(value)] += count;
+    total_ += count;
+    sum_ += static_cast<double>(value) * static_cast<double>(count);
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+
+  void merge(const HdrHistogram& other) noexcept {
+    for (SizeT i = 0; i < kBuckets; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    total_ += other.total_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+
+  void reset() noexcept {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<ValueT>::max();
+    max_ = 0;
+  }
+
+  std::uint64_t count() const noexcept { return total_; }
+
+  [[nodiscard]] bool empty() const noexcept { return total_ == 0; }
+
+  // Exact, unlike percentiles; 0 if empty.
+  ValueT min() const noexcept { return total_ == 0 ? 0 : min_; }
+
+  ValueT max() const noexcept { return max_; }
+
+  double mean() const noexcept {
+    return total_ == 0 ? 0.0 : sum_ / static_cast<double>(total_);
+  }
+
+  /**
+   * The smallest value v such that percentile% of the recorded values are at
+   * most v, up to the bucket resolution: reported as the highest value of
+   * its bucket (but never above max()), so it errs high, as a latency bound
+   * should. 0 if empty.
+   */
+  ValueT valueAtPercentile(double percentile) const noexcept {
+    if (total_ == 0) {
+      return 0;
+    }
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const auto target = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(
+               std::ceil(clamped / 100.0 * static_cast<double>(total_))));
+
+    std::uint64_t seen = 0;
+    for (SizeT i = 0; i < kBuckets; ++i) {
+      seen += counts_[i];
+      if (seen >= target) {
+        return std::min(highestInBucket(i), max_);
+      }
+    }
+    return max_;
+  }
+
+  // The recorded count in the bucket holding value.
+  std::uint64_t countAt(ValueT value) const noexcept {
+    return counts_[indexOf(value)];
+  }
+
+  static constexpr SizeT indexOf(ValueT value) noexcept {
+    if (value < kSubBuckets) {
+      return static_cast<SizeT>(value);
+    }
+    // The top PrecisionBits bits of value select the bucket within its power
+    // of two; shift >= 1 counts the powers of two above the linear range.
+    const auto shift =
+        static_cast<unsigned>(std::bit_width(value)) - PrecisionBits;
+    const auto mantissa = static_cast<SizeT>(value >> shift);
+    return kSubBuckets + (shift - 1) * kHalf + (mantissa - kHalf);
+  }
+
+  static constexpr ValueT lowestInBucket(SizeT index) noexcept {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    const SizeT k = index - kSubBuckets;
+    const auto shift = static_cast<unsigned>(k / kHalf + 1);
+    return static_cast<ValueT>(k % kHalf + kHalf) << shift;
+  }
+
+  static constexpr ValueT highestInBucket(SizeT index) noexcept {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    const auto shift =
+        static_cast<unsigned>((index - kSubBuckets) / kHalf + 1);
+    return lowestInBucket(index) + ((ValueT{1} << shift) - 1);
+  }
+
+ private:
+  Vector<std::uint64_t> counts_;
+  std::uint64_t total_ = 0;
+  double sum_ = 0;
+  ValueT min_ = std::numeric_limits<ValueT>::max();
+  ValueT max_ = 0;
+};
+
+}  // namespace ecx::stl
@@ -0,0 +1,719 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "src/stl/Exceptions.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Unordered container with stable element addresses, O(1) insertion and
+ * erasure, and iteration close to that of a contiguous array: the shape of
+ * C++26 std::hive (plf::colony), for storage such as entities that are
+ * created and destroyed constantly while others hold pointers to them.
+ *
+ * Elements live in blocks that grow geometrically, up to kMaxBlockCapacity.
+ * Erasing leaves a hole that a later insertion fills; a block that empties
+ * is kept for reuse until trimCapacity(). Each block has a jump-counting
+ * skipfield: for every run of erased slots, its first and last entries hold
+ * the run's length and live slots hold 0, so iteration steps over any run in
+ * one jump. The runs of each block are also chained into a free list,
+ * through the erased slots themselves, which is where insertions go first.
+ *
+ * Insertion never moves elements, so pointers, references and iterators stay
+ * valid until their element is erased. Iteration order is unspecified.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class Hive : private Allocator {
+  using AllocTraits = std::allocator_traits<Allocator>;
+
+  static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                "Allocator::value_type must be T");
+
+  using SkipT = std::uint16_t;
+
+  static constexpr SkipT kNoRun = 0xFFFF;
+
+  // Links between the runs of erased slots in a block, stored in the first
+  // slot of each run.
+  struct FreeRun {
+    SkipT prev;
+    SkipT next;
+  };
+
+  struct alignas(std::max(alignof(T), alignof(FreeRun))) Slot {
+    std::byte bytes[std::max(sizeof(T), sizeof(FreeRun))];
+  };
+
+  struct Block {
+    Slot* slots;
+    // capacity + 1 entries; the last stays 0, ending every forward jump.
+    SkipT* skip;
+    Block* prev;
+    Block* next;
+    // Among the blocks with erased slots.
+    Block* prevWithRuns;
+    Block* nextWithRuns;
+    SkipT capacity;
+    // Slots at or past top have never held an element since the block was
+    // last reset.
+    SkipT top;
+    SkipT live;
+    SkipT firstRun;
+  };
+
+  using BlockAllocator =
+      typename AllocTraits::template rebind_alloc<Block>;
+  using SlotAllocator = typename AllocTraits::template rebind_alloc<Slot>;
+  using SkipAllocator = typename AllocTraits::template rebind_alloc<SkipT>;
+
+ public:
+  using SizeT = std::size_t;
+  using ValueT = T;
+  using AllocatorT = Allocator;
+  using allocator_type = Allocator;
+
+  static constexpr SizeT kMinBlockCapacity = 8;
+  static constexpr SizeT kMaxBlockCapacity = 8192;
+
+  template <bool Const>
+  class BasicIterator {
+    friend class Hive;
+    template <bool>
+    friend class BasicIterator;
+
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+    using reference = std::conditional_t<Const, const T&, T&>;
+
+    BasicIterator() noexcept = default;
+
+    // Iterator to ConstIterator.
+    operator BasicIterator<true>() const noexcept
+      requires(!Const)
+    {
+      return BasicIterator<true>(block_, index_);
+    }
+
+    reference operator*() const noexcept {
+      return *elementAt(block_, index_);
+    }
+
+    pointer operator->() const noexcept { return elementAt(block_, index_); }
+
+    BasicIterator& operator++() noexcept {
+      std::tie(block_, index_) = Hive::advance(block_, index_);
+      return *this;
+    }
+
+    BasicIterator operator++(int) noexcept {
+      BasicIterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    BasicIterator& operator--() noexcept {
+      std::tie(block_, index_) = Hive::retreat(block_, index_);
+      return *this;
+    }
+
+    BasicIterator operator--(int) noexcept {
+      BasicIterator old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const BasicIterator& other) const noexcept = default;
+
+   private:
+    BasicIterator(Block* block, SizeT index) noexcept
+        : block_(block), index_(index) {}
+
+    Block* block_ = nullptr;
+    SizeT index_ = 0;
+  };
+
+  using IteratorT = BasicIterator<false>;
+  using ConstIteratorT = BasicIterator<true>;
+
+  explicit Hive() noexcept(noexcept(Allocator())) = default;
+
+  explicit Hive(const Allocator& alloc) noexcept : Allocator(alloc) {}
+
+  Hive(std::initializer_list<T> init, const Allocator& alloc = Allocator())
+      : Hive(alloc) {
+    reserve(init.size());
+    for (const T& value : init) {
+      insert(value);
+    }
+  }
+
+  Hive(const Hive& other)
+      : Hive(other, AllocTraits::select_on_container_copy_construction(
+                        other.allocator())) {}
+
+  Hive(const Hive& other, const Allocator& alloc) : Hive(alloc) {
+    ECX_TRY {
+      copyFrom(other);
+    } ECX_CATCH_ALL {
+      releaseAll();
+      ECX_RETHROW;
+    }
+  }
+
+  Hive(Hive&& other) noexcept : Allocator(std::move(other.allocator())) {
+    steal(other);
+  }
+
+  /**
+   * Copies the elements, reusing this hive's blocks. Iteration order follows
+   * other's.
+   */
+  Hive& operator=(const Hive& other) {
+    if (this == &other) {
+      return *this;
+    }
+
+    if constexpr (kPropagateOnCopy) {
+      if (!kAlwaysEqual && allocator() != other.allocator()) {
+        releaseAll();
+      }
+      allocator() = other.allocator();
+    }
+    clear();
+    copyFrom(other);
+    return *this;
+  }
+
+  Hive& operator=(Hive&& other) noexcept(kPropagateOnMove || kAlwaysEqual) {
+    if (this == &other) {
+      return *this;
+    }
+
+    if constexpr (kPropagateOnMove || kAlwaysEqual) {
+      releaseAll();
+      if constexpr (kPropagateOnMove) {
+        allocator() = std::move(other.allocator());
+      }
+      steal(other);
+    } else if (allocator() == other.allocator()) {
+      releaseAll();
+      steal(other);
+    } else {
+      // Memory from a different allocator cannot be adopted.
+      clear();
+      reserve(other.size());
+      for (T& value : other) {
+        insert(std::move(value));
+      }
+      other.clear();
+    }
+    return *this;
+  }
+
+  ~Hive() { releaseAll(); }
+
+  AllocatorT getAllocator() const noexcept { return allocator(); }
+
+  IteratorT begin() noexcept {
+    return head_ == nullptr ? end() : IteratorT(head_, head_->skip[0]);
+  }
+
+  IteratorT end() noexcept {
+    return tail_ == nullptr ? IteratorT() : IteratorT(tail_, tail_->top);
+  }
+
+  ConstIteratorT begin() const noexcept {
+    return const_cast<Hive&>(*this).begin();
+  }
+
+  ConstIteratorT end() const noexcept {
+    return const_cast<Hive&>(*this).end();
+  }
+
+  SizeT size() const noexcept { return size_; }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  /**
+   * Slots in every block, including erased slots and emptied blocks kept
+   * for reuse.
+   */
+  SizeT capacity() const noexcept { return capacity_; }
+
+  /**
+   * Constructs an element in the first hole of a block with erasures, or
+   * else past the end of the last block, or else in a new block. Nothing is
+   * moved. If the constructor throws, the hive is unchanged.
+   */
+  template <typename... Args>
+  IteratorT emplace(Args&&... args) {
+    if (blocksWithRuns_ != nullptr) {
+      return emplaceInRun(blocksWithRuns_, std::forward<Args>(args)...);
+    }
+    if (tail_ != nullptr && tail_->top < tail_->capacity) {
+      Block* block = tail_;
+      const SizeT index = block->top;
+      constructAt(block, index, std::forward<Args>(args)...);
+      ++block->top;
+      ++block->live;
+      ++size_;
+      return IteratorT(block, index);
+    }
+
+    Block* block = takeBlock();
+    ECX_TRY {
+      constructAt(block, 0, std::forward<Args>(args)...);
+    } ECX_CATCH_ALL {
+      pushReserve(block);
+      ECX_RETHROW;
+    }
+    block->top = 1;
+    block->live = 1;
+    linkAtTail(block);
+    ++size_;
+    return IteratorT(block, 0);
+  }
+
+  IteratorT insert(const T& value) { return emplace(value); }
+
+  IteratorT insert(T&& value) { return emplace(std::move(value)); }
+
+  /**
+   * Destroys the element at it, in O(1), and returns the iterator following
+   * it. Other iterators stay valid. A block left empty is kept for reuse.
+   */
+  IteratorT erase(ConstIteratorT it) noexcept {
+    Block* block = it.block_;
+    const auto i = static_cast<SkipT>(it.index_);
+    AllocTraits::destroy(allocator(), elementAt(block, i));
+    --size_;
+
+    if (--block->live == 0) {
+      Block* next = block->next;
+      unlink(block);
+      if (block->firstRun != kNoRun) {
+        unlinkWithRuns(block);
+      }
+      resetBlock(block);
+      pushReserve(block);
+      return next == nullptr ? end() : IteratorT(next, next->skip[0]);
+    }
+
+    SkipT* skip = block->skip;
+    const SkipT left = i == 0 ? 0 : skip[i - 1];
+    const SkipT right = skip[i + 1];
+    const SizeT nextIndex = SizeT{i} + 1 + right;
+
+    if (block->firstRun == kNoRun) {
+      linkWithRuns(block);
+    }
+    if (left == 0 && right == 0) {
+      skip[i] = 1;
+      pushRun(block, i);
+    } else if (right == 0) {
+      const SkipT length = left + 1;
+      skip[i - left] = length;
+      skip[i] = length;
+    } else if (left == 0) {
+      const SkipT length = right + 1;
+      skip[i] = length;
+      skip[i + right] = length;
+      moveRun(block, i + 1, i);
+    } else {
+      // Joins the two runs; the right one's links are dropped.
+      const SkipT length = left + 1 + right;
+      skip[i - left] = length;
+      skip[i + right] = length;
+      removeRun(block, i + 1);
+    }
+
+    if (nextIndex < block->top || block->next == nullptr) {
+      return IteratorT(block, std::min<SizeT>(nextIndex, block->top));
+    }
+    return IteratorT(block->next, block->next->skip[0]);
+  }
+
+  /**
+   * The iterator to the element at p, found by a linear search of the
+   * blocks: O(log(size())) of them while they grow geometrically, but
+   * linear in size() / kMaxBlockCapacity past that cap.
+   */
+  IteratorT getIterator(const T* p) noexcept {
+    const auto* bytes = reinterpret_cast<const std::byte*>(p);
+    for (Block* block = head_; block != nullptr; block = block->next) {
+      const auto* first = reinterpret_cast<const std::byte*>(block->slots);
+      if (bytes >= first && bytes < first + block->top * sizeof(Slot)) {
+        return IteratorT(block, static_cast<SizeT>(bytes - first) /
+                                    sizeof(Slot));
+      }
+    }
+    return end();
+  }
+
+  /**
+   * Destroys every element, keeping the blocks for reuse.
+   */
+  void clear() noexcept {
+    while (head_ != nullptr) {
+      Block* block = head_;
+      destroyElements(block);
+      unlink(block);
+      resetBlock(block);
+      pushReserve(block);
+    }
+    blocksWithRuns_ = nullptr;
+    size_ = 0;
+  }
+
+  /**
+   * Allocates blocks until capacity() >= n.
+   */
+  void reserve(SizeT n) {
+    while (capacity_ < n) {
+      pushReserve(allocateBlock(std::clamp(n - capacity_, kMinBlockCapacity,
+                                           kMaxBlockCapacity)));
+    }
+  }
+
+  /**
+   * Frees the empty blocks kept for reuse.
+   */
+  void trimCapacity() noexcept {
+    while (reserve_ != nullptr) {
+      Block* block = std::exchange(reserve_, reserve_->next);
+      deallocateBlock(block);
+    }
+  }
+
+ private:
+  static constexpr bool kPropagateOnCopy =
+      AllocTraits::propagate_on_container_copy_assignment::value;
+  static constexpr bool kPropagateOnMove =
+      AllocTraits::propagate_on_container_move_assignment::value;
+  static constexpr bool kAlwaysEqual = AllocTraits::is_always_equal::value;
+
+  Allocator& allocator() noexcept { return static_cast<Allocator&>(*this); }
+
+  const Allocator& allocator() const noexcept {
+    return static_cast<const Allocator&>(*this);
+  }
+
+  static T* elementAt(Block* block, SizeT index) noexcept {
+    return std::launder(reinterpret_cast<T*>(block->slots + index));
+  }
+
+  /**
+   * The position after (block, index): one slot on, plus the length of the
+   * run of erased slots starting there, if any; then on to the next block.
+   * Stays at (tail, top), which is end().
+   */
+  static std::pair<Block*, SizeT> advance(Block* block,
+                                          SizeT index) noexcept {
+    index += 1;
+    index += block->skip[index];
+    if (index >= block->top && block->next != nullptr) {
+      block = block->next;
+      index = block->skip[0];
+    }
+    return {block, index};
+  }
+
+  /**
+   * The position before (block, index): back one slot, and back over the run
+   * of erased slots ending there, if any, whose last entry holds its length.
+   */
+  static std::pair<Block*, SizeT> retreat(Block* block,
+                                          SizeT index) noexcept {
+    while (true) {
+      if (index == 0) {
+        block = block->prev;
+        index = block->top;
+      }
+      index -= 1;
+      const SkipT run = block->skip[index];
+      if (run == 0) {
+        return {block, index};
+      }
+      if (index + 1 == run) {
+        index = 0;
+        continue;
+      }
+      return {block, index - run};
+    }
+  }
+
+  template <typename... Args>
+  void constructAt(Block* block, SizeT index, Args&&... args) {
+    AllocTraits::construct(allocator(),
+                           reinterpret_cast<T*>(block->slots + index),
+                           std::forward<Args>(args)...);
+  }
+
+  /**
+   * Fills the first slot of block's first run.
+   */
+  template <typename... Args>
+  IteratorT emplaceInRun(Block* block, Args&&... args) {
+    const SkipT s = block->firstRun;
+    const FreeRun links = runAt(block, s);
+    ECX_TRY {
+      constructAt(block, s, std::forward<Args>(args)...);
+    } ECX_CATCH_ALL {
+      // The constructor may have written over the links.
+      setRun(block, s, links);
+      ECX_RETHROW;
+    }
+
+    SkipT* skip = block->skip;
+    const SkipT length = skip[s];
+    skip[s] = 0;
+    if (length > 1) {
+      skip[s + 1] = length - 1;
+      skip[s + length - 1] = length - 1;
+      setRun(block, s + 1, links);
+      relink(block, links, s + 1);
+    } else {
+      block->firstRun = links.next;
+      if (links.next != kNoRun) {
+        FreeRun next = runAt(block, links.next);
+        next.prev = kNoRun;
+        setRun(block, links.next, next);
+      } else {
+        unlinkWithRuns(block);
+      }
+    }
+    ++block->live;
+    ++size_;
+    return IteratorT(block, s);
+  }
+
+  static FreeRun runAt(Block* block, SizeT index) noexcept {
+    FreeRun run;
+    std::memcpy(&run, block->slots + index, sizeof(run));
+    return run;
+  }
+
+  static void setRun(Block* block, SizeT index, const FreeRun& run) noexcept {
+    std::memcpy(block->slots + index, &run, sizeof(run));
+  }
+
+  // Points the neighbours of the run with links at index instead.
+  static void relink(Block* block, const FreeRun& links,
+                     SizeT index) noexcept {
+    const auto at = static_cast<SkipT>(index);
+    if (links.prev == kNoRun) {
+      block->firstRun = at;
+    } else {
+      FreeRun prev = runAt(block, links.prev);
+      prev.next = at;
+      setRun(block, links.prev, prev);
+    }
+    if (links.next != kNoRun) {
+      FreeRun next = runAt(block, links.next);
+      next.prev = at;
+      setRun(block, links.next, next);
+    }
+  }
+
+  static void pushRun(Block* block, SkipT index) noexcept {
+    setRun(block, index, FreeRun{kNoRun, block->firstRun});
+    if (block->firstRun != kNoRun) {
+      FreeRun next = runAt(block, block->firstRun);
+      next.prev = index;
+      setRun(block, block->firstRun, next);
+    }
+    block->firstRun = index;
+  }
+
+  static void moveRun(Block* block, SizeT from, SizeT to) noexcept {
+    const FreeRun links = runAt(block, from);
+    setRun(block, to, links);
+    relink(block, links, to);
+  }
+
+  static void removeRun(Block* block, SizeT index) noexcept {
+    const FreeRun links = runAt(block, index);
+    if (links.prev == kNoRun) {
+      block->firstRun = links.next;
+    } else {
+      FreeRun prev = runAt(block, links.prev);
+      prev.next = links.next;
+      setRun(block, links.prev, prev);
+    }
+    if (links.next != kNoRun) {
+      FreeRun next = runAt(block, links.next);
+      next.prev = links.prev;
+      setRun(block, links.next, next);
+    }
+  }
+
+  void linkWithRuns(Block* block) noexcept {
+    block->prevWithRuns = nullptr;
+    block->nextWithRuns = blocksWithRuns_;
+    if (blocksWithRuns_ != nullptr) {
+      blocksWithRuns_->prevWithRuns = block;
+    }
+    blocksWithRuns_ = block;
+  }
+
+  void unlinkWithRuns(Block* block) noexcept {
+    if (block->prevWithRuns != nullptr) {
+      block->prevWithRuns->nextWithRuns = block->nextWithRuns;
+    } else {
+      blocksWithRuns_ = block->nextWithRuns;
+    }
+    if (block->nextWithRuns != nullptr) {
+      block->nextWithRuns->prevWithRuns = block->prevWithRuns;
+    }
+  }
+
+  void linkAtTail(Block* block) noexcept {
+    block->prev = tail_;
+    block->next = nullptr;
+    if (tail_ != nullptr) {
+      tail_->next = block;
+    } else {
+      head_ = block;
+    }
+    tail_ = block;
+  }
+
+  void unlink(Block* block) noexcept {
+    if (block->prev != nullptr) {
+      block->prev->next = block->next;
+    } else {
+      head_ = block->next;
+    }
+    if (block->next != nullptr) {
+      block->next->prev = block->prev;
+    } else {
+      tail_ = block->prev;
+    }
+  }
+
+  // Reserve blocks are kept empty and reset, chained through next.
+  void pushReserve(Block* block) noexcept {
+    block->next = reserve_;
+    reserve_ = block;
+  }
+
+  /**
+   * An empty block: a reserved one if any, or else a new one sized to grow
+   * the hive geometrically.
+   */
+  Block* takeBlock() {
+    if (reserve_ != nullptr) {
+      return std::exchange(reserve_, reserve_->next);
+    }
+    return allocateBlock(
+        std::clamp(size_, kMinBlockCapacity, kMaxBlockCapacity));
+  }
+
+  Block* allocateBlock(SizeT capacity) {
+    BlockAllocator blocks(allocator());
+    Block* block = std::allocator_traits<BlockAllocator>::allocate(blocks, 1);
+    SlotAllocator slots(allocator());
+    SkipAllocator skips(allocator());
+    Slot* slotArray = nullptr;
+    ECX_TRY {
+      slotArray =
+          std::allocator_traits<SlotAllocator>::allocate(slots, capacity);
+      SkipT* skipArray =
+          std::allocator_traits<SkipAllocator>::allocate(skips, capacity + 1);
+      ::new (block) Block{slotArray,
+                          skipArray,
+                          nullptr,
+                          nullptr,
+                          nullptr,
+                          nullptr,
+                          static_cast<SkipT>(capacity),
+                          0,
+                          0,
+                          kNoRun};
+    } ECX_CATCH_ALL {
+      if (slotArray != nullptr) {
+        std::allocator_traits<SlotAllocator>::deallocate(slots, slotArray,
+                                                         capacity);
+      }
+      std::allocator_traits<BlockAllocator>::deallocate(blocks, block, 1);
+      ECX_RETHROW;
+    }
+    std::fill_n(block->skip, capacity + 1, SkipT{0});
+    capacity_ += capacity;
+    return block;
+  }
+
+  void deallocateBlock(Block* block) noexcept {
+    capacity_ -= block->capacity;
+    SlotAllocator slots(allocator());
+    SkipAllocator skips(allocator());
+    BlockAllocator blocks(allocator());
+    std::allocator_traits<SlotAllocator>::deallocate(slots, block->slots,
+                                                     block->capacity);
+    std::allocator_traits<SkipAllocator>::deallocate(skips, block->skip,
+                                                     block->capacity + 1);
+    std::allocator_traits<BlockAllocator>::deallocate(blocks, block, 1);
+  }
+
+  // Only the slots below top can have been used since the last reset.
+  static void resetBlock(Block* block) noexcept {
+    std::fill_n(block->skip, block->top + 1, SkipT{0});
+    block->top = 0;
+    block->live = 0;
+    block->firstRun = kNoRun;
+  }
+
+  void destroyElements(Block* block) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (SizeT i = block->skip[0]; i < block->top;
+           i += 1 + block->skip[i + 1]) {
+        AllocTraits::destroy(allocator(), elementAt(block, i));
+      }
+    }
+  }
+
+  void copyFrom(const Hive& other) {
+    reserve(other.size());
+    for (const T& value : other) {
+      insert(value);
+    }
+  }
+
+  void releaseAll() noexcept {
+    clear();
+    trimCapacity();
+  }
+
+  void steal(Hive& other) noexcept {
+    head_ = std::exchange(other.head_, nullptr);
+    tail_ = std::exchange(other.tail_, nullptr);
+    blocksWithRuns_ = std::exchange(other.blocksWithRuns_, nullptr);
+    reserve_ = std::exchange(other.reserve_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+  }
+
+  // The blocks holding elements, in iteration order.
+  Block* head_ = nullptr;
+  Block* tail_ = nullptr;
+  Block* blocksWithRuns_ = nullptr;
+  Block* reserve_ = nullptr;
+  SizeT size_ = 0;
+  SizeT capacity_ = 0;
+};
+
+}  // namespace ecx::stl
@@ -0,0 +1,526 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace ecx::stl {
+
+/**
+ * What a hook does to catch misuse:
+ * - kNormal: nothing. Cheapest; linking a hook twice, or destroying an object
+ *   while it is in a list, corrupts the list.
+ * - kSafe: unlinked hooks are nulled, so isLinked() is accurate, and linking
+ *   a linked hook or destroying a linked hook aborts.
+ * - kAutoUnlink: destroying a linked object unlinks it, and it may unlink
+ *   itself at any time. Lists of such hooks cannot keep a count, so their
+ *   size() is linear.
+ */
+enum class LinkMode : std::uint8_t { kNormal, kSafe, kAutoUnlink };
+
+namespace detail {
+
+struct ListNode {
+  ListNode* prev = nullptr;
+  ListNode* next = nullptr;
+
+  void unlink() noexcept {
+    prev->next = next;
+    next->prev = prev;
+  }
+};
+
+struct ForwardNode {
+  ForwardNode* next = nullptr;
+};
+
+/**
+ * The T containing the hook at node, for a hook that is the data member
+ * Member of T.
+ *
+ * Under the Itanium C++ ABI (GCC, Clang), a pointer to data member is the
+ * offset of the member, which saves computing it from a dummy object.
+ */
+template <typename T, auto Member, typename Node>
+T* ownerOf(Node* node) noexcept {
+  static_assert(sizeof(Member) == sizeof(std::ptrdiff_t),
+                "pointer to data member must be a plain offset");
+  const auto offset = std::bit_cast<std::ptrdiff_t>(Member);
+  return reinterpret_cast<T*>(reinterpret_cast<char*>(node) - offset);
+}
+
+template <typename T, auto Member>
+using HookOf = std::remove_reference_t<decltype(std::declval<T&>().*Member)>;
+
+}  // namespace detail
+
+/**
+ * Embedded in an object to let it be linked into an IntrusiveList, one hook
+ * per list the object may be in at once. The list never allocates; the
+ * object must outlive its membership (or use LinkMode::kAutoUnlink).
+ *
+ * Copying an object does not copy its list memberships: a copied hook is
+ * unlinked, and assigning to a hook leaves it as it was.
+ */
+template <LinkMode Mode = LinkMode::kSafe>
+class IntrusiveListHook {
+ public:
+  static constexpr LinkMode kMode = Mode;
+
+  IntrusiveListHook() noexcept = default;
+
+  IntrusiveListHook(const IntrusiveListHook&) noexcept {}
+
+  IntrusiveListHook& operator=(const IntrusiveListHook&) noexcept {
+    return *this;
+  }
+
+  ~IntrusiveListHook() {
+    if constexpr (Mode == LinkMode::kSafe) {
+      if (isLinked()) {
+        std::abort();
+      }
+    } else if constexpr (Mode == LinkMode::kAutoUnlink) {
+      unlink();
+    }
+  }
+
+  /**
+   * Whether the hook is in a list. Not meaningful for LinkMode::kNormal,
+   * which does not clear hooks when they are unlinked.
+   */
+  bool isLinked() const noexcept { return node_.next != nullptr; }
+
+  /**
+   * Removes the object from whatever list it is in, if any.
+   */
+  void unlink() noexcept
+    requires(Mode == LinkMode::kAutoUnlink)
+  {
+    if (isLinked()) {
+      node_.unlink();
+      node_ = {};
+    }
+  }
+
+ private:
+  template <typename T, auto Member>
+  friend class IntrusiveList;
+
+  detail::ListNode node_;
+};
+
+/**
+ * Doubly linked list threaded through the Member hooks of its elements, e.g.
+ *   struct Request {
+ *     IntrusiveListHook<> pending;
+ *     IntrusiveListHook<> byClient;
+ *   };
+ *   IntrusiveList<Request, &Request::pending> pending;
+ *
+ * Insertion and removal at any position are O(1) and never allocate; the
+ * list does not own its elements. The list's own node is a sentinel, making
+ * the list circular, so there are no null checks on the hot paths.
+ */
+template <typename T, auto Member>
+class IntrusiveList {
+  using HookT = detail::HookOf<T, Member>;
+  using Node = detail::ListNode;
+
+  static constexpr LinkMode kMode = HookT::kMode;
+  static constexpr bool kCountsSize = kMode != LinkMode::kAutoUnlink;
+
+ public:
+  using SizeT = std::size_t;
+  using ValueT = T;
+
+  template <typename U>
+  class IteratorImpl {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::remove_const_t<U>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = U*;
+    using reference = U&;
+
+    IteratorImpl() noexcept = default;
+
+    // Iterator to const_iterator.
+    template <typename V>
+      requires(std::is_const_v<U> && !std::is_const_v<V>)
+    IteratorImpl(const IteratorImpl<V>& other) noexcept : node_(other.node_) {}
+
+    U& operator*() const noexcept { return *toValue(node_); }
+
+    U* operator->() const noexcept { return toValue(node_); }
+
+    IteratorImpl& operator++() noexcept {
+      node_ = node_->next;
+      return *this;
+    }
+
+    IteratorImpl operator++(int) noexcept {
+      IteratorImpl old = *this;
+      ++*this;
+      return old;
+    }
+
+    IteratorImpl& operator--() noexcept {
+      node_ = node_->prev;
+      return *this;
+    }
+
+    IteratorImpl operator--(int) noexcept {
+      IteratorImpl old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const IteratorImpl& other) const noexcept = default;
+
+   private:
+    friend class IntrusiveList;
+
+    template <typename V>
+    friend class IteratorImpl;
+
+    explicit IteratorImpl(Node* node) noexcept : node_(node) {}
+
+    Node* node_ = nullptr;
+  };
+
+  using Iterator = IteratorImpl<T>;
+  using ConstIterator = IteratorImpl<const T>;
+
+  IntrusiveList() noexcept { sentinel_.prev = sentinel_.next = &sentinel_; }
+
+  IntrusiveList(const IntrusiveList&) = delete;
+  IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+  IntrusiveList(IntrusiveList&& other) noexcept : IntrusiveList() {
+    swap(other);
+  }
+
+  IntrusiveList& operator=(IntrusiveList&& other) noexcept {
+    if (this != &other) {
+      clear();
+      swap(other);
+    }
+    return *this;
+  }
+
+  // Unlinks, but does not destroy, every element.
+  ~IntrusiveList() { clear(); }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return sentinel_.next == &sentinel_;
+  }
+
+  /**
+   * O(1), except for LinkMode::kAutoUnlink hooks, where elements may leave
+   * without the list knowing.
+   */
+  SizeT size() const noexcept {
+    if constexpr (kCountsSize) {
+      return size_;
+    } else {
+      return static_cast<SizeT>(std::distance(begin(), end()));
+    }
+  }
+
+  Iterator begin() noexcept { return Iterator(sentinel_.next); }
+  Iterator end() noexcept { return Iterator(&sentinel_); }
+  ConstIterator begin() const noexcept { return ConstIterator(firstNode()); }
+  ConstIterator end() const noexcept { return ConstIterator(sentinelNode()); }
+
+  T& front() noexcept { return *toValue(sentinel_.next); }
+  T& back() noexcept { return *toValue(sentinel_.prev); }
+  const T& front() const noexcept { return *toValue(sentinel_.next); }
+  const T& back() const noexcept { return *toValue(sentinel_.prev); }
+
+  void pushFront(T& value) noexcept { insert(begin(), value); }
+
+  void pushBack(T& value) noexcept { insert(end(), value); }
+
+  void popFront() noexcept { erase(begin()); }
+
+  void popBack() noexcept { erase(Iterator(sentinel_.prev)); }
+
+  /**
+   * Links value before pos, and returns an iterator to it. value must not
+   * already be in a list through this hook.
+   */
+  Iterator insert(ConstIterator pos, T& value) noexcept {
+    Node* node = nodeOf(value);
+    if constexpr (kMode == LinkMode::kSafe) {
+      if (node->next != nullptr) {
+        std::abort();
+      }
+    }
+    Node* next = pos.node_;
+    node->prev = next->prev;
+    node->next = next;
+    next->prev->next = node;
+    next->prev = node;
+    if constexpr (kCountsSize) {
+      ++size_;
+    }
+    return Iterator(node);
+  }
+
+  /**
+   * Unlinks the element at pos, and returns an iterator to the next one.
+   */
+  Iterator erase(ConstIterator pos) noexcept {
+    Node* node = pos.node_;
+    Node* next = node->next;
+    node->unlink();
+    if constexpr (kMode != LinkMode::kNormal) {
+      *node = {};
+    }
+    if constexpr (kCountsSize) {
+      --size_;
+    }
+    return Iterator(next);
+  }
+
+  /**
+   * Unlinks value, which must be in this list.
+   */
+  void remove(T& value) noexcept { erase(iteratorTo(value)); }
+
+  /**
+   * The iterator to value, which must be in this list, in O(1).
+   */
+  Iterator iteratorTo(T& value) noexcept { return Iterator(nodeOf(value)); }
+
+  ConstIterator iteratorTo(const T& value) const noexcept {
+    return ConstIterator(nodeOf(const_cast<T&>(value)));
+  }
+
+  void clear() noexcept {
+    if constexpr (kMode != LinkMode::kNormal) {
+      for (Node* node = sentinel_.next; node != &sentinel_;) {
+        *std::exchange(node, node->next) = {};
+      }
+    }
+    sentinel_.prev = sentinel_.next = &sentinel_;
+    if constexpr (kCountsSize) {
+      size_ = 0;
+    }
+  }
+
+  /**
+   * Moves every element of other to before pos, in O(1).
+   */
+  void splice(ConstIterator pos, IntrusiveList& other) noexcept {
+    if (other.empty()) {
+      return;
+    }
+    Node* next = pos.node_;
+    Node* first = other.sentinel_.next;
+    Node* last = other.sentinel_.prev;
+    first->prev = next->prev;
+    next->prev->next = first;
+    last->next = next;
+    next->prev = last;
+    if constexpr (kCountsSize) {
+      size_ += std::exchange(other.size_, 0);
+    }
+    other.sentinel_.prev = other.sentinel_.next = &other.sentinel_;
+  }
+
+  void swap(IntrusiveList& other) noexcept {
+    // The sentinels stay put; only their neighbours are swapped, and then
+    // repointed at the sentinel they now belong to.
+    std::swap(sentinel_, other.sentinel_);
+    if constexpr (kCountsSize) {
+      std::swap(size_, other.size_);
+    }
+    adoptNeighbours(other);
+    other.adoptNeighbours(*this);
+  }
+
+ private:
+  static Node* nodeOf(T& value) noexcept { return &(value.*Member).node_; }
+
+  static T* toValue(Node* node) noexcept {
+    return detail::ownerOf<T, Member>(reinterpret_cast<HookT*>(node));
+  }
+
+  // The sentinel_ fields are never written through a const list, so the
+  // const overloads can hand out non-const nodes for iterators to share.
+  Node* firstNode() const noexcept { return sentinel_.next; }
+
+  Node* sentinelNode() const noexcept {
+    return const_cast<Node*>(&sentinel_);
+  }
+
+  void adoptNeighbours(IntrusiveList& previousOwner) noexcept {
+    if (sentinel_.next == &previousOwner.sentinel_) {
+      sentinel_.prev = sentinel_.next = &sentinel_;
+      return;
+    }
+    sentinel_.next->prev = &sentinel_;
+    sentinel_.prev->next = &sentinel_;
+  }
+
+  struct NoCount {};
+
+  Node sentinel_;
+  [[no_unique_address]] std::conditional_t<kCountsSize, SizeT, NoCount> size_{};
+};
+
+/**
+ * Embedded in an object to let it be linked into an IntrusiveStack or
+ * IntrusiveQueue: a single pointer. Unlike IntrusiveListHook, there are no
+ * checking modes, as an element cannot be unlinked from the middle.
+ */
+class IntrusiveForwardHook {
+ public:
+  IntrusiveForwardHook() noexcept = default;
+
+  IntrusiveForwardHook(const IntrusiveForwardHook&) noexcept {}
+
+  IntrusiveForwardHook& operator=(const IntrusiveForwardHook&) noexcept {
+    return *this;
+  }
+
+ private:
+  template <typename T, auto Member>
+  friend class IntrusiveStack;
+
+  template <typename T, auto Member>
+  friend class IntrusiveQueue;
+
+  detail::ForwardNode node_;
+};
+
+/**
+ * LIFO stack threaded through the Member hooks of its elements, e.g. a free
+ * list of objects. push, pop and top are O(1) and never allocate.
+ */
+template <typename T, auto Member>
+class IntrusiveStack {
+  using Node = detail::ForwardNode;
+
+ public:
+  IntrusiveStack() noexcept = default;
+
+  IntrusiveStack(const IntrusiveStack&) = delete;
+  IntrusiveStack& operator=(const IntrusiveStack&) = delete;
+
+  IntrusiveStack(IntrusiveStack&& other) noexcept
+      : head_(std::exchange(other.head_, nullptr)) {}
+
+  IntrusiveStack& operator=(IntrusiveStack&& other) noexcept {
+    head_ = std::exchange(other.head_, nullptr);
+    return *this;
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return head_ == nullptr; }
+
+  T& top() const noexcept { return *toValue(head_); }
+
+  void push(T& value) noexcept {
+    Node* node = &(value.*Member).node_;
+    node->next = head_;
+    head_ = node;
+  }
+
+  // Unlinks and returns the top element.
+  T& pop() noexcept {
+    Node* node = std::exchange(head_, head_->next);
+    node->next = nullptr;
+    return *toValue(node);
+  }
+
+ private:
+  static T* toValue(Node* node) noexcept {
+    return detail::ownerOf<T, Member>(
+        reinterpret_cast<IntrusiveForwardHook*>(node));
+  }
+
+  Node* head_ = nullptr;
+};
+
+/**
+ * FIFO queue threaded through the Member hooks of its elements. push, pop
+ * and front are O(1) and never allocate, and whole queues append in O(1).
+ */
+template <typename T, auto Member>
+class IntrusiveQueue {
+  using Node = detail::ForwardNode;
+
+ public:
+  IntrusiveQueue() noexcept = default;
+
+  IntrusiveQueue(const IntrusiveQueue&) = delete;
+  IntrusiveQueue& operator=(const IntrusiveQueue&) = delete;
+
+  IntrusiveQueue(IntrusiveQueue&& other) noexcept
+      : head_(std::exchange(other.head_, nullptr)),
+        tail_(std::exchange(other.tail_, nullptr)) {}
+
+  IntrusiveQueue& operator=(IntrusiveQueue&& other) noexcept {
+    head_ = std::exchange(other.head_, nullptr);
+    tail_ = std::exchange(other.tail_, nullptr);
+    return *this;
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return head_ == nullptr; }
+
+  T& front() const noexcept { return *toValue(head_); }
+
+  T& back() const noexcept { return *toValue(tail_); }
+
+  void push(T& value) noexcept {
+    Node* node = &(value.*Member).node_;
+    node->next = nullptr;
+    if (tail_ == nullptr) {
+      head_ = node;
+    } else {
+      tail_->next = node;
+    }
+    tail_ = node;
+  }
+
+  // Unlinks and returns the front element.
+  T& pop() noexcept {
+    Node* node = std::exchange(head_, head_->next);
+    if (head_ == nullptr) {
+      tail_ = nullptr;
+    }
+    node->next = nullptr;
+    return *toValue(node);
+  }
+
+  // Moves every element of other to the back of this queue.
+  void append(IntrusiveQueue& other) noexcept {
+    if (other.empty()) {
+      return;
+    }
+    if (tail_ == nullptr) {
+      head_ = other.head_;
+    } else {
+      tail_->next = other.head_;
+    }
+    tail_ = other.tail_;
+    other.head_ = other.tail_ = nullptr;
+  }
+
+ private:
+  static T* toValue(Node* node) noexcept {
+    return detail::ownerOf<T, Member>(
+        reinterpret_cast<IntrusiveForwardHook*>(node));
+  }
+
+  Node* head_ = nullptr;
+  Node* tail_ = nullptr;
+};
+
+}  // namespace ecx::stl
@@ -0,0 +1,618 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "src/stl/Task.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Outcome of an asynchronous read or write, in io_uring's convention: the
+ * number of bytes transferred, or a negated errno.
+ */
+struct IoResult {
+  std::int32_t value;
+
+  bool ok() const noexcept { return value >= 0; }
+
+  std::size_t bytes() const noexcept { return static_cast<std::size_t>(value); }
+
+  int error() const noexcept { return ok() ? 0 : -value; }
+};
+
+namespace detail {
+
+struct IoOperation {
+  enum class Kind : std::uint8_t { kRead, kWrite };
+
+  Kind kind;
+  int fd;
+  void* buffer;
+  std::uint32_t length;
+  std::uint64_t offset;
+  // Index into the kernel-registered buffers, or -1.
+  int fixedIndex = -1;
+  std::coroutine_handle<> waiter{};
+  std::int32_t result = 0;
+};
+
+/**
+ * Minimal io_uring instance driven through the raw system calls, so that no
+ * liburing is needed.
+ * Submissions are only published to the kernel by submitAndWait(), so every
+ * operation prepared in between goes out in a single io_uring_enter.
+ */
+class IoUring {
+ public:
+  // Throws std::system_error if the kernel refuses to set up a ring, e.g.
+  // when io_uring is disabled or filtered by seccomp.
+  explicit IoUring(unsigned entries) {
+    io_uring_params params{};
+    ringFd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ringFd_ < 0) {
+      throw std::system_error(errno, std::system_category(),
+                              "io_uring_setup");
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+      sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+
+    try {
+      sqRing_ = map(sqRingSize_, IORING_OFF_SQ_RING);
+      cqRing_ = singleMmap ? sqRing_ : map(cqRingSize_, IORING_OFF_CQ_RING);
+      sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+      sqes_ = static_cast<io_uring_sqe*>(map(sqesSize_, IORING_OFF_SQES));
+    } catch (...) {
+      // The destructor does not run for a constructor that throws.
+      release();
+      throw;
+    }
+
+    auto* sq = static_cast<std::byte*>(sqRing_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqEntries_ = params.sq_entries;
+    localSqTail_ = *sqTail_;
+
+    auto* cq = static_cast<std::byte*>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  }
+
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+
+  ~IoUring() { release(); }
+
+  /**
+   * Queues op for the next submission; false if the submission queue is full.
+   */
+  bool tryPrepare(IoOperation& op) noexcept {
+    const unsigned head =
+        std::atomic_ref(*sqHead_).load(std::memory_order_acquire);
+    if (localSqTail_ - head == sqEntries_) {
+      return false;
+    }
+
+    const unsigned index = localSqTail_ & sqMask_;
+    io_uring_sqe& sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    const bool read = op.kind == IoOperation::Kind::kRead;
+    if (op.fixedIndex >= 0) {
+      sqe.opcode = read ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+      sqe.buf_index = static_cast<std::uint16_t>(op.fixedIndex);
+    } else {
+      sqe.opcode = read ? IORING_OP_READ : IORING_OP_WRITE;
+    }
+    sqe.fd = op.fd;
+    sqe.addr = reinterpret_cast<std::uint64_t>(op.buffer);
+    sqe.len = op.length;
+    sqe.off = op.offset;
+    sqe.user_data = reinterpret_cast<std::uint64_t>(&op);
+
+    sqArray_[index] = index;
+    ++localSqTail_;
+    return true;
+  }
+
+  /**
+   * Publishes every prepared operation, then blocks until at least
+   * minComplete completions are available.
+   */
+  void submitAndWait(unsigned minComplete) {
+    std::atomic_ref(*sqTail_).store(localSqTail_, std::memory_order_release);
+    const unsigned head =
+        std::atomic_ref(*sqHead_).load(std::memory_order_acquire);
+    const unsigned toSubmit = localSqTail_ - head;
+    const unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+
+    while (syscall(__NR_io_uring_enter, ringFd_, toSubmit, minComplete, flags,
+                   nullptr, 0) < 0) {
+      if (errno != EINTR) {
+        throw std::system_error(errno, std::system_category(),
+                                "io_uring_enter");
+      }
+    }
+  }
+
+  /**
+   * Calls onComplete(op, result) for every available completion, returning
+   * how many there were.
+   */
+  template <typename OnComplete>
+  unsigned reap(OnComplete&& onComplete) {
+    unsigned reaped = 0;
+    unsigned head = *cqHead_;
+    while (head != std::atomic_ref(*cqTail_).load(std::memory_order_acquire)) {
+      const io_uring_cqe cqe = cqes_[head & cqMask_];
+      std::atomic_ref(*cqHead_).store(++head, std::memory_order_release);
+      onComplete(*reinterpret_cast<IoOperation*>(cqe.user_data), cqe.res);
+      ++reaped;
+    }
+    return reaped;
+  }
+
+  /**
+   * Registers buffers for the fixed operations, replacing any registered
+   * before: the kernel refuses a second set (EBUSY) until the first is
+   * unregistered.
+   */
+  void registerBuffers(const iovec* buffers, unsigned count) {
+    if (buffersRegistered_) {
+      if (syscall(__NR_io_uring_register, ringFd_, IORING_UNREGISTER_BUFFERS,
+                  nullptr, 0) < 0) {
+        throw std::system_error(errno, std::system_category(),
+                                "io_uring_register");
+      }
+      buffersRegistered_ = false;
+    }
+    if (syscall(__NR_io_uring_register, ringFd_, IORING_REGISTER_BUFFERS,
+                buffers, count) < 0) {
+      throw std::system_error(errno, std::system_category(),
+                              "io_uring_register");
+    }
+    buffersRegistered_ = true;
+  }
+
+ private:
+  void* map(std::size_t size, off_t offset) {
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ringFd_, offset);
+    if (p == MAP_FAILED) {
+      throw std::system_error(errno, std::system_category(), "mmap");
+    }
+    return p;
+  }
+
+  // Unmaps whatever has been mapped so far, and closes the ring.
+  void release() noexcept {
+    if (sqes_) {
+      ::munmap(sqes_, sqesSize_);
+    }
+    if (cqRing_ && cqRing_ != sqRing_) {
+      ::munmap(cqRing_, cqRingSize_);
+    }
+    if (sqRing_) {
+      ::munmap(sqRing_, sqRingSize_);
+    }
+    ::close(ringFd_);
+  }
+
+  int ringFd_;
+  void* sqRing_ = nullptr;
+  void* cqRing_ = nullptr;
+  io_uring_sqe* sqes_ = nullptr;
+  std::size_t sqRingSize_ = 0;
+  std::size_t cqRingSize_ = 0;
+  std::size_t sqesSize_ = 0;
+  bool buffersRegistered_ = false;
+
+  unsigned* sqHead_;
+  unsigned* sqTail_;
+  unsigned* sqArray_;
+  unsigned sqMask_;
+  unsigned sqEntries_;
+  unsigned localSqTail_;
+
+  unsigned* cqHead_;
+  unsigned* cqTail_;
+  unsigned cqMask_;
+  io_uring_cqe* cqes_;
+};
+
+/**
+ * Fallback backend: blocking pread/pwrite on a pool of worker threads, with
+ * completions queued back to the loop thread.
+ */
+class BlockingIoPool {
+ public:
+  explicit BlockingIoPool(unsigned threads) {
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < std::max(threads, 1U); ++i) {
+      workers_.emplace_back([this](std::stop_token stop) { work(stop); });
+    }
+  }
+
+  // A stop request wakes the workers itself: see submitted_.
+  ~BlockingIoPool() {
+    for (auto& worker : workers_) {
+      worker.request_stop();
+    }
+  }
+
+  /**
+   * Hands every operation to the workers under a single lock acquisition.
+   */
+  void submit(Vector<IoOperation*>& ops) {
+    if (ops.empty()) {
+      return;
+    }
+    {
+      std::lock_guard lock(mutex_);
+      for (IoOperation* op : ops) {
+        queue_.push_back(op);
+      }
+    }
+    ops.clear();
+    submitted_.notify_all();
+  }
+
+  /**
+   * Blocks until at least one operation has completed, then calls
+   * onComplete(op, result) for each completed one, returning how many there
+   * were.
+   */
+  template <typename OnComplete>
+  unsigned waitAndReap(OnComplete&& onComplete) {
+    Vector<IoOperation*> done;
+    {
+      std::unique_lock lock(mutex_);
+      completedCv_.wait(lock, [this] { return !completed_.empty(); });
+      std::swap(done, completed_);
+    }
+    for (IoOperation* op : done) {
+      onComplete(*op, op->result);
+    }
+    return static_cast<unsigned>(done.size());
+  }
+
+ private:
+  void work(std::stop_token stop) {
+    while (true) {
+      IoOperation* op = nullptr;
+      {
+        std::unique_lock lock(mutex_);
+        // False once stop is requested and the queue is drained.
+        if (!submitted_.wait(lock, stop,
+                             [this] { return queueHead_ < queue_.size(); })) {
+          return;
+        }
+        op = queue_[queueHead_++];
+        if (queueHead_ == queue_.size()) {
+          queue_.clear();
+          queueHead_ = 0;
+        }
+      }
+
+      const auto offset = static_cast<off_t>(op->offset);
+      const ssize_t n = op->kind == IoOperation::Kind::kRead
+                            ? ::pread(op->fd, op->buffer, op->length, offset)
+                            : ::pwrite(op->fd, op->buffer, op->length, offset);
+      op->result = static_cast<std::int32_t>(n < 0 ? -errno : n);
+
+      {
+        std::lock_guard lock(mutex_);
+        completed_.push_back(op);
+      }
+      completedCv_.notify_one();
+    }
+  }
+
+  std::mutex mutex_;
+  // Waited on with the workers' stop tokens, so that a stop request cannot
+  // slip in between a worker checking for it and going to sleep.
+  std::condition_variable_any submitted_;
+  std::condition_variable completedCv_;
+  // Served in submission order, from queueHead_.
+  Vector<IoOperation*> queue_;
+  std::size_t queueHead_ = 0;
+  Vector<IoOperation*> completed_;
+  Vector<std::jthread> workers_;
+};
+
+}  // namespace detail
+
+/**
+ * Single-threaded event loop for asynchronous file I/O from Tasks.
+ *
+ * Backed by io_uring when the kernel allows it, and otherwise by a pool of
+ * threads doing blocking I/O; either way, coroutines are only ever resumed on
+ * the thread calling run().
+ *
+ * Operations issued while tasks run are batched, and submitted together each
+ * time the loop goes back to waiting for completions; with io_uring, that is
+ * one system call for the whole batch, so a single thread can keep a deep
+ * queue of reads in flight against an NVMe device.
+ *
+ * Buffers must stay alive and unmoved until their operation completes.
+ */
+class IoLoop {
+ public:
+  using SizeT = std::size_t;
+
+  struct Options {
+    // Submission queue depth of the io_uring.
+    unsigned entries = 256;
+    // Worker threads of the fallback backend.
+    unsigned fallbackThreads = 4;
+    // Skip io_uring, e.g. to test the fallback.
+    bool forceThreadPool = false;
+  };
+
+  class IoAwaiter {
+   public:
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> waiter) {
+      op_.waiter = waiter;
+      loop_.enqueue(op_);
+    }
+
+    IoResult await_resume() const noexcept { return IoResult{op_.result}; }
+
+   private:
+    friend class IoLoop;
+
+    IoAwaiter(IoLoop& loop, detail::IoOperation op) noexcept
+        : loop_(loop), op_(op) {}
+
+    IoLoop& loop_;
+    detail::IoOperation op_;
+  };
+
+  explicit IoLoop() : IoLoop(Options{}) {}
+
+  explicit IoLoop(Options options) {
+    if (!options.forceThreadPool) {
+      try {
+        ring_.emplace(options.entries);
+      } catch (const std::system_error&) {
+        // Fall through to the thread pool.
+      }
+    }
+    if (!ring_) {
+      pool_.emplace(options.fallbackThreads);
+    }
+  }
+
+  IoLoop(const IoLoop&) = delete;
+  IoLoop& operator=(const IoLoop&) = delete;
+
+  bool usesIoUring() const noexcept { return ring_.has_value(); }
+
+  /**
+   * Reads up to length bytes at offset into data.
+   */
+  IoAwaiter read(int fd, std::byte* data, SizeT length, std::uint64_t offset) {
+    return IoAwaiter(*this, {detail::IoOperation::Kind::kRead, fd, data,
+                             clampLength(length), offset});
+  }
+
+  /**
+   * Reads up to buffer.size() bytes at offset straight into buffer's storage.
+   */
+  IoAwaiter read(int fd, Vector<std::byte>& buffer, std::uint64_t offset) {
+    return read(fd, buffer.data(), buffer.size(), offset);
+  }
+
+  IoAwaiter write(int fd, const std::byte* data, SizeT length,
+                  std::uint64_t offset) {
+    return IoAwaiter(*this, {detail::IoOperation::Kind::kWrite, fd,
+                             const_cast<std::byte*>(data), clampLength(length),
+                             offset});
+  }
+
+  IoAwaiter write(int fd, const Vector<std::byte>& buffer,
+                  std::uint64_t offset) {
+    return write(fd, buffer.data(), buffer.size(), offset);
+  }
+
+  /**
+   * Registers buffers with the kernel, so that readFixed/writeFixed skip
+   * pinning and mapping the pages on every operation. The Vectors must not be
+   * resized or destroyed while registered (i.e. for the life of the loop).
+   * Calling it again replaces the set, and must not happen while a fixed
+   * operation is in flight.
+   *
+   * Returns false if the kernel refused (e.g. over RLIMIT_MEMLOCK) or the
+   * loop runs on the fallback backend; the fixed operations then degrade to
+   * plain reads and writes of the same buffers.
+   */
+  bool registerBuffers(Vector<Vector<std::byte>>& buffers) {
+    fixedBuffers_.clear();
+    fixedRegistered_ = false;
+    Vector<iovec> iovecs;
+    iovecs.reserve(buffers.size());
+    for (auto& buffer : buffers) {
+      fixedBuffers_.push_back(&buffer);
+      iovecs.push_back(iovec{buffer.data(), buffer.size()});
+    }
+
+    if (ring_) {
+      try {
+        ring_->registerBuffers(iovecs.data(),
+                               static_cast<unsigned>(iovecs.size()));
+        fixedRegistered_ = true;
+      } catch (const std::system_error&) {
+        // Degrade to plain operations.
+      }
+    }
+    return fixedRegistered_;
+  }
+
+  /**
+   * Fills registered buffer `index` from offset.
+   */
+  IoAwaiter readFixed(int fd, unsigned index, std::uint64_t offset) {
+    Vector<std::byte>& buffer = *fixedBuffers_[index];
+    return IoAwaiter(*this, {detail::IoOperation::Kind::kRead, fd,
+                             buffer.data(), clampLength(buffer.size()), offset,
+                             fixedRegistered_ ? static_cast<int>(index) : -1});
+  }
+
+  /**
+   * Writes the first length bytes of registered buffer `index` at offset.
+   */
+  IoAwaiter writeFixed(int fd, unsigned index, SizeT length,
+                       std::uint64_t offset) {
+    Vector<std::byte>& buffer = *fixedBuffers_[index];
+    return IoAwaiter(*this, {detail::IoOperation::Kind::kWrite, fd,
+                             buffer.data(), clampLength(length), offset,
+                             fixedRegistered_ ? static_cast<int>(index) : -1});
+  }
+
+  /**
+   * Runs task to completion on the calling thread, dispatching I/O
+   * completions as they arrive, and returns its result.
+   */
+  template <typename T>
+  T run(Task<T> task) {
+    task.start();
+    while (!task.done()) {
+      if (inFlight_ == 0) {
+        throw std::logic_error(
+            "IoLoop::run: task is suspended, but not on this loop's I/O");
+      }
+      pump();
+    }
+    return std::move(task).result();
+  }
+
+ private:
+  // Results are reported as int32, so single operations are capped at 1 GiB.
+  static std::uint32_t clampLength(SizeT length) noexcept {
+    return static_cast<std::uint32_t>(std::min<SizeT>(length, SizeT{1} << 30));
+  }
+
+  // Counts op as in flight only once it is prepared or held, so that an
+  // exception from here leaves run() able to tell that nothing is pending.
+  void enqueue(detail::IoOperation& op) {
+    if (ring_ && pending_.empty()) {
+      if (ring_->tryPrepare(op)) {
+        ++inFlight_;
+        return;
+      }
+      // Submission queue full: flush it without waiting, and retry.
+      ring_->submitAndWait(0);
+      if (ring_->tryPrepare(op)) {
+        ++inFlight_;
+        return;
+      }
+    }
+    // Held for pump(): by the fallback backend, or when the kernel left the
+    // submission queue full, and then behind earlier held operations too.
+    pending_.push_back(&op);
+    ++inFlight_;
+  }
+
+  // Moves held operations into the submission queue, in order, while there
+  // is room.
+  void prepareHeld() {
+    SizeT prepared = 0;
+    while (prepared < pending_.size() &&
+           ring_->tryPrepare(*pending_[prepared])) {
+      ++prepared;
+    }
+    std::copy(pending_.begin() + prepared, pending_.end(), pending_.begin());
+    pending_.resize(pending_.size() - prepared);
+  }
+
+  void pump() {
+    auto complete = [this](detail::IoOperation& op, std::int32_t result) {
+      --inFlight_;
+      op.result = result;
+      op.waiter.resume();
+    };
+
+    if (ring_) {
+      prepareHeld();
+      ring_->submitAndWait(1);
+      ring_->reap(complete);
+    } else {
+      pool_->submit(pending_);
+      pool_->waitAndReap(complete);
+    }
+  }
+
+  std::optional<detail::IoUring> ring_;
+  std::optional<detail::BlockingIoPool> pool_;
+  Vector<detail::IoOperation*> pending_;
+  SizeT inFlight_ = 0;
+
+  Vector<Vector<std::byte>*> fixedBuffers_;
+  bool fixedRegistered_ = false;
+};
+
+/**
+ * Reads the whole of fd (a regular file) into a Vector, issuing reads of at
+ * most chunkSize bytes.
+ * Throws std::system_error on failure.
+ */
+inline Task<Vector<std::byte>> readFile(IoLoop& loop, int fd,
+                                        std::size_t chunkSize = 1 << 20) {
+  struct stat st {};
+  if (::fstat(fd, &st) < 0) {
+    throw std::system_error(errno, std::system_category(), "fstat");
+  }
+
+  // Left uninitialised: the reads overwrite every byte.
+  Vector<std::byte> contents;
+  contents.resizeForOverwrite(static_cast<std::size_t>(st.st_size));
+  std::size_t done = 0;
+  while (done < contents.size()) {
+    const std::size_t length = std::min(chunkSize, contents.size() - done);
+    IoResult result = co_await loop.read(fd, contents.data() + done, length,
+                                         done);
+    if (!result.ok()) {
+      throw std::system_error(result.error(), std::system_category(), "read");
+    }
+    if (result.bytes() == 0) {
+      // Truncated since fstat.
+      contents.resize(done);
+      break;
+    }
+    done += result.bytes();
+  }
+  co_return contents;
+}
+
+}  // namespace ecx::stl
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <ranges>
+#include <utility>
+
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Rows of varying length stored contiguously, in compressed sparse row form:
+ * every element in one Vector, row after row, and rows() + 1 offsets, row r
+ * spanning [offsets[r], offsets[r + 1]). In place of Vector<Vector<T>> for
+ * adjacency or posting lists, it takes two allocations instead of one per
+ * row, a word per row instead of three, and a scan over all rows reads
+ * memory sequentially.
+ *
+ * Rows are appended at the end, or built all at once by a Builder in two
+ * passes (count, then fill), which threads can share. Rows can change their
+ * elements but not their lengths.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class JaggedArray {
+  using OffsetAllocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<std::size_t>;
+
+ public:
+  using SizeT = std::size_t;
+  using ValueT = T;
+  using AllocatorT = Allocator;
+  using RowT = Span<T>;
+  using ConstRowT = Span<const T>;
+
+  class Builder;
+
+  explicit JaggedArray(const Allocator& alloc = Allocator())
+      : values_(alloc), offsets_(OffsetAllocator(alloc)) {}
+
+  SizeT rows() const noexcept {
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
+  }
+
+  // The total number of elements, over all rows.
+  SizeT size() const noexcept { return values_.size(); }
+
+  [[nodiscard]] bool empty() const noexcept { return rows() == 0; }
+
+  RowT operator[](SizeT row) noexcept {
+    return RowT(values_.data() + offsets_[row], rowSize(row));
+  }
+
+  ConstRowT operator[](SizeT row) const noexcept {
+    return ConstRowT(values_.data() + offsets_[row], rowSize(row));
+  }
+
+  SizeT rowSize(SizeT row) const noexcept {
+    return offsets_[row + 1] - offsets_[row];
+  }
+
+  // Every element, row after row.
+  RowT values() noexcept { return RowT(values_); }
+
+  ConstRowT values() const noexcept { return ConstRowT(values_); }
+
+  // rows() + 1 entries, or none while there are no rows.
+  Span<const SizeT> offsets() const noexcept {
+    return Span<const SizeT>(offsets_);
+  }
+
+  void reserve(SizeT rows, SizeT values) {
+    offsets_.reserve(rows + 1);
+    values_.reserve(values);
+  }
+
+  /**
+   * Appends an empty row, for pushBack() to fill.
+   */
+  void appendRow() {
+    if (offsets_.empty()) {
+      offsets_.push_back(0);
+    }
+    offsets_.push_back(values_.size());
+  }
+
+  template <std::ranges::input_range R>
+  void appendRow(R&& row) {
+    appendRow();
+    for (auto&& value : row) {
+      pushBack(std::forward<decltype(value)>(value));
+    }
+  }
+
+  void appendRow(std::initializer_list<T> row) {
+    appendRow<std::initializer_list<T>>(std::move(row));
+  }
+
+  /**
+   * Appends value to the last row, which must exist.
+   */
+  void pushBack(const T& value) {
+    values_.push_back(value);
+    ++offsets_[offsets_.size() - 1];
+  }
+
+  void pushBack(T&& value) {
+    values_.push_back(std::move(value));
+    ++offsets_[offsets_.size() - 1];
+  }
+
+  void clear() noexcept {
+    values_.clear();
+    offsets_.clear();
+  }
+
+ private:
+  Vector<T, Allocator> values_;
+  Vector<SizeT, OffsetAllocator> offsets_;
+};
+
+/**
+ * Builds a JaggedArray with a known number of rows in two passes over the
+ * input, without reallocating:
+ *
+ *   JaggedArray<std::uint32_t>::Builder builder(nodes);
+ *   for (auto [from, to] : edges) builder.count(from);
+ *   builder.allocate();
+ *   for (auto [from, to] : edges) builder.fill(from, to);
+ *   JaggedArray<std::uint32_t> adjacency = std::move(builder).build();
+ *
+ * To share the passes between threads, each taking a part of the input,
+ * call countConcurrent() and fillConcurrent() instead: they update the
+ * per-row counters with relaxed atomic adds, as the row each call touches
+ * is all that it needs, but an atomic add costs several times a plain one
+ * even uncontended. Within a row, elements filled from different threads
+ * land in no particular order. Every counted element must be filled before
+ * build().
+ *
+ * T must be default-constructible: allocate() value-initialises the
+ * elements, which fill() then assigns.
+ */
+template <typename T, typename Allocator>
+class JaggedArray<T, Allocator>::Builder {
+ public:
+  explicit Builder(SizeT rows, const Allocator& alloc = Allocator())
+      : array_(alloc), cursors_(OffsetAllocator(alloc)) {
+    array_.offsets_.resize(rows + 1);
+  }
+
+  void count(SizeT row, SizeT n = 1) noexcept {
+    array_.offsets_[row + 1] += n;
+  }
+
+  void countConcurrent(SizeT row, SizeT n = 1) noexcept {
+    std::atomic_ref(array_.offsets_[row + 1])
+        .fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /**
+   * Turns the counts into offsets and allocates the elements. Must follow
+   * every count() and precede every fill().
+   */
+  void allocate() {
+    auto& offsets = array_.offsets_;
+    for (SizeT r = 1; r < offsets.size(); ++r) {
+      offsets[r] += offsets[r - 1];
+    }
+    array_.values_.resize(offsets[offsets.size() - 1]);
+    cursors_.reserve(offsets.size() - 1);
+    for (SizeT r = 0; r + 1 < offsets.size(); ++r) {
+      cursors_.push_back(offsets[r]);
+    }
+  }
+
+  void fill(SizeT row, const T& value) {
+    array_.values_[cursors_[row]++] = value;
+  }
+
+  void fill(SizeT row, T&& value) {
+    array_.values_[cursors_[row]++] = std::move(value);
+  }
+
+  void fillConcurrent(SizeT row, const T& value) {
+    array_.values_[claim(row)] = value;
+  }
+
+  void fillConcurrent(SizeT row, T&& value) {
+    array_.values_[claim(row)] = std::move(value);
+  }
+
+  JaggedArray build() && { return std::move(array_); }
+
+ private:
+  SizeT claim(SizeT row) noexcept {
+    return std::atomic_ref(cursors_[row]).fetch_add(
+        1, std::memory_order_relaxed);
+  }
+
+  JaggedArray array_;
+  // The next free position in each row.
+  Vector<SizeT, OffsetAllocator> cursors_;
+};
+
+}  // namespace ecx::stl
@@ -0,0 +1,411 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <thread>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "src/stl/AlignedAllocator.hpp"
+#include "src/stl/MdSpan.hpp"
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Dense row-major matrix in a single allocation.
+ *
+ * Rows are padded so that each starts on a cache line: the leading dimension
+ * (the distance between rows, in elements) is the column count rounded up to
+ * a whole number of cache lines. Rows then never share a line, which keeps
+ * aligned SIMD loads valid and lets threads write disjoint rows without false
+ * sharing. The padding is zero and not part of the matrix.
+ */
+template <typename T>
+class Matrix {
+  static_assert(std::is_arithmetic_v<T>, "Matrix<T> requires an arithmetic T");
+
+ public:
+  using SizeT = std::size_t;
+  using ValueT = T;
+  using StorageT = Vector<T, AlignedAllocator<T>>;
+  using ViewT = MdSpan<T, DExtents<2>, LayoutStride>;
+  using ConstViewT = MdSpan<const T, DExtents<2>, LayoutStride>;
+
+  static constexpr SizeT kRowAlignment = 64;
+
+  explicit Matrix() : Matrix(0, 0) {}
+
+  /**
+   * A rows x cols matrix of zeroes.
+   */
+  explicit Matrix(SizeT rows, SizeT cols)
+      : rows_(rows),
+        cols_(cols),
+        ld_(paddedWidth(cols)),
+        data_(rows * paddedWidth(cols)) {}
+
+  explicit Matrix(SizeT rows, SizeT cols, T value) : Matrix(rows, cols) {
+    for (SizeT r = 0; r < rows_; ++r) {
+      std::fill_n(rowData(r), cols_, value);
+    }
+  }
+
+  /**
+   * From a list of rows, all of the same length:
+   *   Matrix<float> m{{1, 2, 3}, {4, 5, 6}};
+   */
+  Matrix(std::initializer_list<std::initializer_list<T>> rows)
+      : Matrix(rows.size(), rows.size() == 0 ? 0 : rows.begin()->size()) {
+    SizeT r = 0;
+    for (const auto& row : rows) {
+      assert(row.size() == cols_);
+      std::copy(row.begin(), row.end(), rowData(r++));
+    }
+  }
+
+  SizeT rows() const noexcept { return rows_; }
+
+  SizeT cols() const noexcept { return cols_; }
+
+  // The distance between consecutive rows, in elements.
+  SizeT leadingDimension() const noexcept { return ld_; }
+
+  T* data() noexcept { return data_.data(); }
+
+  const T* data() const noexcept { return data_.data(); }
+
+  T& operator[](SizeT r, SizeT c) noexcept { return data_[r * ld_ + c]; }
+
+  const T& operator[](SizeT r, SizeT c) const noexcept {
+    return data_[r * ld_ + c];
+  }
+
+  Span<T> row(SizeT r) noexcept { return Span<T>(rowData(r), cols_); }
+
+  Span<const T> row(SizeT r) const noexcept {
+    return Span<const T>(rowData(r), cols_);
+  }
+
+  ViewT view() noexcept {
+    return ViewT(data(), typename ViewT::MappingT(DExtents<2>(rows_, cols_),
+                                                  {ld_, 1}));
+  }
+
+  ConstViewT view() const noexcept {
+    return ConstViewT(data(), typename ConstViewT::MappingT(
+                                  DExtents<2>(rows_, cols_), {ld_, 1}));
+  }
+
+  friend bool operator==(const Matrix& lhs, const Matrix& rhs) noexcept {
+    if (lhs.rows_ != rhs.rows_ || lhs.cols_ != rhs.cols_) {
+      return false;
+    }
+    for (SizeT r = 0; r < lhs.rows_; ++r) {
+      if (!std::equal(lhs.rowData(r), lhs.rowData(r) + lhs.cols_,
+                      rhs.rowData(r))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  static constexpr SizeT paddedWidth(SizeT cols) noexcept {
+    constexpr SizeT kPerLine =
+        kRowAlignment % sizeof(T) == 0 ? kRowAlignment / sizeof(T) : 1;
+    return (cols + kPerLine - 1) / kPerLine * kPerLine;
+  }
+
+  T* rowData(SizeT r) noexcept { return data_.data() + r * ld_; }
+
+  const T* rowData(SizeT r) const noexcept { return data_.data() + r * ld_; }
+
+  SizeT rows_;
+  SizeT cols_;
+  SizeT ld_;
+  StorageT data_;
+};
+
+namespace detail::gemm {
+
+using SizeT = std::size_t;
+
+// Register tile of C computed by the micro-kernel: kMr x kNr, i.e. 6 x 16
+// floats in twelve AVX registers.
+inline constexpr SizeT kMr = 6;
+inline constexpr SizeT kNr = 16;
+// Cache blocks: a kKc x kNr sliver of B stays in L1, a kMc x kKc block of A
+// in L2, and a kKc x kNc panel of B in L3.
+inline constexpr SizeT kMc = 96;
+inline constexpr SizeT kKc = 256;
+inline constexpr SizeT kNc = 2048;
+
+template <typename T>
+using KernelFn = void (*)(SizeT kc, const T* a, const T* b, T* c, SizeT ldc);
+
+/**
+ * C[kMr x kNr] += A-sliver * B-sliver, over kc packed steps: a holds kMr
+ * elements per step, and b holds kNr. Portable; the accumulators are small
+ * enough for the compiler to keep them in (vector) registers.
+ */
+template <typename T>
+void microKernel(SizeT kc, const T* a, const T* b, T* c, SizeT ldc) {
+  T acc[kMr][kNr] = {};
+  for (SizeT p = 0; p < kc; ++p, a += kMr, b += kNr) {
+    for (SizeT i = 0; i < kMr; ++i) {
+      for (SizeT j = 0; j < kNr; ++j) {
+        acc[i][j] += a[i] * b[j];
+      }
+    }
+  }
+  for (SizeT i = 0; i < kMr; ++i) {
+    for (SizeT j = 0; j < kNr; ++j) {
+      c[i * ldc + j] += acc[i][j];
+    }
+  }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * microKernel<float> with AVX2 and FMA: each step broadcasts one element of
+ * A per row against two 8-wide vectors of B. Compiled for AVX2 whatever the
+ * build flags, and only selected if the CPU supports it.
+ */
+__attribute__((target("avx2,fma"))) inline void microKernelAvx2(
+    SizeT kc, const float* a, const float* b, float* c, SizeT ldc) {
+  __m256 acc[kMr][2];
+#pragma GCC unroll 6
+  for (SizeT i = 0; i < kMr; ++i) {
+    acc[i][0] = _mm256_setzero_ps();
+    acc[i][1] = _mm256_setzero_ps();
+  }
+
+  for (SizeT p = 0; p < kc; ++p, a += kMr, b += kNr) {
+    const __m256 b0 = _mm256_load_ps(b);
+    const __m256 b1 = _mm256_load_ps(b + 8);
+#pragma GCC unroll 6
+    for (SizeT i = 0; i < kMr; ++i) {
+      const __m256 ai = _mm256_broadcast_ss(a + i);
+      acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+      acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+    }
+  }
+
+#pragma GCC unroll 6
+  for (SizeT i = 0; i < kMr; ++i) {
+    float* row = c + i * ldc;
+    _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), acc[i][0]));
+    _mm256_storeu_ps(row + 8,
+                     _mm256_add_ps(_mm256_loadu_ps(row + 8), acc[i][1]));
+  }
+}
+
+inline bool hasAvx2Fma() noexcept {
+  static const bool has =
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  return has;
+}
+#endif
+
+template <typename T>
+KernelFn<T> selectKernel() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  if constexpr (std::is_same_v<T, float>) {
+    if (hasAvx2Fma()) {
+      return &microKernelAvx2;
+    }
+  }
+#endif
+  return &microKernel<T>;
+}
+
+/**
+ * Copies the mc x kc block of A at (ic, pc) into kMr-row slivers, each laid
+ * out step by step (column-major within the sliver), so the micro-kernel
+ * reads it sequentially. The last sliver is padded with zeroes.
+ */
+template <typename T>
+void packA(const Matrix<T>& a, SizeT ic, SizeT pc, SizeT mc, SizeT kc,
+           T* out) {
+  const T* base = a.data();
+  const SizeT lda = a.leadingDimension();
+  for (SizeT i0 = 0; i0 < mc; i0 += kMr) {
+    for (SizeT p = 0; p < kc; ++p) {
+      for (SizeT i = 0; i < kMr; ++i) {
+        *out++ = i0 + i < mc ? base[(ic + i0 + i) * lda + pc + p] : T{};
+      }
+    }
+  }
+}
+
+/**
+ * Copies the kc x nc panel of B at (pc, jc) into kNr-column slivers, row by
+ * row. The last sliver is padded with zeroes.
+ */
+template <typename T>
+void packB(const Matrix<T>& b, SizeT pc, SizeT jc, SizeT kc, SizeT nc,
+           T* out) {
+  const T* base = b.data();
+  const SizeT ldb = b.leadingDimension();
+  for (SizeT j0 = 0; j0 < nc; j0 += kNr) {
+    const SizeT width = std::min(kNr, nc - j0);
+    for (SizeT p = 0; p < kc; ++p) {
+      const T* row = base + (pc + p) * ldb + jc + j0;
+      std::copy_n(row, width, out);
+      std::fill(out + width, out + kNr, T{});
+      out += kNr;
+    }
+  }
+}
+
+constexpr SizeT roundUp(SizeT n, SizeT multiple) noexcept {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * C[rowBegin, rowEnd) += A[rowBegin, rowEnd) * B, the loop nest of the
+ * BLIS/Goto algorithm: panels of B, then blocks of A, then register tiles.
+ */
+template <typename T>
+void multiplyRows(const Matrix<T>& a, const Matrix<T>& b, Matrix<T>& c,
+                  SizeT rowBegin, SizeT rowEnd) {
+  const SizeT n = b.cols();
+  const SizeT k = a.cols();
+  const SizeT ldc = c.leadingDimension();
+  const KernelFn<T> kernel = selectKernel<T>();
+
+  Vector<T, AlignedAllocator<T>> packedA(
+      roundUp(std::min(kMc, rowEnd - rowBegin), kMr) * std::min(kKc, k));
+  Vector<T, AlignedAllocator<T>> packedB(roundUp(std::min(kNc, n), kNr) *
+                                         std::min(kKc, k));
+  alignas(64) T edge[kMr * kNr];
+
+  for (SizeT jc = 0; jc < n; jc += kNc) {
+    const SizeT nc = std::min(kNc, n - jc);
+    for (SizeT pc = 0; pc < k; pc += kKc) {
+      const SizeT kc = std::min(kKc, k - pc);
+      packB(b, pc, jc, kc, nc, packedB.data());
+
+      for (SizeT ic = rowBegin; ic < rowEnd; ic += kMc) {
+        const SizeT mc = std::min(kMc, rowEnd - ic);
+        packA(a, ic, pc, mc, kc, packedA.data());
+
+        for (SizeT jr = 0; jr < nc; jr += kNr) {
+          const SizeT width = std::min(kNr, nc - jr);
+          for (SizeT ir = 0; ir < mc; ir += kMr) {
+            const SizeT height = std::min(kMr, mc - ir);
+            const T* aSliver = packedA.data() + ir * kc;
+            const T* bSliver = packedB.data() + jr * kc;
+            T* cTile = c.data() + (ic + ir) * ldc + jc + jr;
+
+            if (height == kMr && width == kNr) {
+              kernel(kc, aSliver, bSliver, cTile, ldc);
+              continue;
+            }
+            // Partial tile at the bottom or right edge.
+            std::fill(std::begin(edge), std::end(edge), T{});
+            kernel(kc, aSliver, bSliver, edge, kNr);
+            for (SizeT i = 0; i < height; ++i) {
+              for (SizeT j = 0; j < width; ++j) {
+                cTile[i * ldc + j] += edge[i * kNr + j];
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace detail::gemm
+
+struct GemmOptions {
+  // Worker threads, each computing a band of rows of the result.
+  unsigned threads = 1;
+};
+
+/**
+ * C += A * B, cache-blocked, with operands packed for a register-blocked
+ * micro-kernel (AVX2/FMA for float where the CPU has it).
+ *
+ * With options.threads > 1, the rows of C are split into bands computed
+ * concurrently; each thread packs its own copy of B, which is cheap next to
+ * the multiplication once each band has a few dozen rows.
+ *
+ * Requires a.cols() == b.rows(), and c to be a.rows() x b.cols().
+ */
+template <typename T>
+void multiplyAdd(const Matrix<T>& a, const Matrix<T>& b, Matrix<T>& c,
+                 GemmOptions options = {}) {
+  using detail::gemm::kMr;
+  using SizeT = std::size_t;
+
+  assert(a.cols() == b.rows());
+  assert(c.rows() == a.rows() && c.cols() == b.cols());
+  const SizeT m = a.rows();
+  if (m == 0 || b.cols() == 0 || a.cols() == 0) {
+    return;
+  }
+
+  const SizeT tiles = (m + kMr - 1) / kMr;
+  const auto threads = static_cast<SizeT>(
+      std::clamp<SizeT>(options.threads, 1, tiles));
+  if (threads == 1) {
+    detail::gemm::multiplyRows(a, b, c, 0, m);
+    return;
+  }
+
+  const SizeT band = (tiles + threads - 1) / threads * kMr;
+  Vector<std::jthread> workers;
+  workers.reserve(threads);
+  for (SizeT rowBegin = 0; rowBegin < m; rowBegin += band) {
+    const SizeT rowEnd = std::min(m, rowBegin + band);
+    workers.emplace_back([&a, &b, &c, rowBegin, rowEnd] {
+      detail::gemm::multiplyRows(a, b, c, rowBegin, rowEnd);
+    });
+  }
+}
+
+/**
+ * A * B, see multiplyAdd.
+ */
+template <typename T>
+Matrix<T> multiply(const Matrix<T>& a, const Matrix<T>& b,
+                   GemmOptions options = {}) {
+  Matrix<T> c(a.rows(), b.cols());
+  multiplyAdd(a, b, c, options);
+  return c;
+}
+
+/**
+ * The transpose of a, copied tile by tile, so that both the reads and the
+ * strided writes of a tile stay within a few cache lines.
+ */
+template <typename T>
+Matrix<T> transpose(const Matrix<T>& a) {
+  using SizeT = std::size_t;
+  constexpr SizeT kTile = 32;
+
+  Matrix<T> t(a.cols(), a.rows());
+  for (SizeT r0 = 0; r0 < a.rows(); r0 += kTile) {
+    const SizeT r1 = std::min(a.rows(), r0 + kTile);
+    for (SizeT c0 = 0; c0 < a.cols(); c0 += kTile) {
+      const SizeT c1 = std::min(a.cols(), c0 + kTile);
+      for (SizeT r = r0; r < r1; ++r) {
+        for (SizeT c = c0; c < c1; ++c) {
+          t[c, r] = a[r, c];
+        }
+      }
+    }
+  }
+  return t;
+}
+
+}  // namespace ecx::stl
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * The shape of a multi-dimensional array: one extent per dimension, each
+ * either fixed at compile time or kDynamicExtent. Only the dynamic extents
+ * are stored, so a fully static shape takes no space at all.
+ */
+template <std::size_t... Exts>
+class Extents {
+ public:
+  using SizeT = std::size_t;
+
+  static constexpr SizeT kRank = sizeof...(Exts);
+  static constexpr SizeT kRankDynamic =
+      ((Exts == kDynamicExtent ? 1 : 0) + ... + 0);
+
+  constexpr Extents() noexcept = default;
+
+  /**
+   * From either the dynamic extents alone, or every extent (of which the
+   * static ones must match).
+   */
+  template <std::convertible_to<SizeT>... Sizes>
+    requires(sizeof...(Sizes) == kRankDynamic)
+  constexpr explicit Extents(Sizes... sizes) noexcept
+      : dynamic_{static_cast<SizeT>(sizes)...} {}
+
+  template <std::convertible_to<SizeT>... Sizes>
+    requires(sizeof...(Sizes) == kRank && kRank != kRankDynamic)
+  constexpr explicit Extents(Sizes... sizes) noexcept {
+    if constexpr (kRankDynamic > 0) {
+      const std::array<SizeT, kRank> all{static_cast<SizeT>(sizes)...};
+      for (SizeT r = 0; r < kRank; ++r) {
+        if (kStatic[r] == kDynamicExtent) {
+          dynamic_[kDynamicIndex[r]] = all[r];
+        }
+      }
+    }
+  }
+
+  static constexpr SizeT rank() noexcept { return kRank; }
+
+  static constexpr SizeT rankDynamic() noexcept { return kRankDynamic; }
+
+  static constexpr SizeT staticExtent(SizeT r) noexcept { return kStatic[r]; }
+
+  constexpr SizeT extent(SizeT r) const noexcept {
+    if constexpr (kRankDynamic == 0) {
+      return kStatic[r];
+    } else {
+      return kStatic[r] == kDynamicExtent ? dynamic_[kDynamicIndex[r]]
+                                          : kStatic[r];
+    }
+  }
+
+  // The number of elements, the product of the extents.
+  constexpr SizeT size() const noexcept {
+    SizeT n = 1;
+    for (SizeT r = 0; r < kRank; ++r) {
+      n *= extent(r);
+    }
+    return n;
+  }
+
+  friend constexpr bool operator==(const Extents& lhs,
+                                   const Extents& rhs) noexcept {
+    return lhs.dynamic_ == rhs.dynamic_;
+  }
+
+ private:
+  static constexpr std::array<SizeT, kRank> kStatic{Exts...};
+
+  // For each dynamic dimension, its position among the dynamic extents.
+  static constexpr std::array<SizeT, kRank> kDynamicIndex = [] {
+    std::array<SizeT, kRank> index{};
+    SizeT next = 0;
+    for (SizeT r = 0; r < kRank; ++r) {
+      index[r] = kStatic[r] == kDynamicExtent ? next++ : 0;
+    }
+    return index;
+  }();
+
+  // Not std::array<SizeT, 0>, which is not an empty class.
+  struct NoDynamicExtents {
+    constexpr bool operator==(const NoDynamicExtents&) const = default;
+  };
+
+  [[no_unique_address]] std::conditional_t<
+      kRankDynamic == 0, NoDynamicExtents, std::array<SizeT, kRankDynamic>>
+      dynamic_{};
+};
+
+namespace detail {
+
+template <std::size_t Rank, typename = std::make_index_sequence<Rank>>
+struct DynamicExtents;
+
+template <std::size_t Rank, std::size_t... Is>
+struct DynamicExtents<Rank, std::index_sequence<Is...>> {
+  using Type = Extents<((void)Is, kDynamicExtent)...>;
+};
+
+}  // namespace detail
+
+// Extents with every dimension dynamic.
+template <std::size_t Rank>
+using DExtents = typename detail::DynamicExtents<Rank>::Type;
+
+/**
+ * Layout policies, mapping a multi-dimensional index to an offset into the
+ * underlying storage. Each provides a Mapping<ExtentsT> with
+ *   SizeT operator()(indices...): the offset of an element,
+ *   SizeT stride(r): the distance between neighbours along dimension r,
+ *   SizeT requiredSpanSize(): the number of elements the storage must hold.
+ *
+ * With static extents, the offset computation folds into constants, so loops
+ * over an MdSpan optimise like loops over a plain array.
+ */
+
+// Row-major, as C arrays: the last index is contiguous.
+struct LayoutRight {
+  template <typename ExtentsT>
+  class Mapping {
+   public:
+    using SizeT = std::size_t;
+
+    constexpr Mapping() noexcept = default;
+
+    constexpr explicit Mapping(const ExtentsT& extents) noexcept
+        : extents_(extents) {}
+
+    constexpr const ExtentsT& extents() const noexcept { return extents_; }
+
+    template <typename... Indices>
+    constexpr SizeT operator()(Indices... indices) const noexcept {
+      SizeT offset = 0;
+      SizeT r = 0;
+      ((offset = offset * extents_.extent(r++) + static_cast<SizeT>(indices)),
+       ...);
+      return offset;
+    }
+
+    constexpr SizeT stride(SizeT r) const noexcept {
+      SizeT stride = 1;
+      for (SizeT i = r + 1; i < ExtentsT::rank(); ++i) {
+        stride *= extents_.extent(i);
+      }
+      return stride;
+    }
+
+    constexpr SizeT requiredSpanSize() const noexcept {
+      return extents_.size();
+    }
+
+   private:
+    [[no_unique_address]] ExtentsT extents_;
+  };
+};
+
+// Column-major, as Fortran and BLAS: the first index is contiguous.
+struct LayoutLeft {
+  template <typename ExtentsT>
+  class Mapping {
+   public:
+    using SizeT = std::size_t;
+
+    constexpr Mapping() noexcept = default;
+
+    constexpr explicit Mapping(const ExtentsT& extents) noexcept
+        : extents_(extents) {}
+
+    constexpr const ExtentsT& extents() const noexcept { return extents_; }
+
+    template <typename... Indices>
+    constexpr SizeT operator()(Indices... indices) const noexcept {
+      SizeT offset = 0;
+      SizeT stride = 1;
+      SizeT r = 0;
+      ((offset += static_cast<SizeT>(indices) * stride,
+        stride *= extents_.extent(r++)),
+       ...);
+      return offset;
+    }
+
+    constexpr SizeT stride(SizeT r) const noexcept {
+      SizeT stride = 1;
+      for (SizeT i = 0; i < r; ++i) {
+        stride *= extents_.extent(i);
+      }
+      return stride;
+    }
+
+    constexpr SizeT requiredSpanSize() const noexcept {
+      return extents_.size();
+    }
+
+   private:
+    [[no_unique_address]] ExtentsT extents_;
+  };
+};
+
+// Arbitrary strides per dimension, e.g. a column or a transposed or
+// sub-sampled view of another layout.
+struct LayoutStride {
+  template <typename ExtentsT>
+  class Mapping {
+   public:
+    using SizeT = std::size_t;
+    using StridesT = std::array<SizeT, ExtentsT::rank()>;
+
+    constexpr Mapping() noexcept = default;
+
+    constexpr Mapping(const ExtentsT& extents, const StridesT& strides) noexcept
+        : extents_(extents), strides_(strides) {}
+
+    constexpr const ExtentsT& extents() const noexcept { return extents_; }
+
+    template <typename... Indices>
+    constexpr SizeT operator()(Indices... indices) const noexcept {
+      SizeT offset = 0;
+      SizeT r = 0;
+      ((offset += static_cast<SizeT>(indices) * strides_[r++]), ...);
+      return offset;
+    }
+
+    constexpr SizeT stride(SizeT r) const noexcept { return strides_[r]; }
+
+    constexpr const StridesT& strides() const noexcept { return strides_; }
+
+    constexpr SizeT requiredSpanSize() const noexcept {
+      SizeT last = 0;
+      for (SizeT r = 0; r < ExtentsT::rank(); ++r) {
+        if (extents_.extent(r) == 0) {
+          return 0;
+        }
+        last += (extents_.extent(r) - 1) * strides_[r];
+      }
+      return last + 1;
+    }
+
+   private:
+    [[no_unique_address]] ExtentsT extents_;
+    StridesT strides_{};
+  };
+};
+
+/**
+ * Non-owning multi-dimensional view, modelled on std::mdspan: a pointer, a
+ * shape (ExtentsT) and a Layout mapping indices into the storage.
+ *
+ *   Vector<float> storage(rows * cols);
+ *   MdSpan grid(storage, rows, cols);      // MdSpan<float, DExtents<2>>
+ *   grid[i, j] = 1.0f;
+ *
+ *   MdSpan<const float, Extents<4, 4>> tile(data);  // A single pointer.
+ *
+ * Like Span, the storage must outlive the view.
+ */
+template <typename T, typename ExtentsT, typename Layout = LayoutRight>
+class MdSpan {
+ public:
+  using SizeT = std::size_t;
+  using ElementT = T;
+  using ValueT = std::remove_cv_t<T>;
+  using PointerT = T*;
+  using ReferenceT = T&;
+  using ExtentsType = ExtentsT;
+  using LayoutT = Layout;
+  using MappingT = typename Layout::template Mapping<ExtentsT>;
+
+  constexpr MdSpan() noexcept = default;
+
+  constexpr MdSpan(PointerT data, const MappingT& mapping) noexcept
+      : data_(data), mapping_(mapping) {}
+
+  constexpr MdSpan(PointerT data, const ExtentsT& extents) noexcept
+    requires std::constructible_from<MappingT, const ExtentsT&>
+      : MdSpan(data, MappingT(extents)) {}
+
+  /**
+   * From the dynamic extents alone, or every extent.
+   */
+  template <std::convertible_to<SizeT>... Sizes>
+    requires std::constructible_from<ExtentsT, Sizes...> &&
+             std::constructible_from<MappingT, const ExtentsT&>
+  constexpr explicit MdSpan(PointerT data, Sizes... sizes) noexcept
+      : MdSpan(data, ExtentsT(sizes...)) {}
+
+  /**
+   * Views the storage of a Vector (or anything Span can view), which must
+   * hold at least mapping().requiredSpanSize() elements.
+   */
+  template <std::convertible_to<SizeT>... Sizes>
+    requires std::constructible_from<ExtentsT, Sizes...> &&
+             std::constructible_from<MappingT, const ExtentsT&>
+  constexpr explicit MdSpan(Span<T> storage, Sizes... sizes) noexcept
+      : MdSpan(storage.data(), ExtentsT(sizes...)) {}
+
+  template <typename U, typename Allocator,
+            std::convertible_to<SizeT>... Sizes>
+    requires detail::SpanConvertible<U, T> &&
+             std::constructible_from<ExtentsT, Sizes...> &&
+             std::constructible_from<MappingT, const ExtentsT&>
+  constexpr explicit MdSpan(Vector<U, Allocator>& storage,
+                            Sizes... sizes) noexcept
+      : MdSpan(storage.data(), ExtentsT(sizes...)) {}
+
+  template <typename U, typename Allocator,
+            std::convertible_to<SizeT>... Sizes>
+    requires detail::SpanConvertible<const U, T> &&
+             std::constructible_from<ExtentsT, Sizes...> &&
+             std::constructible_from<MappingT, const ExtentsT&>
+  constexpr explicit MdSpan(const Vector<U, Allocator>& storage,
+                            Sizes... sizes) noexcept
+      : MdSpan(storage.data(), ExtentsT(sizes...)) {}
+
+  // Adding const to the elements.
+  template <typename U>
+    requires detail::SpanConvertible<U, T> && (!std::same_as<U, T>)
+  constexpr MdSpan(const MdSpan<U, ExtentsT, Layout>& other) noexcept
+      : data_(other.data()), mapping_(other.mapping()) {}
+
+  template <std::convertible_to<SizeT>... Indices>
+    requires(sizeof...(Indices) == ExtentsT::rank())
+  constexpr ReferenceT operator[](Indices... indices) const noexcept {
+    return data_[mapping_(static_cast<SizeT>(indices)...)];
+  }
+
+  static constexpr SizeT rank() noexcept { return ExtentsT::rank(); }
+
+  static constexpr SizeT staticExtent(SizeT r) noexcept {
+    return ExtentsT::staticExtent(r);
+  }
+
+  constexpr SizeT extent(SizeT r) const noexcept {
+    return mapping_.extents().extent(r);
+  }
+
+  constexpr const ExtentsT& extents() const noexcept {
+    return mapping_.extents();
+  }
+
+  // The number of elements viewed, not the span of storage they occupy.
+  constexpr SizeT size() const noexcept { return extents().size(); }
+
+  [[nodiscard]] constexpr bool empty() const noexcept { return size() == 0; }
+
+  constexpr SizeT stride(SizeT r) const noexcept { return mapping_.stride(r); }
+
+  constexpr PointerT data() const noexcept { return data_; }
+
+  constexpr const MappingT& mapping() const noexcept { return mapping_; }
+
+ private:
+  PointerT data_ = nullptr;
+  [[no_unique_address]] MappingT mapping_;
+};
+
+template <typename T, std::convertible_to<std::size_t>... Sizes>
+MdSpan(T*, Sizes...) -> MdSpan<T, DExtents<sizeof...(Sizes)>>;
+
+template <typename T, typename Allocator,
+          std::convertible_to<std::size_t>... Sizes>
+MdSpan(Vector<T, Allocator>&, Sizes...)
+    -> MdSpan<T, DExtents<sizeof...(Sizes)>>;
+
+template <typename T, typename Allocator,
+          std::convertible_to<std::size_t>... Sizes>
+MdSpan(const Vector<T, Allocator>&, Sizes...)
+    -> MdSpan<const T, DExtents<sizeof...(Sizes)>>;
+
+}  // namespace ecx::stl
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Type-erased source of memory, modelled on std::pmr::memory_resource.
+ * Implementations override the private doAllocate/doDeallocate/doIsEqual
+ * hooks (Non-Virtual Interface), and the public entry points supply the
+ * default alignment.
+ */
+class MemoryResource {
+ public:
+  using SizeT = std::size_t;
+
+  static constexpr SizeT kMaxAlign = alignof(std::max_align_t);
+
+  virtual ~MemoryResource() = default;
+
+  [[nodiscard]] void* allocate(SizeT bytes, SizeT alignment = kMaxAlign) {
+    return doAllocate(bytes, alignment);
+  }
+
+  void deallocate(void* p, SizeT bytes, SizeT alignment = kMaxAlign) {
+    doDeallocate(p, bytes, alignment);
+  }
+
+  bool isEqual(const MemoryResource& other) const noexcept {
+    return doIsEqual(other);
+  }
+
+  friend bool operator==(const MemoryResource& a,
+                         const MemoryResource& b) noexcept {
+    return &a == &b || a.isEqual(b);
+  }
+
+ private:
+  virtual void* doAllocate(SizeT bytes, SizeT alignment) = 0;
+  virtual void doDeallocate(void* p, SizeT bytes, SizeT alignment) = 0;
+  virtual bool doIsEqual(const MemoryResource& other) const noexcept = 0;
+};
+
+namespace detail {
+
+class NewDeleteResource final : public MemoryResource {
+  void* doAllocate(SizeT bytes, SizeT alignment) override {
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return ::operator new(bytes, std::align_val_t{alignment});
+    }
+    return ::operator new(bytes);
+  }
+
+  void doDeallocate(void* p, SizeT bytes, SizeT alignment) override {
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(p, bytes, std::align_val_t{alignment});
+      return;
+    }
+    ::operator delete(p, bytes);
+  }
+
+  bool doIsEqual(const MemoryResource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+class NullMemoryResource final : public MemoryResource {
+  void* doAllocate(SizeT, SizeT) override {
+#if defined(__cpp_exceptions)
+    throw std::bad_alloc();
+#else
+    std::abort();
+#endif
+  }
+
+  void doDeallocate(void*, SizeT, SizeT) override {}
+
+  bool doIsEqual(const MemoryResource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+inline constexpr std::size_t alignUp(std::size_t n, std::size_t alignment) {
+  return (n + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace detail
+
+/**
+ * Resource backed by global operator new/delete.
+ */
+inline MemoryResource* newDeleteResource() noexcept {
+  static detail::NewDeleteResource resource;
+  return &resource;
+}
+
+/**
+ * Resource that fails every allocation with std::bad_alloc. Useful as the
+ * upstream of a MonotonicBufferResource over a fixed buffer, to assert that
+ * the buffer is never outgrown.
+ */
+inline MemoryResource* nullMemoryResource() noexcept {
+  static detail::NullMemoryResource resource;
+  return &resource;
+}
+
+namespace detail {
+
+inline std::atomic<MemoryResource*>& defaultResource() noexcept {
+  static std::atomic<MemoryResource*> resource{newDeleteResource()};
+  return resource;
+}
+
+}  // namespace detail
+
+inline MemoryResource* getDefaultResource() noexcept {
+  return detail::defaultResource().load(std::memory_order_acquire);
+}
+
+/**
+ * Replaces the resource used by default-constructed PolymorphicAllocators,
+ * returning the previous one. nullptr restores newDeleteResource().
+ */
+inline MemoryResource* setDefaultResource(MemoryResource* resource) noexcept {
+  return detail::defaultResource().exchange(
+      resource ? resource : newDeleteResource(), std::memory_order_acq_rel);
+}
+
+/**
+ * Bump allocator over a chain of geometrically growing chunks.
+ *
+ * deallocate() is a no-op; memory is only returned by release() or the
+ * destructor, which hand every chunk back upstream at once, regardless of how
+ * many allocations were carved from them. Paired with pmr::Vector, a whole
+ * request's graph of Vectors can be dropped by releasing its resource, without
+ * walking the graph to free each buffer.
+ */
+class MonotonicBufferResource : public MemoryResource {
+ public:
+  static constexpr SizeT kDefaultInitialSize = 1024;
+  static constexpr SizeT kGrowthFactor = 2;
+
+  explicit MonotonicBufferResource(
+      MemoryResource* upstream = getDefaultResource()) noexcept
+      : MonotonicBufferResource(kDefaultInitialSize, upstream) {}
+
+  explicit MonotonicBufferResource(
+      SizeT initialSize,
+      MemoryResource* upstream = getDefaultResource()) noexcept
+      : upstream_(upstream),
+        nextChunkSize_(std::max<SizeT>(initialSize, 1)),
+        initialChunkSize_(nextChunkSize_) {}
+
+  /**
+   * Serves allocations from buffer first, which is not owned and never
+   * returned upstream.
+   */
+  MonotonicBufferResource(void* buffer, SizeT size,
+                          MemoryResource* upstream = getDefaultResource())
+      : upstream_(upstream),
+        initialBuffer_(static_cast<std::byte*>(buffer)),
+        initialBufferSize_(size),
+        current_(initialBuffer_),
+        remaining_(size),
+        nextChunkSize_(std::max<SizeT>(size * kGrowthFactor, 1)),
+        initialChunkSize_(nextChunkSize_) {}
+
+  MonotonicBufferResource(const MonotonicBufferResource&) = delete;
+  MonotonicBufferResource& operator=(const MonotonicBufferResource&) = delete;
+
+  ~MonotonicBufferResource() override { release(); }
+
+  /**
+   * Returns every chunk upstream, and rewinds to the initial buffer.
+   */
+  void release() noexcept {
+    while (chunks_) {
+      Chunk* prev = chunks_->prev;
+      upstream_->deallocate(chunks_, chunks_->size, alignof(Chunk));
+      chunks_ = prev;
+    }
+    current_ = initialBuffer_;
+    remaining_ = initialBufferSize_;
+    nextChunkSize_ = initialChunkSize_;
+  }
+
+  MemoryResource* upstreamResource() const noexcept { return upstream_; }
+
+ private:
+  // Header at the start of every upstream chunk.
+  struct alignas(kMaxAlign) Chunk {
+    Chunk* prev;
+    SizeT size;
+  };
+
+  void* doAllocate(SizeT bytes, SizeT alignment) override {
+    void* p = current_;
+    if (!std::align(alignment, bytes, p, remaining_)) {
+      allocateChunk(bytes, alignment);
+      p = current_;
+      std::align(alignment, bytes, p, remaining_);
+    }
+
+    current_ = static_cast<std::byte*>(p) + bytes;
+    remaining_ -= bytes;
+    return p;
+  }
+
+  void doDeallocate(void*, SizeT, SizeT) override {}
+
+  bool doIsEqual(const MemoryResource& other) const noexcept override {
+    return this == &other;
+  }
+
+  void allocateChunk(SizeT bytes, SizeT alignment) {
+    SizeT size = std::max(nextChunkSize_, sizeof(Chunk) + bytes + alignment);
+    void* memory = upstream_->allocate(size, alignof(Chunk));
+    auto* chunk = ::new (memory) Chunk{chunks_, size};
+    chunks_ = chunk;
+
+    current_ = reinterpret_cast<std::byte*>(chunk + 1);
+    remaining_ = size - sizeof(Chunk);
+    nextChunkSize_ = size * kGrowthFactor;
+  }
+
+  MemoryResource* upstream_;
+  std::byte* initialBuffer_ = nullptr;
+  SizeT initialBufferSize_ = 0;
+  std::byte* current_ = nullptr;
+  SizeT remaining_ = 0;
+  SizeT nextChunkSize_;
+  SizeT initialChunkSize_;
+  Chunk* chunks_ = nullptr;
+};
+
+struct PoolOptions {
+  // Upper bound on the blocks carved from one upstream chunk; 0 picks the
+  // default.
+  std::size_t maxBlocksPerChunk = 0;
+
+  // Allocations larger than this bypass the pools and go straight upstream;
+  // 0 picks the default.
+  std::size_t largestRequiredPoolBlock = 0;
+};
+
+/**
+ * Segregated free-list allocator, not thread-safe.
+ *
+ * Allocations are rounded up to a power-of-two size class, each of which is
+ * served by a pool of equally sized blocks carved from upstream chunks.
+ * Chunks grow geometrically up to PoolOptions::maxBlocksPerChunk blocks.
+ * Freed blocks are pushed onto their pool's intrusive free list, and reused
+ * LIFO, which keeps recently touched memory hot.
+ * Chunks are aligned to their block size, so every block is naturally aligned
+ * for any alignment up to its size.
+ */
+class UnsynchronizedPoolResource : public MemoryResource {
+ public:
+  static constexpr SizeT kDefaultMaxBlocksPerChunk = 1024;
+  static constexpr SizeT kDefaultLargestBlock = 4096;
+  static constexpr SizeT kSmallestBlock = sizeof(void*);
+  static constexpr SizeT kInitialBlocksPerChunk = 16;
+
+  explicit UnsynchronizedPoolResource(
+      MemoryResource* upstream = getDefaultResource())
+      : UnsynchronizedPoolResource(PoolOptions{}, upstream) {}
+
+  explicit UnsynchronizedPoolResource(
+      const PoolOptions& options,
+      MemoryResource* upstream = getDefaultResource())
+      : upstream_(upstream),
+        maxBlocksPerChunk_(options.maxBlocksPerChunk
+                               ? options.maxBlocksPerChunk
+                               : kDefaultMaxBlocksPerChunk),
+        largestBlock_(std::bit_ceil(std::max(
+            options.largestRequiredPoolBlock ? options.largestRequiredPoolBlock
+                                             : kDefaultLargestBlock,
+            kSmallestBlock))),
+        pools_(poolIndex(largestBlock_) + 1) {}
+
+  UnsynchronizedPoolResource(const UnsynchronizedPoolResource&) = delete;
+  UnsynchronizedPoolResource& operator=(const UnsynchronizedPoolResource&) =
+      delete;
+
+  ~UnsynchronizedPoolResource() override { release(); }
+
+  /**
+   * Returns every chunk and oversized allocation upstream.
+   */
+  void release() noexcept {
+    for (SizeT i = 0; i < pools_.size(); ++i) {
+      Pool& pool = pools_[i];
+      const SizeT blockSize = kSmallestBlock << i;
+      while (pool.chunks) {
+        ChunkFooter* footer = pool.chunks;
+        pool.chunks = footer->prev;
+        upstream_->deallocate(footer->begin, footer->bytes, blockSize);
+      }
+      pool = Pool{};
+    }
+
+    while (largeAllocations_) {
+      LargeHeader* header = std::exchange(largeAllocations_,
+                                          largeAllocations_->next);
+      upstream_->deallocate(header->base, header->bytes, header->alignment);
+    }
+  }
+
+  MemoryResource* upstreamResource() const noexcept { return upstream_; }
+
+  PoolOptions options() const noexcept {
+    return {maxBlocksPerChunk_, largestBlock_};
+  }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  // Stored after the blocks of every chunk.
+  struct ChunkFooter {
+    ChunkFooter* prev;
+    std::byte* begin;
+    SizeT bytes;
+  };
+
+  struct Pool {
+    FreeBlock* freeList = nullptr;
+    ChunkFooter* chunks = nullptr;
+    SizeT nextBlocksPerChunk = kInitialBlocksPerChunk;
+  };
+
+  // Prefixed to allocations too large for the pools, linking them so that
+  // release() can find them.
+  struct LargeHeader {
+    LargeHeader* prev;
+    LargeHeader* next;
+    void* base;
+    SizeT bytes;
+    SizeT alignment;
+  };
+
+  static SizeT poolIndex(SizeT blockSize) noexcept {
+    return static_cast<SizeT>(std::countr_zero(blockSize) -
+                              std::countr_zero(kSmallestBlock));
+  }
+
+  void* doAllocate(SizeT bytes, SizeT alignment) override {
+    const SizeT blockSize =
+        std::bit_ceil(std::max({bytes, alignment, kSmallestBlock}));
+    if (blockSize > largestBlock_) {
+      return allocateLarge(bytes, alignment);
+    }
+
+    Pool& pool = pools_[poolIndex(blockSize)];
+    if (!pool.freeList) {
+      refill(pool, blockSize);
+    }
+    FreeBlock* block = pool.freeList;
+    pool.freeList = block->next;
+    return block;
+  }
+
+  void doDeallocate(void* p, SizeT bytes, SizeT alignment) override {
+    const SizeT blockSize =
+        std::bit_ceil(std::max({bytes, alignment, kSmallestBlock}));
+    if (blockSize > largestBlock_) {
+      deallocateLarge(p);
+      return;
+    }
+
+    Pool& pool = pools_[poolIndex(blockSize)];
+    auto* block = ::new (p) FreeBlock{pool.freeList};
+    pool.freeList = block;
+  }
+
+  bool doIsEqual(const MemoryResource& other) const noexcept override {
+    return this == &other;
+  }
+
+  void refill(Pool& pool, SizeT blockSize) {
+    const SizeT blocks = pool.nextBlocksPerChunk;
+    const SizeT footerOffset =
+        detail::alignUp(blocks * blockSize, alignof(ChunkFooter));
+    const SizeT bytes = footerOffset + sizeof(ChunkFooter);
+
+    auto* begin = static_cast<std::byte*>(upstream_->allocate(
+        bytes, std::max(blockSize, alignof(ChunkFooter))));
+    pool.chunks = ::new (begin + footerOffset)
+        ChunkFooter{pool.chunks, begin, bytes};
+    pool.nextBlocksPerChunk = std::min(blocks * 2, maxBlocksPerChunk_);
+
+    // Thread the blocks onto the free list back to front, so that they are
+    // handed out in address order.
+    for (SizeT i = blocks; i-- > 0;) {
+      pool.freeList = ::new (begin + i * blockSize) FreeBlock{pool.freeList};
+    }
+  }
+
+  void* allocateLarge(SizeT bytes, SizeT alignment) {
+    alignment = std::max(alignment, alignof(LargeHeader));
+    const SizeT headerSize = detail::alignUp(sizeof(LargeHeader), alignment);
+    void* base = upstream_->allocate(headerSize + bytes, alignment);
+
+    auto* p = static_cast<std::byte*>(base) + headerSize;
+    auto* header = ::new (p - sizeof(LargeHeader))
+        LargeHeader{nullptr, largeAllocations_, base, headerSize + bytes,
+                    alignment};
+    if (largeAllocations_) {
+      largeAllocations_->prev = header;
+    }
+    largeAllocations_ = header;
+    return p;
+  }
+
+  void deallocateLarge(void* p) noexcept {
+    auto* header = reinterpret_cast<LargeHeader*>(static_cast<std::byte*>(p) -
+                                                  sizeof(LargeHeader));
+    if (header->prev) {
+      header->prev->next = header->next;
+    } else {
+      largeAllocations_ = header->next;
+    }
+    if (header->next) {
+      header->next->prev = header->prev;
+    }
+    upstream_->deallocate(header->base, header->bytes, header->alignment);
+  }
+
+  MemoryResource* upstream_;
+  SizeT maxBlocksPerChunk_;
+  SizeT largestBlock_;
+  Vector<Pool> pools_;
+  LargeHeader* largeAllocations_ = nullptr;
+};
+
+/**
+ * Thread-safe UnsynchronizedPoolResource, serialising every call on a mutex.
+ */
+class SynchronizedPoolResource : public MemoryResource {
+ public:
+  explicit SynchronizedPoolResource(
+      MemoryResource* upstream = getDefaultResource())
+      : pool_(upstream) {}
+
+  explicit SynchronizedPoolResource(
+      const PoolOptions& options,
+      MemoryResource* upstream = getDefaultResource())
+      : pool_(options, upstream) {}
+
+  void release() {
+    std::lock_guard lock(mutex_);
+    pool_.release();
+  }
+
+  MemoryResource* upstreamResource() const noexcept {
+    return pool_.upstreamResource();
+  }
+
+  PoolOptions options() const noexcept { return pool_.options(); }
+
+ private:
+  void* doAllocate(SizeT bytes, SizeT alignment) override {
+    std::lock_guard lock(mutex_);
+    return pool_.allocate(bytes, alignment);
+  }
+
+  void doDeallocate(void* p, SizeT bytes, SizeT alignment) override {
+    std::lock_guard lock(mutex_);
+    pool_.deallocate(p, bytes, alignment);
+  }
+
+  bool doIsEqual(const MemoryResource& other) const noexcept override {
+    return this == &other;
+  }
+
+  std::mutex mutex_;
+  UnsynchronizedPoolResource pool_;
+};
+
+/**
+ * Allocator drawing from a MemoryResource, modelled on
+ * std::pmr::polymorphic_allocator.
+ *
+ * construct() performs uses-allocator construction: an element that is
+ * itself allocator-aware (such as a pmr::Vector) is handed this allocator,
+ * so a container and all of its nested containers share one resource.
+ * The allocator does not propagate on copy/move assignment or swap, and a
+ * copy-constructed container reverts to the default resource, as in std::pmr.
+ */
+template <typename T = std::byte>
+class PolymorphicAllocator {
+ public:
+  using value_type = T;
+  using SizeT = std::size_t;
+
+  PolymorphicAllocator() noexcept : resource_(getDefaultResource()) {}
+
+  // Implicit, so that a resource can be passed wherever an allocator is
+  // expected.
+  PolymorphicAllocator(MemoryResource* resource) noexcept
+      : resource_(resource) {}
+
+  PolymorphicAllocator(const PolymorphicAllocator&) = default;
+
+  template <typename U>
+  PolymorphicAllocator(const PolymorphicAllocator<U>& other) noexcept
+      : resource_(other.resource()) {}
+
+  PolymorphicAllocator& operator=(const PolymorphicAllocator&) = delete;
+
+  [[nodiscard]] T* allocate(SizeT n) {
+    if (n > std::numeric_limits<SizeT>::max() / sizeof(T)) {
+#if defined(__cpp_exceptions)
+      throw std::bad_array_new_length();
+#else
+      std::abort();
+#endif
+    }
+    return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, SizeT n) noexcept {
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  template <typename U, typename... Args>
+  void construct(U* p, Args&&... args) {
+    std::uninitialized_construct_using_allocator(p, *this,
+                                                 std::forward<Args>(args)...);
+  }
+
+  PolymorphicAllocator select_on_container_copy_construction() const noexcept {
+    return PolymorphicAllocator();
+  }
+
+  MemoryResource* resource() const noexcept { return resource_; }
+
+  friend bool operator==(const PolymorphicAllocator& a,
+                         const PolymorphicAllocator& b) noexcept {
+    return *a.resource_ == *b.resource_;
+  }
+
+ private:
+  MemoryResource* resource_;
+};
+
+namespace pmr {
+
+template <typename T>
+using Vector = ecx::stl::Vector<T, PolymorphicAllocator<T>>;
+
+}  // namespace pmr
+
+}  // namespace ecx::stl
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace ecx::stl {
+
+namespace detail::streaming {
+
+using SizeT = std::size_t;
+
+// Below this, the destination is likely to be read soon and may fit in the
+// LLC anyway, so ordinary stores are better.
+inline constexpr SizeT kThresholdBytes = SizeT{16} << 20;
+// The block a fill replicates: small enough to stay in L1 as the source.
+inline constexpr SizeT kFillBlockBytes = 4096;
+// Below this per thread, starting threads costs more than they add.
+inline constexpr SizeT kMinBytesPerThread = SizeT{8} << 20;
+inline constexpr SizeT kMaxThreads = 64;
+
+/**
+ * Copies with non-temporal stores, which write combined cache lines straight
+ * to memory rather than evicting the working set to make room for them.
+ * Unaligned ends go through memcpy. The stores are weakly ordered: the
+ * caller must sfence before the data is published.
+ */
+inline void streamBytes(void* dst, const void* src, SizeT bytes) noexcept {
+#if defined(__SSE2__)
+  auto* d = static_cast<char*>(dst);
+  const auto* s = static_cast<const char*>(src);
+  const SizeT head =
+      std::min(bytes, (16 - reinterpret_cast<std::uintptr_t>(d) % 16) % 16);
+  std::memcpy(d, s, head);
+  d += head;
+  s += head;
+  bytes -= head;
+
+  for (; bytes >= 64; bytes -= 64, d += 64, s += 64) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+    const __m128i c =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+    const __m128i e =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+    _mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+  }
+  std::memcpy(d, s, bytes);
+#else
+  std::memcpy(dst, src, bytes);
+#endif
+}
+
+inline void storeFence() noexcept {
+#if defined(__SSE2__)
+  _mm_sfence();
+#endif
+}
+
+/**
+ * Runs work(first, last) over [0, bytes) split at 64-byte boundaries, on up
+ * to threads threads (including this one), each ending with an sfence.
+ */
+template <typename Work>
+void splitAcrossThreads(SizeT bytes, unsigned threads, Work&& work) {
+  const SizeT parts = std::clamp<SizeT>(
+      bytes / kMinBytesPerThread, 1,
+      std::min<SizeT>(std::max(threads, 1u), kMaxThreads));
+  const SizeT chunk = (bytes / parts + 63) / 64 * 64;
+  {
+    std::jthread workers[kMaxThreads];
+    for (SizeT p = 1; p < parts; ++p) {
+      const SizeT first = std::min(bytes, p * chunk);
+      const SizeT last = std::min(bytes, first + chunk);
+      workers[p] = std::jthread([&work, first, last] {
+        work(first, last);
+        storeFence();
+      });
+    }
+    work(0, std::min(bytes, chunk));
+    storeFence();
+  }
+}
+
+}  // namespace detail::streaming
+
+/**
+ * memcpy of bytes into memory that will not be read again soon (a large
+ * Vector being built or relocated): above kThresholdBytes, non-temporal
+ * stores keep it from flushing the caches, optionally split across threads.
+ * The stores are fenced before returning, so the result may be published
+ * as after any memcpy.
+ */
+inline void streamingCopy(void* dst, const void* src, std::size_t bytes,
+                          unsigned threads = 1) {
+  using namespace detail::streaming;
+  if (bytes < kThresholdBytes) {
+    if (bytes != 0) {
+      std::memcpy(dst, src, bytes);
+    }
+    return;
+  }
+  splitAcrossThreads(bytes, threads, [&](SizeT first, SizeT last) {
+    streamBytes(static_cast<char*>(dst) + first,
+                static_cast<const char*>(src) + first, last - first);
+  });
+}
+
+namespace detail::streaming {
+
+/**
+ * The streaming path of streamingFill, for bytes >= kThresholdBytes. Kept out
+ * of line: inlined into a caller with a small constant n, GCC would warn
+ * -Wstringop-overflow about the block fill this path never reaches. It is
+ * called for at least 16 MiB, so the call costs nothing.
+ */
+template <typename T>
+__attribute__((noinline)) void streamFill(T* dst, SizeT bytes, const T& value,
+                                          unsigned threads) {
+  const SizeT block = std::max<SizeT>(1, kFillBlockBytes / sizeof(T));
+  std::uninitialized_fill_n(dst, block, value);
+  const SizeT blockBytes = block * sizeof(T);
+  auto* bytesOut = reinterpret_cast<char*>(dst);
+  // Thread boundaries fall on 64 bytes, not on blocks: each thread starts
+  // from the first block boundary in its range and fills up to it from the
+  // block's tail, so the pattern stays aligned to elements.
+  splitAcrossThreads(bytes, threads, [&](SizeT first, SizeT last) {
+    first = std::max(first, blockBytes);
+    if (first >= last) {
+      return;
+    }
+    const SizeT offset = first % blockBytes;
+    const SizeT lead =
+        std::min(last - first, offset == 0 ? 0 : blockBytes - offset);
+    streamBytes(bytesOut + first, bytesOut + offset, lead);
+    for (SizeT at = first + lead; at < last; at += blockBytes) {
+      streamBytes(bytesOut + at, bytesOut, std::min(blockBytes, last - at));
+    }
+  });
+}
+
+}  // namespace detail::streaming
+
+/**
+ * std::uninitialized_fill_n for trivially copyable T, with non-temporal
+ * stores above kThresholdBytes: one block is filled normally, then streamed
+ * out repeatedly from L1.
+ */
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+void streamingFill(T* dst, std::size_t n, const T& value,
+                   unsigned threads = 1) {
+  using namespace detail::streaming;
+  const SizeT bytes = n * sizeof(T);
+  if (bytes < kThresholdBytes) {
+    std::uninitialized_fill_n(dst, n, value);
+    return;
+  }
+  streamFill(dst, bytes, value, threads);
+}
+
+}  // namespace ecx::stl
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <concepts>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace ecx::stl {
+
+namespace detail {
+
+// Named, so that the trivial special members of Optional and Expected, which
+// add triviality on top, are more constrained than the non-trivial ones.
+template <typename T>
+concept CopyConstructibleAndAssignable =
+    std::copy_constructible<T> && std::is_copy_assignable_v<T>;
+
+template <typename T>
+concept MoveConstructibleAndAssignable =
+    std::move_constructible<T> && std::is_move_assignable_v<T>;
+
+}  // namespace detail
+
+struct NullOpt {
+  constexpr explicit NullOpt(int) noexcept {}
+};
+
+inline constexpr NullOpt kNullOpt{0};
+
+/**
+ * A T, or nothing, stored inline.
+ *
+ * Every special member is defaulted (and so trivial) whenever T's is, which
+ * makes Optional<T> trivially copyable and destructible for trivially
+ * copyable T: it can be memcpy'd, passed in registers, and stored in
+ * containers that relocate with memcpy.
+ *
+ * Nothing here throws; accessing the value of an empty Optional is undefined,
+ * as with operator* on std::optional.
+ */
+template <typename T>
+class Optional {
+  static_assert(std::is_object_v<T> && !std::is_array_v<T>,
+                "Optional<T> requires a non-array object type");
+
+  static constexpr bool kTriviallyCopyable =
+      std::is_trivially_copy_constructible_v<T> &&
+      std::is_trivially_copy_assignable_v<T> &&
+      std::is_trivially_move_constructible_v<T> &&
+      std::is_trivially_move_assignable_v<T> &&
+      std::is_trivially_destructible_v<T>;
+
+ public:
+  using ValueT = T;
+
+  constexpr Optional() noexcept : empty_(), hasValue_(false) {}
+
+  constexpr Optional(NullOpt) noexcept : Optional() {}
+
+  template <typename U = T>
+    requires std::constructible_from<T, U&&> &&
+             (!std::same_as<std::remove_cvref_t<U>, Optional>) &&
+             (!std::same_as<std::remove_cvref_t<U>, NullOpt>) &&
+             (!std::same_as<std::remove_cvref_t<U>, std::in_place_t>)
+  constexpr explicit(!std::convertible_to<U&&, T>) Optional(U&& value)
+      : value_(std::forward<U>(value)), hasValue_(true) {}
+
+  template <typename... Args>
+  constexpr explicit Optional(std::in_place_t, Args&&... args)
+      : value_(std::forward<Args>(args)...), hasValue_(true) {}
+
+  Optional(const Optional&)
+    requires std::copy_constructible<T> &&
+             std::is_trivially_copy_constructible_v<T>
+  = default;
+
+  constexpr Optional(const Optional& other)
+    requires std::copy_constructible<T>
+      : Optional() {
+    if (other.hasValue_) {
+      construct(other.value_);
+    }
+  }
+
+  Optional(Optional&&)
+    requires std::move_constructible<T> &&
+             std::is_trivially_move_constructible_v<T>
+  = default;
+
+  constexpr Optional(Optional&& other) noexcept(
+      std::is_nothrow_move_constructible_v<T>)
+    requires std::move_constructible<T>
+      : Optional() {
+    if (other.hasValue_) {
+      construct(std::move(other.value_));
+    }
+  }
+
+  Optional& operator=(const Optional&)
+    requires detail::CopyConstructibleAndAssignable<T> && kTriviallyCopyable
+  = default;
+
+  constexpr Optional& operator=(const Optional& other)
+    requires detail::CopyConstructibleAndAssignable<T>
+  {
+    assign(other);
+    return *this;
+  }
+
+  Optional& operator=(Optional&&)
+    requires detail::MoveConstructibleAndAssignable<T> && kTriviallyCopyable
+  = default;
+
+  constexpr Optional& operator=(Optional&& other) noexcept(
+      std::is_nothrow_move_constructible_v<T> &&
+      std::is_nothrow_move_assignable_v<T>)
+    requires detail::MoveConstructibleAndAssignable<T>
+  {
+    assign(std::move(other));
+    return *this;
+  }
+
+  constexpr Optional& operator=(NullOpt) noexcept {
+    reset();
+    return *this;
+  }
+
+  ~Optional()
+    requires std::is_trivially_destructible_v<T>
+  = default;
+
+  constexpr ~Optional() { reset(); }
+
+  constexpr bool hasValue() const noexcept { return hasValue_; }
+
+  constexpr explicit operator bool() const noexcept { return hasValue_; }
+
+  constexpr T& operator*() & noexcept { return value_; }
+
+  constexpr const T& operator*() const& noexcept { return value_; }
+
+  constexpr T&& operator*() && noexcept { return std::move(value_); }
+
+  constexpr T* operator->() noexcept { return std::addressof(value_); }
+
+  constexpr const T* operator->() const noexcept {
+    return std::addressof(value_);
+  }
+
+  template <typename U>
+  constexpr T valueOr(U&& fallback) const& {
+    return hasValue_ ? value_ : static_cast<T>(std::forward<U>(fallback));
+  }
+
+  template <typename U>
+  constexpr T valueOr(U&& fallback) && {
+    return hasValue_ ? std::move(value_)
+                     : static_cast<T>(std::forward<U>(fallback));
+  }
+
+  template <typename... Args>
+  constexpr T& emplace(Args&&... args) {
+    reset();
+    construct(std::forward<Args>(args)...);
+    return value_;
+  }
+
+  // GCC (12, at -O3) loses track of hasValue_ once the Optional's address
+  // escapes, and then warns that the value it destroys may be uninitialized.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+  constexpr void reset() noexcept {
+    if (hasValue_) {
+      if constexpr (!std::is_trivially_destructible_v<T>) {
+        value_.~T();
+      }
+      hasValue_ = false;
+    }
+  }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+  friend constexpr bool operator==(const Optional& lhs, const Optional& rhs)
+    requires std::equality_comparable<T>
+  {
+    if (lhs.hasValue_ != rhs.hasValue_) {
+      return false;
+    }
+    return !lhs.hasValue_ || lhs.value_ == rhs.value_;
+  }
+
+  friend constexpr bool operator==(const Optional& lhs, NullOpt) noexcept {
+    return !lhs.hasValue_;
+  }
+
+ private:
+  struct Empty {};
+
+  template <typename... Args>
+  constexpr void construct(Args&&... args) {
+    std::construct_at(std::addressof(value_), std::forward<Args>(args)...);
+    hasValue_ = true;
+  }
+
+  template <typename Other>
+  constexpr void assign(Other&& other) {
+    if (!other.hasValue_) {
+      reset();
+    } else if (hasValue_) {
+      value_ = std::forward<Other>(other).value_;
+    } else {
+      construct(std::forward<Other>(other).value_);
+    }
+  }
+
+  union {
+    Empty empty_;
+    T value_;
+  };
+  bool hasValue_;
+};
+
+}  // namespace ecx::stl
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+namespace detail::bitpack {
+
+using SizeT = std::size_t;
+
+// Values are unpacked in groups of 64: a group of width-W values is exactly W
+// words, so every group starts on a word boundary.
+inline constexpr SizeT kGroupSize = 64;
+
+constexpr std::uint64_t lowMask(unsigned width) noexcept {
+  return width == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << width) - 1;
+}
+
+// The value at bit offset pos of a packed array, width bits wide.
+inline std::uint64_t read(const std::uint64_t* words, SizeT pos,
+                          unsigned width) noexcept {
+  const SizeT word = pos / 64;
+  const unsigned shift = pos % 64;
+  std::uint64_t value = words[word] >> shift;
+  if (shift + width > 64) {
+    value |= words[word + 1] << (64 - shift);
+  }
+  return value & lowMask(width);
+}
+
+// Ors value into a zeroed slot; see read.
+inline void write(std::uint64_t* words, SizeT pos, unsigned width,
+                  std::uint64_t value) noexcept {
+  const SizeT word = pos / 64;
+  const unsigned shift = pos % 64;
+  words[word] |= value << shift;
+  if (shift + width > 64) {
+    words[word + 1] |= value >> (64 - shift);
+  }
+}
+
+/**
+ * Unpacks one group of 64 values. With the width a template argument, every
+ * shift and word index is a constant once the loop is unrolled, leaving
+ * straight-line shifts and masks that the compiler turns into vector code.
+ */
+template <unsigned Width>
+void unpackGroup(const std::uint64_t* in, std::uint64_t* out) noexcept {
+  if constexpr (Width == 0) {
+    std::fill_n(out, kGroupSize, std::uint64_t{0});
+  } else {
+#pragma GCC unroll 64
+    for (unsigned i = 0; i < kGroupSize; ++i) {
+      out[i] = read(in, SizeT{i} * Width, Width);
+    }
+  }
+}
+
+using UnpackGroupFn = void (*)(const std::uint64_t*, std::uint64_t*) noexcept;
+
+// unpackGroup<W>, indexed by W.
+inline constexpr auto kUnpackGroup =
+    []<unsigned... Widths>(std::integer_sequence<unsigned, Widths...>) {
+      return std::array<UnpackGroupFn, sizeof...(Widths)>{
+          &unpackGroup<Widths>...};
+    }(std::make_integer_sequence<unsigned, 65>{});
+
+// Words needed for count values of the given width, plus one so that read
+// may always look at the word after the one a value starts in.
+constexpr SizeT wordsFor(SizeT count, unsigned width) noexcept {
+  return (count * width + 63) / 64 + 1;
+}
+
+}  // namespace detail::bitpack
+
+/**
+ * Vector of unsigned integers, each stored in the fewest bits that hold the
+ * largest of them, e.g. 20 bits per ID instead of 64.
+ *
+ * Random access is a shift and a mask across at most two words. unpack()
+ * decodes ranges in bulk with kernels specialised per width. pushBack of a
+ * value wider than the current width repacks every element, at most once per
+ * extra bit, so the total cost stays linear.
+ */
+class PackedIntVector {
+ public:
+  using SizeT = std::size_t;
+  using ValueT = std::uint64_t;
+
+  PackedIntVector() = default;
+
+  explicit PackedIntVector(Span<const ValueT> values)
+      : PackedIntVector(values, widthOf(values)) {}
+
+  /**
+   * Packs values at the given width, which must be at least the bit width of
+   * the largest value, e.g. to leave room for later pushBacks.
+   */
+  explicit PackedIntVector(Span<const ValueT> values, unsigned width)
+      : words_(detail::bitpack::wordsFor(values.size(), width)),
+        size_(values.size()),
+        width_(width) {
+    for (SizeT i = 0; i < size_; ++i) {
+      detail::bitpack::write(words_.data(), i * width_, width_, values[i]);
+    }
+  }
+
+  SizeT size() const noexcept { return size_; }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  // Bits per element.
+  unsigned bitWidth() const noexcept { return width_; }
+
+  // Bytes of packed storage.
+  SizeT sizeBytes() const noexcept { return words_.size() * sizeof(ValueT); }
+
+  ValueT operator[](SizeT i) const noexcept {
+    return width_ == 0
+               ? 0
+               : detail::bitpack::read(words_.data(), i * width_, width_);
+  }
+
+  void pushBack(ValueT value) {
+    if (const auto width = static_cast<unsigned>(std::bit_width(value));
+        width > width_) {
+      repack(width);
+    }
+    const SizeT needed = detail::bitpack::wordsFor(size_ + 1, width_);
+    if (needed > words_.size()) {
+      words_.resize(std::max(needed, words_.size() * 2));
+    }
+    if (width_ > 0) {
+      detail::bitpack::write(words_.data(), size_ * width_, width_, value);
+    }
+    ++size_;
+  }
+
+  /**
+   * Decodes elements [first, first + out.size()) into out.
+   */
+  void unpack(SizeT first, Span<ValueT> out) const noexcept {
+    using detail::bitpack::kGroupSize;
+
+    SizeT i = first;
+    const SizeT last = first + out.size();
+    ValueT* dest = out.data();
+    for (; i < last && i % kGroupSize != 0; ++i) {
+      *dest++ = (*this)[i];
+    }
+
+    const auto unpackGroup = detail::bitpack::kUnpackGroup[width_];
+    for (; last - i >= kGroupSize; i += kGroupSize, dest += kGroupSize) {
+      unpackGroup(words_.data() + i / kGroupSize * width_, dest);
+    }
+
+    for (; i < last; ++i) {
+      *dest++ = (*this)[i];
+    }
+  }
+
+  Vector<ValueT> toVector() const {
+    Vector<ValueT> values(size_);
+    unpack(0, Span<ValueT>(values));
+    return values;
+  }
+
+  friend bool operator==(const PackedIntVector& lhs,
+                         const PackedIntVector& rhs) noexcept {
+    if (lhs.size_ != rhs.size_) {
+      return false;
+    }
+    for (SizeT i = 0; i < lhs.size_; ++i) {
+      if (lhs[i] != rhs[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  static unsigned widthOf(Span<const ValueT> values) noexcept {
+    ValueT max = 0;
+    for (ValueT v : values) {
+      max = std::max(max, v);
+    }
+    return static_cast<unsigned>(std::bit_width(max));
+  }
+
+  void repack(unsigned width) {
+    Vector<ValueT> values = toVector();
+    *this = PackedIntVector(Span<const ValueT>(values), width);
+  }
+
+  Vector<ValueT> words_;
+  SizeT size_ = 0;
+  unsigned width_ = 0;
+};
+
+/**
+ * Non-decreasing sequence of unsigned integers, e.g. a sorted ID list or
+ * posting list, stored as bit-packed deltas in blocks of kBlockSize.
+ *
+ * Each block is packed at the width of its own largest delta, so dense runs
+ * cost a few bits per element however large the values are. A header per
+ * block records its first value and where its deltas start: element access
+ * sums the deltas of a single block up to the element, and lowerBound binary
+ * searches the headers to skip straight to the one block that can hold the
+ * answer.
+ */
+class DeltaPackedVector {
+ public:
+  using SizeT = std::size_t;
+  using ValueT = std::uint64_t;
+
+  static constexpr SizeT kBlockSize = 2 * detail::bitpack::kGroupSize;
+
+  DeltaPackedVector() = default;
+
+  /**
+   * values must be sorted in non-decreasing order.
+   */
+  explicit DeltaPackedVector(Span<const ValueT> values) : size_(values.size()) {
+    const SizeT blocks = (size_ + kBlockSize - 1) / kBlockSize;
+    headers_.reserve(blocks);
+
+    std::array<ValueT, kBlockSize> deltas;
+    for (SizeT begin = 0; begin < size_; begin += kBlockSize) {
+      const SizeT count = std::min(kBlockSize, size_ - begin);
+      deltas.fill(0);
+      ValueT maxDelta = 0;
+      for (SizeT j = 1; j < count; ++j) {
+        deltas[j] = values[begin + j] - values[begin + j - 1];
+        maxDelta = std::max(maxDelta, deltas[j]);
+      }
+
+      const auto width = static_cast<unsigned>(std::bit_width(maxDelta));
+      const SizeT offset = words_.size();
+      headers_.push_back(BlockHeader{values[begin], offset, width});
+      // Always a whole block, so that decoding never special-cases the tail.
+      words_.resize(offset + detail::bitpack::wordsFor(kBlockSize, width));
+      for (SizeT j = 1; j < count; ++j) {
+        detail::bitpack::write(words_.data() + offset, j * width, width,
+                               deltas[j]);
+      }
+    }
+  }
+
+  SizeT size() const noexcept { return size_; }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  // Bytes of packed deltas and block headers.
+  SizeT sizeBytes() const noexcept {
+    return words_.size() * sizeof(ValueT) +
+           headers_.size() * sizeof(BlockHeader);
+  }
+
+  ValueT operator[](SizeT i) const noexcept {
+    return decodePrefix(i / kBlockSize, i % kBlockSize);
+  }
+
+  /**
+   * The index of the first element not less than value, or size() if there
+   * is none.
+   */
+  SizeT lowerBound(ValueT value) const noexcept {
+    return search(value).index;
+  }
+
+  bool contains(ValueT value) const noexcept {
+    const Position found = search(value);
+    return found.index < size_ && found.value == value;
+  }
+
+  Vector<ValueT> toVector() const {
+    Vector<ValueT> values;
+    values.reserve(size_);
+    std::array<ValueT, kBlockSize> block;
+    for (SizeT b = 0; b < headers_.size(); ++b) {
+      decodeBlock(b, block);
+      for (SizeT j = 0; j < blockCount(b); ++j) {
+        values.push_back(block[j]);
+      }
+    }
+    return values;
+  }
+
+ private:
+  struct BlockHeader {
+    ValueT first;
+    SizeT offset;  // Into words_.
+    unsigned width;
+  };
+
+  // An index, and the element there if it is less than size().
+  struct Position {
+    SizeT index;
+    ValueT value;
+  };
+
+  // lowerBound, with the element it found, decoding a single block.
+  Position search(ValueT value) const noexcept {
+    // The last block whose first element is less than value; the answer is
+    // in it, or is the first element of the block after.
+    const auto next = std::lower_bound(
+        headers_.begin(), headers_.end(), value,
+        [](const BlockHeader& header, ValueT v) { return header.first < v; });
+    if (next == headers_.begin()) {
+      return {0, headers_.empty() ? 0 : (*next).first};
+    }
+    const auto block = static_cast<SizeT>(next - headers_.begin()) - 1;
+
+    std::array<ValueT, kBlockSize> values;
+    decodeBlock(block, values);
+    const SizeT count = blockCount(block);
+    const auto it = std::lower_bound(values.begin(), values.begin() + count,
+                                     value);
+    const SizeT index =
+        block * kBlockSize + static_cast<SizeT>(it - values.begin());
+    if (it != values.begin() + count) {
+      return {index, *it};
+    }
+    return {index, next == headers_.end() ? 0 : (*next).first};
+  }
+
+  SizeT blockCount(SizeT block) const noexcept {
+    return std::min(kBlockSize, size_ - block * kBlockSize);
+  }
+
+  // Element j of block: its first value plus its deltas up to j.
+  ValueT decodePrefix(SizeT block, SizeT j) const noexcept {
+    const BlockHeader& header = headers_[block];
+    ValueT value = header.first;
+    if (header.width == 0) {
+      return value;
+    }
+    const ValueT* words = words_.data() + header.offset;
+    for (SizeT k = 1; k <= j; ++k) {
+      value += detail::bitpack::read(words, k * header.width, header.width);
+    }
+    return value;
+  }
+
+  void decodeBlock(SizeT block,
+                   std::array<ValueT, kBlockSize>& out) const noexcept {
+    using detail::bitpack::kGroupSize;
+
+    const BlockHeader& header = headers_[block];
+    const auto unpackGroup = detail::bitpack::kUnpackGroup[header.width];
+    const ValueT* words = words_.data() + header.offset;
+    for (SizeT g = 0; g < kBlockSize / kGroupSize; ++g) {
+      unpackGroup(words + g * header.width, out.data() + g * kGroupSize);
+    }
+
+    ValueT value = header.first;
+    for (ValueT& x : out) {
+      value += x;
+      x = value;
+    }
+  }
+
+  Vector<BlockHeader> headers_;
+  Vector<ValueT> words_;
+  SizeT size_ = 0;
+};
+
+}  // namespace ecx::stl
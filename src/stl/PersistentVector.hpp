@@ -0,0 +1,517 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "src/stl/Exceptions.hpp"
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Immutable vector whose versions share structure: a 32-way radix tree of
+ * leaves holding the elements, plus a separate tail leaf for the last up to
+ * 32 elements (as in Clojure's PersistentVector).
+ *
+ * pushBack, set and popBack return a new version in O(log32 n), copying only
+ * the path from the root to the changed leaf; every other node is shared with
+ * the old version, by reference count. With the tail, 31 of 32 pushBacks
+ * touch no tree node at all.
+ *
+ * Nodes are refcounted atomically, so versions may be read, copied and
+ * destroyed on different threads.
+ *
+ * For batches of edits, transient() gives a mutable Transient: it copies a
+ * path the first time it touches it, and then edits the nodes it owns in
+ * place, before persistent() freezes the result into a new version.
+ */
+template <typename T>
+class PersistentVector {
+  static constexpr unsigned kBits = 5;
+  static constexpr std::size_t kBranch = std::size_t{1} << kBits;
+  static constexpr std::size_t kMask = kBranch - 1;
+
+  struct Node {
+    std::atomic<std::uint32_t> refs{1};
+  };
+
+  struct Inner : Node {
+    Node* children[kBranch] = {};
+  };
+
+  struct Leaf : Node {
+    Leaf() noexcept = default;
+    Leaf(const Leaf&) = delete;
+    Leaf& operator=(const Leaf&) = delete;
+
+    ~Leaf() { std::destroy_n(values(), count); }
+
+    T* values() noexcept {
+      return std::launder(reinterpret_cast<T*>(storage));
+    }
+
+    std::uint32_t count = 0;
+    alignas(T) std::byte storage[kBranch * sizeof(T)];
+  };
+
+ public:
+  using SizeT = std::size_t;
+  using ValueT = T;
+
+  class ConstIterator;
+  class Transient;
+
+  PersistentVector() noexcept = default;
+
+  explicit PersistentVector(Span<const T> values) {
+    for (const T& value : values) {
+      pushBackInPlace(value);
+    }
+  }
+
+  template <typename Allocator>
+  explicit PersistentVector(const Vector<T, Allocator>& values)
+      : PersistentVector(Span<const T>(values)) {}
+
+  PersistentVector(const PersistentVector& other) noexcept
+      : root_(retain(other.root_)),
+        tail_(retain(other.tail_)),
+        size_(other.size_),
+        shift_(other.shift_) {}
+
+  PersistentVector(PersistentVector&& other) noexcept
+      : root_(std::exchange(other.root_, nullptr)),
+        tail_(std::exchange(other.tail_, nullptr)),
+        size_(std::exchange(other.size_, 0)),
+        shift_(std::exchange(other.shift_, kBits)) {}
+
+  PersistentVector& operator=(PersistentVector other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~PersistentVector() {
+    release(root_, shift_);
+    release(tail_, 0);
+  }
+
+  SizeT size() const noexcept { return size_; }
+
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+  const T& operator[](SizeT i) const noexcept {
+    return leafFor(i)->values()[i & kMask];
+  }
+
+  const T& front() const noexcept { return (*this)[0]; }
+
+  const T& back() const noexcept { return (*this)[size_ - 1]; }
+
+  ConstIterator begin() const noexcept { return ConstIterator(this, 0); }
+
+  ConstIterator end() const noexcept { return ConstIterator(this, size_); }
+
+  [[nodiscard]] PersistentVector pushBack(T value) const {
+    PersistentVector next = *this;
+    next.pushBackInPlace(std::move(value));
+    return next;
+  }
+
+  [[nodiscard]] PersistentVector set(SizeT i, T value) const {
+    PersistentVector next = *this;
+    next.setInPlace(i, std::move(value));
+    return next;
+  }
+
+  [[nodiscard]] PersistentVector popBack() const {
+    PersistentVector next = *this;
+    next.popBackInPlace();
+    return next;
+  }
+
+  Transient transient() const { return Transient(*this); }
+
+  /**
+   * Calls fn with a Span<const T> over each leaf in order: up to 32
+   * contiguous elements at a time, with no per-element tree walk.
+   */
+  template <typename Fn>
+  void forEachChunk(Fn&& fn) const {
+    const SizeT tailStart = tailOffset();
+    for (SizeT i = 0; i < tailStart; i += kBranch) {
+      fn(Span<const T>(leafFor(i)->values(), kBranch));
+    }
+    if (tail_ != nullptr) {
+      fn(Span<const T>(tail_->values(), tail_->count));
+    }
+  }
+
+  Vector<T> toVector() const {
+    Vector<T> values;
+    values.reserve(size_);
+    forEachChunk([&](Span<const T> chunk) {
+      for (const T& value : chunk) {
+        values.push_back(value);
+      }
+    });
+    return values;
+  }
+
+  void swap(PersistentVector& other) noexcept {
+    std::swap(root_, other.root_);
+    std::swap(tail_, other.tail_);
+    std::swap(size_, other.size_);
+    std::swap(shift_, other.shift_);
+  }
+
+  friend bool operator==(const PersistentVector& lhs,
+                         const PersistentVector& rhs) noexcept {
+    if (lhs.size_ != rhs.size_) {
+      return false;
+    }
+    if (lhs.root_ == rhs.root_ && lhs.tail_ == rhs.tail_) {
+      return true;
+    }
+    for (SizeT i = 0; i < lhs.size_; ++i) {
+      if (!(lhs[i] == rhs[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Forward iterator that walks the tree once per leaf, not per element.
+   */
+  class ConstIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    ConstIterator() noexcept = default;
+
+    const T& operator*() const noexcept { return leaf_[index_ & kMask]; }
+
+    const T* operator->() const noexcept { return &**this; }
+
+    ConstIterator& operator++() noexcept {
+      ++index_;
+      if ((index_ & kMask) == 0 && index_ < vector_->size_) {
+        leaf_ = vector_->leafFor(index_)->values();
+      }
+      return *this;
+    }
+
+    ConstIterator operator++(int) noexcept {
+      ConstIterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const ConstIterator& other) const noexcept {
+      return index_ == other.index_;
+    }
+
+   private:
+    friend class PersistentVector;
+
+    ConstIterator(const PersistentVector* vector, SizeT index) noexcept
+        : vector_(vector),
+          leaf_(index < vector->size_ ? vector->leafFor(index)->values()
+                                      : nullptr),
+          index_(index) {}
+
+    const PersistentVector* vector_ = nullptr;
+    const T* leaf_ = nullptr;
+    SizeT index_ = 0;
+  };
+
+  /**
+   * Mutable working copy of a PersistentVector. Edits share nothing they
+   * change with the version it came from, or with other versions.
+   */
+  class Transient {
+   public:
+    SizeT size() const noexcept { return vector_.size(); }
+
+    const T& operator[](SizeT i) const noexcept { return vector_[i]; }
+
+    void pushBack(T value) { vector_.pushBackInPlace(std::move(value)); }
+
+    void set(SizeT i, T value) { vector_.setInPlace(i, std::move(value)); }
+
+    void popBack() { vector_.popBackInPlace(); }
+
+    // The edited vector, as a new version; leaves this Transient empty.
+    PersistentVector persistent() && { return std::move(vector_); }
+
+   private:
+    friend class PersistentVector;
+
+    explicit Transient(const PersistentVector& vector) noexcept
+        : vector_(vector) {}
+
+    PersistentVector vector_;
+  };
+
+ private:
+  template <typename N>
+  static N* retain(N* node) noexcept {
+    if (node != nullptr) {
+      node->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    return node;
+  }
+
+  // Drops a reference to node, whose children are leaves if level is kBits,
+  // and which is itself a leaf if level is 0.
+  static void release(Node* node, unsigned level) noexcept {
+    if (node == nullptr ||
+        node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+    if (level == 0) {
+      delete static_cast<Leaf*>(node);
+      return;
+    }
+    auto* inner = static_cast<Inner*>(node);
+    for (Node* child : inner->children) {
+      release(child, level - kBits);
+    }
+    delete inner;
+  }
+
+  static bool isUnique(const Node* node) noexcept {
+    return node->refs.load(std::memory_order_acquire) == 1;
+  }
+
+  static Leaf* copyLeaf(Leaf* leaf) {
+    auto* copy = new Leaf;
+    ECX_TRY {
+      for (; copy->count < leaf->count; ++copy->count) {
+        std::construct_at(copy->values() + copy->count,
+                          leaf->values()[copy->count]);
+      }
+    } ECX_CATCH_ALL {
+      // Destroys the elements copied so far.
+      delete copy;
+      ECX_RETHROW;
+    }
+    return copy;
+  }
+
+  /**
+   * Makes the node in slot exclusively ours, replacing it with a copy if it
+   * is shared, and returns it. A copied inner node shares its children.
+   */
+  template <typename Slot>
+  static Leaf* editableLeaf(Slot& slot) {
+    auto* leaf = static_cast<Leaf*>(slot);
+    if (!isUnique(leaf)) {
+      Leaf* copy = copyLeaf(leaf);
+      release(leaf, 0);
+      slot = copy;
+      return copy;
+    }
+    return leaf;
+  }
+
+  static Inner* editableInner(Node*& slot, unsigned level) {
+    auto* inner = static_cast<Inner*>(slot);
+    if (!isUnique(inner)) {
+      auto* copy = new Inner;
+      for (SizeT i = 0; i < kBranch; ++i) {
+        copy->children[i] = retain(inner->children[i]);
+      }
+      release(inner, level);
+      slot = copy;
+      return copy;
+    }
+    return inner;
+  }
+
+  // A chain of single-child inner nodes from level down to leaf. If it
+  // throws, it frees the nodes it made and leaves leaf to its owner.
+  static Node* newPath(unsigned level, Leaf* leaf) {
+    Node* node = leaf;
+    ECX_TRY {
+      for (unsigned depth = kBits; depth <= level; depth += kBits) {
+        auto* inner = new Inner;
+        inner->children[0] = node;
+        node = inner;
+      }
+    } ECX_CATCH_ALL {
+      while (node != leaf) {
+        auto* inner = static_cast<Inner*>(node);
+        node = inner->children[0];
+        delete inner;
+      }
+      ECX_RETHROW;
+    }
+    return node;
+  }
+
+  // The index of the first element in the tail.
+  SizeT tailOffset() const noexcept {
+    return size_ < kBranch ? 0 : ((size_ - 1) >> kBits) << kBits;
+  }
+
+  Leaf* leafFor(SizeT i) const noexcept {
+    if (i >= tailOffset()) {
+      return tail_;
+    }
+    Node* node = root_;
+    for (unsigned level = shift_; level > 0; level -= kBits) {
+      node = static_cast<Inner*>(node)->children[(i >> level) & kMask];
+    }
+    return static_cast<Leaf*>(node);
+  }
+
+  void pushBackInPlace(T value) {
+    if (tail_ == nullptr) {
+      tail_ = new Leaf;
+    } else if (tail_->count == kBranch) {
+      // Fills the new tail before linking the full one into the tree, and
+      // commits only once both succeed, so a throw changes nothing.
+      auto* tail = new Leaf;
+      ECX_TRY {
+        std::construct_at(tail->values(), std::move(value));
+        tail->count = 1;
+        pushTailIntoTree();
+      } ECX_CATCH_ALL {
+        delete tail;
+        ECX_RETHROW;
+      }
+      // The tree now holds the full tail's reference.
+      tail_ = tail;
+      ++size_;
+      return;
+    } else {
+      editableLeaf(tail_);
+    }
+    std::construct_at(tail_->values() + tail_->count, std::move(value));
+    ++tail_->count;
+    ++size_;
+  }
+
+  // Links the full tail into the tree, growing the tree by a level if it is
+  // full, and leaves tail_ for the caller to replace. The tail is linked
+  // last, so a throw leaves the tree without it.
+  void pushTailIntoTree() {
+    Leaf* leaf = tail_;
+    if (root_ == nullptr) {
+      root_ = newPath(shift_, leaf);
+    } else if ((size_ >> kBits) > (SizeT{1} << shift_)) {
+      auto* root = new Inner;
+      ECX_TRY {
+        root->children[1] = newPath(shift_, leaf);
+      } ECX_CATCH_ALL {
+        delete root;
+        ECX_RETHROW;
+      }
+      root->children[0] = root_;
+      root_ = root;
+      shift_ += kBits;
+    } else {
+      pushTail(root_, shift_, leaf);
+    }
+  }
+
+  void pushTail(Node*& slot, unsigned level, Leaf* leaf) {
+    Inner* inner = editableInner(slot, level);
+    Node*& child = inner->children[((size_ - 1) >> level) & kMask];
+    if (level == kBits) {
+      child = leaf;
+    } else if (child == nullptr) {
+      child = newPath(level - kBits, leaf);
+    } else {
+      pushTail(child, level - kBits, leaf);
+    }
+  }
+
+  void setInPlace(SizeT i, T value) {
+    if (i >= tailOffset()) {
+      editableLeaf(tail_)->values()[i & kMask] = std::move(value);
+      return;
+    }
+    Node** slot = &root_;
+    for (unsigned level = shift_; level > 0; level -= kBits) {
+      slot = &editableInner(*slot, level)->children[(i >> level) & kMask];
+    }
+    editableLeaf(*slot)->values()[i & kMask] = std::move(value);
+  }
+
+  void popBackInPlace() {
+    if (size_ - tailOffset() > 1) {
+      Leaf* tail = editableLeaf(tail_);
+      --tail->count;
+      std::destroy_at(tail->values() + tail->count);
+      --size_;
+      return;
+    }
+    if (size_ == 1) {
+      release(std::exchange(tail_, nullptr), 0);
+      size_ = 0;
+      return;
+    }
+
+    // The tail empties: the last leaf of the tree becomes the tail.
+    Leaf* newTail = retain(leafFor(size_ - 2));
+    release(std::exchange(tail_, newTail), 0);
+    popTail(root_, shift_);
+    --size_;
+    if (root_ == nullptr) {
+      shift_ = kBits;
+    } else if (auto* root = static_cast<Inner*>(root_);
+               shift_ > kBits && root->children[1] == nullptr) {
+      root_ = retain(root->children[0]);
+      release(root, shift_);
+      shift_ -= kBits;
+    }
+  }
+
+  // Removes the last leaf under slot, and slot itself if that empties it.
+  void popTail(Node*& slot, unsigned level) {
+    const SizeT child = ((size_ - 2) >> level) & kMask;
+    if (child == 0 && (level == kBits || isOnlyPath(slot, level))) {
+      release(std::exchange(slot, nullptr), level);
+      return;
+    }
+    Inner* inner = editableInner(slot, level);
+    if (level == kBits) {
+      release(std::exchange(inner->children[child], nullptr), 0);
+    } else {
+      popTail(inner->children[child], level - kBits);
+    }
+  }
+
+  // Whether the subtree under node holds just one leaf, the one being
+  // popped, which is then its first.
+  bool isOnlyPath(Node* node, unsigned level) const noexcept {
+    for (; level > kBits; level -= kBits) {
+      auto* inner = static_cast<Inner*>(node);
+      if (inner->children[1] != nullptr) {
+        return false;
+      }
+      node = inner->children[0];
+    }
+    return static_cast<Inner*>(node)->children[1] == nullptr;
+  }
+
+  Node* root_ = nullptr;
+  Leaf* tail_ = nullptr;
+  SizeT size_ = 0;
+  // Bits to shift an index right by to get its slot in the root.
+  unsigned shift_ = kBits;
+};
+
+}  // namespace ecx::stl
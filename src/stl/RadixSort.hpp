@@ -0,0 +1,418 @@
+#pragma once
+
+#include <algorithm>
+#include <barrier>
+#include <climits>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <latch>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "src/stl/Exceptions.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+/**
+ * Maps an element to the unsigned integer key that the radix sorts operate
+ * on. The mapping must be order-preserving, i.e. a < b iff key(a) < key(b).
+ *
+ * Specialisations are provided for:
+ * 1. Unsigned integers: the identity.
+ * 2. Signed integers: flip the sign bit so that negatives order first.
+ * 3. std::pair<K, V>: the key of `first`, so key-value pairs sort by key.
+ */
+template <typename T>
+struct RadixKey;
+
+template <std::unsigned_integral T>
+struct RadixKey<T> {
+  using KeyT = T;
+
+  static constexpr KeyT get(T value) noexcept { return value; }
+};
+
+template <std::signed_integral T>
+struct RadixKey<T> {
+  using KeyT = std::make_unsigned_t<T>;
+
+  static constexpr KeyT get(T value) noexcept {
+    return static_cast<KeyT>(value) ^
+           (KeyT{1} << (sizeof(KeyT) * CHAR_BIT - 1));
+  }
+};
+
+template <typename K, typename V>
+struct RadixKey<std::pair<K, V>> {
+  using KeyT = typename RadixKey<K>::KeyT;
+
+  static constexpr KeyT get(const std::pair<K, V>& kv) noexcept {
+    return RadixKey<K>::get(kv.first);
+  }
+};
+
+template <typename T>
+concept RadixSortable = requires(const T& value) {
+  { RadixKey<T>::get(value) } -> std::unsigned_integral;
+} && std::default_initializable<T> && std::movable<T>;
+
+/**
+ * Reusable scratch space for the out-of-place radix sorts: the ping-pong
+ * buffer and the digit histograms.
+ * Sorting repeatedly with the same scratch only allocates when the input
+ * outgrows every input seen so far.
+ */
+template <RadixSortable T>
+class RadixSortScratch {
+ public:
+  using SizeT = std::size_t;
+
+  explicit RadixSortScratch() = default;
+
+  void reserve(SizeT n) {
+    if (buffer_.size() < n) {
+      buffer_.resize(n);
+    }
+  }
+
+  SizeT capacity() const noexcept { return buffer_.size(); }
+
+ private:
+  template <unsigned, RadixSortable U, typename Allocator>
+  friend void radixSort(Vector<U, Allocator>&, RadixSortScratch<U>&);
+
+  template <unsigned, RadixSortable U, typename Allocator, typename Spawn>
+  friend void parallelRadixSort(Vector<U, Allocator>&, RadixSortScratch<U>&,
+                                unsigned, Spawn);
+
+  SizeT* counts(SizeT n) {
+    if (counts_.size() < n) {
+      counts_.resize(n);
+    }
+    std::fill_n(counts_.data(), n, SizeT{0});
+    return counts_.data();
+  }
+
+  Vector<T> buffer_;
+  Vector<SizeT> counts_;
+};
+
+namespace detail {
+
+// Below this, the constant factor of histogramming dominates.
+inline constexpr std::size_t kRadixInsertionSortThreshold = 64;
+
+// Elements ahead of the current one to prefetch while histogramming.
+inline constexpr std::size_t kRadixPrefetchDistance = 16;
+
+template <typename T>
+using RadixKeyT = typename RadixKey<T>::KeyT;
+
+template <unsigned DigitBits, typename KeyT>
+constexpr std::size_t digitOf(KeyT key, unsigned digit) noexcept {
+  constexpr KeyT mask = (KeyT{1} << DigitBits) - 1;
+  return static_cast<std::size_t>((key >> (digit * DigitBits)) & mask);
+}
+
+// Starts a parallelRadixSort worker on its own thread.
+struct SpawnRadixWorker {
+  template <typename Fn>
+  std::jthread operator()(Fn& worker, unsigned t) const {
+    return std::jthread(worker, t);
+  }
+};
+
+template <typename T>
+void insertionSortByKey(T* first, T* last) {
+  for (T* i = first + 1; i < last; ++i) {
+    T value = std::move(*i);
+    auto key = RadixKey<T>::get(value);
+    T* j = i;
+    for (; j > first && key < RadixKey<T>::get(*(j - 1)); --j) {
+      *j = std::move(*(j - 1));
+    }
+    *j = std::move(value);
+  }
+}
+
+/**
+ * American flag sort: an in-place MSD radix sort on 8-bit digits.
+ * Each level permutes elements into their buckets by cycle-walking, then
+ * recurses into each bucket on the next lower digit.
+ */
+template <typename T>
+void msdRadixSort(T* first, T* last, int digit) {
+  using SizeT = std::size_t;
+  constexpr unsigned kDigitBits = 8;
+  constexpr SizeT kRadix = SizeT{1} << kDigitBits;
+
+  auto n = static_cast<SizeT>(last - first);
+  if (n <= kRadixInsertionSortThreshold) {
+    insertionSortByKey(first, last);
+    return;
+  }
+
+  SizeT counts[kRadix] = {};
+  for (T* it = first; it != last; ++it) {
+    ++counts[digitOf<kDigitBits>(RadixKey<T>::get(*it), digit)];
+  }
+
+  SizeT heads[kRadix];
+  SizeT tails[kRadix];
+  SizeT offset = 0;
+  for (SizeT b = 0; b < kRadix; ++b) {
+    heads[b] = offset;
+    offset += counts[b];
+    tails[b] = offset;
+  }
+
+  for (SizeT b = 0; b < kRadix; ++b) {
+    while (heads[b] < tails[b]) {
+      T& slot = first[heads[b]];
+      SizeT target = digitOf<kDigitBits>(RadixKey<T>::get(slot), digit);
+      if (target == b) {
+        ++heads[b];
+        continue;
+      }
+      // Swap the misplaced element into its bucket, and keep walking the
+      // cycle with whatever came back.
+      using std::swap;
+      swap(slot, first[heads[target]++]);
+    }
+  }
+
+  if (digit == 0) {
+    return;
+  }
+
+  T* bucket = first;
+  for (SizeT b = 0; b < kRadix; ++b) {
+    if (counts[b] > 1) {
+      msdRadixSort(bucket, bucket + counts[b], digit - 1);
+    }
+    bucket += counts[b];
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Stable LSD radix sort of `vec` by RadixKey, using `scratch` as the
+ * ping-pong buffer.
+ *
+ * DigitBits trades histogram size for passes: 8-bit digits keep the
+ * histograms in L1, while 11 and 16-bit digits need fewer passes over the
+ * data (e.g. 6 and 4 passes for 64-bit keys, against 8).
+ *
+ * The histograms of every digit are built in a single prefetching pass over
+ * the input. A digit whose histogram has a single non-empty bucket cannot
+ * reorder anything, so its scatter pass is skipped entirely; this makes small
+ * keys stored in wide integers proportionally cheaper.
+ */
+template <unsigned DigitBits = 8, RadixSortable T, typename Allocator>
+void radixSort(Vector<T, Allocator>& vec, RadixSortScratch<T>& scratch) {
+  using SizeT = std::size_t;
+  using KeyT = detail::RadixKeyT<T>;
+  static_assert(DigitBits > 0 && DigitBits <= 16,
+                "Digits wider than 16 bits have histograms exceeding L2");
+
+  constexpr SizeT kRadix = SizeT{1} << DigitBits;
+  constexpr unsigned kKeyBits = sizeof(KeyT) * CHAR_BIT;
+  constexpr unsigned kDigits = (kKeyBits + DigitBits - 1) / DigitBits;
+
+  const SizeT n = vec.size();
+  if (n <= detail::kRadixInsertionSortThreshold) {
+    detail::insertionSortByKey(vec.data(), vec.data() + n);
+    return;
+  }
+
+  scratch.reserve(n);
+  SizeT* counts = scratch.counts(kDigits * kRadix);
+
+  T* src = vec.data();
+  for (SizeT i = 0; i < n; ++i) {
+    if (i + detail::kRadixPrefetchDistance < n) {
+      __builtin_prefetch(src + i + detail::kRadixPrefetchDistance);
+    }
+    KeyT key = RadixKey<T>::get(src[i]);
+    for (unsigned d = 0; d < kDigits; ++d) {
+      ++counts[d * kRadix + detail::digitOf<DigitBits>(key, d)];
+    }
+  }
+
+  T* dst = scratch.buffer_.data();
+  for (unsigned d = 0; d < kDigits; ++d) {
+    SizeT* digitCounts = counts + d * kRadix;
+    if (digitCounts[detail::digitOf<DigitBits>(RadixKey<T>::get(*src), d)] ==
+        n) {
+      continue;
+    }
+
+    SizeT offset = 0;
+    for (SizeT b = 0; b < kRadix; ++b) {
+      offset += std::exchange(digitCounts[b], offset);
+    }
+
+    for (SizeT i = 0; i < n; ++i) {
+      SizeT b = detail::digitOf<DigitBits>(RadixKey<T>::get(src[i]), d);
+      dst[digitCounts[b]++] = std::move(src[i]);
+    }
+    std::swap(src, dst);
+  }
+
+  if (src != vec.data()) {
+    std::move(src, src + n, vec.data());
+  }
+}
+
+template <unsigned DigitBits = 8, RadixSortable T, typename Allocator>
+void radixSort(Vector<T, Allocator>& vec) {
+  RadixSortScratch<T> scratch;
+  radixSort<DigitBits>(vec, scratch);
+}
+
+/**
+ * In-place MSD radix sort (American flag sort) on 8-bit digits.
+ * Needs no scratch buffer, at the cost of stability: key-value pairs with
+ * equal keys may be reordered.
+ */
+template <RadixSortable T, typename Allocator>
+void radixSortInPlace(Vector<T, Allocator>& vec) {
+  using KeyT = detail::RadixKeyT<T>;
+  constexpr int kTopDigit = static_cast<int>(sizeof(KeyT)) - 1;
+
+  detail::msdRadixSort(vec.data(), vec.data() + vec.size(), kTopDigit);
+}
+
+/**
+ * Multi-threaded stable LSD radix sort.
+ *
+ * The input is split into one contiguous chunk per thread. For every digit,
+ * each thread histograms its own chunk; the per-thread histograms are then
+ * prefix-summed bucket-major, thread-minor, which gives every thread a
+ * disjoint set of output ranges to scatter into without synchronisation,
+ * while preserving stability.
+ * Threads are started once and step through the passes in lockstep on a
+ * barrier, whose completion step does the (serial, tiny) prefix sum.
+ *
+ * spawn starts each worker thread. If it fails part-way, the sort runs on
+ * the threads that did start, down to the calling thread alone.
+ */
+template <unsigned DigitBits = 8, RadixSortable T, typename Allocator,
+          typename Spawn = detail::SpawnRadixWorker>
+void parallelRadixSort(
+    Vector<T, Allocator>& vec, RadixSortScratch<T>& scratch,
+    unsigned numThreads = std::thread::hardware_concurrency(),
+    Spawn spawn = {}) {
+  using SizeT = std::size_t;
+  using KeyT = detail::RadixKeyT<T>;
+  static_assert(DigitBits > 0 && DigitBits <= 16,
+                "Digits wider than 16 bits have histograms exceeding L2");
+
+  constexpr SizeT kRadix = SizeT{1} << DigitBits;
+  constexpr unsigned kKeyBits = sizeof(KeyT) * CHAR_BIT;
+  constexpr unsigned kDigits = (kKeyBits + DigitBits - 1) / DigitBits;
+  // Splitting less than this per thread costs more in coordination than it
+  // saves.
+  constexpr SizeT kMinChunk = SizeT{1} << 16;
+
+  const SizeT n = vec.size();
+  numThreads = static_cast<unsigned>(
+      std::clamp<SizeT>(n / kMinChunk, 1, std::max(numThreads, 1U)));
+  if (numThreads == 1) {
+    radixSort<DigitBits>(vec, scratch);
+    return;
+  }
+
+  scratch.reserve(n);
+  SizeT* counts = scratch.counts(numThreads * kRadix);
+
+  T* src = vec.data();
+  T* dst = scratch.buffer_.data();
+  unsigned digit = 0;
+  bool skip = false;
+
+  auto prefixSum = [&]() noexcept {
+    SizeT offset = 0;
+    skip = false;
+    for (SizeT b = 0; b < kRadix; ++b) {
+      const SizeT bucketBegin = offset;
+      for (unsigned t = 0; t < numThreads; ++t) {
+        offset += std::exchange(counts[t * kRadix + b], offset);
+      }
+      skip = skip || offset - bucketBegin == n;
+    }
+  };
+  auto nextDigit = [&]() noexcept {
+    if (!skip) {
+      std::swap(src, dst);
+    }
+    ++digit;
+  };
+  // Sized once the threads have started, as that many must arrive.
+  std::optional<std::barrier<decltype(prefixSum)>> histogrammed;
+  std::optional<std::barrier<decltype(nextDigit)>> scattered;
+  std::latch started(1);
+
+  auto worker = [&](unsigned t) {
+    started.wait();
+    const SizeT begin = n * t / numThreads;
+    const SizeT end = n * (t + 1) / numThreads;
+    SizeT* local = counts + t * kRadix;
+
+    while (digit < kDigits) {
+      std::fill_n(local, kRadix, SizeT{0});
+      for (SizeT i = begin; i < end; ++i) {
+        if (i + detail::kRadixPrefetchDistance < n) {
+          __builtin_prefetch(src + i + detail::kRadixPrefetchDistance);
+        }
+        ++local[detail::digitOf<DigitBits>(RadixKey<T>::get(src[i]), digit)];
+      }
+      histogrammed->arrive_and_wait();
+
+      if (!skip) {
+        for (SizeT i = begin; i < end; ++i) {
+          SizeT b =
+              detail::digitOf<DigitBits>(RadixKey<T>::get(src[i]), digit);
+          dst[local[b]++] = std::move(src[i]);
+        }
+      }
+      scattered->arrive_and_wait();
+    }
+  };
+
+  {
+    Vector<std::jthread> workers;
+    workers.reserve(numThreads - 1);
+    ECX_TRY {
+      for (unsigned t = 1; t < numThreads; ++t) {
+        workers.push_back(spawn(worker, t));
+      }
+    } ECX_CATCH_ALL {
+      // Sorts with the threads that did start.
+    }
+    numThreads = static_cast<unsigned>(workers.size()) + 1;
+    histogrammed.emplace(numThreads, prefixSum);
+    scattered.emplace(numThreads, nextDigit);
+    started.count_down();
+    worker(0);
+  }
+
+  if (src != vec.data()) {
+    std::move(src, src + n, vec.data());
+  }
+}
+
+template <unsigned DigitBits = 8, RadixSortable T, typename Allocator>
+void parallelRadixSort(
+    Vector<T, Allocator>& vec,
+    unsigned numThreads = std::thread::hardware_concurrency()) {
+  RadixSortScratch<T> scratch;
+  parallelRadixSort<DigitBits>(vec, scratch, numThreads);
+}
+
+}  // namespace ecx::stl
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <ranges>
+#include <type_traits>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+inline constexpr std::size_t kDynamicExtent =
+    std::numeric_limits<std::size_t>::max();
+
+namespace detail {
+
+// The size of a Span, stored only if it is not known at compile time.
+template <std::size_t Extent>
+struct SpanExtent {
+  constexpr SpanExtent() noexcept = default;
+
+  constexpr explicit SpanExtent(std::size_t) noexcept {}
+
+  static constexpr std::size_t size() noexcept { return Extent; }
+};
+
+template <>
+struct SpanExtent<kDynamicExtent> {
+  constexpr SpanExtent() noexcept = default;
+
+  constexpr explicit SpanExtent(std::size_t size) noexcept : size_(size) {}
+
+  constexpr std::size_t size() const noexcept { return size_; }
+
+  std::size_t size_ = 0;
+};
+
+// Whether elements of From can be viewed as To, i.e. To is From, or const
+// From.
+template <typename From, typename To>
+concept SpanConvertible = std::is_convertible_v<From (*)[], To (*)[]>;
+
+}  // namespace detail
+
+/**
+ * Non-owning view over a contiguous sequence, modelled on std::span.
+ *
+ * With a static Extent, the size is part of the type: a Span<float, 8> is a
+ * single pointer, and loops over it have a compile-time trip count for the
+ * compiler to unroll and vectorise. With kDynamicExtent, the size is stored
+ * alongside the pointer.
+ *
+ * A Span does not keep its storage alive; one taken over a Vector is
+ * invalidated by anything that reallocates the Vector.
+ */
+template <typename T, std::size_t Extent = kDynamicExtent>
+class Span {
+ public:
+  using SizeT = std::size_t;
+  using ValueT = std::remove_cv_t<T>;
+  using ElementT = T;
+  using PointerT = T*;
+  using ReferenceT = T&;
+  using IteratorT = T*;
+  using ReverseIteratorT = std::reverse_iterator<IteratorT>;
+
+  static constexpr SizeT kExtent = Extent;
+
+  constexpr Span() noexcept
+    requires(Extent == kDynamicExtent || Extent == 0)
+  = default;
+
+  /**
+   * Views [data, data + size). For a static extent, size must equal Extent.
+   */
+  constexpr explicit(Extent != kDynamicExtent)
+      Span(PointerT data, SizeT size) noexcept
+      : data_(data), extent_(size) {}
+
+  template <SizeT N>
+    requires(Extent == kDynamicExtent || Extent == N)
+  constexpr Span(T (&array)[N]) noexcept : data_(array), extent_(N) {}
+
+  template <typename U, SizeT N>
+    requires(Extent == kDynamicExtent || Extent == N) &&
+            detail::SpanConvertible<U, T>
+  constexpr Span(std::array<U, N>& array) noexcept
+      : data_(array.data()), extent_(N) {}
+
+  template <typename U, SizeT N>
+    requires(Extent == kDynamicExtent || Extent == N) &&
+            detail::SpanConvertible<const U, T>
+  constexpr Span(const std::array<U, N>& array) noexcept
+      : data_(array.data()), extent_(N) {}
+
+  template <typename U, typename Allocator>
+    requires detail::SpanConvertible<U, T>
+  constexpr explicit(Extent != kDynamicExtent)
+      Span(Vector<U, Allocator>& vector) noexcept
+      : data_(vector.data()), extent_(vector.size()) {}
+
+  template <typename U, typename Allocator>
+    requires detail::SpanConvertible<const U, T>
+  constexpr explicit(Extent != kDynamicExtent)
+      Span(const Vector<U, Allocator>& vector) noexcept
+      : data_(vector.data()), extent_(vector.size()) {}
+
+  /**
+   * Conversion between spans, e.g. adding const or forgetting a static
+   * extent. Narrowing a dynamic extent to a static one must be explicit.
+   */
+  template <typename U, SizeT OtherExtent>
+    requires(Extent == kDynamicExtent || OtherExtent == kDynamicExtent ||
+             Extent == OtherExtent) &&
+            detail::SpanConvertible<U, T>
+  constexpr explicit(Extent != kDynamicExtent &&
+                     OtherExtent == kDynamicExtent)
+      Span(const Span<U, OtherExtent>& other) noexcept
+      : data_(other.data()), extent_(other.size()) {}
+
+  constexpr Span(const Span&) noexcept = default;
+  constexpr Span& operator=(const Span&) noexcept = default;
+
+  constexpr PointerT data() const noexcept { return data_; }
+
+  constexpr SizeT size() const noexcept { return extent_.size(); }
+
+  constexpr SizeT sizeBytes() const noexcept { return size() * sizeof(T); }
+
+  [[nodiscard]] constexpr bool empty() const noexcept { return size() == 0; }
+
+  constexpr ReferenceT operator[](SizeT i) const noexcept { return data_[i]; }
+
+  constexpr ReferenceT front() const noexcept { return data_[0]; }
+
+  constexpr ReferenceT back() const noexcept { return data_[size() - 1]; }
+
+  constexpr IteratorT begin() const noexcept { return data_; }
+
+  constexpr IteratorT end() const noexcept { return data_ + size(); }
+
+  constexpr ReverseIteratorT rbegin() const noexcept {
+    return ReverseIteratorT(end());
+  }
+
+  constexpr ReverseIteratorT rend() const noexcept {
+    return ReverseIteratorT(begin());
+  }
+
+  /**
+   * Subviews. The forms taking the count as a template argument produce a
+   * static extent.
+   */
+  template <SizeT Count>
+    requires(Extent == kDynamicExtent || Count <= Extent)
+  constexpr Span<T, Count> first() const noexcept {
+    return Span<T, Count>(data_, Count);
+  }
+
+  constexpr Span<T> first(SizeT count) const noexcept {
+    return Span<T>(data_, count);
+  }
+
+  template <SizeT Count>
+    requires(Extent == kDynamicExtent || Count <= Extent)
+  constexpr Span<T, Count> last() const noexcept {
+    return Span<T, Count>(data_ + (size() - Count), Count);
+  }
+
+  constexpr Span<T> last(SizeT count) const noexcept {
+    return Span<T>(data_ + (size() - count), count);
+  }
+
+  template <SizeT Offset, SizeT Count = kDynamicExtent>
+    requires(Extent == kDynamicExtent ||
+             (Offset <= Extent &&
+              (Count == kDynamicExtent || Count <= Extent - Offset)))
+  constexpr auto subspan() const noexcept {
+    constexpr SizeT kSubExtent =
+        Count != kDynamicExtent
+            ? Count
+            : (Extent != kDynamicExtent ? Extent - Offset : kDynamicExtent);
+    return Span<T, kSubExtent>(
+        data_ + Offset, Count != kDynamicExtent ? Count : size() - Offset);
+  }
+
+  constexpr Span<T> subspan(SizeT offset,
+                            SizeT count = kDynamicExtent) const noexcept {
+    return Span<T>(data_ + offset,
+                   count != kDynamicExtent ? count : size() - offset);
+  }
+
+ private:
+  PointerT data_ = nullptr;
+  [[no_unique_address]] detail::SpanExtent<Extent> extent_;
+};
+
+template <typename T, std::size_t N>
+Span(T (&)[N]) -> Span<T, N>;
+
+template <typename T, std::size_t N>
+Span(std::array<T, N>&) -> Span<T, N>;
+
+template <typename T, std::size_t N>
+Span(const std::array<T, N>&) -> Span<const T, N>;
+
+template <typename T, typename Allocator>
+Span(Vector<T, Allocator>&) -> Span<T>;
+
+template <typename T, typename Allocator>
+Span(const Vector<T, Allocator>&) -> Span<const T>;
+
+/**
+ * The object representation of the viewed elements.
+ */
+template <typename T, std::size_t Extent>
+auto asBytes(Span<T, Extent> span) noexcept {
+  constexpr std::size_t kBytes =
+      Extent == kDynamicExtent ? kDynamicExtent : Extent * sizeof(T);
+  return Span<const std::byte, kBytes>(
+      reinterpret_cast<const std::byte*>(span.data()), span.sizeBytes());
+}
+
+template <typename T, std::size_t Extent>
+  requires(!std::is_const_v<T>)
+auto asWritableBytes(Span<T, Extent> span) noexcept {
+  constexpr std::size_t kBytes =
+      Extent == kDynamicExtent ? kDynamicExtent : Extent * sizeof(T);
+  return Span<std::byte, kBytes>(reinterpret_cast<std::byte*>(span.data()),
+                                 span.sizeBytes());
+}
+
+}  // namespace ecx::stl
+
+// Spans are cheap to copy and do not own their elements, so they can be
+// passed to and returned from range algorithms freely.
+namespace std::ranges {
+
+template <typename T, std::size_t Extent>
+inline constexpr bool enable_borrowed_range<ecx::stl::Span<T, Extent>> = true;
+
+template <typename T, std::size_t Extent>
+inline constexpr bool enable_view<ecx::stl::Span<T, Extent>> = true;
+
+}  // namespace std::ranges
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "src/stl/CoroutineFrame.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+template <typename T>
+class TaskResult {
+ public:
+  template <typename U = T>
+  void return_value(U&& value) noexcept(
+      std::is_nothrow_constructible_v<T, U&&>) {
+    ::new (static_cast<void*>(std::addressof(value_)))
+        T(std::forward<U>(value));
+    hasValue_ = true;
+  }
+
+  void unhandled_exception() noexcept {
+    exception_ = std::current_exception();
+  }
+
+  T takeResult() {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+    return std::move(value_);
+  }
+
+ protected:
+  TaskResult() noexcept {}
+
+  ~TaskResult() {
+    if (hasValue_) {
+      value_.~T();
+    }
+  }
+
+ private:
+  union {
+    T value_;
+  };
+  bool hasValue_ = false;
+  std::exception_ptr exception_;
+};
+
+template <>
+class TaskResult<void> {
+ public:
+  void return_void() const noexcept {}
+
+  void unhandled_exception() noexcept {
+    exception_ = std::current_exception();
+  }
+
+  void takeResult() {
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+ private:
+  std::exception_ptr exception_;
+};
+
+}  // namespace detail
+
+/**
+ * Lazily started, single-consumer asynchronous computation.
+ *
+ * A Task does not run until it is awaited (or started by an event loop).
+ * Awaiting it transfers control into it, and its completion transfers control
+ * straight back to the awaiter; both use symmetric transfer, so long chains of
+ * tasks that complete synchronously run in constant stack space (as long as
+ * the compiler emits the transfer as a tail call, which GCC only does when
+ * optimising).
+ *
+ * Exceptions escaping the task body are captured, and rethrown to the
+ * awaiter.
+ *
+ * The frame allocation can be redirected, see AllocatorAwarePromise.
+ */
+template <typename T>
+class Task {
+ public:
+  using ValueT = T;
+
+  class promise_type;
+  using HandleT = std::coroutine_handle<promise_type>;
+
+  class promise_type : public AllocatorAwarePromise,
+                       public detail::TaskResult<T> {
+   public:
+    Task get_return_object() noexcept {
+      return Task(HandleT::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    auto final_suspend() noexcept { return FinalAwaiter{}; }
+
+   private:
+    friend class Task;
+
+    struct FinalAwaiter {
+      bool await_ready() const noexcept { return false; }
+
+      std::coroutine_handle<> await_suspend(HandleT handle) noexcept {
+        if (auto continuation = handle.promise().continuation_) {
+          return continuation;
+        }
+        return std::noop_coroutine();
+      }
+
+      void await_resume() const noexcept {}
+    };
+
+    std::coroutine_handle<> continuation_{};
+  };
+
+  explicit Task() noexcept = default;
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+
+  ~Task() { destroy(); }
+
+  /**
+   * Awaits completion and yields the result (or rethrows).
+   */
+  auto operator co_await() && noexcept {
+    struct Awaiter : ReadyAwaiter {
+      T await_resume() { return this->handle.promise().takeResult(); }
+    };
+    return Awaiter{{handle_}};
+  }
+
+  /**
+   * Awaits completion without consuming the result, which can be taken later
+   * with result().
+   */
+  auto whenReady() noexcept { return ReadyAwaiter{handle_}; }
+
+  /**
+   * Runs the task from the top without an awaiter, e.g. from an event loop;
+   * it runs until its first suspension.
+   */
+  void start() { handle_.resume(); }
+
+  bool done() const noexcept { return !handle_ || handle_.done(); }
+
+  /**
+   * The result of a completed task (or rethrows its exception).
+   */
+  T result() && { return handle_.promise().takeResult(); }
+
+ private:
+  struct ReadyAwaiter {
+    HandleT handle;
+
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<> awaiter) noexcept {
+      handle.promise().continuation_ = awaiter;
+      return handle;
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  explicit Task(HandleT handle) noexcept : handle_(handle) {}
+
+  void destroy() noexcept {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  HandleT handle_{};
+};
+
+namespace detail {
+
+// Eagerly started coroutine that frees its own frame on completion.
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+/**
+ * Counts down the tasks of a whenAll, resuming the awaiter on the last one.
+ * The awaiter holds one count itself, released once every task has been
+ * started, so that tasks completing synchronously cannot resume it before it
+ * has suspended.
+ */
+class WhenAllLatch {
+ public:
+  explicit WhenAllLatch(std::size_t tasks) noexcept : remaining_(tasks + 1) {}
+
+  template <typename StartFn>
+  struct Awaiter {
+    WhenAllLatch& latch;
+    StartFn start;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiter) {
+      latch.awaiter_ = awaiter;
+      start();
+      return !latch.arrive();
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  // Returns whether this was the last arrival.
+  bool arrive() noexcept {
+    return remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  void arriveAndResume() {
+    if (arrive()) {
+      awaiter_.resume();
+    }
+  }
+
+ private:
+  std::atomic<std::size_t> remaining_;
+  std::coroutine_handle<> awaiter_{};
+};
+
+template <typename T>
+DetachedTask runAndArrive(Task<T>& task, WhenAllLatch& latch) {
+  co_await task.whenReady();
+  latch.arriveAndResume();
+}
+
+}  // namespace detail
+
+/**
+ * Runs every task concurrently, completing once all of them have. Yields the
+ * results in task order (nothing for Task<void>), or rethrows the exception of
+ * the first failed task.
+ */
+template <typename T>
+auto whenAll(Vector<Task<T>> tasks)
+    -> Task<std::conditional_t<std::is_void_v<T>, void, Vector<T>>> {
+  detail::WhenAllLatch latch(tasks.size());
+  auto startAll = [&] {
+    for (Task<T>& task : tasks) {
+      detail::runAndArrive(task, latch);
+    }
+  };
+  co_await detail::WhenAllLatch::Awaiter<decltype(startAll)>{latch, startAll};
+
+  if constexpr (std::is_void_v<T>) {
+    for (Task<T>& task : tasks) {
+      std::move(task).result();
+    }
+  } else {
+    Vector<T> results;
+    results.reserve(tasks.size());
+    for (Task<T>& task : tasks) {
+      results.push_back(std::move(task).result());
+    }
+    co_return results;
+  }
+}
+
+}  // namespace ecx::stl
@@ -0,0 +1,574 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "src/stl/Exceptions.hpp"
+
+namespace ecx::stl {
+
+namespace detail::compact {
+
+using SizeT = std::size_t;
+
+/**
+ * ThinVector's layout: a single pointer to the elements, null until the
+ * first allocation, with size and capacity in a header just before them.
+ * Reading size() costs a load through the pointer, which the element access
+ * that follows usually needs anyway.
+ */
+template <typename T, typename Allocator>
+class HeaderLayout {
+  struct Header {
+    SizeT size;
+    SizeT capacity;
+  };
+
+  // The buffer is allocated as Chunks, aligned for both Header and T; the
+  // elements start at the first multiple of alignof(T) past the header.
+  static constexpr SizeT kAlign = std::max(alignof(T), alignof(Header));
+  static constexpr SizeT kHeaderBytes =
+      (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+  struct alignas(kAlign) Chunk {
+    std::byte bytes[kAlign];
+  };
+
+  using ChunkAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Chunk>;
+  using ChunkTraits = std::allocator_traits<ChunkAllocator>;
+
+ public:
+  static constexpr const char* kName = "ThinVector";
+  static constexpr SizeT kMaxSize =
+      (std::numeric_limits<SizeT>::max() - kHeaderBytes - kAlign) / sizeof(T);
+
+  T* data() const noexcept { return data_; }
+
+  SizeT size() const noexcept {
+    return data_ == nullptr ? 0 : header(data_)->size;
+  }
+
+  SizeT capacity() const noexcept {
+    return data_ == nullptr ? 0 : header(data_)->capacity;
+  }
+
+  void setSize(SizeT n) noexcept {
+    if (data_ != nullptr) {
+      header(data_)->size = n;
+    }
+  }
+
+  /**
+   * Storage for capacity elements, with its header written; null for 0.
+   */
+  static T* allocate(Allocator& alloc, SizeT capacity) {
+    if (capacity == 0) {
+      return nullptr;
+    }
+    ChunkAllocator chunks(alloc);
+    auto* base = reinterpret_cast<std::byte*>(
+        ChunkTraits::allocate(chunks, chunksFor(capacity)));
+    ::new (base) Header{0, capacity};
+    return reinterpret_cast<T*>(base + kHeaderBytes);
+  }
+
+  static void deallocate(Allocator& alloc, T* data, SizeT capacity) noexcept {
+    if (data != nullptr) {
+      ChunkAllocator chunks(alloc);
+      ChunkTraits::deallocate(
+          chunks,
+          reinterpret_cast<Chunk*>(reinterpret_cast<std::byte*>(data) -
+                                   kHeaderBytes),
+          chunksFor(capacity));
+    }
+  }
+
+  void adopt(T* data, SizeT capacity, SizeT size) noexcept {
+    static_cast<void>(capacity);
+    data_ = data;
+    setSize(size);
+  }
+
+  void steal(HeaderLayout& other) noexcept {
+    data_ = std::exchange(other.data_, nullptr);
+  }
+
+ private:
+  static Header* header(T* data) noexcept {
+    return std::launder(reinterpret_cast<Header*>(
+        reinterpret_cast<std::byte*>(data) - kHeaderBytes));
+  }
+
+  static SizeT chunksFor(SizeT capacity) noexcept {
+    return (kHeaderBytes + capacity * sizeof(T) + kAlign - 1) / kAlign;
+  }
+
+  T* data_ = nullptr;
+};
+
+/**
+ * CompactVector's layout: Vector's three members, with 32-bit counts.
+ */
+template <typename T, typename Allocator>
+class CountedLayout {
+  using AllocTraits = std::allocator_traits<Allocator>;
+
+ public:
+  static constexpr const char* kName = "CompactVector";
+  static constexpr SizeT kMaxSize = std::numeric_limits<std::uint32_t>::max();
+
+  T* data() const noexcept { return data_; }
+
+  SizeT size() const noexcept { return size_; }
+
+  SizeT capacity() const noexcept { return capacity_; }
+
+  void setSize(SizeT n) noexcept { size_ = static_cast<std::uint32_t>(n); }
+
+  static T* allocate(Allocator& alloc, SizeT capacity) {
+    return capacity == 0 ? nullptr : AllocTraits::allocate(alloc, capacity);
+  }
+
+  static void deallocate(Allocator& alloc, T* data, SizeT capacity) noexcept {
+    if (data != nullptr) {
+      AllocTraits::deallocate(alloc, data, capacity);
+    }
+  }
+
+  void adopt(T* data, SizeT capacity, SizeT size) noexcept {
+    data_ = data;
+    capacity_ = static_cast<std::uint32_t>(capacity);
+    size_ = static_cast<std::uint32_t>(size);
+  }
+
+  void steal(CountedLayout& other) noexcept {
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    capacity_ = std::exchange(other.capacity_, 0);
+  }
+
+ private:
+  T* data_ = nullptr;
+  std::uint32_t size_ = 0;
+  std::uint32_t capacity_ = 0;
+};
+
+/**
+ * The Vector API over a Layout that decides where size and capacity are
+ * kept. Growth, exception safety and allocator handling follow Vector.
+ */
+template <typename T, typename Allocator, typename Layout>
+class SmallVector : private Allocator {
+  using AllocTraits = std::allocator_traits<Allocator>;
+
+  static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                "Allocator::value_type must be T");
+  static_assert(std::is_same_v<typename AllocTraits::pointer, T*>,
+                "Fancy pointers are not supported");
+
+ public:
+  using SizeT = std::size_t;
+  using ValueT = T;
+  using PointerT = T*;
+  using ConstPointerT = const T*;
+  using ReferenceT = T&;
+  using ConstReferenceT = const T&;
+  using IteratorT = T*;
+  using ConstIteratorT = const T*;
+  using AllocatorT = Allocator;
+  using allocator_type = Allocator;
+
+  static constexpr SizeT kMaxSize = Layout::kMaxSize;
+
+  explicit SmallVector() noexcept(noexcept(Allocator())) = default;
+
+  explicit SmallVector(const Allocator& alloc) noexcept : Allocator(alloc) {}
+
+  explicit SmallVector(SizeT n, const Allocator& alloc = Allocator())
+      : SmallVector(alloc) {
+    resize(n);
+  }
+
+  explicit SmallVector(SizeT n, ConstReferenceT init,
+                       const Allocator& alloc = Allocator())
+      : SmallVector(alloc) {
+    resize(n, init);
+  }
+
+  SmallVector(std::initializer_list<ValueT> init,
+              const Allocator& alloc = Allocator())
+      : SmallVector(alloc) {
+    assignCopy(init.begin(), init.size());
+  }
+
+  SmallVector(const SmallVector& other)
+      : SmallVector(other, AllocTraits::select_on_container_copy_construction(
+                               other.allocator())) {}
+
+  // Exact-fit, like Vector's copies.
+  SmallVector(const SmallVector& other, const Allocator& alloc)
+      : SmallVector(alloc) {
+    assignCopy(other.data(), other.size());
+  }
+
+  SmallVector& operator=(const SmallVector& other) {
+    if (this == &other) {
+      return *this;
+    }
+
+    if constexpr (kPropagateOnCopy) {
+      if (!kAlwaysEqual && allocator() != other.allocator()) {
+        release();
+      }
+      allocator() = other.allocator();
+    }
+    assignCopy(other.data(), other.size());
+    return *this;
+  }
+
+  SmallVector(SmallVector&& other) noexcept
+      : Allocator(std::move(other.allocator())) {
+    layout_.steal(other.layout_);
+  }
+
+  SmallVector& operator=(SmallVector&& other) noexcept(kPropagateOnMove ||
+                                                       kAlwaysEqual) {
+    if (this == &other) {
+      return *this;
+    }
+
+    if constexpr (kPropagateOnMove || kAlwaysEqual) {
+      release();
+      if constexpr (kPropagateOnMove) {
+        allocator() = std::move(other.allocator());
+      }
+      layout_.steal(other.layout_);
+    } else if (allocator() == other.allocator()) {
+      release();
+      layout_.steal(other.layout_);
+    } else {
+      // Memory from a different allocator cannot be adopted.
+      SmallVector temp(allocator());
+      temp.reserve(other.size());
+      temp.constructN(temp.data(), other.size(), [&](PointerT p, SizeT i) {
+        temp.constructAt(p, std::move(other.data()[i]));
+      });
+      temp.layout_.setSize(other.size());
+      release();
+      layout_.steal(temp.layout_);
+    }
+    return *this;
+  }
+
+  ~SmallVector() { release(); }
+
+  AllocatorT getAllocator() const noexcept { return allocator(); }
+
+  IteratorT begin() noexcept { return data(); }
+
+  IteratorT end() noexcept { return data() + size(); }
+
+  ConstIteratorT begin() const noexcept { return data(); }
+
+  ConstIteratorT end() const noexcept { return data() + size(); }
+
+  SizeT size() const noexcept { return layout_.size(); }
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  SizeT capacity() const noexcept { return layout_.capacity(); }
+
+  PointerT data() const noexcept { return layout_.data(); }
+
+  ReferenceT operator[](SizeT i) { return data()[i]; }
+
+  ConstReferenceT operator[](SizeT i) const { return data()[i]; }
+
+  ReferenceT back() { return data()[size() - 1]; }
+
+  ConstReferenceT back() const { return data()[size() - 1]; }
+
+  /**
+   * As Vector::reserve; throws std::length_error above kMaxSize.
+   */
+  void reserve(SizeT newCapacity) {
+    if (capacity() >= newCapacity) {
+      return;
+    }
+    checkCapacity(newCapacity);
+    relocateAndAdopt(Layout::allocate(allocator(), newCapacity),
+                     newCapacity);
+  }
+
+  /**
+   * Reallocates to exactly size() elements, freeing the buffer altogether
+   * when empty: mostly-empty vectors then cost only their own bytes.
+   */
+  void shrinkToFit() {
+    if (capacity() == size()) {
+      return;
+    }
+    if (empty()) {
+      release();
+      return;
+    }
+    relocateAndAdopt(Layout::allocate(allocator(), size()), size());
+  }
+
+  void resize(SizeT newSize) {
+    resizeWith(newSize, [this](PointerT p) { constructAt(p); });
+  }
+
+  void resize(SizeT newSize, ConstReferenceT value) {
+    resizeWith(newSize, [&](PointerT p) { constructAt(p, value); });
+  }
+
+  void push_back(ConstReferenceT elem) { emplace_back(elem); }
+
+  void push_back(T&& elem) { emplace_back(std::move(elem)); }
+
+  template <typename... Args>
+  ReferenceT emplace_back(Args&&... args) {
+    const SizeT n = size();
+    if (n >= capacity()) [[unlikely]] {
+      return reallocateAndEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    constructAt(data() + n, std::forward<Args>(args)...);
+    layout_.setSize(n + 1);
+    return data()[n];
+  }
+
+  void pop_back() {
+    const SizeT n = size() - 1;
+    AllocTraits::destroy(allocator(), data() + n);
+    layout_.setSize(n);
+  }
+
+  /**
+   * Destroys every element, keeping the capacity.
+   */
+  void clear() noexcept {
+    destroyRange(data(), data() + size());
+    layout_.setSize(0);
+  }
+
+ private:
+  static constexpr bool kPropagateOnCopy =
+      AllocTraits::propagate_on_container_copy_assignment::value;
+  static constexpr bool kPropagateOnMove =
+      AllocTraits::propagate_on_container_move_assignment::value;
+  static constexpr bool kAlwaysEqual = AllocTraits::is_always_equal::value;
+  static constexpr bool kBitwiseCopy =
+      std::is_trivially_copyable_v<T> &&
+      !requires(Allocator& alloc, PointerT p, ConstReferenceT value) {
+        alloc.construct(p, value);
+      };
+
+  Allocator& allocator() noexcept { return static_cast<Allocator&>(*this); }
+
+  const Allocator& allocator() const noexcept {
+    return static_cast<const Allocator&>(*this);
+  }
+
+  static void checkCapacity(SizeT n) {
+    if (n > kMaxSize) {
+#if defined(__cpp_exceptions)
+      throw std::length_error(std::string(Layout::kName) +
+                              ": capacity above kMaxSize");
+#else
+      std::abort();
+#endif
+    }
+  }
+
+  template <typename... Args>
+  void constructAt(PointerT p, Args&&... args) {
+    AllocTraits::construct(allocator(), p, std::forward<Args>(args)...);
+  }
+
+  void destroyRange(PointerT first, PointerT last) noexcept {
+    for (; first != last; ++first) {
+      AllocTraits::destroy(allocator(), first);
+    }
+  }
+
+  /**
+   * As in Vector: if a construction throws, the elements constructed so far
+   * are destroyed before rethrowing.
+   */
+  template <typename ConstructFn>
+  void constructN(PointerT first, SizeT n, ConstructFn&& construct) {
+    SizeT i = 0;
+    ECX_TRY {
+      for (; i < n; ++i) {
+        construct(first + i, i);
+      }
+    } ECX_CATCH_ALL {
+      destroyRange(first, first + i);
+      ECX_RETHROW;
+    }
+  }
+
+  template <typename ConstructFn>
+  void resizeWith(SizeT newSize, ConstructFn&& construct) {
+    const SizeT n = size();
+    if (newSize < n) {
+      destroyRange(data() + newSize, data() + n);
+    } else if (newSize > n) {
+      reserve(newSize);
+      constructN(data() + n, newSize - n,
+                 [&](PointerT p, SizeT) { construct(p); });
+    }
+    layout_.setSize(newSize);
+  }
+
+  /**
+   * Makes the elements copies of [src, src + n), reusing the storage if it
+   * can hold n elements.
+   */
+  void assignCopy(ConstPointerT src, SizeT n) {
+    if (n > capacity()) {
+      checkCapacity(n);
+      PointerT newBuffer = Layout::allocate(allocator(), n);
+      ECX_TRY {
+        copyConstruct(newBuffer, src, n);
+      } ECX_CATCH_ALL {
+        Layout::deallocate(allocator(), newBuffer, n);
+        ECX_RETHROW;
+      }
+      release();
+      layout_.adopt(newBuffer, n, n);
+      return;
+    }
+
+    const SizeT common = std::min(n, size());
+    std::copy(src, src + common, data());
+    if (n > size()) {
+      copyConstruct(data() + size(), src + size(), n - size());
+    } else {
+      destroyRange(data() + n, data() + size());
+    }
+    layout_.setSize(n);
+  }
+
+  void copyConstruct(PointerT dest, ConstPointerT src, SizeT n) {
+    if constexpr (kBitwiseCopy) {
+      if (n != 0) {
+        std::memcpy(dest, src, n * sizeof(T));
+      }
+    } else {
+      constructN(dest, n,
+                 [&](PointerT p, SizeT i) { constructAt(p, src[i]); });
+    }
+  }
+
+  /**
+   * Moves the elements into newBuffer (std::move_if_noexcept, as in Vector).
+   * If this throws, newBuffer is left uninitialised.
+   */
+  void relocateTo(PointerT newBuffer) {
+    if constexpr (kBitwiseCopy) {
+      if (size() != 0) {
+        std::memcpy(newBuffer, data(), size() * sizeof(T));
+      }
+    } else {
+      constructN(newBuffer, size(), [this](PointerT p, SizeT i) {
+        constructAt(p, std::move_if_noexcept(data()[i]));
+      });
+    }
+  }
+
+  void relocateAndAdopt(PointerT newBuffer, SizeT newCapacity) {
+    ECX_TRY {
+      relocateTo(newBuffer);
+    } ECX_CATCH_ALL {
+      Layout::deallocate(allocator(), newBuffer, newCapacity);
+      ECX_RETHROW;
+    }
+    adopt(newBuffer, newCapacity, size());
+  }
+
+  /**
+   * Releases the old buffer, whose elements have been relocated, and takes
+   * newBuffer with newSize elements.
+   */
+  void adopt(PointerT newBuffer, SizeT newCapacity, SizeT newSize) noexcept {
+    destroyRange(data(), data() + size());
+    Layout::deallocate(allocator(), data(), capacity());
+    layout_.adopt(newBuffer, newCapacity, newSize);
+  }
+
+  template <typename... Args>
+  ReferenceT reallocateAndEmplaceBack(Args&&... args) {
+    const SizeT n = size();
+    checkCapacity(n + 1);
+    const SizeT newCapacity =
+        n == 0 ? 1 : std::min(kMaxSize, std::max(n + 1, capacity() * 2));
+    PointerT newBuffer = Layout::allocate(allocator(), newCapacity);
+
+    // Constructed first, as args may refer to an existing element.
+    ECX_TRY {
+      constructAt(newBuffer + n, std::forward<Args>(args)...);
+    } ECX_CATCH_ALL {
+      Layout::deallocate(allocator(), newBuffer, newCapacity);
+      ECX_RETHROW;
+    }
+    ECX_TRY {
+      relocateTo(newBuffer);
+    } ECX_CATCH_ALL {
+      destroyRange(newBuffer + n, newBuffer + n + 1);
+      Layout::deallocate(allocator(), newBuffer, newCapacity);
+      ECX_RETHROW;
+    }
+    adopt(newBuffer, newCapacity, n + 1);
+    return data()[n];
+  }
+
+  void release() noexcept {
+    destroyRange(data(), data() + size());
+    Layout::deallocate(allocator(), data(), capacity());
+    layout_.adopt(nullptr, 0, 0);
+  }
+
+  Layout layout_;
+};
+
+}  // namespace detail::compact
+
+/**
+ * A Vector that is a single pointer: null while nothing is allocated, and
+ * otherwise pointing at the elements, with size and capacity in a header
+ * just before them. For structs holding many mostly-empty vectors, such as
+ * per-node adjacency lists, an empty ThinVector costs 8 bytes against
+ * Vector's 24, and no allocation.
+ *
+ * Same API and guarantees as Vector, with raw pointers as iterators, plus
+ * shrinkToFit() to drop the slack of vectors that are done growing.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+using ThinVector = detail::compact::SmallVector<
+    T, Allocator, detail::compact::HeaderLayout<T, Allocator>>;
+
+/**
+ * A Vector with 32-bit size and capacity: 16 bytes instead of 24, with the
+ * counts kept inline, so that size() does not touch the heap. Holds at most
+ * 2^32 - 1 elements; growing past that throws std::length_error.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+using CompactVector = detail::compact::SmallVector<
+    T, Allocator, detail::compact::CountedLayout<T, Allocator>>;
+
+}  // namespace ecx::stl
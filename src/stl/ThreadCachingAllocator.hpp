@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ecx::stl {
+
+struct ThreadCachingHeapStats {
+  std::size_t allocations = 0;
+  std::size_t deallocations = 0;
+  // Allocations that found their thread cache empty and had to fetch a batch
+  // from the central free list.
+  std::size_t centralFetches = 0;
+  // Batches handed back to the central free list by overflowing or exiting
+  // thread caches.
+  std::size_t centralReleases = 0;
+  // Allocations too large (or too aligned) for the size classes.
+  std::size_t largeAllocations = 0;
+  // Bytes of spans carved into size-class objects; never returned.
+  std::size_t spanBytes = 0;
+};
+
+/**
+ * General-purpose size-class allocator with per-thread caches, in the style of
+ * tcmalloc and mimalloc.
+ *
+ * Requests up to kMaxSmallSize bytes are rounded up to one of kNumClasses size
+ * classes: multiples of 16 up to 256 bytes, then four classes per power of
+ * two. Each thread owns a cache of singly linked free lists, one per class,
+ * so the common allocate/deallocate is a lock-free list pop/push.
+ *
+ * Caches exchange whole batches of objects with a mutex-protected central free
+ * list per class: an empty thread list fetches one batch, and a list grown to
+ * twice the batch size (e.g. by a consumer thread freeing objects a producer
+ * allocated) releases one. A central list is a stack of batches linked
+ * through their first objects, so releasing to it never allocates; it is
+ * refilled by carving spans obtained from global operator new.
+ *
+ * Deallocation is sized: callers pass back the size (and alignment) they
+ * allocated with, so no per-object header or page map is needed.
+ */
+class ThreadCachingHeap {
+ public:
+  using SizeT = std::size_t;
+
+  static constexpr SizeT kMinAlign = 16;
+  static constexpr SizeT kMaxSmallSize = SizeT{32} << 10;
+  static constexpr SizeT kNumClasses = 44;
+
+  static ThreadCachingHeap& instance() {
+    // Leaked, so that thread caches flushing during static destruction still
+    // find their central free lists.
+    static auto* heap = new ThreadCachingHeap();
+    return *heap;
+  }
+
+  static constexpr SizeT sizeClass(SizeT bytes) noexcept {
+    if (bytes <= 256) {
+      return bytes == 0 ? 0 : (bytes + 15) / 16 - 1;
+    }
+    const auto p = static_cast<SizeT>(std::bit_width(bytes - 1) - 1);
+    const SizeT base = SizeT{1} << p;
+    const SizeT step = base / 4;
+    return 16 + (p - 8) * 4 + (bytes - base + step - 1) / step - 1;
+  }
+
+  static constexpr SizeT classSize(SizeT sizeClass) noexcept {
+    if (sizeClass < 16) {
+      return (sizeClass + 1) * 16;
+    }
+    const SizeT k = sizeClass - 16;
+    const SizeT base = SizeT{1} << (8 + k / 4);
+    return base + (k % 4 + 1) * (base / 4);
+  }
+
+  // Objects moved between a thread cache and the central list at once.
+  static constexpr SizeT batchSize(SizeT sizeClass) noexcept {
+    return std::clamp<SizeT>((SizeT{32} << 10) / classSize(sizeClass), 2, 32);
+  }
+
+  [[nodiscard]] void* allocate(SizeT bytes, SizeT alignment = kMinAlign) {
+    if (bytes > kMaxSmallSize || alignment > kMinAlign) [[unlikely]] {
+      largeAllocations_.fetch_add(1, std::memory_order_relaxed);
+      return ::operator new(bytes, std::align_val_t{alignment});
+    }
+
+    const SizeT cls = sizeClass(bytes);
+    if (ThreadCache* cache = localCache()) [[likely]] {
+      return cache->allocate(cls);
+    }
+    // The calling thread's cache has already been destroyed, so take a single
+    // object straight from the central free list.
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    centralFetches_.fetch_add(1, std::memory_order_relaxed);
+    Batch batch = central_[cls].fetch(*this, cls);
+    if (batch.count > 1) {
+      central_[cls].release(batch.head->next);
+      centralReleases_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return batch.head;
+  }
+
+  void deallocate(void* p, SizeT bytes, SizeT alignment = kMinAlign) noexcept {
+    if (bytes > kMaxSmallSize || alignment > kMinAlign) [[unlikely]] {
+      ::operator delete(p, bytes, std::align_val_t{alignment});
+      return;
+    }
+
+    const SizeT cls = sizeClass(bytes);
+    if (ThreadCache* cache = localCache()) [[likely]] {
+      cache->deallocate(p, cls);
+      return;
+    }
+    deallocations_.fetch_add(1, std::memory_order_relaxed);
+    centralReleases_.fetch_add(1, std::memory_order_relaxed);
+    central_[cls].release(::new (p) FreeObject{nullptr});
+  }
+
+  /**
+   * Aggregate counters. Fast-path counts of other live threads are only
+   * published when they next touch their central free lists, so they may lag.
+   */
+  ThreadCachingHeapStats stats() const noexcept {
+    ThreadCachingHeapStats stats{
+        .allocations = allocations_.load(std::memory_order_relaxed),
+        .deallocations = deallocations_.load(std::memory_order_relaxed),
+        .centralFetches = centralFetches_.load(std::memory_order_relaxed),
+        .centralReleases = centralReleases_.load(std::memory_order_relaxed),
+        .largeAllocations = largeAllocations_.load(std::memory_order_relaxed),
+        .spanBytes = spanBytes_.load(std::memory_order_relaxed),
+    };
+    if (ThreadCache* cache = localCache()) {
+      stats.allocations += cache->pendingAllocations;
+      stats.deallocations += cache->pendingDeallocations;
+    }
+    return stats;
+  }
+
+ private:
+  struct FreeObject {
+    FreeObject* next;
+    // Set on the first object of each batch held by a central free list.
+    FreeObject* nextBatch = nullptr;
+  };
+
+  struct Batch {
+    FreeObject* head;
+    SizeT count;
+  };
+
+  class alignas(64) CentralFreeList {
+   public:
+    Batch fetch(ThreadCachingHeap& heap, SizeT cls) {
+      FreeObject* head = nullptr;
+      {
+        std::lock_guard lock(mutex_);
+        if (!batches_) {
+          refill(heap, cls);
+        }
+        head = std::exchange(batches_, batches_->nextBatch);
+      }
+      // Batches are null-terminated; counting one touches the objects the
+      // thread cache is about to hand out anyway.
+      SizeT count = 0;
+      for (FreeObject* object = head; object; object = object->next) {
+        ++count;
+      }
+      return Batch{head, count};
+    }
+
+    // Takes the null-terminated list at head as one batch.
+    void release(FreeObject* head) noexcept {
+      std::lock_guard lock(mutex_);
+      push(head);
+    }
+
+   private:
+    void refill(ThreadCachingHeap& heap, SizeT cls) {
+      const SizeT size = classSize(cls);
+      const SizeT batch = batchSize(cls);
+      const SizeT objects = std::max(kSpanSize / size, batch);
+      auto* span = static_cast<std::byte*>(::operator new(objects * size));
+      heap.spanBytes_.fetch_add(objects * size, std::memory_order_relaxed);
+
+      for (SizeT first = 0; first < objects; first += batch) {
+        const SizeT last = std::min(first + batch, objects);
+        FreeObject* head = nullptr;
+        for (SizeT i = last; i-- > first;) {
+          head = ::new (span + i * size) FreeObject{head};
+        }
+        push(head);
+      }
+    }
+
+    void push(FreeObject* head) noexcept {
+      head->nextBatch = std::exchange(batches_, head);
+    }
+
+    static constexpr SizeT kSpanSize = SizeT{64} << 10;
+
+    std::mutex mutex_;
+    FreeObject* batches_ = nullptr;
+  };
+
+  struct FreeList {
+    FreeObject* head = nullptr;
+    SizeT length = 0;
+  };
+
+  class ThreadCache {
+   public:
+    enum class State : std::uint8_t { kUninitialised, kLive, kDestroyed };
+
+    explicit ThreadCache(ThreadCachingHeap& heap, State& state) noexcept
+        : heap_(heap), state_(state) {
+      state_ = State::kLive;
+    }
+
+    ThreadCache(const ThreadCache&) = delete;
+    ThreadCache& operator=(const ThreadCache&) = delete;
+
+    ~ThreadCache() {
+      for (SizeT cls = 0; cls < kNumClasses; ++cls) {
+        if (lists_[cls].length > 0) {
+          heap_.central_[cls].release(lists_[cls].head);
+          heap_.centralReleases_.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      publishCounters();
+      state_ = State::kDestroyed;
+    }
+
+    void* allocate(SizeT cls) {
+      ++pendingAllocations;
+      FreeList& list = lists_[cls];
+      if (!list.head) [[unlikely]] {
+        Batch batch = heap_.central_[cls].fetch(heap_, cls);
+        heap_.centralFetches_.fetch_add(1, std::memory_order_relaxed);
+        publishCounters();
+        list.head = batch.head;
+        list.length = batch.count;
+      }
+
+      FreeObject* object = list.head;
+      list.head = object->next;
+      --list.length;
+      return object;
+    }
+
+    void deallocate(void* p, SizeT cls) noexcept {
+      ++pendingDeallocations;
+      FreeList& list = lists_[cls];
+      list.head = ::new (p) FreeObject{list.head};
+      if (++list.length >= 2 * batchSize(cls)) [[unlikely]] {
+        releaseBatch(list, cls);
+      }
+    }
+
+    SizeT pendingAllocations = 0;
+    SizeT pendingDeallocations = 0;
+
+   private:
+    void releaseBatch(FreeList& list, SizeT cls) noexcept {
+      const SizeT count = batchSize(cls);
+      FreeObject* head = list.head;
+      FreeObject* tail = head;
+      for (SizeT i = 1; i < count; ++i) {
+        tail = tail->next;
+      }
+      list.head = std::exchange(tail->next, nullptr);
+      list.length -= count;
+
+      heap_.central_[cls].release(head);
+      heap_.centralReleases_.fetch_add(1, std::memory_order_relaxed);
+      publishCounters();
+    }
+
+    void publishCounters() noexcept {
+      heap_.allocations_.fetch_add(std::exchange(pendingAllocations, 0),
+                                   std::memory_order_relaxed);
+      heap_.deallocations_.fetch_add(std::exchange(pendingDeallocations, 0),
+                                     std::memory_order_relaxed);
+    }
+
+    ThreadCachingHeap& heap_;
+    State& state_;
+    std::array<FreeList, kNumClasses> lists_{};
+  };
+
+  ThreadCachingHeap() = default;
+
+  /**
+   * The calling thread's cache, or nullptr once it has been destroyed during
+   * thread exit (e.g. when another thread_local frees memory after it).
+   */
+  static ThreadCache* localCache() noexcept {
+    thread_local constinit auto state = ThreadCache::State::kUninitialised;
+    if (state == ThreadCache::State::kDestroyed) [[unlikely]] {
+      return nullptr;
+    }
+    thread_local ThreadCache cache(instance(), state);
+    return &cache;
+  }
+
+  std::array<CentralFreeList, kNumClasses> central_;
+
+  std::atomic<SizeT> allocations_{0};
+  std::atomic<SizeT> deallocations_{0};
+  std::atomic<SizeT> centralFetches_{0};
+  std::atomic<SizeT> centralReleases_{0};
+  std::atomic<SizeT> largeAllocations_{0};
+  std::atomic<SizeT> spanBytes_{0};
+};
+
+static_assert(ThreadCachingHeap::sizeClass(ThreadCachingHeap::kMaxSmallSize) ==
+              ThreadCachingHeap::kNumClasses - 1);
+static_assert(ThreadCachingHeap::classSize(0) >= 2 * sizeof(void*));
+
+/**
+ * Stateless allocator over ThreadCachingHeap::instance(), so that Vector (and
+ * allocateUnique) can use it as their allocation backend:
+ *   Vector<int, ThreadCachingAllocator<int>> ids;
+ */
+template <typename T>
+class ThreadCachingAllocator {
+ public:
+  using value_type = T;
+  using SizeT = std::size_t;
+  using is_always_equal = std::true_type;
+
+  constexpr ThreadCachingAllocator() noexcept = default;
+
+  template <typename U>
+  constexpr ThreadCachingAllocator(const ThreadCachingAllocator<U>&) noexcept {
+  }
+
+  [[nodiscard]] T* allocate(SizeT n) {
+    if (n > std::numeric_limits<SizeT>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(ThreadCachingHeap::instance().allocate(
+        n * sizeof(T), std::max(alignof(T), ThreadCachingHeap::kMinAlign)));
+  }
+
+  void deallocate(T* p, SizeT n) noexcept {
+    ThreadCachingHeap::instance().deallocate(
+        p, n * sizeof(T), std::max(alignof(T), ThreadCachingHeap::kMinAlign));
+  }
+
+  friend constexpr bool operator==(const ThreadCachingAllocator&,
+                                   const ThreadCachingAllocator&) noexcept {
+    return true;
+  }
+};
+
+}  // namespace ecx::stl
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <mutex>
+#include <new>
+#include <ostream>
+
+/**
+ * In-process tracing:
+ *
+ *   void Vector::reserve(SizeT n) {
+ *     ECX_TRACE_SCOPE("Vector::reserve");
+ *     ...
+ *   }
+ *
+ * records one fixed-size event per scope (start and duration in TSC ticks,
+ * and the interned name) into a ring buffer owned by the calling thread, with
+ * no locks and no allocation after the thread's first event.
+ * ECX_TRACE_INSTANT(name) records a point in time instead. Names must be
+ * string literals, or otherwise live for the rest of the program.
+ *
+ * The probes compile to nothing unless ECX_TRACING is defined to 1 (the CMake
+ * option of that name), so they can sit on hot paths. trace::forEachEvent and
+ * trace::writeChromeTrace read the rings, from any thread, while they are
+ * being written; the JSON loads in chrome://tracing and ui.perfetto.dev.
+ */
+#if defined(ECX_TRACING) && ECX_TRACING
+#define ECX_TRACE_CONCAT_(a, b) a##b
+#define ECX_TRACE_CONCAT(a, b) ECX_TRACE_CONCAT_(a, b)
+#define ECX_TRACE_SCOPE(name)                                          \
+  static const std::uint32_t ECX_TRACE_CONCAT(ecxTraceName, __LINE__) = \
+      ::ecx::stl::trace::intern(name);                                 \
+  const ::ecx::stl::trace::Scope ECX_TRACE_CONCAT(ecxTraceScope,        \
+                                                  __LINE__)(            \
+      ECX_TRACE_CONCAT(ecxTraceName, __LINE__))
+#define ECX_TRACE_INSTANT(name)                                           \
+  do {                                                                    \
+    static const std::uint32_t ecxTraceName =                             \
+        ::ecx::stl::trace::intern(name);                                  \
+    ::ecx::stl::trace::detail::record(ecxTraceName,                       \
+                                      ::ecx::stl::trace::detail::now(),   \
+                                      ::ecx::stl::trace::detail::kInstant); \
+  } while (false)
+#else
+#define ECX_TRACE_SCOPE(name) static_cast<void>(0)
+#define ECX_TRACE_INSTANT(name) static_cast<void>(0)
+#endif
+
+namespace ecx::stl::trace {
+
+namespace detail {
+
+inline constexpr std::size_t kRingSlots = std::size_t{1} << 14;
+// Events each thread keeps; older ones are overwritten. One slot short of the
+// ring, as the slot after the newest may be mid-write.
+inline constexpr std::size_t kRingEvents = kRingSlots - 1;
+inline constexpr std::size_t kMaxNames = 1024;
+// The duration of an instant event.
+inline constexpr std::uint64_t kInstant = ~std::uint64_t{0};
+
+inline std::uint64_t now() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+/**
+ * Ticks and wall time when the first name was interned, before any event:
+ * timestamps are measured from here, and the tick rate calibrated against it
+ * when reading.
+ */
+struct Epoch {
+  std::uint64_t ticks;
+  std::chrono::steady_clock::time_point time;
+};
+
+inline const Epoch& epoch() noexcept {
+  static const Epoch e{now(), std::chrono::steady_clock::now()};
+  return e;
+}
+
+/**
+ * Single-producer ring of events. Fields are relaxed atomics (plain stores
+ * on x86) so that a reader may copy a slot while its thread overwrites it;
+ * the reader then checks written to discard any slot that was reused.
+ */
+struct Ring {
+  struct Slot {
+    std::atomic<std::uint64_t> start;
+    std::atomic<std::uint64_t> duration;
+    std::atomic<std::uint64_t> name;
+  };
+
+  Slot slots[kRingSlots];
+  alignas(64) std::atomic<std::uint64_t> written{0};
+  std::uint32_t threadId = 0;
+  Ring* next = nullptr;
+};
+
+inline std::atomic<Ring*> rings{nullptr};
+inline std::atomic<std::uint32_t> threadCount{0};
+inline thread_local Ring* localRing = nullptr;
+
+// Interned names; id 0 stands in for any past kMaxNames.
+inline std::atomic<const char*> names[kMaxNames] = {"(too many names)"};
+inline std::atomic<std::uint32_t> nameCount{1};
+inline std::mutex internMutex;
+
+/**
+ * The calling thread's ring, created and published on its first event. Rings
+ * are never freed, so events outlive their thread until read.
+ */
+inline Ring* ring() noexcept {
+  if (localRing == nullptr) [[unlikely]] {
+    Ring* created = new (std::nothrow) Ring;
+    if (created == nullptr) {
+      return nullptr;
+    }
+    created->threadId =
+        threadCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    created->next = rings.load(std::memory_order_relaxed);
+    while (!rings.compare_exchange_weak(created->next, created,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+    localRing = created;
+  }
+  return localRing;
+}
+
+inline void record(std::uint32_t name, std::uint64_t start,
+                   std::uint64_t duration) noexcept {
+  Ring* r = ring();
+  if (r == nullptr) {
+    return;
+  }
+  const std::uint64_t index = r->written.load(std::memory_order_relaxed);
+  // Pairs with the reader's acquire fence: a reader that sees any of the
+  // stores below then sees written at index at least, and so discards the
+  // slot, as in a seqlock.
+  std::atomic_thread_fence(std::memory_order_release);
+  Ring::Slot& slot = r->slots[index % kRingSlots];
+  slot.start.store(start, std::memory_order_relaxed);
+  slot.duration.store(duration, std::memory_order_relaxed);
+  slot.name.store(name, std::memory_order_relaxed);
+  r->written.store(index + 1, std::memory_order_release);
+}
+
+inline void writeJsonString(std::ostream& out, const char* s) {
+  out << '"';
+  for (; *s != '\0'; ++s) {
+    if (*s == '"' || *s == '\\') {
+      out << '\\' << *s;
+    } else if (static_cast<unsigned char>(*s) < 0x20) {
+      out << ' ';
+    } else {
+      out << *s;
+    }
+  }
+  out << '"';
+}
+
+}  // namespace detail
+
+/**
+ * The id under which events for name are recorded, the same for every call
+ * with an equal string. Called once per probe, by the probe macros.
+ */
+inline std::uint32_t intern(const char* name) {
+  using namespace detail;
+  static_cast<void>(epoch());
+  const std::lock_guard lock(internMutex);
+  const std::uint32_t count = nameCount.load(std::memory_order_relaxed);
+  for (std::uint32_t id = 1; id < count; ++id) {
+    if (std::strcmp(names[id].load(std::memory_order_relaxed), name) == 0) {
+      return id;
+    }
+  }
+  if (count == kMaxNames) {
+    return 0;
+  }
+  names[count].store(name, std::memory_order_relaxed);
+  nameCount.store(count + 1, std::memory_order_release);
+  return count;
+}
+
+/**
+ * Records the time from construction to destruction; see ECX_TRACE_SCOPE.
+ */
+class Scope {
+ public:
+  explicit Scope(std::uint32_t name) noexcept
+      : name_(name), start_(detail::now()) {}
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+  ~Scope() { detail::record(name_, start_, detail::now() - start_); }
+
+ private:
+  std::uint32_t name_;
+  std::uint64_t start_;
+};
+
+struct Event {
+  const char* name;
+  // Numbered from 1 in the order threads first recorded an event.
+  std::uint32_t threadId;
+  // Since the first probe was reached.
+  double startUs;
+  double durationUs;
+  bool instant;
+};
+
+/**
+ * Calls fn(const Event&) for every event still held, thread by thread, oldest
+ * first within a thread.
+ */
+template <typename Fn>
+void forEachEvent(Fn&& fn) {
+  using namespace detail;
+  const Epoch& e = epoch();
+  const double elapsedUs = std::chrono::duration<double, std::micro>(
+                               std::chrono::steady_clock::now() - e.time)
+                               .count();
+  const std::uint64_t elapsedTicks = now() - e.ticks;
+  const double ticksPerUs =
+      elapsedUs > 0 && elapsedTicks > 0
+          ? static_cast<double>(elapsedTicks) / elapsedUs
+          : 1.0;
+
+  for (Ring* r = rings.load(std::memory_order_acquire); r != nullptr;
+       r = r->next) {
+    const std::uint64_t end = r->written.load(std::memory_order_acquire);
+    const std::uint64_t begin = end > kRingEvents ? end - kRingEvents : 0;
+    for (std::uint64_t i = begin; i < end; ++i) {
+      const Ring::Slot& slot = r->slots[i % kRingSlots];
+      const std::uint64_t start = slot.start.load(std::memory_order_relaxed);
+      const std::uint64_t duration =
+          slot.duration.load(std::memory_order_relaxed);
+      const std::uint64_t name = slot.name.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // Overwritten while being copied: the writer has moved past it.
+      if (r->written.load(std::memory_order_relaxed) > i + kRingEvents) {
+        continue;
+      }
+
+      const bool instant = duration == kInstant;
+      fn(Event{
+          .name = names[name].load(std::memory_order_acquire),
+          .threadId = r->threadId,
+          .startUs = static_cast<double>(static_cast<std::int64_t>(
+                         start - e.ticks)) /
+                     ticksPerUs,
+          .durationUs =
+              instant ? 0.0 : static_cast<double>(duration) / ticksPerUs,
+          .instant = instant,
+      });
+    }
+  }
+}
+
+/**
+ * Events lost to ring overwrites, summed over threads.
+ */
+inline std::uint64_t droppedEvents() noexcept {
+  std::uint64_t dropped = 0;
+  for (detail::Ring* r = detail::rings.load(std::memory_order_acquire);
+       r != nullptr; r = r->next) {
+    const std::uint64_t written = r->written.load(std::memory_order_acquire);
+    dropped += written > detail::kRingEvents ? written - detail::kRingEvents
+                                             : 0;
+  }
+  return dropped;
+}
+
+/**
+ * Writes every event held in the Chrome trace event format: scopes as
+ * complete ("X") events and instants as thread-scoped ("i") ones.
+ */
+inline void writeChromeTrace(std::ostream& out) {
+  const std::ios_base::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision(3);
+  out.setf(std::ios_base::fixed, std::ios_base::floatfield);
+
+  out << "{\"traceEvents\":[";
+  bool first = true;
+  forEachEvent([&](const Event& event) {
+    out << (first ? "\n" : ",\n") << "{\"name\":";
+    detail::writeJsonString(out, event.name);
+    if (event.instant) {
+      out << ",\"ph\":\"i\",\"s\":\"t\"";
+    } else {
+      out << ",\"ph\":\"X\",\"dur\":" << event.durationUs;
+    }
+    out << ",\"ts\":" << event.startUs << ",\"pid\":1,\"tid\":"
+        << event.threadId << '}';
+    first = false;
+  });
+  out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+  out.precision(precision);
+  out.flags(flags);
+}
+
+}  // namespace ecx::stl::trace
@@ -1,6 +1,13 @@
+#pragma once
+
 #include <memory>
+#include <new>
 #include <utility>
 
+#include "src/stl/Exceptions.hpp"
+#include "src/stl/Expected.hpp"
+#include "src/stl/Trace.hpp"
+
 namespace ecx::stl {
 
 namespace v1 {
@@ -138,5 +145,67 @@ constexpr UniquePointer<T> makeUnique(Args&&... args) {
   return UniquePointer<T>(new T(std::forward<Args>(args)...));
 }
 
+/**
+ * makeUnique, reporting allocation failure instead of throwing std::bad_alloc.
+ * Exceptions from T's constructor still propagate.
+ */
+template <typename T, typename... Args>
+Expected<UniquePointer<T>, AllocError> tryMakeUnique(Args&&... args) {
+  T* ptr = new (std::nothrow) T(std::forward<Args>(args)...);
+  if (!ptr) {
+    ECX_TRACE_INSTANT("tryMakeUnique: out of memory");
+    return Unexpected(AllocError::kOutOfMemory);
+  }
+  return Expected<UniquePointer<T>, AllocError>(std::in_place, ptr);
+}
+
+/**
+ * Deleter that destroys and deallocates through an Allocator, pairing with
+ * allocateUnique. Like the deleter in UniquePointer, the allocator is held as
+ * a base class, so a stateless allocator costs no space.
+ */
+template <typename Allocator>
+class AllocatorDeleter : private Allocator {
+  using AllocTraits = std::allocator_traits<Allocator>;
+
+ public:
+  using PointerT = typename AllocTraits::pointer;
+
+  constexpr AllocatorDeleter() = default;
+
+  constexpr explicit AllocatorDeleter(const Allocator& alloc) noexcept
+      : Allocator(alloc) {}
+
+  constexpr void operator()(PointerT p) noexcept {
+    Allocator& alloc = *this;
+    AllocTraits::destroy(alloc, p);
+    AllocTraits::deallocate(alloc, p, 1);
+  }
+};
+
+/**
+ * makeUnique with a pluggable allocation backend: the object is allocated and
+ * constructed through alloc (rebound to T), and handed back the same way when
+ * the UniquePointer lets go of it.
+ */
+template <typename T, typename Allocator, typename... Args>
+constexpr auto allocateUnique(const Allocator& alloc, Args&&... args) {
+  using AllocT = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<T>;
+  using AllocTraits = std::allocator_traits<AllocT>;
+
+  AllocT typedAlloc(alloc);
+  T* ptr = AllocTraits::allocate(typedAlloc, 1);
+  ECX_TRY {
+    AllocTraits::construct(typedAlloc, ptr, std::forward<Args>(args)...);
+  } ECX_CATCH_ALL {
+    AllocTraits::deallocate(typedAlloc, ptr, 1);
+    ECX_RETHROW;
+  }
+
+  return UniquePointer<T, AllocatorDeleter<AllocT>>(
+      ptr, AllocatorDeleter<AllocT>(typedAlloc));
+}
+
 }  // namespace v2
 }  // namespace ecx::stl
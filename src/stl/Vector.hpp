@@ -1,18 +1,45 @@
 #pragma once
 
 #include <algorithm>
+#include <concepts>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
 #include <new>
+#include <type_traits>
 #include <utility>
 
+#include "src/stl/Exceptions.hpp"
+#include "src/stl/Expected.hpp"
+#include "src/stl/NonTemporal.hpp"
+#include "src/stl/Trace.hpp"
+
 namespace ecx::stl {
 
-template <typename T>
-class Vector {
+/**
+ * Allocator-aware dynamic array.
+ *
+ * Elements are constructed and destroyed through the allocator, so that
+ * scoped allocators (e.g. PolymorphicAllocator) can propagate themselves into
+ * nested containers. The allocator is held as a base class for the Empty Base
+ * Class optimisation, leaving Vector<T> at three words with std::allocator.
+ *
+ * The try* variants of the growing operations report allocation failure as an
+ * AllocError instead of throwing std::bad_alloc, and remain usable under
+ * -fno-exceptions.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class Vector : private Allocator {
+  using AllocTraits = std::allocator_traits<Allocator>;
+
+  static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                "Allocator::value_type must be T");
+  static_assert(std::is_same_v<typename AllocTraits::pointer, T*>,
+                "Fancy pointers are not supported");
+
  public:
   using SizeT = std::size_t;
   using ValueT = T;
@@ -20,6 +47,11 @@ class Vector {
   using ConstPointerT = const T*;
   using ReferenceT = T&;
   using ConstReferenceT = const T&;
+  using AllocatorT = Allocator;
+
+  // Spelled the standard way, so that std::uses_allocator recognises Vector
+  // during uses-allocator construction.
+  using allocator_type = Allocator;
 
   /**
    * Iterator class should be a nested class, and needs to contain a pointer
@@ -29,6 +61,10 @@ class Vector {
    * 2. Iter& operator++(): prefix increment, optionally: Iter operator++(int)
    * 3. bool operator!=(): Inequality
    * 4. bool operator==(): Equality
+   *
+   * As a random access iterator, it additionally supports decrement, ordering,
+   * offset arithmetic, distance and subscripting, which the standard
+   * algorithms (std::sort, std::copy, ...) rely on.
    */
   class Iterator {
    public:
@@ -39,6 +75,8 @@ class Vector {
     using pointer = PointerT;
     using reference = ReferenceT;
 
+    Iterator() = default;
+
     explicit Iterator(pointer ptr) : curr_(ptr) {}
 
     reference operator*() const { return *curr_; }
@@ -54,15 +92,52 @@ class Vector {
       return pre;
     }
 
+    Iterator& operator--() {
+      --curr_;
+      return *this;
+    }
+
+    Iterator operator--(int) {
+      Iterator pre = *this;
+      --(*this);
+      return pre;
+    }
+
     // C++20, compiler will generate operator != if operator== is defined.
     bool operator==(const Iterator& other) const {
       return curr_ == other.curr_;
     }
 
-    Iterator operator+(SizeT x) const { return Iterator(curr_ + x); }
+    auto operator<=>(const Iterator& other) const {
+      return curr_ <=> other.curr_;
+    }
+
+    reference operator[](difference_type i) const { return curr_[i]; }
+
+    Iterator& operator+=(difference_type x) {
+      curr_ += x;
+      return *this;
+    }
+
+    Iterator& operator-=(difference_type x) {
+      curr_ -= x;
+      return *this;
+    }
+
+    Iterator operator+(difference_type x) const { return Iterator(curr_ + x); }
+
+    Iterator operator-(difference_type x) const { return Iterator(curr_ - x); }
+
+    difference_type operator-(const Iterator& other) const {
+      return curr_ - other.curr_;
+    }
+
+    friend Iterator operator+(difference_type x, const Iterator& it) {
+      return it + x;
+    }
 
    private:
-    pointer curr_;
+    pointer curr_ = nullptr;
   };
 
   class ConstIterator {
@@ -74,6 +149,8 @@ class Vector {
     using pointer = ConstPointerT;
     using reference = ConstReferenceT;
 
+    ConstIterator() = default;
+
     explicit ConstIterator(pointer ptr) : curr_(ptr) {}
 
     ConstReferenceT operator*() const { return *curr_; }
@@ -89,14 +166,55 @@ class Vector {
       return pre;
     }
 
+    ConstIterator& operator--() {
+      --curr_;
+      return *this;
+    }
+
+    ConstIterator operator--(int) {
+      ConstIterator pre = *this;
+      --(*this);
+      return pre;
+    }
+
     bool operator==(const ConstIterator& other) const {
       return curr_ == other.curr_;
     }
 
-    ConstIterator operator+(SizeT x) const { return ConstIterator(curr_ + x); }
+    auto operator<=>(const ConstIterator& other) const {
+      return curr_ <=> other.curr_;
+    }
+
+    reference operator[](difference_type i) const { return curr_[i]; }
+
+    ConstIterator& operator+=(difference_type x) {
+      curr_ += x;
+      return *this;
+    }
+
+    ConstIterator& operator-=(difference_type x) {
+      curr_ -= x;
+      return *this;
+    }
+
+    ConstIterator operator+(difference_type x) const {
+      return ConstIterator(curr_ + x);
+    }
+
+    ConstIterator operator-(difference_type x) const {
+      return ConstIterator(curr_ - x);
+    }
+
+    difference_type operator-(const ConstIterator& other) const {
+      return curr_ - other.curr_;
+    }
+
+    friend ConstIterator operator+(difference_type x, const ConstIterator& it) {
+      return it + x;
+    }
 
    private:
-    pointer curr_;
+    pointer curr_ = nullptr;
   };
 
   using IteratorT = Iterator;
@@ -104,59 +222,123 @@ class Vector {
   using ReverseIteratorT = std::reverse_iterator<IteratorT>;
   using ConstReverseIteratorT = std::reverse_iterator<ConstIteratorT>;
 
-  explicit Vector() noexcept : size_(0), capacity_(0), data_(nullptr) {}
+  explicit Vector() noexcept(noexcept(Allocator()))
+      : Allocator(), size_(0), capacity_(0), data_(nullptr) {}
+
+  explicit Vector(const Allocator& alloc) noexcept
+      : Allocator(alloc), size_(0), capacity_(0), data_(nullptr) {}
 
-  explicit Vector(SizeT n) : size_(n), capacity_(n), data_(allocate(n)) {
-    std::uninitialized_default_construct(begin(), end());
+  explicit Vector(SizeT n, const Allocator& alloc = Allocator())
+      : Vector(alloc) {
+    reserve(n);
+    valueConstruct(data_, n);
+    size_ = n;
   }
 
-  explicit Vector(SizeT n, ConstReferenceT init)
-      : size_(n), capacity_(n), data_(allocate(n)) {
-    std::uninitialized_fill(begin(), end(), init);
+  explicit Vector(SizeT n, ConstReferenceT init,
+                  const Allocator& alloc = Allocator())
+      : Vector(alloc) {
+    reserve(n);
+    fillConstruct(data_, n, init);
+    size_ = n;
   }
 
-  Vector(std::initializer_list<ValueT> init) : Vector() {
+  Vector(std::initializer_list<ValueT> init,
+         const Allocator& alloc = Allocator())
+      : Vector(alloc) {
     reserve(init.size());
-    std::uninitialized_copy(init.begin(), init.end(), begin());
+    copyConstruct(data_, init.begin(), init.size());
     size_ = init.size();
   }
 
   Vector(const Vector& other)
-      : size_(other.size_),
-        capacity_(other.capacity_),
-        data_(allocate(other.capacity_)) {
-    std::uninitialized_copy(other.begin(), other.end(), begin());
+      : Vector(other, AllocTraits::select_on_container_copy_construction(
+                          other.allocator())) {}
+
+  /**
+   * Allocates exactly other.size() elements: the copy of a vector that grew by
+   * doubling does not inherit its slack.
+   */
+  Vector(const Vector& other, const Allocator& alloc) : Vector(alloc) {
+    reserve(other.size_);
+    copyConstruct(data_, other.data_, other.size_);
+    size_ = other.size_;
   }
 
+  /**
+   * Reuses the existing storage when it is large enough (and the allocator
+   * is kept): the common prefix is copy-assigned, and the tail constructed
+   * or destroyed, so no allocation takes place. Otherwise a buffer of exactly
+   * other.size() elements replaces it.
+   *
+   * Like std::vector, this only gives the Basic Exception Guarantee when the
+   * storage is reused: if a copy throws, the vector is left valid, holding
+   * a mix of old and new elements.
+   */
   Vector& operator=(const Vector& other) {
-    if (this != &other) {
-      Vector temp(other);
-      std::swap(*this, temp);
+    if (this == &other) {
+      return *this;
     }
 
+    if constexpr (kPropagateOnCopy) {
+      if (!kAlwaysEqual && allocator() != other.allocator()) {
+        // Storage from the old allocator cannot be kept past the switch.
+        release();
+      }
+      allocator() = other.allocator();
+    }
+    assignCopy(other.data_, other.size_);
     return *this;
   }
 
   Vector(Vector&& other) noexcept
-      : size_(std::exchange(other.size_, 0)),
+      : Allocator(std::move(other.allocator())),
+        size_(std::exchange(other.size_, 0)),
         capacity_(std::exchange(other.capacity_, 0)),
         data_(std::exchange(other.data_, nullptr)) {}
 
-  Vector& operator=(Vector&& other) noexcept {
-    if (this != &other) {
-      std::destroy(begin(), end());
-      ::operator delete(data_);
+  Vector(Vector&& other, const Allocator& alloc) : Vector(alloc) {
+    if (allocator() == other.allocator()) {
+      steal(other);
+      return;
+    }
+
+    // Memory from a different allocator cannot be adopted, so the elements
+    // are moved across one by one instead.
+    reserve(other.size_);
+    constructN(data_, other.size_, [&](PointerT p, SizeT i) {
+      constructAt(p, std::move(other.data_[i]));
+    });
+    size_ = other.size_;
+  }
+
+  Vector& operator=(Vector&& other) noexcept(kPropagateOnMove ||
+                                             kAlwaysEqual) {
+    if (this == &other) {
+      return *this;
+    }
 
+    if constexpr (kPropagateOnMove || kAlwaysEqual) {
+      release();
+      if constexpr (kPropagateOnMove) {
+        allocator() = std::move(other.allocator());
+      }
+      steal(other);
+    } else if (allocator() == other.allocator()) {
+      release();
       steal(other);
+    } else {
+      Vector temp(std::move(other), allocator());
+      release();
+      steal(temp);
     }
 
     return *this;
   }
 
-  ~Vector() {
-    std::destroy(begin(), end());
-    ::operator delete(data_);
-  }
+  ~Vector() { release(); }
+
+  AllocatorT getAllocator() const noexcept { return allocator(); }
 
   IteratorT begin() { return Iterator(data_); }
 
@@ -195,23 +377,25 @@ class Vector {
       return;
     }
 
-    // NOTE:
-    // Instead of doing the CAS idiom, we make use of std::uninitialized_move,
-    // which essentially:
-    // 1. move if noexcept
-    // 2. copy otherwise,
-    // This provides Exception Safety, since the moved-from buffer can be
-    // destroyed without crashing.
-    // It is crucial that we do not call the destructor on the moved-from buffer
-    // as it may try to release any resources that it no longer owns.
-    PointerT tempBuffer = allocate(newCapacity);
-    if (data_) {
-      std::uninitialized_move(begin(), end(), tempBuffer);
+    ECX_TRACE_SCOPE("Vector::reserve");
+    relocateAndAdopt(allocate(newCapacity), newCapacity);
+  }
+
+  /**
+   * reserve(), reporting allocation failure instead of throwing. Exceptions
+   * from relocating the elements still propagate.
+   */
+  Expected<void, AllocError> tryReserve(SizeT newCapacity) {
+    if (capacity_ >= newCapacity) {
+      return {};
     }
-    ::operator delete(data_);
 
-    data_ = tempBuffer;
-    capacity_ = newCapacity;
+    auto newBuffer = tryAllocate(newCapacity);
+    if (!newBuffer) {
+      return Unexpected(newBuffer.error());
+    }
+    relocateAndAdopt(*newBuffer, newCapacity);
+    return {};
   }
 
   /**
@@ -231,11 +415,11 @@ class Vector {
 
     // shrink
     if (newSize < size_) {
-      std::destroy_n(begin() + newSize, size_ - newSize);
+      destroyRange(data_ + newSize, data_ + size_);
     } else {
       // expand.
       reserve(newSize);
-      std::uninitialized_default_construct_n(begin() + size_, newSize - size_);
+      valueConstruct(data_ + size_, newSize - size_);
     }
     size_ = newSize;
   }
@@ -246,41 +430,87 @@ class Vector {
     }
 
     if (newSize < size_) {
-      std::destroy_n(begin() + newSize, size_ - newSize);
+      destroyRange(data_ + newSize, data_ + size_);
     } else {
       reserve(newSize);
-      std::uninitialized_fill_n(begin() + size_, newSize - size_, value);
+      fillConstruct(data_ + size_, newSize - size_, value);
     }
     size_ = newSize;
   }
 
-  void push_back(ConstReferenceT elem) {
-    if (size_ >= capacity_) {
-      reserve(capacity_ == 0 ? 1 : capacity_ * 2);
+  /**
+   * As resize(newSize), but for trivial types the added elements are left
+   * uninitialised rather than zeroed, for a caller about to overwrite them
+   * (as with std::make_unique_for_overwrite).
+   */
+  void resizeForOverwrite(SizeT newSize) {
+    if constexpr (kBitwiseCopy &&
+                  std::is_trivially_default_constructible_v<T>) {
+      if (newSize > size_) {
+        reserve(newSize);
+        size_ = newSize;
+        return;
+      }
     }
-
-    new (&data_[size_++]) ValueT(elem);
+    resize(newSize);
   }
 
-  void push_back(T&& elem) {
-    if (size_ >= capacity_) {
-      reserve(capacity_ == 0 ? 1 : capacity_ * 2);
-    }
+  void push_back(ConstReferenceT elem) { emplace_back(elem); }
 
-    new (&data_[size_++]) ValueT(std::move(elem));
-  }
+  void push_back(T&& elem) { emplace_back(std::move(elem)); }
 
   template <typename... Args>
   ReferenceT emplace_back(Args&&... args) {
-    if (size_ >= capacity_) {
-      reserve(capacity_ == 0 ? 1 : capacity_ * 2);
+    if (size_ >= capacity_) [[unlikely]] {
+      return reallocateAndEmplaceBack(std::forward<Args>(args)...);
     }
 
-    new (&data_[size_]) ValueT(std::forward<Args>(args)...);
+    constructAt(data_ + size_, std::forward<Args>(args)...);
     return data_[size_++];
   }
 
-  void pop_back() { std::destroy_at(&data_[--size_]); }
+  /**
+   * push_back/emplace_back, reporting allocation failure instead of throwing,
+   * in which case the vector is unchanged. Exceptions from constructing or
+   * relocating the elements still propagate.
+   */
+  Expected<void, AllocError> tryPushBack(ConstReferenceT elem) {
+    return tryEmplaceBack(elem);
+  }
+
+  Expected<void, AllocError> tryPushBack(T&& elem) {
+    return tryEmplaceBack(std::move(elem));
+  }
+
+  template <typename... Args>
+  Expected<void, AllocError> tryEmplaceBack(Args&&... args) {
+    if (size_ >= capacity_) [[unlikely]] {
+      const SizeT newCapacity = grownCapacity();
+      auto newBuffer = tryAllocate(newCapacity);
+      if (!newBuffer) {
+        return Unexpected(newBuffer.error());
+      }
+      emplaceBackInto(*newBuffer, newCapacity, std::forward<Args>(args)...);
+      return {};
+    }
+
+    constructAt(data_ + size_, std::forward<Args>(args)...);
+    ++size_;
+    return {};
+  }
+
+  void pop_back() {
+    --size_;
+    AllocTraits::destroy(allocator(), data_ + size_);
+  }
+
+  /**
+   * Destroys every element, keeping the capacity.
+   */
+  void clear() noexcept {
+    destroyRange(data_, data_ + size_);
+    size_ = 0;
+  }
 
   ReferenceT back() { return data_[size_ - 1]; }
 
@@ -299,8 +529,277 @@ class Vector {
   ConstReferenceT operator[](SizeT i) const { return data_[i]; }
 
  private:
+  static constexpr bool kPropagateOnCopy =
+      AllocTraits::propagate_on_container_copy_assignment::value;
+  static constexpr bool kPropagateOnMove =
+      AllocTraits::propagate_on_container_move_assignment::value;
+  static constexpr bool kAlwaysEqual = AllocTraits::is_always_equal::value;
+  // Copies can be made as bytes: T allows it, and the allocator does not
+  // customise construction (as PolymorphicAllocator does).
+  static constexpr bool kBitwiseCopy =
+      std::is_trivially_copyable_v<T> &&
+      !requires(Allocator& alloc, PointerT p, ConstReferenceT value) {
+        alloc.construct(p, value);
+      };
+
+  Allocator& allocator() noexcept { return static_cast<Allocator&>(*this); }
+
+  const Allocator& allocator() const noexcept {
+    return static_cast<const Allocator&>(*this);
+  }
+
   PointerT allocate(SizeT n) {
-    return static_cast<PointerT>(::operator new(n * sizeof(ValueT)));
+    return n == 0 ? nullptr : AllocTraits::allocate(allocator(), n);
+  }
+
+  /**
+   * allocate(), returning the failure instead of throwing. An allocator can
+   * provide this itself, as a tryAllocate(n) member returning a null pointer
+   * on failure; std::allocator goes through the nothrow operator new, and
+   * other allocators have their std::bad_alloc caught (or, without
+   * exceptions, cannot fail recoverably).
+   */
+  Expected<PointerT, AllocError> tryAllocate(SizeT n) {
+    if (n == 0) {
+      return nullptr;
+    }
+    if (n > AllocTraits::max_size(allocator())) {
+      return Unexpected(AllocError::kLengthError);
+    }
+
+    PointerT p = nullptr;
+    if constexpr (requires(Allocator& alloc) {
+                    { alloc.tryAllocate(n) } -> std::same_as<PointerT>;
+                  }) {
+      p = allocator().tryAllocate(n);
+    } else if constexpr (std::is_same_v<Allocator, std::allocator<T>>) {
+      if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        p = static_cast<PointerT>(::operator new(
+            n * sizeof(T), std::align_val_t(alignof(T)), std::nothrow));
+      } else {
+        p = static_cast<PointerT>(::operator new(n * sizeof(T), std::nothrow));
+      }
+    } else {
+#if defined(__cpp_exceptions)
+      try {
+        p = AllocTraits::allocate(allocator(), n);
+      } catch (const std::bad_alloc&) {
+        p = nullptr;
+      }
+#else
+      p = AllocTraits::allocate(allocator(), n);
+#endif
+    }
+
+    if (!p) {
+      return Unexpected(AllocError::kOutOfMemory);
+    }
+    return p;
+  }
+
+  void deallocate(PointerT p, SizeT n) noexcept {
+    if (p) {
+      AllocTraits::deallocate(allocator(), p, n);
+    }
+  }
+
+  template <typename... Args>
+  void constructAt(PointerT p, Args&&... args) {
+    AllocTraits::construct(allocator(), p, std::forward<Args>(args)...);
+  }
+
+  void destroyRange(PointerT first, PointerT last) noexcept {
+    for (; first != last; ++first) {
+      AllocTraits::destroy(allocator(), first);
+    }
+  }
+
+  /**
+   * Constructs n elements from first onwards by calling construct(p, i) for
+   * the i-th element. If any construction throws, the elements constructed so
+   * far are destroyed before rethrowing, leaving [first, first + n)
+   * uninitialised.
+   */
+  template <typename ConstructFn>
+  void constructN(PointerT first, SizeT n, ConstructFn&& construct) {
+    SizeT i = 0;
+    ECX_TRY {
+      for (; i < n; ++i) {
+        construct(first + i, i);
+      }
+    } ECX_CATCH_ALL {
+      destroyRange(first, first + i);
+      ECX_RETHROW;
+    }
+  }
+
+  /**
+   * Copy-constructs n elements at dest, which is uninitialised, from src.
+   * Bitwise copies of large vectors bypass the cache (streamingCopy).
+   */
+  void copyConstruct(PointerT dest, ConstPointerT src, SizeT n) {
+    if constexpr (kBitwiseCopy) {
+      streamingCopy(dest, src, n * sizeof(T));
+    } else {
+      constructN(dest, n,
+                 [&](PointerT p, SizeT i) { constructAt(p, src[i]); });
+    }
+  }
+
+  /**
+   * Constructs n copies of value at dest, which is uninitialised.
+   */
+  void fillConstruct(PointerT dest, SizeT n, ConstReferenceT value) {
+    if constexpr (kBitwiseCopy) {
+      streamingFill(dest, n, value);
+    } else {
+      constructN(dest, n, [&](PointerT p, SizeT) { constructAt(p, value); });
+    }
+  }
+
+  /**
+   * Value-initialises n elements at dest, which is uninitialised. Where that
+   * has no side effects, it is a fill with T().
+   */
+  void valueConstruct(PointerT dest, SizeT n) {
+    if constexpr (kBitwiseCopy &&
+                  std::is_trivially_default_constructible_v<T>) {
+      fillConstruct(dest, n, T());
+    } else {
+      constructN(dest, n, [this](PointerT p, SizeT) { constructAt(p); });
+    }
+  }
+
+  /**
+   * Makes the elements copies of [src, src + n), reusing the storage if it
+   * can hold n elements.
+   */
+  void assignCopy(ConstPointerT src, SizeT n) {
+    if (n > capacity_) {
+      // Built aside, so that the vector is unchanged if a copy throws.
+      PointerT newBuffer = allocate(n);
+      ECX_TRY {
+        copyConstruct(newBuffer, src, n);
+      } ECX_CATCH_ALL {
+        deallocate(newBuffer, n);
+        ECX_RETHROW;
+      }
+      release();
+      data_ = newBuffer;
+      capacity_ = n;
+      size_ = n;
+      return;
+    }
+
+    const SizeT common = std::min(n, size_);
+    if constexpr (kBitwiseCopy) {
+      streamingCopy(data_, src, common * sizeof(T));
+    } else {
+      std::copy(src, src + common, data_);
+    }
+    if (n > size_) {
+      copyConstruct(data_ + size_, src + size_, n - size_);
+    } else {
+      destroyRange(data_ + n, data_ + size_);
+    }
+    size_ = n;
+  }
+
+  /**
+   * Moves the elements into newBuffer, which must hold at least size_
+   * elements. If this throws, newBuffer is left uninitialised.
+   *
+   * NOTE:
+   * Instead of doing the CAS idiom, elements are moved if their move
+   * constructor is noexcept, and copied otherwise (std::move_if_noexcept).
+   * This provides the Strong Exception Guarantee: if a copy throws, the
+   * original elements are untouched. Trivially copyable elements are
+   * copied as bytes, bypassing the cache for large vectors.
+   */
+  void relocateTo(PointerT newBuffer) {
+    if constexpr (kBitwiseCopy) {
+      streamingCopy(newBuffer, data_, size_ * sizeof(T));
+    } else {
+      constructN(newBuffer, size_, [this](PointerT p, SizeT i) {
+        constructAt(p, std::move_if_noexcept(data_[i]));
+      });
+    }
+  }
+
+  /**
+   * Relocates the elements into newBuffer and adopts it, or releases it if
+   * the relocation throws.
+   */
+  void relocateAndAdopt(PointerT newBuffer, SizeT newCapacity) {
+    ECX_TRY {
+      relocateTo(newBuffer);
+    } ECX_CATCH_ALL {
+      deallocate(newBuffer, newCapacity);
+      ECX_RETHROW;
+    }
+    adopt(newBuffer, newCapacity);
+  }
+
+  /**
+   * Adopts newBuffer, already holding the relocated elements, as the storage.
+   * Moved-from elements are still alive, so they are destroyed before the old
+   * buffer is released.
+   */
+  void adopt(PointerT newBuffer, SizeT newCapacity) noexcept {
+    destroyRange(data_, data_ + size_);
+    deallocate(data_, capacity_);
+    data_ = newBuffer;
+    capacity_ = newCapacity;
+  }
+
+  SizeT grownCapacity() const noexcept {
+    return capacity_ == 0 ? 1 : capacity_ * 2;
+  }
+
+  /**
+   * Slow path of emplace_back.
+   */
+  template <typename... Args>
+  ReferenceT reallocateAndEmplaceBack(Args&&... args) {
+    ECX_TRACE_SCOPE("Vector::grow");
+    const SizeT newCapacity = grownCapacity();
+    return emplaceBackInto(allocate(newCapacity), newCapacity,
+                           std::forward<Args>(args)...);
+  }
+
+  /**
+   * Moves to newBuffer with a new element appended. The new element is
+   * constructed before the existing elements are relocated, as args may refer
+   * to one of them.
+   */
+  template <typename... Args>
+  ReferenceT emplaceBackInto(PointerT newBuffer, SizeT newCapacity,
+                             Args&&... args) {
+    ECX_TRY {
+      constructAt(newBuffer + size_, std::forward<Args>(args)...);
+    } ECX_CATCH_ALL {
+      deallocate(newBuffer, newCapacity);
+      ECX_RETHROW;
+    }
+
+    ECX_TRY {
+      relocateTo(newBuffer);
+    } ECX_CATCH_ALL {
+      destroyRange(newBuffer + size_, newBuffer + size_ + 1);
+      deallocate(newBuffer, newCapacity);
+      ECX_RETHROW;
+    }
+
+    adopt(newBuffer, newCapacity);
+    return data_[size_++];
+  }
+
+  void release() noexcept {
+    destroyRange(data_, data_ + size_);
+    deallocate(data_, capacity_);
+    size_ = 0;
+    capacity_ = 0;
+    data_ = nullptr;
   }
 
   void steal(Vector& other) {
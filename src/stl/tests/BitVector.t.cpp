@@ -0,0 +1,62 @@
+#include "src/stl/BitVector.hpp"
+
+#include <gtest/gtest.h>
+
+namespace ecx::stl {
+namespace test {
+
+TEST(BitVectorTest, SetTestAndCount) {
+  BitVector underTest(130);
+
+  underTest.set(0);
+  underTest.set(64);
+  underTest.set(129);
+  underTest.set(64, false);
+
+  EXPECT_EQ(underTest.size(), 130);
+  EXPECT_TRUE(underTest.test(0));
+  EXPECT_FALSE(underTest[64]);
+  EXPECT_TRUE(underTest[129]);
+  EXPECT_EQ(underTest.count(), 2);
+}
+
+TEST(BitVectorTest, PushBackAndResizeKeepTheTailClear) {
+  BitVector underTest(3, true);
+  for (int i = 0; i < 70; ++i) {
+    underTest.pushBack(i % 2 == 0);
+  }
+
+  EXPECT_EQ(underTest.size(), 73);
+  EXPECT_EQ(underTest.count(), 3 + 35);
+
+  underTest.resize(10);
+  EXPECT_EQ(underTest.count(), 3 + 4);
+  underTest.resize(100, true);
+  EXPECT_EQ(underTest.count(), 3 + 4 + 90);
+  EXPECT_EQ(underTest.words().size(), 2);
+}
+
+TEST(BitVectorTest, AllSetOverRanges) {
+  BitVector underTest(200, true);
+  underTest.reset(150);
+
+  EXPECT_TRUE(underTest.allSet(0, 150));
+  EXPECT_TRUE(underTest.allSet(151, 200));
+  EXPECT_FALSE(underTest.allSet(100, 151));
+  EXPECT_TRUE(underTest.allSet(5, 5));
+}
+
+TEST(BitVectorTest, Equality) {
+  BitVector lhs(65, true);
+  BitVector rhs(65);
+  for (int i = 0; i < 65; ++i) {
+    rhs.set(i);
+  }
+
+  EXPECT_EQ(lhs, rhs);
+  rhs.reset(64);
+  EXPECT_NE(lhs, rhs);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
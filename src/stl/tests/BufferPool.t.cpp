@@ -0,0 +1,150 @@
+#include "src/stl/BufferPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+constexpr std::size_t kKiB = 1024;
+
+TEST(BufferPoolTest, RoundsUpToCapacityClasses) {
+  BufferPool underTest(BufferPoolOptions{.minCapacity = 4 * kKiB});
+
+  BufferPool::Lease small = underTest.acquire(1);
+  EXPECT_TRUE(small);
+  EXPECT_TRUE(small->empty());
+  EXPECT_EQ(small->capacity(), 4 * kKiB);
+
+  BufferPool::Lease large = underTest.acquire(40 * kKiB);
+  EXPECT_EQ(large->capacity(), 64 * kKiB);
+  EXPECT_EQ(underTest.acquire(64 * kKiB)->capacity(), 64 * kKiB);
+}
+
+TEST(BufferPoolTest, ReusesReturnedBuffers) {
+  BufferPool underTest;
+  const std::byte* data = nullptr;
+  {
+    BufferPool::Lease lease = underTest.acquire(100 * kKiB);
+    lease->resize(100 * kKiB, std::byte{1});
+    data = lease->data();
+  }
+  EXPECT_EQ(underTest.stats().retainedBytes, 128 * kKiB);
+
+  BufferPool::Lease lease = underTest.acquire(128 * kKiB);
+  EXPECT_EQ(lease->data(), data);
+  EXPECT_TRUE(lease->empty());
+  EXPECT_EQ(underTest.stats().hits, 1);
+  EXPECT_EQ(underTest.stats().retainedBytes, 0);
+
+  // A smaller class is not served from a larger one.
+  lease.reset();
+  BufferPool::Lease other = underTest.acquire(8 * kKiB);
+  EXPECT_NE(other->data(), data);
+  EXPECT_EQ(underTest.stats().hits, 1);
+}
+
+TEST(BufferPoolTest, GrownBuffersFileUnderTheClassTheyCover) {
+  BufferPool underTest;
+  {
+    BufferPool::Lease lease = underTest.acquire(4 * kKiB);
+    lease->resize(20 * kKiB);
+    EXPECT_GE(lease->capacity(), 20 * kKiB);
+    EXPECT_LT(lease->capacity(), 32 * kKiB);
+  }
+  EXPECT_EQ(underTest.acquire(32 * kKiB)->capacity(), 32 * kKiB);
+  EXPECT_EQ(underTest.stats().hits, 0);
+  EXPECT_GE(underTest.acquire(16 * kKiB)->capacity(), 20 * kKiB);
+  EXPECT_EQ(underTest.stats().hits, 1);
+}
+
+TEST(BufferPoolTest, CapsRetainedBytes) {
+  BufferPool underTest(BufferPoolOptions{.minCapacity = 4 * kKiB,
+                                         .maxCapacity = 64 * kKiB,
+                                         .maxRetainedBytes = 96 * kKiB});
+  {
+    // Returned in reverse: 64 KiB, then 32 KiB, then 32 KiB over the cap.
+    BufferPool::Lease c = underTest.acquire(32 * kKiB);
+    BufferPool::Lease b = underTest.acquire(32 * kKiB);
+    BufferPool::Lease a = underTest.acquire(64 * kKiB);
+  }
+  BufferPoolStats stats = underTest.stats();
+  EXPECT_EQ(stats.retainedBytes, 96 * kKiB);
+  EXPECT_EQ(stats.drops, 1);
+
+  // Above maxCapacity, buffers are served but never retained.
+  underTest.acquire(128 * kKiB).reset();
+  stats = underTest.stats();
+  EXPECT_EQ(stats.retainedBytes, 96 * kKiB);
+  EXPECT_EQ(stats.drops, 2);
+
+  underTest.trim();
+  EXPECT_EQ(underTest.stats().retainedBytes, 0);
+}
+
+TEST(BufferPoolTest, LeasesMoveAndRelease) {
+  BufferPool underTest;
+  BufferPool::Lease a = underTest.acquire(kKiB);
+  a->push_back(std::byte{7});
+
+  BufferPool::Lease b = std::move(a);
+  EXPECT_FALSE(a);
+  EXPECT_EQ(a.get(), nullptr);
+  ASSERT_TRUE(b);
+  EXPECT_EQ((*b)[0], std::byte{7});
+
+  // Assigning over a lease returns its buffer.
+  b = underTest.acquire(kKiB);
+  EXPECT_EQ(underTest.stats().retainedBytes, 4 * kKiB);
+
+  Vector<std::byte> kept = b.release();
+  EXPECT_FALSE(b);
+  EXPECT_EQ(kept.capacity(), 4 * kKiB);
+  b.reset();
+  EXPECT_EQ(underTest.stats().retainedBytes, 4 * kKiB);
+}
+
+TEST(BufferPoolTest, StealsFromOtherThreads) {
+  BufferPool underTest;
+  // Returned on another thread, so likely to another shard.
+  for (int i = 0; i < 4; ++i) {
+    std::jthread([&] { underTest.acquire(64 * kKiB).reset(); }).join();
+  }
+  const BufferPoolStats returned = underTest.stats();
+  EXPECT_EQ(returned.retainedBytes, 64 * kKiB);
+  BufferPool::Lease lease = underTest.acquire(64 * kKiB);
+  EXPECT_EQ(underTest.stats().hits, returned.hits + 1);
+}
+
+TEST(BufferPoolTest, SharedBetweenThreads) {
+  constexpr int kThreads = 4;
+  constexpr int kLeases = 2000;
+  BufferPool underTest(BufferPoolOptions{.maxRetainedBytes = 256 * kKiB});
+  {
+    Vector<std::jthread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+      workers.emplace_back([&, t] {
+        for (int i = 0; i < kLeases; ++i) {
+          const std::size_t bytes = (1 + (i + t) % 16) * kKiB;
+          BufferPool::Lease lease = underTest.acquire(bytes);
+          ASSERT_TRUE(lease->empty());
+          ASSERT_GE(lease->capacity(), bytes);
+          lease->resize(bytes, std::byte(t));
+          ASSERT_EQ((*lease)[bytes - 1], std::byte(t));
+        }
+      });
+    }
+  }
+  const BufferPoolStats stats = underTest.stats();
+  EXPECT_EQ(stats.acquires, kThreads * kLeases);
+  EXPECT_GT(stats.hits, 0);
+  EXPECT_LE(stats.retainedBytes, 256 * kKiB);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,139 @@
+#include "src/stl/ByteStream.hpp"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+class ByteStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    char path[] = "/tmp/bytestream_test_XXXXXX";
+    fd_ = ::mkstemp(path);
+    ASSERT_GE(fd_, 0);
+    ::unlink(path);
+  }
+
+  void TearDown() override { ::close(fd_); }
+
+  void setContents(std::string_view contents) {
+    ASSERT_EQ(::pwrite(fd_, contents.data(), contents.size(), 0),
+              static_cast<ssize_t>(contents.size()));
+  }
+
+  std::string contents() {
+    std::string result(static_cast<std::size_t>(::lseek(fd_, 0, SEEK_END)),
+                       '\0');
+    EXPECT_EQ(::pread(fd_, result.data(), result.size(), 0),
+              static_cast<ssize_t>(result.size()));
+    return result;
+  }
+
+  Vector<std::string> readAllLines(std::size_t chunkSize) {
+    ::lseek(fd_, 0, SEEK_SET);
+    ByteStreamReader reader(fd_, chunkSize);
+    Vector<std::string> lines;
+    while (auto line = reader.nextLine()) {
+      lines.emplace_back(*line);
+    }
+    return lines;
+  }
+
+  int fd_ = -1;
+};
+
+TEST_F(ByteStreamTest, SplitsLines) {
+  setContents("first\nsecond\r\n\nlast without newline");
+
+  Vector<std::string> underTest = readAllLines(1024);
+
+  ASSERT_EQ(underTest.size(), 4);
+  EXPECT_EQ(underTest[0], "first");
+  EXPECT_EQ(underTest[1], "second");
+  EXPECT_EQ(underTest[2], "");
+  EXPECT_EQ(underTest[3], "last without newline");
+}
+
+TEST_F(ByteStreamTest, RecordsStraddlingChunksAndLargerThanTheBuffer) {
+  std::string longLine(100, 'x');
+  setContents("ab\ncdefg\n" + longLine + "\nhi\n");
+
+  // Every line crosses a chunk boundary, and one needs the buffer to grow.
+  Vector<std::string> underTest = readAllLines(4);
+
+  ASSERT_EQ(underTest.size(), 4);
+  EXPECT_EQ(underTest[1], "cdefg");
+  EXPECT_EQ(underTest[2], longLine);
+  EXPECT_EQ(underTest[3], "hi");
+}
+
+TEST_F(ByteStreamTest, EmptyInput) {
+  EXPECT_TRUE(readAllLines(16).empty());
+}
+
+TEST_F(ByteStreamTest, CustomDelimiterAndFixedSizeRecords) {
+  setContents("a,bb,ccc|0123456789");
+  ByteStreamReader reader(fd_, 8);
+
+  EXPECT_EQ(reader.nextRecord(','), "a");
+  EXPECT_EQ(reader.nextRecord(','), "bb");
+  EXPECT_EQ(reader.nextRecord('|'), "ccc");
+  EXPECT_EQ(reader.nextBytes(4), "0123");
+  EXPECT_EQ(reader.nextBytes(4), "4567");
+  EXPECT_EQ(reader.nextBytes(4), "89");
+  EXPECT_FALSE(reader.nextBytes(4).has_value());
+}
+
+TEST_F(ByteStreamTest, WriterBatchesUntilFlushed) {
+  ByteStreamWriter writer(fd_, 64);
+
+  writer.writeRecord("one");
+  writer.writeRecord("two");
+
+  EXPECT_EQ(writer.pending(), 8);
+  EXPECT_EQ(contents(), "");
+
+  writer.flush();
+
+  EXPECT_EQ(writer.pending(), 0);
+  EXPECT_EQ(contents(), "one\ntwo\n");
+}
+
+TEST_F(ByteStreamTest, WriterPassesLargeWritesThroughInOrder) {
+  std::string large(200, 'y');
+  {
+    ByteStreamWriter writer(fd_, 16);
+    writer.write("head,");
+    writer.write(large);
+    writer.write(",0123456789");
+    writer.write(",tail");
+  }
+
+  EXPECT_EQ(contents(), "head," + large + ",0123456789,tail");
+}
+
+TEST_F(ByteStreamTest, RoundTrip) {
+  {
+    ByteStreamWriter writer(fd_, 32);
+    for (int i = 0; i < 1000; ++i) {
+      writer.writeRecord(std::to_string(i));
+    }
+  }
+
+  Vector<std::string> underTest = readAllLines(32);
+
+  ASSERT_EQ(underTest.size(), 1000);
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(underTest[i], std::to_string(i));
+  }
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,183 @@
+#include "src/stl/ColumnTable.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <variant>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+namespace {
+
+// 5000 rows: id = row, price = row % 100, with every 7th quantity null.
+ColumnTable makeOrders() {
+  ColumnTable table;
+  table.addColumn<std::int64_t>("id");
+  table.addColumn<double>("price");
+  table.addColumn<std::int32_t>("quantity");
+  auto& id = table.column<std::int64_t>("id");
+  auto& price = table.column<double>("price");
+  auto& quantity = table.column<std::int32_t>("quantity");
+  for (int row = 0; row < 5000; ++row) {
+    id.append(row);
+    price.append(row % 100);
+    if (row % 7 == 0) {
+      quantity.appendNull();
+    } else {
+      quantity.append(row % 10);
+    }
+  }
+  return table;
+}
+
+}  // namespace
+
+TEST(ColumnTableTest, ColumnsByNameAndType) {
+  ColumnTable underTest = makeOrders();
+
+  EXPECT_EQ(underTest.rows(), 5000);
+  EXPECT_EQ(underTest.columnCount(), 3);
+  EXPECT_TRUE(underTest.hasColumn("price"));
+  EXPECT_EQ(underTest.column<std::int32_t>("quantity").nullCount(), 715);
+  EXPECT_THROW(underTest.column<float>("price"), std::bad_variant_access);
+  EXPECT_THROW(underTest.column<double>("missing"), std::out_of_range);
+  EXPECT_THROW(underTest.addColumn<double>("price"), std::invalid_argument);
+}
+
+TEST(ColumnTableTest, ReserveCoversValuesAndValidity) {
+  Column<std::int32_t> underTest;
+  underTest.reserve(1000);
+  underTest.append(0);
+  const std::int32_t* values = underTest.values().data();
+  const std::uint64_t* validity = underTest.validity().words().data();
+
+  for (int row = 1; row < 1000; ++row) {
+    if (row % 3 == 0) {
+      underTest.appendNull();
+    } else {
+      underTest.append(row);
+    }
+  }
+
+  EXPECT_EQ(underTest.values().data(), values);
+  EXPECT_EQ(underTest.validity().words().data(), validity);
+}
+
+TEST(ColumnTableTest, FilterMatchesAScalarScan) {
+  const ColumnTable table = makeOrders();
+  const auto& price = table.column<double>("price");
+
+  const SelectionVector underTest = filter(price, CompareOp::kGe, 95.0);
+
+  SelectionVector expected;
+  for (std::uint32_t row = 0; row < 5000; ++row) {
+    if (row % 100 >= 95) {
+      expected.push_back(row);
+    }
+  }
+  EXPECT_TRUE(std::ranges::equal(underTest, expected));
+}
+
+TEST(ColumnTableTest, NullsNeverPassAFilter) {
+  const ColumnTable table = makeOrders();
+  const auto& quantity = table.column<std::int32_t>("quantity");
+
+  const auto underTest = filter(quantity, CompareOp::kEq, 0);
+
+  // Rows with row % 10 == 0, minus those with row % 70 == 0.
+  EXPECT_EQ(underTest.size(), 500 - 72);
+  for (std::uint32_t row : underTest) {
+    ASSERT_NE(row % 7, 0);
+  }
+}
+
+TEST(ColumnTableTest, FiltersChainThroughSelections) {
+  const ColumnTable table = makeOrders();
+
+  const auto cheap =
+      filter(table.column<double>("price"), CompareOp::kLt, 10.0);
+  const auto underTest = filter(table.column<std::int64_t>("id"),
+                                CompareOp::kGt, std::int64_t{4000}, cheap);
+
+  EXPECT_EQ(underTest.size(), 99);
+  EXPECT_EQ(underTest[0], 4001);
+  EXPECT_EQ(underTest[98], 4909);
+}
+
+TEST(ColumnTableTest, AggregateSkipsNulls) {
+  const ColumnTable table = makeOrders();
+
+  const auto underTest = aggregate(table.column<std::int32_t>("quantity"));
+
+  std::int64_t sum = 0;
+  for (int row = 0; row < 5000; ++row) {
+    sum += row % 7 == 0 ? 0 : row % 10;
+  }
+  EXPECT_EQ(underTest.count, 5000 - 715);
+  EXPECT_EQ(underTest.sum, sum);
+  EXPECT_EQ(*underTest.min, 0);
+  EXPECT_EQ(*underTest.max, 9);
+}
+
+TEST(ColumnTableTest, AggregateOverASelection) {
+  const ColumnTable table = makeOrders();
+  const auto& price = table.column<double>("price");
+  const auto rows = filter(price, CompareOp::kGe, 90.0);
+
+  const auto underTest = aggregate(price, rows);
+
+  EXPECT_EQ(underTest.count, 500);
+  EXPECT_EQ(underTest.sum, 50.0 * (90 + 91 + 92 + 93 + 94 + 95 + 96 + 97 +
+                                   98 + 99));
+  EXPECT_EQ(*underTest.min, 90.0);
+  EXPECT_EQ(*underTest.max, 99.0);
+}
+
+TEST(ColumnTableTest, FusedAggregateWhereMatchesTwoPasses) {
+  const ColumnTable table = makeOrders();
+  const auto& price = table.column<double>("price");
+  const auto& quantity = table.column<std::int32_t>("quantity");
+
+  const auto underTest =
+      aggregateWhere(price, quantity, CompareOp::kGt, std::int32_t{6});
+
+  const auto expected =
+      aggregate(price, filter(quantity, CompareOp::kGt, std::int32_t{6}));
+  EXPECT_EQ(underTest.count, expected.count);
+  EXPECT_EQ(underTest.sum, expected.sum);
+  EXPECT_EQ(underTest.min, expected.min);
+  EXPECT_EQ(underTest.max, expected.max);
+}
+
+TEST(ColumnTableTest, AggregateOfNothingHasNoMinOrMax) {
+  Column<float> empty;
+
+  const auto underTest = aggregate(empty);
+
+  EXPECT_EQ(underTest.count, 0);
+  EXPECT_FALSE(underTest.min.hasValue());
+  EXPECT_FALSE(underTest.max.hasValue());
+}
+
+TEST(ColumnTableTest, ProjectAndTake) {
+  const ColumnTable table = makeOrders();
+  const SelectionVector rows{0, 3, 4999};
+
+  const ColumnTable underTest = table.project({"quantity", "id"}).take(rows);
+
+  ASSERT_EQ(underTest.columnCount(), 2);
+  EXPECT_EQ(underTest.columnNames()[0], "quantity");
+  EXPECT_EQ(underTest.rows(), 3);
+  const auto& quantity = underTest.column<std::int32_t>("quantity");
+  EXPECT_FALSE(quantity.isValid(0));
+  EXPECT_EQ(quantity.values()[1], 3);
+  EXPECT_EQ(underTest.column<std::int64_t>("id").values()[2], 4999);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
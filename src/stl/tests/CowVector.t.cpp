@@ -0,0 +1,165 @@
+#include "src/stl/CowVector.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "src/stl/MemoryResource.hpp"
+#include "src/stl/Vector.hpp"
+#include "src/testutil/LifetimeTracker.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+TEST(CowVectorTest, DefaultIsEmptyAndUnallocated) {
+  const CowVector<int> underTest;
+
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.useCount(), 0);
+  EXPECT_EQ(underTest.begin(), underTest.end());
+}
+
+TEST(CowVectorTest, CopiesShareTheBuffer) {
+  const CowVector<std::string> original{"a", "b", "c"};
+
+  const CowVector<std::string> snapshot = original;
+
+  EXPECT_EQ(original.useCount(), 2);
+  EXPECT_EQ(snapshot.data(), original.data());
+  EXPECT_EQ(snapshot, original);
+}
+
+TEST(CowVectorTest, FirstWriteDetachesOnce) {
+  LifetimeTracker::reset();
+  CowVector<LifetimeTracker> writer;
+  for (int i = 0; i < 10; ++i) {
+    writer.emplace_back();
+  }
+  const int copiesBefore = LifetimeTracker::copyConstructions;
+
+  const CowVector<LifetimeTracker> snapshot = writer;
+  EXPECT_EQ(LifetimeTracker::copyConstructions, copiesBefore);
+
+  writer.emplace_back();
+  writer.emplace_back();
+  writer.pop_back();
+
+  EXPECT_EQ(LifetimeTracker::copyConstructions, copiesBefore + 10);
+  EXPECT_EQ(writer.useCount(), 1);
+  EXPECT_EQ(snapshot.useCount(), 1);
+  EXPECT_EQ(snapshot.size(), 10);
+  EXPECT_EQ(writer.size(), 11);
+}
+
+TEST(CowVectorTest, UniqueOwnerMutatesInPlace) {
+  CowVector<int> underTest{1, 2, 3};
+  underTest.reserve(8);
+  const int* before = std::as_const(underTest).data();
+
+  underTest.mutableAt(1) = 20;
+  underTest.edit().push_back(4);
+  underTest.resize(3);
+
+  EXPECT_EQ(std::as_const(underTest).data(), before);
+  EXPECT_TRUE(std::ranges::equal(underTest, Vector<int>{1, 20, 3}));
+}
+
+TEST(CowVectorTest, SnapshotIsUnaffectedByWrites) {
+  CowVector<int> writer{1, 2, 3};
+  const CowVector<int> snapshot = writer;
+
+  writer.mutableAt(0) = 10;
+  writer.push_back(4);
+
+  EXPECT_TRUE(std::ranges::equal(snapshot, Vector<int>{1, 2, 3}));
+  EXPECT_TRUE(std::ranges::equal(writer, Vector<int>{10, 2, 3, 4}));
+}
+
+TEST(CowVectorTest, ClearOnlyDropsTheShare) {
+  CowVector<int> writer{1, 2, 3};
+  const CowVector<int> snapshot = writer;
+
+  writer.clear();
+
+  EXPECT_TRUE(writer.empty());
+  EXPECT_EQ(snapshot.size(), 3);
+  EXPECT_EQ(snapshot.useCount(), 1);
+}
+
+TEST(CowVectorTest, AdoptsAVectorWithoutCopying) {
+  Vector<int> source{1, 2, 3};
+  const int* data = source.data();
+
+  const CowVector<int> underTest(std::move(source));
+
+  EXPECT_EQ(underTest.data(), data);
+  EXPECT_EQ(underTest.size(), 3);
+}
+
+TEST(CowVectorTest, AssignmentSharesAcrossPmrResources) {
+  using PmrCowVector = CowVector<int, PolymorphicAllocator<int>>;
+  UnsynchronizedPoolResource first;
+  UnsynchronizedPoolResource second;
+  PmrCowVector underTest({1, 2}, &first);
+  PmrCowVector other({3, 4, 5}, &second);
+
+  underTest = other;
+  EXPECT_EQ(underTest.data(), other.data());
+  EXPECT_EQ(other.useCount(), 2);
+
+  underTest.push_back(6);
+  EXPECT_NE(underTest.data(), other.data());
+  EXPECT_EQ(underTest.edit().getAllocator().resource(), &first);
+
+  other = std::move(underTest);
+  EXPECT_EQ(other.size(), 4);
+  EXPECT_EQ(other[3], 6);
+  EXPECT_EQ(other.useCount(), 1);
+}
+
+TEST(CowVectorTest, ReadersSnapshotWhileWriterMutates) {
+  constexpr int kWrites = 2000;
+  std::mutex mutex;
+  CowVector<int> published;
+  std::atomic<bool> done{false};
+
+  std::jthread writer([&] {
+    CowVector<int> working;
+    for (int i = 0; i < kWrites; ++i) {
+      working.push_back(i);
+      std::lock_guard lock(mutex);
+      published = working;
+    }
+    done.store(true);
+  });
+
+  Vector<std::jthread> readers;
+  for (int r = 0; r < 3; ++r) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        CowVector<int> snapshot;
+        {
+          std::lock_guard lock(mutex);
+          snapshot = published;
+        }
+        // Each snapshot is some prefix 0, 1, ..., n - 1, never torn.
+        for (std::size_t i = 0; i < snapshot.size(); ++i) {
+          ASSERT_EQ(snapshot[i], static_cast<int>(i));
+        }
+      }
+    });
+  }
+  writer.join();
+  readers.clear();
+
+  EXPECT_EQ(published.size(), kWrites);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
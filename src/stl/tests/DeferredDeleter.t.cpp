@@ -0,0 +1,188 @@
+#include "src/stl/DeferredDeleter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+#include "src/stl/UniquePointer.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+namespace {
+
+std::atomic<int> destroyed{0};
+std::atomic<bool> destroyedElsewhere{false};
+
+struct Tracked {
+  explicit Tracked(std::thread::id owner) : owner(owner) {}
+
+  ~Tracked() {
+    destroyedElsewhere = std::this_thread::get_id() != owner;
+    ++destroyed;
+  }
+
+  std::thread::id owner;
+  Vector<int> payload = Vector<int>(1000, 1);
+};
+
+struct Node {
+  ~Node() { ++destroyed; }
+
+  UniquePointer<Node, DeferredDeleter<Node>> next;
+};
+
+// Waits, with a timeout, for the reclaimer's counters to satisfy done.
+template <typename Done>
+bool eventually(const DeferredReclaimer& reclaimer, Done&& done) {
+  for (int i = 0; i < 5000; ++i) {
+    if (done(reclaimer.stats())) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(DeferredDeleterTest, CostsNoSpace) {
+  EXPECT_EQ(sizeof(UniquePointer<int, DeferredDeleter<int>>), sizeof(int*));
+}
+
+TEST(DeferredDeleterTest, DestroysOnTheReclaimerThread) {
+  destroyed = 0;
+  UniquePointer<Tracked, DeferredDeleter<Tracked>> underTest(
+      new Tracked(std::this_thread::get_id()));
+  underTest.reset(new Tracked(std::this_thread::get_id()));
+  ASSERT_TRUE(underTest);
+
+  DeferredReclaimer::instance().drain();
+  EXPECT_EQ(destroyed, 1);
+  EXPECT_TRUE(destroyedElsewhere);
+
+  underTest.reset();
+  DeferredReclaimer::instance().drain();
+  EXPECT_EQ(destroyed, 2);
+}
+
+TEST(DeferredDeleterTest, NestedOwnersAreDestroyedInPlace) {
+  destroyed = 0;
+  UniquePointer<Node, DeferredDeleter<Node>> head(new Node);
+  head->next.reset(new Node);
+  head->next->next.reset(new Node);
+
+  const auto before = DeferredReclaimer::instance().stats();
+  head.reset();
+  DeferredReclaimer::instance().drain();
+  EXPECT_EQ(destroyed, 3);
+  // The nested nodes were destroyed in place, within head's destructor, so
+  // all three are counted once drain() returns.
+  const auto after = DeferredReclaimer::instance().stats();
+  EXPECT_EQ(after.retired - before.retired, 3);
+  EXPECT_EQ(after.reclaimed - before.reclaimed, 3);
+}
+
+TEST(DeferredDeleterTest, DrainIsNotSatisfiedByObjectsDestroyedInPlace) {
+  static std::atomic<bool> started{false};
+  static std::atomic<bool> released{false};
+  static std::atomic<bool> earlierDestroyed{false};
+  started = false;
+  released = false;
+  earlierDestroyed = false;
+
+  DeferredReclaimer underTest;
+  static DeferredReclaimer* reclaimer = nullptr;
+  reclaimer = &underTest;
+  // Destroyed first, retiring two nested objects in place once released.
+  underTest.retire(nullptr, [](void*) noexcept {
+    started = true;
+    while (!released) {
+      std::this_thread::yield();
+    }
+    reclaimer->retire(nullptr, [](void*) noexcept {});
+    reclaimer->retire(nullptr, [](void*) noexcept {});
+  });
+  while (!started) {
+    std::this_thread::yield();
+  }
+  // Queued behind it, and retired before drain() is called; slow, so that a
+  // drain() returning early would not find it destroyed.
+  underTest.retire(nullptr, [](void*) noexcept {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    earlierDestroyed = true;
+  });
+
+  // Released while drain() waits, most likely; counting the in-place
+  // objects would then let it return before the second one is destroyed.
+  std::jthread releaser([] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    released = true;
+  });
+  underTest.drain();
+
+  EXPECT_TRUE(earlierDestroyed);
+}
+
+TEST(DeferredDeleterTest, FullQueueStallsTheProducer) {
+  static std::atomic<bool> released{false};
+  static std::atomic<int> reclaimed{0};
+  released = false;
+  reclaimed = 0;
+  const DeferredReclaimer::DestroyFn blocking = [](void*) noexcept {
+    while (!released) {
+      std::this_thread::yield();
+    }
+    ++reclaimed;
+  };
+  const DeferredReclaimer::DestroyFn counting = [](void*) noexcept {
+    ++reclaimed;
+  };
+
+  DeferredReclaimer underTest(2);
+  // Taken by the reclaimer, which then blocks on it with the queue empty.
+  underTest.retire(nullptr, blocking);
+  ASSERT_TRUE(eventually(underTest, [](auto s) { return s.batches == 1; }));
+  underTest.retire(nullptr, counting);
+  underTest.retire(nullptr, counting);
+  EXPECT_EQ(underTest.stats().stalls, 0);
+
+  std::jthread producer([&] { underTest.retire(nullptr, counting); });
+  ASSERT_TRUE(eventually(underTest, [](auto s) { return s.stalls == 1; }));
+  EXPECT_EQ(underTest.stats().retired, 3);
+
+  released = true;
+  producer.join();
+  underTest.drain();
+  EXPECT_EQ(reclaimed, 4);
+  EXPECT_EQ(underTest.stats().reclaimed, 4);
+}
+
+TEST(DeferredDeleterTest, DestructorFinishesPendingObjects) {
+  constexpr int kThreads = 4;
+  constexpr int kObjects = 10'000;
+  static std::atomic<int> reclaimed{0};
+  reclaimed = 0;
+  {
+    DeferredReclaimer underTest(64);
+    Vector<std::jthread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+      workers.emplace_back([&] {
+        for (int i = 0; i < kObjects; ++i) {
+          underTest.retire(new int(i), [](void* p) noexcept {
+            delete static_cast<int*>(p);
+            ++reclaimed;
+          });
+        }
+      });
+    }
+  }
+  EXPECT_EQ(reclaimed, kThreads * kObjects);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,242 @@
+// Also built with -fno-exceptions, see CMakeLists.txt.
+#include "src/stl/Expected.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "src/stl/UniquePointer.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+static_assert(std::is_trivially_copyable_v<Expected<int, AllocError>>);
+static_assert(std::is_trivially_copyable_v<Expected<void, AllocError>>);
+static_assert(!std::is_trivially_copyable_v<Expected<std::string, int>>);
+static_assert(!std::is_trivially_copyable_v<Expected<int, std::string>>);
+static_assert(sizeof(Expected<void, AllocError>) == 2);
+
+// Allocator with a byte budget, refusing allocations beyond it through the
+// tryAllocate extension point.
+template <typename T>
+struct BudgetAllocator {
+  using value_type = T;
+
+  explicit BudgetAllocator(std::size_t* budget) noexcept : budget(budget) {}
+
+  template <typename U>
+  BudgetAllocator(const BudgetAllocator<U>& other) noexcept
+      : budget(other.budget) {}
+
+  T* tryAllocate(std::size_t n) noexcept {
+    if (n * sizeof(T) > *budget) {
+      return nullptr;
+    }
+    *budget -= n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+
+  T* allocate(std::size_t n) {
+    if (T* p = tryAllocate(n)) {
+      return p;
+    }
+    std::abort();
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    *budget += n * sizeof(T);
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  bool operator==(const BudgetAllocator&) const = default;
+
+  std::size_t* budget;
+};
+
+TEST(ExpectedTest, HoldsAValue) {
+  Expected<std::string, AllocError> underTest = std::string("value");
+
+  ASSERT_TRUE(underTest.hasValue());
+  EXPECT_EQ(*underTest, "value");
+  EXPECT_EQ(underTest->size(), 5);
+}
+
+TEST(ExpectedTest, HoldsAnError) {
+  Expected<std::string, AllocError> underTest =
+      Unexpected(AllocError::kOutOfMemory);
+
+  ASSERT_FALSE(underTest);
+  EXPECT_EQ(underTest.error(), AllocError::kOutOfMemory);
+  EXPECT_EQ(underTest.valueOr("fallback"), "fallback");
+}
+
+TEST(ExpectedTest, VoidHoldsSuccessOrAnError) {
+  Expected<void, int> success;
+  Expected<void, int> failure = Unexpected(3);
+
+  EXPECT_TRUE(success);
+  ASSERT_FALSE(failure);
+  EXPECT_EQ(failure.error(), 3);
+}
+
+TEST(ExpectedTest, IsUsableInConstantExpressions) {
+  constexpr Expected<int, AllocError> value = 1;
+  constexpr Expected<int, AllocError> error =
+      Unexpected(AllocError::kLengthError);
+
+  static_assert(*value == 1);
+  static_assert(error.error() == AllocError::kLengthError);
+}
+
+TEST(ExpectedTest, AssignmentSwitchesAlternatives) {
+  const std::string longValue(40, 'v');
+  const std::string longError(40, 'e');
+  Expected<std::string, std::string> underTest = longValue;
+  Expected<std::string, std::string> error = Unexpected(longError);
+
+  underTest = error;
+  ASSERT_FALSE(underTest);
+  EXPECT_EQ(underTest.error(), longError);
+
+  underTest = Expected<std::string, std::string>(longValue);
+  ASSERT_TRUE(underTest);
+  EXPECT_EQ(*underTest, longValue);
+}
+
+TEST(ExpectedTest, ToOptionalDropsTheError) {
+  Expected<int, AllocError> value = 5;
+  Expected<int, AllocError> error = Unexpected(AllocError::kOutOfMemory);
+
+  EXPECT_EQ(std::move(value).toOptional(), Optional<int>(5));
+  EXPECT_FALSE(std::move(error).toOptional());
+}
+
+TEST(ExpectedTest, TryPushBackReportsExhaustionAndLeavesTheVectorUnchanged) {
+  // Capacities 1 and 2 are freed on the way; 4 fits, 8 does not.
+  std::size_t budget = 7 * sizeof(int);
+  Vector<int, BudgetAllocator<int>> underTest{BudgetAllocator<int>(&budget)};
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(underTest.tryPushBack(i));
+  }
+
+  auto result = underTest.tryPushBack(4);
+
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error(), AllocError::kOutOfMemory);
+  EXPECT_EQ(underTest.size(), 4);
+  EXPECT_EQ(underTest.capacity(), 4);
+  EXPECT_EQ(underTest[3], 3);
+}
+
+TEST(ExpectedTest, TryReserveReportsExhaustion) {
+  std::size_t budget = 16 * sizeof(int);
+  Vector<int, BudgetAllocator<int>> underTest{BudgetAllocator<int>(&budget)};
+  underTest.push_back(1);
+
+  EXPECT_EQ(underTest.tryReserve(1000).error(), AllocError::kOutOfMemory);
+  EXPECT_EQ(underTest.capacity(), 1);
+
+  EXPECT_TRUE(underTest.tryReserve(8));
+  EXPECT_EQ(underTest.capacity(), 8);
+  EXPECT_EQ(underTest[0], 1);
+}
+
+TEST(ExpectedTest, TryReserveRejectsImpossibleSizes) {
+  Vector<int> underTest;
+
+  auto result = underTest.tryReserve(std::allocator_traits<
+                                         std::allocator<int>>::max_size({}) +
+                                     1);
+
+  ASSERT_FALSE(result);
+  EXPECT_EQ(result.error(), AllocError::kLengthError);
+}
+
+TEST(ExpectedTest, TryPushBackOfAnElementOfTheVector) {
+  Vector<std::string> underTest;
+  ASSERT_TRUE(underTest.tryPushBack(std::string(40, 'x')));
+
+  // Reallocates while copying the element being reallocated.
+  ASSERT_TRUE(underTest.tryPushBack(underTest[0]));
+
+  EXPECT_EQ(underTest[1], std::string(40, 'x'));
+}
+
+TEST(ExpectedTest, TryMakeUnique) {
+  auto underTest = tryMakeUnique<std::string>(3, 'x');
+
+  ASSERT_TRUE(underTest);
+  EXPECT_EQ(**underTest, "xxx");
+}
+
+#if defined(__cpp_exceptions)
+// Allocator without tryAllocate, failing by throwing.
+template <typename T>
+struct ThrowingAllocator {
+  using value_type = T;
+
+  ThrowingAllocator() = default;
+
+  template <typename U>
+  ThrowingAllocator(const ThrowingAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t) { throw std::bad_alloc(); }
+
+  void deallocate(T*, std::size_t) noexcept {}
+
+  bool operator==(const ThrowingAllocator&) const = default;
+};
+
+TEST(ExpectedTest, BadAllocFromOtherAllocatorsIsReported) {
+  Vector<int, ThrowingAllocator<int>> underTest;
+
+  EXPECT_EQ(underTest.tryPushBack(1).error(), AllocError::kOutOfMemory);
+  EXPECT_TRUE(underTest.empty());
+}
+
+// Copyable, and so movable, only by a copy that throws while armed.
+struct ThrowingCopy {
+  ThrowingCopy() = default;
+
+  ThrowingCopy(const ThrowingCopy&) {
+    if (armed) {
+      throw std::runtime_error("copy");
+    }
+  }
+
+  ThrowingCopy& operator=(const ThrowingCopy&) = default;
+
+  static inline bool armed = false;
+};
+
+TEST(ExpectedTest, ThrowingAssignmentKeepsTheOldAlternative) {
+  const std::string longValue(40, 'v');
+  const std::string longError(40, 'e');
+  const Expected<ThrowingCopy, std::string> value;
+  const Expected<std::string, ThrowingCopy> error =
+      Unexpected(ThrowingCopy());
+  Expected<ThrowingCopy, std::string> holdingError = Unexpected(longError);
+  Expected<std::string, ThrowingCopy> holdingValue = longValue;
+
+  ThrowingCopy::armed = true;
+  EXPECT_THROW(holdingError = value, std::runtime_error);
+  EXPECT_THROW(holdingValue = error, std::runtime_error);
+  ThrowingCopy::armed = false;
+
+  ASSERT_FALSE(holdingError);
+  EXPECT_EQ(holdingError.error(), longError);
+  ASSERT_TRUE(holdingValue);
+  EXPECT_EQ(*holdingValue, longValue);
+}
+#endif
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,178 @@
+#include "src/stl/Generator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "src/stl/MemoryResource.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+struct GeneratorTest : ::testing::Test {
+  static Generator<int> iota(int first, int* produced = nullptr) {
+    for (int i = first;; ++i) {
+      if (produced) {
+        ++*produced;
+      }
+      co_yield i;
+    }
+  }
+
+  static Generator<int> range(int first, int last) {
+    for (int i = first; i < last; ++i) {
+      co_yield i;
+    }
+  }
+
+  // Yields depth, depth - 1, ..., 1, one nesting level per element.
+  static Generator<int> countdown(int depth) {
+    if (depth == 0) {
+      co_return;
+    }
+    co_yield depth;
+    co_yield elementsOf(countdown(depth - 1));
+  }
+
+  static Generator<int> throwsAfter(int n) {
+    for (int i = 0; i < n; ++i) {
+      co_yield i;
+    }
+    throw std::runtime_error("exhausted");
+  }
+
+// See AllocatorAwarePromise: GCC pairs the frame's templated operator new
+// with its operator delete by name, and reports them as mismatched.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+  static Generator<int> withFrameAllocator(std::allocator_arg_t,
+                                           PolymorphicAllocator<>, int n) {
+    for (int i = 0; i < n; ++i) {
+      co_yield i;
+    }
+  }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+};
+
+TEST_F(GeneratorTest, YieldsValuesInOrder) {
+  Vector<int> underTest = collect(range(0, 5));
+
+  EXPECT_EQ(underTest.size(), 5);
+  EXPECT_EQ(underTest[0], 0);
+  EXPECT_EQ(underTest[4], 4);
+}
+
+TEST_F(GeneratorTest, YieldedLvaluesAreCopiedAndRvaluesMoved) {
+  auto generate = []() -> Generator<std::string> {
+    std::string kept = "a string long enough to be heap allocated";
+    co_yield kept;
+    co_yield std::string("a moved string long enough to be heap allocated");
+    EXPECT_EQ(kept, "a string long enough to be heap allocated");
+  };
+
+  Vector<std::string> underTest = collect(generate());
+
+  EXPECT_EQ(underTest.size(), 2);
+  EXPECT_EQ(underTest[1], "a moved string long enough to be heap allocated");
+}
+
+TEST_F(GeneratorTest, NestedGeneratorsDoNotGrowTheStack) {
+  int expected = 10'000;
+  for (int x : countdown(10'000)) {
+    ASSERT_EQ(x, expected--);
+  }
+  EXPECT_EQ(expected, 0);
+}
+
+TEST_F(GeneratorTest, ExceptionsPropagateThroughNestedGenerators) {
+  auto outer = []() -> Generator<int> {
+    co_yield elementsOf(throwsAfter(2));
+  };
+
+  int seen = 0;
+  EXPECT_THROW(
+      {
+        for (int x : outer()) {
+          EXPECT_EQ(x, seen++);
+        }
+      },
+      std::runtime_error);
+  EXPECT_EQ(seen, 2);
+}
+
+TEST_F(GeneratorTest, FrameIsAllocatedThroughTheGivenAllocator) {
+  alignas(16) std::byte buffer[4096];
+  MonotonicBufferResource resource(buffer, sizeof(buffer),
+                                   nullMemoryResource());
+
+  auto underTest = withFrameAllocator(std::allocator_arg, &resource, 3);
+  // The frame took the front of the buffer.
+  EXPECT_NE(resource.allocate(1, 1), buffer);
+
+  Vector<int> values = collect(std::move(underTest));
+
+  EXPECT_EQ(values.size(), 3);
+  EXPECT_EQ(values[2], 2);
+}
+
+TEST_F(GeneratorTest, PipelineIsLazy) {
+  int produced = 0;
+
+  Vector<int> underTest = iota(0, &produced) |
+                          filter([](int x) { return x % 3 == 0; }) |
+                          map([](int x) { return x * 10; }) | take(4) |
+                          collect();
+
+  EXPECT_EQ(underTest.size(), 4);
+  EXPECT_EQ(underTest[3], 90);
+  // Exactly the elements needed for the fourth survivor were produced.
+  EXPECT_EQ(produced, 10);
+}
+
+TEST_F(GeneratorTest, CollectReservesForKnownSize) {
+  Vector<int> source{1, 2, 3, 4, 5, 6, 7};
+
+  Vector<std::string> underTest =
+      iterate(source) | map([](int x) { return std::to_string(x); }) |
+      collect();
+
+  EXPECT_EQ(underTest.size(), 7);
+  EXPECT_EQ(underTest.capacity(), 7);
+  EXPECT_EQ(underTest[6], "7");
+}
+
+TEST_F(GeneratorTest, TakeBoundsTheSizeHint) {
+  Vector<int> source{1, 2, 3, 4, 5, 6, 7, 8};
+  Vector<int> underTest = iterate(source) | take(5) | collect();
+
+  EXPECT_EQ(underTest.size(), 5);
+  EXPECT_EQ(underTest.capacity(), 5);
+  EXPECT_EQ((iterate(source) | take(20)).sizeHint(), 8);
+}
+
+TEST_F(GeneratorTest, TakeDoesNotInventASizeHint) {
+  auto underTest = iota(0) | filter([](int x) { return x < 3; }) |
+                   take(1'000'000);
+
+  EXPECT_FALSE(underTest.sizeHint().has_value());
+  EXPECT_FALSE((iota(0) | take(5)).sizeHint().has_value());
+}
+
+TEST_F(GeneratorTest, FilterDropsTheSizeHint) {
+  Vector<int> source{1, 2, 3, 4};
+
+  auto underTest = iterate(source) | filter([](int x) { return x > 2; });
+
+  EXPECT_EQ(iterate(source).sizeHint(), 4);
+  EXPECT_FALSE(underTest.sizeHint().has_value());
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,287 @@
+#include "src/stl/HashOperators.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "src/stl/ColumnTable.hpp"
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+namespace {
+
+struct Expected {
+  std::int64_t sum = 0;
+  std::uint64_t count = 0;
+  std::int32_t min = 0;
+  std::int32_t max = 0;
+};
+
+// Rows over distinct keys, each repeated about rows / distinct times.
+void makeRows(std::size_t rows, std::uint64_t distinct,
+              Vector<std::uint64_t>& keys, Vector<std::int32_t>& values) {
+  for (std::size_t i = 0; i < rows; ++i) {
+    keys.push_back((i * 2654435761u) % distinct);
+    values.push_back(static_cast<std::int32_t>(i % 1000) - 500);
+  }
+}
+
+void expectMatchesMap(const Vector<std::uint64_t>& keys,
+                      const Vector<std::int32_t>& values,
+                      const GroupByResult<std::uint64_t, std::int32_t>& got) {
+  std::map<std::uint64_t, Expected> expected;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    auto [it, inserted] = expected.try_emplace(keys[i]);
+    Expected& e = it->second;
+    e.min = inserted ? values[i] : std::min(e.min, values[i]);
+    e.max = inserted ? values[i] : std::max(e.max, values[i]);
+    e.sum += values[i];
+    ++e.count;
+  }
+
+  ASSERT_EQ(got.keys.size(), expected.size());
+  ASSERT_EQ(got.sums.size(), expected.size());
+  for (std::size_t g = 0; g < got.keys.size(); ++g) {
+    const auto it = expected.find(got.keys[g]);
+    ASSERT_NE(it, expected.end());
+    EXPECT_EQ(got.sums[g], it->second.sum);
+    EXPECT_EQ(got.counts[g], it->second.count);
+    EXPECT_EQ(got.mins[g], it->second.min);
+    EXPECT_EQ(got.maxs[g], it->second.max);
+    expected.erase(it);
+  }
+}
+
+// Every (build, probe) pair with equal keys, in a canonical order.
+std::multimap<std::uint32_t, std::uint32_t> naiveJoin(
+    const Vector<std::int64_t>& build, const Vector<std::int64_t>& probe) {
+  std::multimap<std::int64_t, std::uint32_t> byKey;
+  for (std::size_t i = 0; i < build.size(); ++i) {
+    byKey.emplace(build[i], static_cast<std::uint32_t>(i));
+  }
+  std::multimap<std::uint32_t, std::uint32_t> pairs;
+  for (std::size_t i = 0; i < probe.size(); ++i) {
+    auto [first, last] = byKey.equal_range(probe[i]);
+    for (; first != last; ++first) {
+      pairs.emplace(static_cast<std::uint32_t>(i), first->second);
+    }
+  }
+  return pairs;
+}
+
+void expectSamePairs(const std::multimap<std::uint32_t, std::uint32_t>& want,
+                     const JoinResult& got) {
+  ASSERT_EQ(got.buildRows.size(), got.probeRows.size());
+  std::multimap<std::uint32_t, std::uint32_t> pairs;
+  for (std::size_t i = 0; i < got.probeRows.size(); ++i) {
+    pairs.emplace(got.probeRows[i], got.buildRows[i]);
+  }
+  // Duplicate build rows for one probe row may come in either order.
+  ASSERT_EQ(pairs.size(), want.size());
+  for (auto it = want.begin(); it != want.end();) {
+    const auto [wantFirst, wantLast] = want.equal_range(it->first);
+    const auto [gotFirst, gotLast] = pairs.equal_range(it->first);
+    std::multiset<std::uint32_t> lhs, rhs;
+    for (auto i = wantFirst; i != wantLast; ++i) {
+      lhs.insert(i->second);
+    }
+    for (auto i = gotFirst; i != gotLast; ++i) {
+      rhs.insert(i->second);
+    }
+    ASSERT_EQ(lhs, rhs) << "probe row " << it->first;
+    it = wantLast;
+  }
+}
+
+}  // namespace
+
+TEST(HashOperatorsTest, GroupBySmallInput) {
+  const Vector<std::int32_t> keys{3, 1, 3, 2, 1, 3};
+  const Vector<double> values{1.5, 2, 3, 4, 5, 6};
+
+  const auto result = groupBy(Span<const std::int32_t>(keys),
+                              Span<const double>(values));
+
+  ASSERT_EQ(result.keys.size(), 3);
+  std::map<std::int32_t, std::size_t> groupOf;
+  for (std::size_t g = 0; g < result.keys.size(); ++g) {
+    groupOf[result.keys[g]] = g;
+  }
+  ASSERT_EQ(groupOf.size(), 3);
+  const std::size_t three = groupOf.at(3);
+  EXPECT_EQ(result.sums[three], 10.5);
+  EXPECT_EQ(result.counts[three], 3);
+  EXPECT_EQ(result.mins[three], 1.5);
+  EXPECT_EQ(result.maxs[three], 6);
+  EXPECT_EQ(result.sums[groupOf.at(1)], 7);
+  EXPECT_EQ(result.counts[groupOf.at(2)], 1);
+}
+
+TEST(HashOperatorsTest, GroupByEmptyInput) {
+  const Vector<std::int64_t> keys;
+  const Vector<float> values;
+
+  const auto result =
+      groupBy(Span<const std::int64_t>(keys), Span<const float>(values));
+
+  EXPECT_TRUE(result.keys.empty());
+  EXPECT_TRUE(result.sums.empty());
+}
+
+TEST(HashOperatorsTest, GroupByGrowsPastAnUnderestimate) {
+  Vector<std::uint64_t> keys;
+  Vector<std::int32_t> values;
+  makeRows(20'000, 5000, keys, values);
+
+  const auto result = groupBy(Span<const std::uint64_t>(keys),
+                              Span<const std::int32_t>(values),
+                              HashOptions{.expectedGroups = 1});
+
+  expectMatchesMap(keys, values, result);
+}
+
+TEST(HashOperatorsTest, GroupByPartitionedMatchesUnpartitioned) {
+  Vector<std::uint64_t> keys;
+  Vector<std::int32_t> values;
+  makeRows(50'000, 12'345, keys, values);
+
+  // Small enough partitions to force the radix-partitioned path.
+  const auto result = groupBy(Span<const std::uint64_t>(keys),
+                              Span<const std::int32_t>(values),
+                              HashOptions{.partitionBytes = 4096});
+
+  expectMatchesMap(keys, values, result);
+}
+
+TEST(HashOperatorsTest, GroupByMultiThreaded) {
+  Vector<std::uint64_t> keys;
+  Vector<std::int32_t> values;
+  makeRows(300'000, 70'000, keys, values);
+
+  const auto result = groupBy(Span<const std::uint64_t>(keys),
+                              Span<const std::int32_t>(values),
+                              HashOptions{.threads = 4});
+
+  expectMatchesMap(keys, values, result);
+}
+
+TEST(HashOperatorsTest, JoinWithDuplicatesOnBothSides) {
+  const Vector<std::int64_t> build{10, 20, 10, 30};
+  const Vector<std::int64_t> probe{20, 10, 40, 10};
+
+  const JoinResult result = hashJoin(Span<const std::int64_t>(build),
+                                     Span<const std::int64_t>(probe));
+
+  // Unpartitioned, pairs follow the probe rows, and the build rows for each
+  // in input order.
+  EXPECT_TRUE(std::ranges::equal(result.probeRows,
+                                 SelectionVector{0, 1, 1, 3, 3}));
+  EXPECT_TRUE(std::ranges::equal(result.buildRows,
+                                 SelectionVector{1, 0, 2, 0, 2}));
+}
+
+TEST(HashOperatorsTest, JoinWithNoMatches) {
+  const Vector<std::int64_t> build{1, 2, 3};
+  const Vector<std::int64_t> probe{4, 5};
+
+  const JoinResult result = hashJoin(Span<const std::int64_t>(build),
+                                     Span<const std::int64_t>(probe));
+
+  EXPECT_TRUE(result.buildRows.empty());
+  EXPECT_TRUE(result.probeRows.empty());
+}
+
+TEST(HashOperatorsTest, JoinGrowsPastAnUnderestimate) {
+  Vector<std::int64_t> build;
+  Vector<std::int64_t> probe;
+  for (std::int64_t i = 0; i < 100; ++i) {
+    build.push_back(i);
+    probe.push_back(i * 3 % 150);
+  }
+
+  const JoinResult result =
+      hashJoin(Span<const std::int64_t>(build), Span<const std::int64_t>(probe),
+               HashOptions{.expectedGroups = 1});
+
+  expectSamePairs(naiveJoin(build, probe), result);
+}
+
+TEST(HashOperatorsTest, WorkerExceptionsReachTheCaller) {
+  const auto failing = [](std::size_t p) {
+    if (p == 3) {
+      throw std::runtime_error("partition");
+    }
+  };
+
+  EXPECT_THROW(detail::hashing::forEachPartition(64, 4, failing),
+               std::runtime_error);
+}
+
+TEST(HashOperatorsTest, JoinPartitionedAndThreadedMatchNaive) {
+  Vector<std::int64_t> build;
+  Vector<std::int64_t> probe;
+  for (std::int64_t i = 0; i < 100'000; ++i) {
+    build.push_back(i * 7 % 40'000);
+  }
+  for (std::int64_t i = 0; i < 200'000; ++i) {
+    probe.push_back(i * 13 % 90'000 - 1000);
+  }
+  const auto want = naiveJoin(build, probe);
+
+  const JoinResult partitioned =
+      hashJoin(Span<const std::int64_t>(build), Span<const std::int64_t>(probe),
+               HashOptions{.partitionBytes = 8192});
+  const JoinResult threaded =
+      hashJoin(Span<const std::int64_t>(build), Span<const std::int64_t>(probe),
+               HashOptions{.threads = 3});
+
+  expectSamePairs(want, partitioned);
+  expectSamePairs(want, threaded);
+}
+
+TEST(HashOperatorsTest, JoinSelectionsFeedColumnTableTake) {
+  ColumnTable orders;
+  orders.addColumn<std::int64_t>("customer");
+  orders.addColumn<double>("amount");
+  ColumnTable customers;
+  customers.addColumn<std::int64_t>("id");
+  customers.addColumn<std::int32_t>("region");
+  for (std::int64_t i = 0; i < 6; ++i) {
+    orders.column<std::int64_t>("customer").append(i % 3);
+    orders.column<double>("amount").append(static_cast<double>(i));
+  }
+  for (std::int64_t id : {2, 0}) {
+    customers.column<std::int64_t>("id").append(id);
+    customers.column<std::int32_t>("region").append(
+        static_cast<std::int32_t>(id * 10));
+  }
+
+  const auto& customerIds = customers.column<std::int64_t>("id").values();
+  const auto& orderCustomers =
+      orders.column<std::int64_t>("customer").values();
+  const JoinResult joined =
+      hashJoin(Span<const std::int64_t>(customerIds),
+               Span<const std::int64_t>(orderCustomers));
+  const ColumnTable regions = customers.take(joined.buildRows);
+  const ColumnTable amounts = orders.take(joined.probeRows);
+
+  ASSERT_EQ(regions.rows(), 4);
+  ASSERT_EQ(amounts.rows(), 4);
+  for (std::size_t i = 0; i < 4; ++i) {
+    const auto amount = amounts.column<double>("amount").values()[i];
+    const auto region = regions.column<std::int32_t>("region").values()[i];
+    EXPECT_EQ(region, static_cast<std::int32_t>(amount) % 3 * 10);
+  }
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,153 @@
+#include "src/stl/HdrHistogram.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <thread>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+using Histogram = HdrHistogram<>;
+
+TEST(HdrHistogramTest, SmallValuesAreExact) {
+  for (std::uint64_t v = 0; v < Histogram::kSubBuckets; ++v) {
+    const auto index = Histogram::indexOf(v);
+    EXPECT_EQ(Histogram::lowestInBucket(index), v);
+    EXPECT_EQ(Histogram::highestInBucket(index), v);
+  }
+}
+
+TEST(HdrHistogramTest, BucketsTileTheWholeRange) {
+  // Each bucket starts right after the previous one ends.
+  for (std::size_t i = 1; i < Histogram::kBuckets; ++i) {
+    ASSERT_EQ(Histogram::lowestInBucket(i),
+              Histogram::highestInBucket(i - 1) + 1)
+        << i;
+  }
+  EXPECT_EQ(Histogram::highestInBucket(Histogram::kBuckets - 1),
+            std::numeric_limits<std::uint64_t>::max());
+  EXPECT_EQ(Histogram::indexOf(std::numeric_limits<std::uint64_t>::max()),
+            Histogram::kBuckets - 1);
+}
+
+TEST(HdrHistogramTest, RelativeErrorIsBounded) {
+  std::mt19937_64 rng(7);
+  for (int i = 0; i < 100'000; ++i) {
+    const std::uint64_t v = rng() >> (rng() % 64);
+    const auto index = Histogram::indexOf(v);
+    const auto low = Histogram::lowestInBucket(index);
+    const auto high = Histogram::highestInBucket(index);
+    ASSERT_LE(low, v);
+    ASSERT_GE(high, v);
+    ASSERT_LE(static_cast<double>(high - low),
+              static_cast<double>(v) / static_cast<double>(Histogram::kHalf))
+        << v;
+  }
+}
+
+TEST(HdrHistogramTest, Percentiles) {
+  Histogram underTest;
+  for (std::uint64_t v = 1; v <= 10'000; ++v) {
+    underTest.record(v);
+  }
+
+  EXPECT_EQ(underTest.count(), 10'000);
+  EXPECT_EQ(underTest.min(), 1);
+  EXPECT_EQ(underTest.max(), 10'000);
+  EXPECT_DOUBLE_EQ(underTest.mean(), 5000.5);
+  for (const double p : {50.0, 90.0, 99.0, 99.9}) {
+    const auto exact = static_cast<double>(p * 100);
+    const auto got = static_cast<double>(underTest.valueAtPercentile(p));
+    EXPECT_GE(got, exact) << p;
+    EXPECT_LE(got, exact * (1 + 1.0 / Histogram::kHalf)) << p;
+  }
+  EXPECT_EQ(underTest.valueAtPercentile(100), 10'000);
+  EXPECT_EQ(underTest.valueAtPercentile(0), 1);
+}
+
+TEST(HdrHistogramTest, TailSpikesShowAbovePercentiles) {
+  // Reallocation-like: cheap operations, with a rare expensive one.
+  Histogram underTest;
+  for (int i = 0; i < 100'000; ++i) {
+    underTest.record(i % 1000 == 0 ? 50'000 : 10);
+  }
+
+  EXPECT_EQ(underTest.valueAtPercentile(50), 10);
+  EXPECT_EQ(underTest.valueAtPercentile(99), 10);
+  EXPECT_GE(underTest.valueAtPercentile(99.95), 50'000);
+  EXPECT_EQ(underTest.max(), 50'000);
+  EXPECT_LT(underTest.mean(), 100);
+}
+
+TEST(HdrHistogramTest, RecordWithCount) {
+  Histogram counted;
+  Histogram single;
+  counted.record(300, 5);
+  counted.record(7, 0);
+  for (int i = 0; i < 5; ++i) {
+    single.record(300);
+  }
+
+  EXPECT_EQ(counted.count(), 5);
+  EXPECT_EQ(counted.min(), 300);
+  EXPECT_EQ(counted.countAt(300), single.countAt(300));
+  EXPECT_EQ(counted.valueAtPercentile(50), single.valueAtPercentile(50));
+}
+
+TEST(HdrHistogramTest, MergeAcrossThreads) {
+  constexpr int kThreads = 4;
+  Vector<Histogram> perThread(kThreads);
+  {
+    Vector<std::jthread> workers;
+    for (int t = 0; t < kThreads; ++t) {
+      workers.emplace_back([&, t] {
+        for (std::uint64_t v = 0; v < 1000; ++v) {
+          perThread[static_cast<std::size_t>(t)].record(
+              v * static_cast<std::uint64_t>(t + 1));
+        }
+      });
+    }
+  }
+
+  Histogram merged;
+  Histogram direct;
+  for (int t = 0; t < kThreads; ++t) {
+    merged.merge(perThread[static_cast<std::size_t>(t)]);
+    for (std::uint64_t v = 0; v < 1000; ++v) {
+      direct.record(v * static_cast<std::uint64_t>(t + 1));
+    }
+  }
+
+  EXPECT_EQ(merged.count(), direct.count());
+  EXPECT_EQ(merged.min(), direct.min());
+  EXPECT_EQ(merged.max(), direct.max());
+  EXPECT_DOUBLE_EQ(merged.mean(), direct.mean());
+  for (const double p : {1.0, 50.0, 99.0, 99.9}) {
+    EXPECT_EQ(merged.valueAtPercentile(p), direct.valueAtPercentile(p));
+  }
+}
+
+TEST(HdrHistogramTest, EmptyAndReset) {
+  Histogram underTest;
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.valueAtPercentile(99), 0);
+  EXPECT_EQ(underTest.min(), 0);
+  EXPECT_EQ(underTest.mean(), 0.0);
+
+  underTest.record(std::numeric_limits<std::uint64_t>::max());
+  EXPECT_EQ(underTest.valueAtPercentile(50),
+            std::numeric_limits<std::uint64_t>::max());
+
+  underTest.reset();
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.max(), 0);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
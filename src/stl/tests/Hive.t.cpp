@@ -0,0 +1,226 @@
+#include "src/stl/Hive.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <string>
+
+#include "src/stl/Vector.hpp"
+#include "src/testutil/LifetimeTracker.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+static_assert(std::bidirectional_iterator<Hive<int>::IteratorT>);
+static_assert(std::bidirectional_iterator<Hive<int>::ConstIteratorT>);
+
+// The elements in ascending order, for comparison ignoring iteration order.
+template <typename T>
+Vector<T> sorted(const Hive<T>& hive) {
+  Vector<T> values;
+  for (const T& value : hive) {
+    values.push_back(value);
+  }
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+TEST(HiveTest, InsertAndIterate) {
+  Hive<int> underTest;
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.begin(), underTest.end());
+
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(*underTest.insert(i), i);
+  }
+  EXPECT_EQ(underTest.size(), 1000);
+  EXPECT_EQ(std::distance(underTest.begin(), underTest.end()), 1000);
+
+  const Vector<int> values = sorted(underTest);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(values[static_cast<std::size_t>(i)], i);
+  }
+}
+
+TEST(HiveTest, BlocksGrowGeometrically) {
+  Hive<int> underTest;
+  underTest.insert(0);
+  EXPECT_EQ(underTest.capacity(), Hive<int>::kMinBlockCapacity);
+  for (int i = 1; i < 100'000; ++i) {
+    underTest.insert(i);
+  }
+  EXPECT_LT(underTest.capacity(), 2 * 100'000);
+}
+
+TEST(HiveTest, ElementsNeverMove) {
+  Hive<std::string> underTest;
+  Vector<std::string*> addresses;
+  for (int i = 0; i < 500; ++i) {
+    addresses.push_back(&*underTest.insert(std::to_string(i)));
+  }
+  // Erase every third, then insert again, reusing the holes.
+  for (std::size_t i = 0; i < addresses.size(); i += 3) {
+    underTest.erase(underTest.getIterator(addresses[i]));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    underTest.insert("new");
+  }
+  for (std::size_t i = 0; i < addresses.size(); ++i) {
+    if (i % 3 != 0) {
+      EXPECT_EQ(*addresses[i], std::to_string(i));
+    }
+  }
+}
+
+TEST(HiveTest, EraseReturnsNextAndSkipsRuns) {
+  Hive<int> underTest;
+  for (int i = 0; i < 100; ++i) {
+    underTest.insert(i);
+  }
+
+  // Erase runs of various lengths, in an order that joins runs from both
+  // sides.
+  int visited = 0;
+  for (auto it = underTest.begin(); it != underTest.end();) {
+    if (*it % 7 < 3 || *it % 11 == 5) {
+      it = underTest.erase(it);
+    } else {
+      ++it;
+      ++visited;
+    }
+  }
+  EXPECT_EQ(underTest.size(), static_cast<std::size_t>(visited));
+  for (int value : underTest) {
+    EXPECT_FALSE(value % 7 < 3 || value % 11 == 5) << value;
+  }
+
+  // Backwards visits the same elements.
+  Vector<int> backwards;
+  for (auto it = underTest.end(); it != underTest.begin();) {
+    backwards.push_back(*--it);
+  }
+  std::reverse(backwards.begin(), backwards.end());
+  Vector<int> forwards;
+  for (int value : underTest) {
+    forwards.push_back(value);
+  }
+  EXPECT_TRUE(std::ranges::equal(forwards, backwards));
+}
+
+TEST(HiveTest, ErasedSlotsAreReused) {
+  Hive<int> underTest;
+  for (int i = 0; i < 10'000; ++i) {
+    underTest.insert(i);
+  }
+  const auto capacity = underTest.capacity();
+
+  std::mt19937 rng(3);
+  for (int round = 0; round < 20; ++round) {
+    for (auto it = underTest.begin(); it != underTest.end();) {
+      it = rng() % 2 == 0 ? underTest.erase(it) : std::next(it);
+    }
+    while (underTest.size() < 10'000) {
+      underTest.insert(round);
+    }
+  }
+  EXPECT_EQ(underTest.capacity(), capacity);
+}
+
+TEST(HiveTest, MatchesReferenceUnderRandomChurn) {
+  Hive<int> underTest;
+  Vector<int> reference;
+  std::mt19937 rng(11);
+  for (int step = 0; step < 50'000; ++step) {
+    if (reference.empty() || rng() % 5 < 3) {
+      const int value = static_cast<int>(rng() % 1000);
+      underTest.insert(value);
+      reference.push_back(value);
+    } else {
+      // Erase a random element from the hive, and its value from the
+      // reference.
+      auto it = underTest.begin();
+      std::advance(it, rng() % underTest.size());
+      const auto found = std::find(reference.begin(), reference.end(), *it);
+      std::swap(*found, reference[reference.size() - 1]);
+      reference.pop_back();
+      underTest.erase(it);
+    }
+    if (step % 5000 == 0) {
+      Vector<int> expected = reference;
+      std::sort(expected.begin(), expected.end());
+      ASSERT_TRUE(std::ranges::equal(sorted(underTest), expected)) << step;
+      std::size_t backwards = 0;
+      for (auto it = underTest.end(); it != underTest.begin(); --it) {
+        ++backwards;
+      }
+      ASSERT_EQ(backwards, underTest.size()) << step;
+    }
+  }
+  EXPECT_EQ(underTest.size(), reference.size());
+}
+
+TEST(HiveTest, EmptiedBlocksAreKeptUntilTrimmed) {
+  Hive<int> underTest;
+  for (int i = 0; i < 1000; ++i) {
+    underTest.insert(i);
+  }
+  const auto capacity = underTest.capacity();
+  for (auto it = underTest.begin(); it != underTest.end();) {
+    it = underTest.erase(it);
+  }
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.begin(), underTest.end());
+  EXPECT_EQ(underTest.capacity(), capacity);
+
+  underTest.insert(1);
+  EXPECT_EQ(underTest.capacity(), capacity);
+  underTest.clear();
+  underTest.trimCapacity();
+  EXPECT_EQ(underTest.capacity(), 0);
+
+  underTest.reserve(5000);
+  EXPECT_GE(underTest.capacity(), 5000);
+}
+
+TEST(HiveTest, CopyAndMove) {
+  Hive<std::string> source{"a", "b", "c", "d"};
+  source.erase(source.begin());
+
+  Hive<std::string> copy(source);
+  EXPECT_TRUE(std::ranges::equal(sorted(copy), sorted(source)));
+
+  Hive<std::string> assigned{"x"};
+  assigned = source;
+  EXPECT_TRUE(std::ranges::equal(sorted(assigned), sorted(source)));
+
+  Hive<std::string> moved(std::move(copy));
+  EXPECT_EQ(moved.size(), 3);
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(copy.capacity(), 0);
+}
+
+TEST(HiveTest, ElementsAreDestroyed) {
+  LifetimeTracker::reset();
+  {
+    Hive<LifetimeTracker> underTest;
+    for (int i = 0; i < 100; ++i) {
+      underTest.emplace();
+    }
+    int i = 0;
+    for (auto it = underTest.begin(); it != underTest.end(); ++i) {
+      it = i % 2 == 0 ? underTest.erase(it) : std::next(it);
+    }
+    EXPECT_EQ(LifetimeTracker::destructions, 50);
+    underTest.clear();
+    EXPECT_EQ(LifetimeTracker::destructions, 100);
+    underTest.emplace();
+  }
+  EXPECT_EQ(LifetimeTracker::constructions, 101);
+  EXPECT_EQ(LifetimeTracker::destructions, 101);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,234 @@
+#include "src/stl/IntrusiveList.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+namespace {
+
+// In two lists at once, and polymorphic, so the hooks are not at offset 0.
+struct Request {
+  virtual ~Request() = default;
+
+  explicit Request(int id) : id(id) {}
+
+  int id;
+  std::string payload;
+  IntrusiveListHook<> pending;
+  IntrusiveListHook<LinkMode::kNormal> byClient;
+};
+
+struct Connection {
+  explicit Connection(int id) : id(id) {}
+
+  int id;
+  IntrusiveListHook<LinkMode::kAutoUnlink> idle;
+};
+
+struct Job {
+  int id;
+  IntrusiveForwardHook next;
+};
+
+template <typename List>
+Vector<int> idsOf(const List& list) {
+  Vector<int> ids;
+  for (const auto& value : list) {
+    ids.push_back(value.id);
+  }
+  return ids;
+}
+
+}  // namespace
+
+static_assert(std::bidirectional_iterator<
+              IntrusiveList<Request, &Request::pending>::Iterator>);
+static_assert(std::bidirectional_iterator<
+              IntrusiveList<Request, &Request::pending>::ConstIterator>);
+
+TEST(IntrusiveListTest, PushPopAndIterate) {
+  Request a(1), b(2), c(3);
+  IntrusiveList<Request, &Request::pending> underTest;
+
+  underTest.pushBack(b);
+  underTest.pushBack(c);
+  underTest.pushFront(a);
+
+  EXPECT_EQ(underTest.size(), 3);
+  EXPECT_TRUE(std::ranges::equal(idsOf(underTest), Vector<int>{1, 2, 3}));
+  EXPECT_EQ(underTest.front().id, 1);
+  EXPECT_EQ(underTest.back().id, 3);
+  EXPECT_EQ(std::prev(underTest.end())->id, 3);
+
+  underTest.popFront();
+  underTest.popBack();
+
+  EXPECT_EQ(underTest.size(), 1);
+  EXPECT_EQ(underTest.front().id, 2);
+  EXPECT_FALSE(a.pending.isLinked());
+  EXPECT_TRUE(b.pending.isLinked());
+  underTest.clear();
+  EXPECT_FALSE(b.pending.isLinked());
+}
+
+TEST(IntrusiveListTest, ObjectsCanBeInSeveralListsAtOnce) {
+  Vector<Request> requests;
+  for (int i = 0; i < 6; ++i) {
+    requests.emplace_back(i);
+  }
+  IntrusiveList<Request, &Request::pending> pending;
+  IntrusiveList<Request, &Request::byClient> byClient;
+
+  for (auto& request : requests) {
+    pending.pushBack(request);
+    if (request.id % 2 == 0) {
+      byClient.pushFront(request);
+    }
+  }
+
+  EXPECT_TRUE(std::ranges::equal(idsOf(pending),
+                                 Vector<int>{0, 1, 2, 3, 4, 5}));
+  EXPECT_TRUE(std::ranges::equal(idsOf(byClient), Vector<int>{4, 2, 0}));
+
+  pending.remove(requests[2]);
+  byClient.remove(requests[2]);
+
+  EXPECT_TRUE(std::ranges::equal(idsOf(pending), Vector<int>{0, 1, 3, 4, 5}));
+  EXPECT_TRUE(std::ranges::equal(idsOf(byClient), Vector<int>{4, 0}));
+}
+
+TEST(IntrusiveListTest, EraseAndInsertAtAnyPosition) {
+  Request a(1), b(2), c(3), d(4);
+  IntrusiveList<Request, &Request::pending> underTest;
+  underTest.pushBack(a);
+  underTest.pushBack(c);
+
+  const auto it = underTest.insert(underTest.iteratorTo(c), b);
+  EXPECT_EQ(it->id, 2);
+  underTest.insert(underTest.end(), d);
+
+  const auto next = underTest.erase(underTest.iteratorTo(c));
+
+  EXPECT_EQ(next->id, 4);
+  EXPECT_TRUE(std::ranges::equal(idsOf(underTest), Vector<int>{1, 2, 4}));
+  underTest.clear();
+}
+
+TEST(IntrusiveListTest, MoveSpliceAndSwap) {
+  Request a(1), b(2), c(3);
+  IntrusiveList<Request, &Request::pending> first;
+  IntrusiveList<Request, &Request::pending> second;
+  first.pushBack(a);
+  first.pushBack(b);
+  second.pushBack(c);
+
+  first.swap(second);
+  EXPECT_TRUE(std::ranges::equal(idsOf(first), Vector<int>{3}));
+  EXPECT_TRUE(std::ranges::equal(idsOf(second), Vector<int>{1, 2}));
+
+  IntrusiveList<Request, &Request::pending> moved = std::move(second);
+  EXPECT_TRUE(second.empty());
+  EXPECT_EQ(moved.size(), 2);
+
+  first.splice(first.begin(), moved);
+  EXPECT_TRUE(moved.empty());
+  EXPECT_EQ(first.size(), 3);
+  EXPECT_TRUE(std::ranges::equal(idsOf(first), Vector<int>{1, 2, 3}));
+
+  IntrusiveList<Request, &Request::pending> empty;
+  first.swap(empty);
+  EXPECT_TRUE(first.empty());
+  EXPECT_TRUE(std::ranges::equal(idsOf(empty), Vector<int>{1, 2, 3}));
+}
+
+TEST(IntrusiveListTest, CopiedObjectsAreNotLinked) {
+  Request a(1);
+  IntrusiveList<Request, &Request::pending> underTest;
+  underTest.pushBack(a);
+
+  Request copy = a;
+  copy = a;
+
+  EXPECT_FALSE(copy.pending.isLinked());
+  EXPECT_EQ(underTest.size(), 1);
+  underTest.clear();
+}
+
+TEST(IntrusiveListTest, SafeHookAbortsWhenDestroyedWhileLinked) {
+  using PendingList = IntrusiveList<Request, &Request::pending>;
+  EXPECT_DEATH(
+      {
+        PendingList list;
+        {
+          Request doomed(1);
+          list.pushBack(doomed);
+        }
+      },
+      "");
+}
+
+TEST(IntrusiveListTest, AutoUnlinkHooksLeaveOnDestruction) {
+  IntrusiveList<Connection, &Connection::idle> underTest;
+  Connection a(1);
+  {
+    Connection b(2);
+    Connection c(3);
+    underTest.pushBack(a);
+    underTest.pushBack(b);
+    underTest.pushBack(c);
+    c.idle.unlink();
+    EXPECT_EQ(underTest.size(), 2);
+  }
+
+  EXPECT_EQ(underTest.size(), 1);
+  EXPECT_EQ(underTest.front().id, 1);
+}
+
+TEST(IntrusiveStackTest, IsLastInFirstOut) {
+  Job jobs[3] = {{1, {}}, {2, {}}, {3, {}}};
+  IntrusiveStack<Job, &Job::next> underTest;
+
+  for (auto& job : jobs) {
+    underTest.push(job);
+  }
+
+  EXPECT_EQ(underTest.top().id, 3);
+  EXPECT_EQ(underTest.pop().id, 3);
+  EXPECT_EQ(underTest.pop().id, 2);
+  EXPECT_EQ(underTest.pop().id, 1);
+  EXPECT_TRUE(underTest.empty());
+}
+
+TEST(IntrusiveQueueTest, IsFirstInFirstOutAndAppends) {
+  Job jobs[4] = {{1, {}}, {2, {}}, {3, {}}, {4, {}}};
+  IntrusiveQueue<Job, &Job::next> underTest;
+  IntrusiveQueue<Job, &Job::next> other;
+
+  underTest.push(jobs[0]);
+  underTest.push(jobs[1]);
+  other.push(jobs[2]);
+  other.push(jobs[3]);
+  underTest.append(other);
+
+  EXPECT_TRUE(other.empty());
+  EXPECT_EQ(underTest.back().id, 4);
+  for (int id = 1; id <= 4; ++id) {
+    EXPECT_EQ(underTest.front().id, id);
+    EXPECT_EQ(underTest.pop().id, id);
+  }
+  EXPECT_TRUE(underTest.empty());
+
+  underTest.push(jobs[0]);
+  EXPECT_EQ(underTest.back().id, 1);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,203 @@
+#include "src/stl/IoLoop.hpp"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "src/stl/Task.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+class IoLoopTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    char path[] = "/tmp/ioloop_test_XXXXXX";
+    fd_ = ::mkstemp(path);
+    ASSERT_GE(fd_, 0);
+    ::unlink(path);
+
+    contents_.resize(kFileSize);
+    for (std::size_t i = 0; i < kFileSize; ++i) {
+      contents_[i] = static_cast<std::byte>(i * 31 % 251);
+    }
+    ASSERT_EQ(::pwrite(fd_, contents_.data(), kFileSize, 0),
+              static_cast<ssize_t>(kFileSize));
+  }
+
+  void TearDown() override { ::close(fd_); }
+
+  IoLoop makeLoop() {
+    return IoLoop(IoLoop::Options{.entries = 8,
+                                  .fallbackThreads = 2,
+                                  .forceThreadPool = GetParam()});
+  }
+
+  static constexpr std::size_t kFileSize = 64 * 1024;
+
+  int fd_ = -1;
+  Vector<std::byte> contents_;
+};
+
+TEST_P(IoLoopTest, ReadsIntoVector) {
+  IoLoop loop = makeLoop();
+  Vector<std::byte> buffer(1000);
+
+  auto readAt = [&](std::uint64_t offset) -> Task<IoResult> {
+    co_return co_await loop.read(fd_, buffer, offset);
+  };
+  IoResult result = loop.run(readAt(500));
+
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.bytes(), 1000);
+  EXPECT_EQ(buffer[0], contents_[500]);
+  EXPECT_EQ(buffer[999], contents_[1499]);
+}
+
+TEST_P(IoLoopTest, WritesFromVector) {
+  IoLoop loop = makeLoop();
+  Vector<std::byte> buffer(16, std::byte{0x7f});
+
+  auto writeAt = [&](std::uint64_t offset) -> Task<IoResult> {
+    co_return co_await loop.write(fd_, buffer, offset);
+  };
+  IoResult result = loop.run(writeAt(kFileSize));
+
+  ASSERT_TRUE(result.ok());
+  std::byte readBack{};
+  ASSERT_EQ(::pread(fd_, &readBack, 1, kFileSize + 15), 1);
+  EXPECT_EQ(readBack, std::byte{0x7f});
+}
+
+TEST_P(IoLoopTest, ReportsErrorsAsNegatedErrno) {
+  IoLoop loop = makeLoop();
+  Vector<std::byte> buffer(16);
+
+  auto readBadFd = [&]() -> Task<IoResult> {
+    co_return co_await loop.read(-1, buffer, 0);
+  };
+  IoResult result = loop.run(readBadFd());
+
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(result.error(), EBADF);
+}
+
+TEST_P(IoLoopTest, ManyConcurrentReadsBeyondTheQueueDepth) {
+  IoLoop loop = makeLoop();
+  constexpr std::size_t kChunk = 1024;
+  Vector<Vector<std::byte>> buffers;
+  for (std::size_t i = 0; i < kFileSize / kChunk; ++i) {
+    buffers.emplace_back(kChunk);
+  }
+
+  auto readChunk = [&](std::size_t i) -> Task<std::size_t> {
+    IoResult result = co_await loop.read(fd_, buffers[i], i * kChunk);
+    co_return result.bytes();
+  };
+  Vector<Task<std::size_t>> tasks;
+  for (std::size_t i = 0; i < buffers.size(); ++i) {
+    tasks.push_back(readChunk(i));
+  }
+  Vector<std::size_t> sizes = loop.run(whenAll(std::move(tasks)));
+
+  for (std::size_t i = 0; i < buffers.size(); ++i) {
+    ASSERT_EQ(sizes[i], kChunk);
+    ASSERT_EQ(buffers[i][kChunk - 1], contents_[i * kChunk + kChunk - 1]);
+  }
+}
+
+TEST_P(IoLoopTest, RegisteredBuffers) {
+  IoLoop loop = makeLoop();
+  Vector<Vector<std::byte>> buffers;
+  buffers.emplace_back(4096);
+  buffers.emplace_back(4096);
+  // Either outcome is valid, e.g. under a tight RLIMIT_MEMLOCK.
+  loop.registerBuffers(buffers);
+
+  auto copy = [&]() -> Task<IoResult> {
+    co_await loop.readFixed(fd_, 1, 4096);
+    // Copied element-wise, as the registered storage must stay in place.
+    std::copy(buffers[1].begin(), buffers[1].end(), buffers[0].begin());
+    co_return co_await loop.writeFixed(fd_, 0, 4096, kFileSize);
+  };
+  IoResult result = loop.run(copy());
+
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ(result.bytes(), 4096);
+
+  std::byte readBack{};
+  ASSERT_EQ(::pread(fd_, &readBack, 1, kFileSize + 100), 1);
+  EXPECT_EQ(readBack, contents_[4096 + 100]);
+}
+
+TEST_P(IoLoopTest, RegisteringAgainReplacesTheBuffers) {
+  IoLoop loop = makeLoop();
+  Vector<Vector<std::byte>> first;
+  first.emplace_back(4096);
+  Vector<Vector<std::byte>> second;
+  second.emplace_back(4096);
+  const bool registered = loop.registerBuffers(first);
+  // The kernel refuses a second set until the first is unregistered.
+  EXPECT_EQ(loop.registerBuffers(second), registered);
+
+  auto readIntoSecond = [&]() -> Task<IoResult> {
+    co_return co_await loop.readFixed(fd_, 0, 8192);
+  };
+  IoResult result = loop.run(readIntoSecond());
+
+  ASSERT_TRUE(result.ok()) << result.error();
+  EXPECT_EQ(second[0][10], contents_[8192 + 10]);
+}
+
+TEST_P(IoLoopTest, ThreadPoolServesOperationsInOrder) {
+  if (!GetParam()) {
+    GTEST_SKIP() << "io_uring does not order independent operations";
+  }
+  IoLoop loop(IoLoop::Options{.fallbackThreads = 1, .forceThreadPool = true});
+  const Vector<std::byte> first(1, std::byte{1});
+  const Vector<std::byte> second(1, std::byte{2});
+
+  auto writeAt = [&](const Vector<std::byte>& buffer) -> Task<IoResult> {
+    co_return co_await loop.write(fd_, buffer, 0);
+  };
+  Vector<Task<IoResult>> writes;
+  writes.push_back(writeAt(first));
+  writes.push_back(writeAt(second));
+  loop.run(whenAll(std::move(writes)));
+
+  std::byte readBack{};
+  ASSERT_EQ(::pread(fd_, &readBack, 1, 0), 1);
+  EXPECT_EQ(readBack, std::byte{2});
+}
+
+TEST_P(IoLoopTest, ReadsWholeFile) {
+  IoLoop loop = makeLoop();
+
+  Vector<std::byte> underTest = loop.run(readFile(loop, fd_, 4096));
+
+  ASSERT_EQ(underTest.size(), kFileSize);
+  for (std::size_t i = 0; i < kFileSize; ++i) {
+    ASSERT_EQ(underTest[i], contents_[i]);
+  }
+}
+
+TEST_P(IoLoopTest, RunRejectsTasksBlockedOnSomethingElse) {
+  IoLoop loop = makeLoop();
+  auto neverResumed = []() -> Task<> { co_await std::suspend_always{}; };
+
+  EXPECT_THROW(loop.run(neverResumed()), std::logic_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, IoLoopTest, ::testing::Bool(),
+                         [](const auto& info) {
+                           return info.param ? "ThreadPool" : "IoUring";
+                         });
+
+}  // namespace test
+}  // namespace ecx::stl
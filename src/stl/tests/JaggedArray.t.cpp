@@ -0,0 +1,137 @@
+#include "src/stl/JaggedArray.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+TEST(JaggedArrayTest, AppendRows) {
+  JaggedArray<int> underTest;
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.rows(), 0);
+  EXPECT_EQ(underTest.offsets().size(), 0);
+
+  underTest.appendRow({1, 2, 3});
+  underTest.appendRow();
+  const Vector<int> row{4, 5};
+  underTest.appendRow(row);
+  underTest.appendRow();
+  underTest.pushBack(6);
+
+  ASSERT_EQ(underTest.rows(), 4);
+  EXPECT_EQ(underTest.size(), 6);
+  const int first[] = {1, 2, 3};
+  EXPECT_TRUE(std::ranges::equal(underTest[0], first));
+  EXPECT_TRUE(underTest[1].empty());
+  EXPECT_TRUE(std::ranges::equal(underTest[2], row));
+  EXPECT_EQ(underTest.rowSize(3), 1);
+  EXPECT_EQ(underTest[3][0], 6);
+
+  const std::size_t offsets[] = {0, 3, 3, 5, 6};
+  EXPECT_TRUE(std::ranges::equal(underTest.offsets(), offsets));
+  const int values[] = {1, 2, 3, 4, 5, 6};
+  EXPECT_TRUE(std::ranges::equal(underTest.values(), values));
+}
+
+TEST(JaggedArrayTest, RowsAreMutable) {
+  JaggedArray<std::string> underTest;
+  underTest.appendRow({"a", "b"});
+  // Not a literal: GCC 12 at -O3 warns -Wrestrict inside the string's
+  // assignment from const char*.
+  underTest[0][1] = std::string("c");
+  EXPECT_EQ(underTest[0][1], "c");
+
+  underTest.clear();
+  EXPECT_EQ(underTest.rows(), 0);
+  EXPECT_EQ(underTest.size(), 0);
+}
+
+TEST(JaggedArrayTest, BuilderCountsThenFills) {
+  // Edges of a small graph, grouped by source.
+  const std::pair<std::uint32_t, std::uint32_t> edges[] = {
+      {2, 0}, {0, 1}, {2, 1}, {0, 3}, {3, 2}, {2, 3}};
+
+  JaggedArray<std::uint32_t>::Builder builder(5);
+  for (const auto& [from, to] : edges) {
+    builder.count(from);
+  }
+  builder.allocate();
+  for (const auto& [from, to] : edges) {
+    builder.fill(from, to);
+  }
+  const JaggedArray<std::uint32_t> underTest = std::move(builder).build();
+
+  ASSERT_EQ(underTest.rows(), 5);
+  EXPECT_EQ(underTest.size(), 6);
+  // From one thread, each row keeps the order of the fills.
+  const std::uint32_t from0[] = {1, 3};
+  const std::uint32_t from2[] = {0, 1, 3};
+  EXPECT_TRUE(std::ranges::equal(underTest[0], from0));
+  EXPECT_TRUE(underTest[1].empty());
+  EXPECT_TRUE(std::ranges::equal(underTest[2], from2));
+  EXPECT_EQ(underTest[3][0], 2);
+  EXPECT_TRUE(underTest[4].empty());
+}
+
+TEST(JaggedArrayTest, BuilderFromSeveralThreads) {
+  constexpr std::size_t kRows = 1000;
+  constexpr std::size_t kEdges = 200'000;
+  constexpr unsigned kThreads = 4;
+
+  std::mt19937 rng(5);
+  Vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+  for (std::size_t e = 0; e < kEdges; ++e) {
+    edges.push_back({static_cast<std::uint32_t>(rng() % kRows),
+                     static_cast<std::uint32_t>(e)});
+  }
+
+  JaggedArray<std::uint32_t>::Builder builder(kRows);
+  const auto inParallel = [&](auto&& perEdge) {
+    Vector<std::jthread> workers;
+    for (unsigned t = 0; t < kThreads; ++t) {
+      workers.emplace_back([&, t] {
+        for (std::size_t e = t; e < kEdges; e += kThreads) {
+          perEdge(edges[e]);
+        }
+      });
+    }
+  };
+  inParallel([&](const auto& edge) { builder.countConcurrent(edge.first); });
+  builder.allocate();
+  inParallel([&](const auto& edge) {
+    builder.fillConcurrent(edge.first, edge.second);
+  });
+  JaggedArray<std::uint32_t> underTest = std::move(builder).build();
+
+  // The same rows as a sequential build, up to order within each row.
+  JaggedArray<std::uint32_t> expected;
+  {
+    Vector<Vector<std::uint32_t>> rows(kRows);
+    for (const auto& [from, to] : edges) {
+      rows[from].push_back(to);
+    }
+    for (const auto& row : rows) {
+      expected.appendRow(row);
+    }
+  }
+  ASSERT_EQ(underTest.rows(), kRows);
+  ASSERT_EQ(underTest.size(), kEdges);
+  for (std::size_t r = 0; r < kRows; ++r) {
+    auto row = underTest[r];
+    std::sort(row.begin(), row.end());
+    ASSERT_TRUE(std::ranges::equal(row, expected[r])) << r;
+  }
+}
+
+}  // namespace test
+}  // namespace ecx::stl
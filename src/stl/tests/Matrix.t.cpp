@@ -0,0 +1,142 @@
+#include "src/stl/Matrix.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ecx::stl {
+namespace test {
+
+namespace {
+
+// Small integers, so that float products and sums are exact and results can
+// be compared for equality whatever the order of accumulation.
+template <typename T>
+Matrix<T> patterned(std::size_t rows, std::size_t cols, int seed) {
+  Matrix<T> m(rows, cols);
+  for (std::size_t r = 0; r < rows; ++r) {
+    for (std::size_t c = 0; c < cols; ++c) {
+      m[r, c] = static_cast<T>(static_cast<int>((r * 7 + c * 3 + seed) % 9) -
+                               4);
+    }
+  }
+  return m;
+}
+
+template <typename T>
+Matrix<T> naiveMultiply(const Matrix<T>& a, const Matrix<T>& b) {
+  Matrix<T> c(a.rows(), b.cols());
+  for (std::size_t i = 0; i < a.rows(); ++i) {
+    for (std::size_t j = 0; j < b.cols(); ++j) {
+      T sum{};
+      for (std::size_t p = 0; p < a.cols(); ++p) {
+        sum += a[i, p] * b[p, j];
+      }
+      c[i, j] = sum;
+    }
+  }
+  return c;
+}
+
+}  // namespace
+
+TEST(MatrixTest, RowsAreCacheLineAlignedAndPadded) {
+  Matrix<float> underTest(3, 5);
+
+  EXPECT_EQ(underTest.rows(), 3);
+  EXPECT_EQ(underTest.cols(), 5);
+  EXPECT_EQ(underTest.leadingDimension(), 16);
+  for (std::size_t r = 0; r < underTest.rows(); ++r) {
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(underTest.row(r).data()) % 64,
+              0);
+  }
+}
+
+TEST(MatrixTest, ElementAccessAndViews) {
+  Matrix<int> underTest{{1, 2, 3}, {4, 5, 6}};
+
+  EXPECT_EQ((underTest[1, 2]), 6);
+  EXPECT_EQ(underTest.row(1).size(), 3);
+  EXPECT_EQ(underTest.row(1)[0], 4);
+
+  auto view = underTest.view();
+  EXPECT_EQ(view.extent(0), 2);
+  EXPECT_EQ(view.extent(1), 3);
+  view[0, 1] = 20;
+  EXPECT_EQ((underTest[0, 1]), 20);
+}
+
+TEST(MatrixTest, EqualityIgnoresPadding) {
+  Matrix<int> lhs(2, 3, 7);
+  Matrix<int> rhs(2, 3, 7);
+
+  EXPECT_EQ(lhs, rhs);
+  rhs[1, 2] = 0;
+  EXPECT_NE(lhs, rhs);
+  EXPECT_NE(lhs, Matrix<int>(3, 2, 7));
+}
+
+TEST(MatrixTest, MultiplyMatchesNaiveProductOnRaggedSizes) {
+  // Not a multiple of any block size, so every edge path is exercised.
+  const auto a = patterned<float>(37, 53, 1);
+  const auto b = patterned<float>(53, 29, 2);
+
+  EXPECT_EQ(multiply(a, b), naiveMultiply(a, b));
+}
+
+TEST(MatrixTest, MultiplySpansSeveralCacheBlocks) {
+  const auto a = patterned<float>(131, 300, 3);
+  const auto b = patterned<float>(300, 70, 4);
+
+  EXPECT_EQ(multiply(a, b), naiveMultiply(a, b));
+}
+
+TEST(MatrixTest, MultithreadedMultiplyMatchesSingleThreaded) {
+  const auto a = patterned<double>(61, 40, 5);
+  const auto b = patterned<double>(40, 45, 6);
+  const auto expected = naiveMultiply(a, b);
+
+  for (unsigned threads : {2u, 3u, 64u}) {
+    EXPECT_EQ(multiply(a, b, {.threads = threads}), expected) << threads;
+  }
+}
+
+TEST(MatrixTest, MultiplyAddAccumulates) {
+  const auto a = patterned<std::int32_t>(9, 17, 7);
+  const auto b = patterned<std::int32_t>(17, 20, 8);
+  Matrix<std::int32_t> underTest(9, 20, 1);
+
+  multiplyAdd(a, b, underTest);
+
+  auto expected = naiveMultiply(a, b);
+  for (std::size_t r = 0; r < expected.rows(); ++r) {
+    for (auto& x : expected.row(r)) {
+      ++x;
+    }
+  }
+  EXPECT_EQ(underTest, expected);
+}
+
+TEST(MatrixTest, EmptyInnerDimensionGivesZeroes) {
+  EXPECT_EQ(multiply(Matrix<float>(3, 0), Matrix<float>(0, 4)),
+            Matrix<float>(3, 4));
+}
+
+TEST(MatrixTest, Transpose) {
+  const auto a = patterned<float>(45, 70, 9);
+
+  const auto underTest = transpose(a);
+
+  ASSERT_EQ(underTest.rows(), 70);
+  ASSERT_EQ(underTest.cols(), 45);
+  for (std::size_t r = 0; r < a.rows(); ++r) {
+    for (std::size_t c = 0; c < a.cols(); ++c) {
+      EXPECT_EQ((underTest[c, r]), (a[r, c]));
+    }
+  }
+  EXPECT_EQ(transpose(underTest), a);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
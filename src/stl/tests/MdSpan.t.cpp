@@ -0,0 +1,110 @@
+#include "src/stl/MdSpan.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+static_assert(Extents<2, kDynamicExtent, 3>::kRankDynamic == 1);
+static_assert(sizeof(Extents<4, 4>) == 1);
+static_assert(sizeof(MdSpan<float, Extents<4, 4>>) == sizeof(float*));
+static_assert(sizeof(MdSpan<float, DExtents<2>>) == 3 * sizeof(float*));
+static_assert(std::is_same_v<DExtents<2>, Extents<kDynamicExtent,
+                                                  kDynamicExtent>>);
+
+struct MdSpanTest : ::testing::Test {
+  static Vector<int> iota(std::size_t n) {
+    Vector<int> values(n);
+    std::iota(values.begin(), values.end(), 0);
+    return values;
+  }
+};
+
+TEST_F(MdSpanTest, RowMajorByDefault) {
+  Vector<int> storage = iota(6);
+
+  MdSpan underTest(storage, 2, 3);
+
+  static_assert(std::is_same_v<decltype(underTest),
+                               MdSpan<int, DExtents<2>>>);
+  EXPECT_EQ(underTest.rank(), 2);
+  EXPECT_EQ(underTest.extent(0), 2);
+  EXPECT_EQ(underTest.extent(1), 3);
+  EXPECT_EQ(underTest.size(), 6);
+  EXPECT_EQ((underTest[0, 2]), 2);
+  EXPECT_EQ((underTest[1, 0]), 3);
+  EXPECT_EQ(underTest.stride(0), 3);
+  EXPECT_EQ(underTest.stride(1), 1);
+}
+
+TEST_F(MdSpanTest, ColumnMajor) {
+  Vector<int> storage = iota(6);
+
+  MdSpan<int, DExtents<2>, LayoutLeft> underTest(storage, 2, 3);
+
+  EXPECT_EQ((underTest[1, 0]), 1);
+  EXPECT_EQ((underTest[0, 2]), 4);
+  EXPECT_EQ(underTest.stride(0), 1);
+  EXPECT_EQ(underTest.stride(1), 2);
+}
+
+TEST_F(MdSpanTest, StridedColumnView) {
+  Vector<int> storage = iota(12);
+  using Column = MdSpan<int, DExtents<1>, LayoutStride>;
+  using Mapping = Column::MappingT;
+
+  // Column 2 of a 3x4 row-major matrix.
+  Column underTest(storage.data() + 2, Mapping(DExtents<1>(3), {4}));
+
+  EXPECT_EQ(underTest[0], 2);
+  EXPECT_EQ(underTest[1], 6);
+  EXPECT_EQ(underTest[2], 10);
+  EXPECT_EQ(underTest.mapping().requiredSpanSize(), 9);
+}
+
+TEST_F(MdSpanTest, StaticAndMixedExtents) {
+  Vector<float> storage(2 * 5 * 4);
+  std::iota(storage.begin(), storage.end(), 0.0f);
+
+  MdSpan<float, Extents<2, kDynamicExtent, 4>> underTest(storage, 5);
+
+  EXPECT_EQ(underTest.extent(1), 5);
+  EXPECT_EQ(underTest.staticExtent(0), 2);
+  EXPECT_EQ(underTest.staticExtent(1), kDynamicExtent);
+  EXPECT_EQ((underTest[1, 2, 3]), 1 * 20 + 2 * 4 + 3);
+  EXPECT_EQ(underTest.extents(),
+            (Extents<2, kDynamicExtent, 4>(std::size_t{2}, 5, 4)));
+}
+
+TEST_F(MdSpanTest, FullyStaticIsUsableInConstantExpressions) {
+  static constexpr std::array<int, 4> kValues{1, 2, 3, 4};
+  constexpr MdSpan<const int, Extents<2, 2>> underTest(kValues.data());
+
+  static_assert((underTest[1, 0]) == 3);
+}
+
+TEST_F(MdSpanTest, ConstViews) {
+  const Vector<int> storage = iota(4);
+  Vector<int> mutableStorage = iota(4);
+
+  MdSpan underTest(storage, 2, 2);
+  MdSpan<const int, DExtents<2>> fromSpan{Span(storage), 2, 2};
+  MdSpan<const int, DExtents<2>> fromMutable =
+      MdSpan(mutableStorage, 2, 2);
+
+  static_assert(std::is_same_v<decltype(underTest)::ElementT, const int>);
+  EXPECT_EQ((underTest[1, 1]), 3);
+  EXPECT_EQ((fromSpan[0, 1]), 1);
+  EXPECT_EQ(fromMutable.extent(0), 2);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
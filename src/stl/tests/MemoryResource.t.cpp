@@ -0,0 +1,187 @@
+#include "src/stl/MemoryResource.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+struct MemoryResourceTest : ::testing::Test {
+  // Forwards to newDeleteResource(), counting the traffic.
+  struct CountingResource : MemoryResource {
+    int allocations = 0;
+    int deallocations = 0;
+    std::size_t bytesOutstanding = 0;
+
+   private:
+    void* doAllocate(SizeT bytes, SizeT alignment) override {
+      ++allocations;
+      bytesOutstanding += bytes;
+      return newDeleteResource()->allocate(bytes, alignment);
+    }
+
+    void doDeallocate(void* p, SizeT bytes, SizeT alignment) override {
+      ++deallocations;
+      bytesOutstanding -= bytes;
+      newDeleteResource()->deallocate(p, bytes, alignment);
+    }
+
+    bool doIsEqual(const MemoryResource& other) const noexcept override {
+      return this == &other;
+    }
+  };
+
+  static bool isAligned(void* p, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+  }
+};
+
+TEST_F(MemoryResourceTest, MonotonicServesFromInitialBufferFirst) {
+  alignas(16) std::byte buffer[256];
+  MonotonicBufferResource underTest(buffer, sizeof(buffer),
+                                    nullMemoryResource());
+
+  void* a = underTest.allocate(64, 16);
+  void* b = underTest.allocate(64, 16);
+
+  EXPECT_EQ(a, buffer);
+  EXPECT_EQ(b, buffer + 64);
+  EXPECT_THROW((void)underTest.allocate(512), std::bad_alloc);
+}
+
+TEST_F(MemoryResourceTest, MonotonicReleaseReturnsEveryChunkAtOnce) {
+  CountingResource upstream;
+  MonotonicBufferResource underTest(64, &upstream);
+
+  for (int i = 0; i < 100; ++i) {
+    void* p = underTest.allocate(48, 8);
+    EXPECT_TRUE(isAligned(p, 8));
+    underTest.deallocate(p, 48, 8);
+  }
+  EXPECT_GT(upstream.allocations, 1);
+  // Chunks grow geometrically, so there are far fewer chunks than
+  // allocations.
+  EXPECT_LT(upstream.allocations, 10);
+  EXPECT_EQ(upstream.deallocations, 0);
+
+  underTest.release();
+  EXPECT_EQ(upstream.deallocations, upstream.allocations);
+  EXPECT_EQ(upstream.bytesOutstanding, 0);
+}
+
+TEST_F(MemoryResourceTest, PoolReusesFreedBlocks) {
+  UnsynchronizedPoolResource underTest;
+
+  void* first = underTest.allocate(24, 8);
+  underTest.deallocate(first, 24, 8);
+  void* second = underTest.allocate(32, 8);
+
+  EXPECT_EQ(first, second);
+  underTest.deallocate(second, 32, 8);
+}
+
+TEST_F(MemoryResourceTest, PoolBlocksAreAlignedToTheirSizeClass) {
+  UnsynchronizedPoolResource underTest;
+
+  for (std::size_t alignment = 8; alignment <= 4096; alignment *= 2) {
+    void* p = underTest.allocate(alignment, alignment);
+    EXPECT_TRUE(isAligned(p, alignment));
+    underTest.deallocate(p, alignment, alignment);
+  }
+}
+
+TEST_F(MemoryResourceTest, PoolOversizedAllocationsGoUpstream) {
+  CountingResource upstream;
+  UnsynchronizedPoolResource underTest(PoolOptions{4, 256}, &upstream);
+
+  void* large = underTest.allocate(1024, 64);
+  EXPECT_TRUE(isAligned(large, 64));
+  EXPECT_EQ(upstream.allocations, 1);
+
+  underTest.deallocate(large, 1024, 64);
+  EXPECT_EQ(upstream.deallocations, 1);
+
+  (void)underTest.allocate(2048);
+  (void)underTest.allocate(16);
+  underTest.release();
+  EXPECT_EQ(upstream.bytesOutstanding, 0);
+}
+
+TEST_F(MemoryResourceTest, SynchronizedPoolIsUsableFromManyThreads) {
+  SynchronizedPoolResource underTest;
+
+  {
+    Vector<std::jthread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&underTest] {
+        for (int i = 0; i < 1000; ++i) {
+          void* p = underTest.allocate(64);
+          static_cast<std::byte*>(p)[0] = std::byte{1};
+          underTest.deallocate(p, 64);
+        }
+      });
+    }
+  }
+
+  underTest.release();
+}
+
+TEST_F(MemoryResourceTest, PmrVectorAllocatesFromItsResource) {
+  CountingResource upstream;
+  {
+    pmr::Vector<int> underTest(&upstream);
+    for (int i = 0; i < 100; ++i) {
+      underTest.push_back(i);
+    }
+
+    EXPECT_GT(upstream.allocations, 0);
+    EXPECT_EQ(underTest.getAllocator().resource(), &upstream);
+  }
+  EXPECT_EQ(upstream.allocations, upstream.deallocations);
+}
+
+TEST_F(MemoryResourceTest, NestedPmrVectorsShareTheParentResource) {
+  MonotonicBufferResource resource;
+  pmr::Vector<pmr::Vector<int>> underTest(&resource);
+
+  underTest.emplace_back();
+  underTest.emplace_back(3, 7);
+  underTest.push_back(pmr::Vector<int>{1, 2, 3});
+
+  for (const auto& inner : underTest) {
+    EXPECT_EQ(inner.getAllocator().resource(), &resource);
+  }
+  EXPECT_EQ(underTest[1][2], 7);
+  EXPECT_EQ(underTest[2][1], 2);
+}
+
+TEST_F(MemoryResourceTest, MoveAcrossResourcesMovesElements) {
+  MonotonicBufferResource first;
+  MonotonicBufferResource second;
+  pmr::Vector<int> source({1, 2, 3}, &first);
+  pmr::Vector<int> destination(&second);
+
+  destination = std::move(source);
+
+  EXPECT_EQ(destination.getAllocator().resource(), &second);
+  EXPECT_EQ(destination.size(), 3);
+  EXPECT_EQ(destination[2], 3);
+}
+
+TEST_F(MemoryResourceTest, CopyRevertsToTheDefaultResource) {
+  MonotonicBufferResource resource;
+  pmr::Vector<int> original({1, 2, 3}, &resource);
+
+  pmr::Vector<int> copy(original);
+
+  EXPECT_EQ(copy.getAllocator().resource(), getDefaultResource());
+  EXPECT_EQ(copy[1], 2);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,118 @@
+#include "src/stl/NonTemporal.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+using detail::streaming::kThresholdBytes;
+
+// Odd-sized, so that elements straddle every alignment.
+struct Triple {
+  std::uint8_t a;
+  std::uint8_t b;
+  std::uint8_t c;
+};
+
+Vector<std::uint8_t> pattern(std::size_t n) {
+  Vector<std::uint8_t> bytes(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    bytes[i] = static_cast<std::uint8_t>(i * 131 + i / 251);
+  }
+  return bytes;
+}
+
+TEST(NonTemporalTest, SmallCopy) {
+  const auto src = pattern(1000);
+  for (const std::size_t n : {0, 1, 15, 64, 1000}) {
+    Vector<std::uint8_t> dst(1000);
+    streamingCopy(dst.data(), src.data(), n);
+    EXPECT_TRUE(std::equal(src.begin(), src.begin() + n, dst.begin())) << n;
+    EXPECT_TRUE(std::all_of(dst.begin() + n, dst.end(),
+                            [](std::uint8_t b) { return b == 0; }))
+        << n;
+  }
+}
+
+TEST(NonTemporalTest, LargeUnalignedCopy) {
+  // Both ends misaligned, and a length that is not a multiple of 64.
+  const std::size_t n = kThresholdBytes + 37;
+  const auto src = pattern(n + 5);
+  for (const unsigned threads : {1u, 3u}) {
+    Vector<std::uint8_t> dst(n + 8);
+    streamingCopy(dst.data() + 3, src.data() + 5, n, threads);
+    EXPECT_TRUE(std::equal(src.begin() + 5, src.begin() + 5 + n,
+                           dst.begin() + 3))
+        << threads;
+    EXPECT_EQ(dst[2], 0);
+    EXPECT_EQ(dst[n + 3], 0);
+  }
+}
+
+TEST(NonTemporalTest, LargeFillOfOddSizedElements) {
+  const std::size_t n = kThresholdBytes / sizeof(Triple) + 11;
+  const Triple value{1, 2, 3};
+  for (const unsigned threads : {1u, 4u}) {
+    Vector<Triple> dst(n + 1, Triple{9, 9, 9});
+    streamingFill(dst.data(), n, value, threads);
+    const auto wrong = std::find_if(dst.begin(), dst.begin() + n, [](auto t) {
+      return t.a != 1 || t.b != 2 || t.c != 3;
+    });
+    EXPECT_EQ(wrong - dst.begin(), static_cast<std::ptrdiff_t>(n))
+        << threads;
+    EXPECT_EQ(dst[n].a, 9);
+  }
+}
+
+TEST(NonTemporalTest, LargeVectorFillsAndCopies) {
+  const std::size_t n = kThresholdBytes / sizeof(std::uint32_t) + 3;
+
+  Vector<std::uint32_t> zeros(n);
+  EXPECT_TRUE(std::all_of(zeros.begin(), zeros.end(),
+                          [](std::uint32_t v) { return v == 0; }));
+
+  Vector<std::uint32_t> sevens(n, 7);
+  EXPECT_TRUE(std::all_of(sevens.begin(), sevens.end(),
+                          [](std::uint32_t v) { return v == 7; }));
+
+  std::iota(zeros.begin(), zeros.end(), 0u);
+  const Vector<std::uint32_t> copy(zeros);
+  EXPECT_TRUE(std::ranges::equal(copy, zeros));
+
+  sevens = copy;
+  EXPECT_TRUE(std::ranges::equal(sevens, zeros));
+}
+
+TEST(NonTemporalTest, LargeVectorResizeAndReserve) {
+  Vector<std::uint64_t> underTest(10);
+  std::iota(underTest.begin(), underTest.end(), 1u);
+
+  const std::size_t n = kThresholdBytes / sizeof(std::uint64_t) + 5;
+  underTest.resize(n, 42);
+  ASSERT_EQ(underTest.size(), n);
+  for (std::size_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(underTest[i], i + 1);
+  }
+  EXPECT_TRUE(std::all_of(underTest.begin() + 10, underTest.end(),
+                          [](std::uint64_t v) { return v == 42; }));
+
+  // Relocates the whole vector.
+  underTest.reserve(2 * n);
+  EXPECT_EQ(underTest[0], 1);
+  EXPECT_EQ(underTest[n - 1], 42);
+
+  underTest.resize(2 * n);
+  EXPECT_EQ(underTest[n - 1], 42);
+  EXPECT_TRUE(std::all_of(underTest.begin() + n, underTest.end(),
+                          [](std::uint64_t v) { return v == 0; }));
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,103 @@
+#include "src/stl/Optional.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "src/testutil/LifetimeTracker.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+static_assert(std::is_trivially_copyable_v<Optional<int>>);
+static_assert(std::is_trivially_destructible_v<Optional<double>>);
+static_assert(!std::is_trivially_copyable_v<Optional<std::string>>);
+static_assert(!std::is_copy_constructible_v<Optional<std::unique_ptr<int>>>);
+static_assert(std::is_move_constructible_v<Optional<std::unique_ptr<int>>>);
+static_assert(sizeof(Optional<int>) == 2 * sizeof(int));
+
+TEST(OptionalTest, DefaultIsEmpty) {
+  Optional<int> underTest;
+
+  EXPECT_FALSE(underTest.hasValue());
+  EXPECT_FALSE(underTest);
+  EXPECT_EQ(underTest.valueOr(7), 7);
+  EXPECT_TRUE(underTest == kNullOpt);
+}
+
+TEST(OptionalTest, HoldsAValue) {
+  Optional<std::string> underTest = std::string("value");
+
+  ASSERT_TRUE(underTest);
+  EXPECT_EQ(*underTest, "value");
+  EXPECT_EQ(underTest->size(), 5);
+  EXPECT_EQ(underTest.valueOr("fallback"), "value");
+}
+
+TEST(OptionalTest, IsUsableInConstantExpressions) {
+  constexpr Optional<int> underTest(42);
+
+  static_assert(*underTest == 42);
+  static_assert(!Optional<int>().hasValue());
+}
+
+TEST(OptionalTest, CopiesAndMovesTheValue) {
+  Optional<std::string> original(std::in_place, 40, 'x');
+
+  Optional<std::string> copy = original;
+  Optional<std::string> moved = std::move(original);
+
+  EXPECT_EQ(*copy, std::string(40, 'x'));
+  EXPECT_EQ(*moved, std::string(40, 'x'));
+}
+
+TEST(OptionalTest, AssignmentBetweenEmptyAndEngaged) {
+  Optional<std::string> underTest;
+  Optional<std::string> engaged("value");
+  Optional<std::string> empty;
+
+  underTest = engaged;
+  EXPECT_EQ(*underTest, "value");
+
+  underTest = empty;
+  EXPECT_FALSE(underTest);
+
+  underTest = std::move(engaged);
+  EXPECT_EQ(*underTest, "value");
+
+  underTest = kNullOpt;
+  EXPECT_FALSE(underTest);
+}
+
+TEST(OptionalTest, DestroysTheValueExactlyOnce) {
+  LifetimeTracker::reset();
+  {
+    Optional<LifetimeTracker> underTest;
+    EXPECT_EQ(LifetimeTracker::constructions, 0);
+
+    underTest.emplace();
+    underTest.emplace();
+    EXPECT_EQ(LifetimeTracker::constructions, 2);
+    EXPECT_EQ(LifetimeTracker::destructions, 1);
+
+    underTest.reset();
+    underTest.reset();
+    EXPECT_EQ(LifetimeTracker::destructions, 2);
+
+    underTest.emplace();
+  }
+  EXPECT_EQ(LifetimeTracker::constructions, LifetimeTracker::destructions);
+}
+
+TEST(OptionalTest, Equality) {
+  EXPECT_EQ(Optional<int>(1), Optional<int>(1));
+  EXPECT_NE(Optional<int>(1), Optional<int>(2));
+  EXPECT_NE(Optional<int>(1), Optional<int>());
+  EXPECT_EQ(Optional<int>(), Optional<int>());
+}
+
+}  // namespace test
+}  // namespace ecx::stl
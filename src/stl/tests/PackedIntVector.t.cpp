@@ -0,0 +1,185 @@
+#include "src/stl/PackedIntVector.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+namespace {
+
+Vector<std::uint64_t> randomValues(std::size_t n, unsigned bits,
+                                   std::uint64_t seed) {
+  Vector<std::uint64_t> values;
+  std::uint64_t state = seed;
+  for (std::size_t i = 0; i < n; ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    values.push_back(bits == 64 ? state : state >> (64 - bits));
+  }
+  return values;
+}
+
+Vector<std::uint64_t> sortedValues(std::size_t n, std::uint64_t start) {
+  Vector<std::uint64_t> values;
+  std::uint64_t value = start;
+  for (std::size_t i = 0; i < n; ++i) {
+    // Mostly small gaps, with the occasional large one and some repeats.
+    value += i % 97 == 0 ? 1'000'000 : i % 5;
+    values.push_back(value);
+  }
+  return values;
+}
+
+}  // namespace
+
+TEST(PackedIntVectorTest, UsesTheWidthOfTheLargestValue) {
+  const Vector<std::uint64_t> values{3, 1000, 7, 0};
+
+  const PackedIntVector underTest{Span<const std::uint64_t>(values)};
+
+  EXPECT_EQ(underTest.size(), 4);
+  EXPECT_EQ(underTest.bitWidth(), 10);
+  EXPECT_EQ(underTest[1], 1000);
+  EXPECT_EQ(underTest[3], 0);
+}
+
+TEST(PackedIntVectorTest, RoundTripsEveryWidth) {
+  for (unsigned bits = 1; bits <= 64; ++bits) {
+    const auto values = randomValues(300, bits, bits);
+
+    const PackedIntVector underTest{Span<const std::uint64_t>(values)};
+
+    EXPECT_LE(underTest.bitWidth(), bits);
+    EXPECT_TRUE(std::ranges::equal(underTest.toVector(), values)) << bits;
+    for (std::size_t i = 0; i < values.size(); i += 7) {
+      ASSERT_EQ(underTest[i], values[i]) << bits;
+    }
+  }
+}
+
+TEST(PackedIntVectorTest, IsSmallerThanAVector) {
+  const auto values = randomValues(4096, 16, 1);
+
+  const PackedIntVector underTest{Span<const std::uint64_t>(values)};
+
+  EXPECT_LE(underTest.sizeBytes(), 4096 * 2 + 8);
+}
+
+TEST(PackedIntVectorTest, UnpacksUnalignedRanges) {
+  const auto values = randomValues(1000, 23, 5);
+  const PackedIntVector underTest{Span<const std::uint64_t>(values)};
+
+  Vector<std::uint64_t> out(500);
+  underTest.unpack(37, Span<std::uint64_t>(out));
+
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    ASSERT_EQ(out[i], values[37 + i]) << i;
+  }
+}
+
+TEST(PackedIntVectorTest, PushBackWidensWhenNeeded) {
+  PackedIntVector underTest;
+  Vector<std::uint64_t> expected;
+
+  for (std::uint64_t i = 0; i < 200; ++i) {
+    const std::uint64_t value = i * i * i;
+    underTest.pushBack(value);
+    expected.push_back(value);
+  }
+  underTest.pushBack(0);
+  expected.push_back(0);
+
+  EXPECT_EQ(underTest.bitWidth(), 23);
+  EXPECT_TRUE(std::ranges::equal(underTest.toVector(), expected));
+}
+
+TEST(PackedIntVectorTest, AllZeroesTakeNoBits) {
+  const Vector<std::uint64_t> values(100);
+
+  const PackedIntVector underTest{Span<const std::uint64_t>(values)};
+
+  EXPECT_EQ(underTest.bitWidth(), 0);
+  EXPECT_EQ(underTest[99], 0);
+  EXPECT_TRUE(std::ranges::equal(underTest.toVector(), values));
+}
+
+TEST(DeltaPackedVectorTest, RoundTripsAndRandomAccess) {
+  const auto values = sortedValues(1000, 1ULL << 40);
+
+  const DeltaPackedVector underTest{Span<const std::uint64_t>(values)};
+
+  ASSERT_EQ(underTest.size(), values.size());
+  EXPECT_TRUE(std::ranges::equal(underTest.toVector(), values));
+  for (std::size_t i = 0; i < values.size(); i += 13) {
+    ASSERT_EQ(underTest[i], values[i]) << i;
+  }
+  EXPECT_EQ(underTest[999], values[999]);
+}
+
+TEST(DeltaPackedVectorTest, DenseSequencesCompressWell) {
+  Vector<std::uint64_t> values;
+  for (std::uint64_t i = 0; i < 10'000; ++i) {
+    values.push_back((1ULL << 50) + 3 * i);
+  }
+
+  const DeltaPackedVector underTest{Span<const std::uint64_t>(values)};
+
+  EXPECT_LT(underTest.sizeBytes() * 8, values.size() * sizeof(std::uint64_t));
+}
+
+TEST(DeltaPackedVectorTest, LowerBoundSkipsToTheRightBlock) {
+  const auto values = sortedValues(2000, 10);
+  const DeltaPackedVector underTest{Span<const std::uint64_t>(values)};
+
+  for (std::size_t i = 0; i < values.size(); i += 11) {
+    const auto expected = static_cast<std::size_t>(
+        std::lower_bound(values.begin(), values.end(), values[i]) -
+        values.begin());
+    ASSERT_EQ(underTest.lowerBound(values[i]), expected) << i;
+    ASSERT_TRUE(underTest.contains(values[i]));
+  }
+  EXPECT_EQ(underTest.lowerBound(0), 0);
+  EXPECT_EQ(underTest.lowerBound(values.back() + 1), values.size());
+  // Between the last element of a block and the first of the next.
+  const std::size_t boundary = DeltaPackedVector::kBlockSize * 3;
+  if (values[boundary - 1] + 1 < values[boundary]) {
+    EXPECT_EQ(underTest.lowerBound(values[boundary - 1] + 1), boundary);
+    EXPECT_FALSE(underTest.contains(values[boundary - 1] + 1));
+  }
+}
+
+TEST(DeltaPackedVectorTest, ContainsTheFirstElementOfEveryBlock) {
+  // A constant run, packed at width 0, then a strictly increasing one.
+  Vector<std::uint64_t> values(DeltaPackedVector::kBlockSize * 2, 7);
+  for (std::uint64_t i = 0; i < DeltaPackedVector::kBlockSize * 3; ++i) {
+    values.push_back(100 + 2 * i);
+  }
+  const DeltaPackedVector underTest{Span<const std::uint64_t>(values)};
+
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(underTest[i], values[i]) << i;
+  }
+  for (std::size_t i = 0; i < values.size();
+       i += DeltaPackedVector::kBlockSize) {
+    ASSERT_TRUE(underTest.contains(values[i])) << i;
+    ASSERT_FALSE(underTest.contains(values[i] + 1)) << i;
+  }
+}
+
+TEST(DeltaPackedVectorTest, Empty) {
+  const DeltaPackedVector underTest;
+
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.lowerBound(5), 0);
+  EXPECT_FALSE(underTest.contains(5));
+  EXPECT_TRUE(underTest.toVector().empty());
+}
+
+}  // namespace test
+}  // namespace ecx::stl
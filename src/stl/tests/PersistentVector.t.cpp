@@ -0,0 +1,220 @@
+#include "src/stl/PersistentVector.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "src/stl/Span.hpp"
+#include "src/stl/Vector.hpp"
+#include "src/testutil/LifetimeTracker.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+static_assert(std::forward_iterator<PersistentVector<int>::ConstIterator>);
+
+namespace {
+
+Vector<int> iota(int n) {
+  Vector<int> values;
+  for (int i = 0; i < n; ++i) {
+    values.push_back(i);
+  }
+  return values;
+}
+
+// Throws from its copy or move once budget such constructions have run.
+struct Fragile {
+  inline static int budget = -1;
+
+  explicit Fragile(int value) : value(value) {}
+  Fragile(const Fragile& other) : value(other.value) { spend(); }
+  Fragile(Fragile&& other) : value(other.value) { spend(); }
+  Fragile& operator=(const Fragile&) = default;
+  Fragile& operator=(Fragile&&) = default;
+
+  static void spend() {
+    if (budget == 0) {
+      throw std::runtime_error("Fragile");
+    }
+    if (budget > 0) {
+      --budget;
+    }
+  }
+
+  int value;
+};
+
+}  // namespace
+
+TEST(PersistentVectorTest, PushBackKeepsOldVersions) {
+  const PersistentVector<std::string> empty;
+
+  const auto one = empty.pushBack("a");
+  const auto two = one.pushBack("b");
+
+  EXPECT_TRUE(empty.empty());
+  ASSERT_EQ(one.size(), 1);
+  ASSERT_EQ(two.size(), 2);
+  EXPECT_EQ(one[0], "a");
+  EXPECT_EQ(two[1], "b");
+  EXPECT_EQ(two.back(), "b");
+}
+
+TEST(PersistentVectorTest, GrowsThroughSeveralTreeLevels) {
+  // Past 32 + 32 * 32 elements, so the root splits twice.
+  constexpr int kSize = 40'000;
+  PersistentVector<int> underTest;
+  for (int i = 0; i < kSize; ++i) {
+    underTest = underTest.pushBack(i);
+  }
+
+  ASSERT_EQ(underTest.size(), kSize);
+  for (int i = 0; i < kSize; i += 37) {
+    ASSERT_EQ(underTest[i], i);
+  }
+  EXPECT_TRUE(std::ranges::equal(underTest, iota(kSize)));
+}
+
+TEST(PersistentVectorTest, SetSharesEverythingElse) {
+  const auto values = iota(5000);
+  const PersistentVector<int> original{Span<const int>(values)};
+
+  const auto updated = original.set(1234, -1).set(4999, -2);
+
+  EXPECT_EQ(original[1234], 1234);
+  EXPECT_EQ(original[4999], 4999);
+  EXPECT_EQ(updated[1234], -1);
+  EXPECT_EQ(updated[4999], -2);
+  EXPECT_EQ(updated[1235], 1235);
+  // Neighbouring leaves are the very same memory in both versions.
+  EXPECT_EQ(&updated[0], &original[0]);
+  EXPECT_NE(&updated[1234], &original[1234]);
+}
+
+TEST(PersistentVectorTest, PopBackAcrossLeafAndLevelBoundaries) {
+  const auto values = iota(1100);
+  PersistentVector<int> underTest{Span<const int>(values)};
+  const auto full = underTest;
+
+  for (int size = 1100; size > 0; --size) {
+    ASSERT_EQ(underTest.size(), static_cast<std::size_t>(size));
+    ASSERT_EQ(underTest.back(), size - 1);
+    ASSERT_EQ(underTest.front(), 0);
+    underTest = underTest.popBack();
+  }
+
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_TRUE(std::ranges::equal(full, values));
+  // And the tree can grow again after shrinking.
+  underTest = underTest.pushBack(7);
+  EXPECT_EQ(underTest[0], 7);
+}
+
+TEST(PersistentVectorTest, TransientBatchEditsInPlace) {
+  const auto values = iota(3000);
+  const PersistentVector<int> original{Span<const int>(values)};
+
+  auto transient = original.transient();
+  for (int i = 0; i < 3000; ++i) {
+    transient.set(static_cast<std::size_t>(i), i * 2);
+  }
+  transient.pushBack(-1);
+  transient.popBack();
+  transient.pushBack(6000);
+  const auto edited = std::move(transient).persistent();
+
+  EXPECT_TRUE(std::ranges::equal(original, values));
+  ASSERT_EQ(edited.size(), 3001);
+  for (std::size_t i = 0; i < edited.size(); ++i) {
+    ASSERT_EQ(edited[i], static_cast<int>(i * 2));
+  }
+}
+
+TEST(PersistentVectorTest, IteratesByLeafChunks) {
+  const auto values = iota(100);
+  const PersistentVector<int> underTest{Span<const int>(values)};
+
+  Vector<std::size_t> chunkSizes;
+  Vector<int> seen;
+  underTest.forEachChunk([&](Span<const int> chunk) {
+    chunkSizes.push_back(chunk.size());
+    for (int value : chunk) {
+      seen.push_back(value);
+    }
+  });
+
+  EXPECT_TRUE(
+      std::ranges::equal(chunkSizes, Vector<std::size_t>{32, 32, 32, 4}));
+  EXPECT_TRUE(std::ranges::equal(seen, values));
+  EXPECT_TRUE(std::ranges::equal(underTest.toVector(), values));
+}
+
+TEST(PersistentVectorTest, EqualityComparesElements) {
+  const auto values = iota(70);
+  const PersistentVector<int> lhs(values);
+  const PersistentVector<int> rhs(values);
+
+  EXPECT_EQ(lhs, rhs);
+  EXPECT_NE(lhs, rhs.set(3, 0));
+  EXPECT_NE(lhs, rhs.popBack());
+}
+
+TEST(PersistentVectorTest, ThrowingPushBackLeavesTheTransientIntact) {
+  Fragile::budget = -1;
+  auto transient = PersistentVector<Fragile>().transient();
+  for (int i = 0; i < 32; ++i) {
+    transient.pushBack(Fragile(i));
+  }
+
+  // The tail is full, so this push moves it into the tree.
+  Fragile::budget = 1;
+  EXPECT_THROW(transient.pushBack(Fragile(32)), std::runtime_error);
+  Fragile::budget = -1;
+
+  ASSERT_EQ(transient.size(), 32);
+  EXPECT_EQ(transient[31].value, 31);
+  transient.pushBack(Fragile(32));
+  EXPECT_EQ(transient[32].value, 32);
+}
+
+TEST(PersistentVectorTest, ThrowingLeafCopyLeavesTheVersionIntact) {
+  Fragile::budget = -1;
+  PersistentVector<Fragile> original;
+  for (int i = 0; i < 8; ++i) {
+    original = original.pushBack(Fragile(i));
+  }
+
+  // set copies the shared tail; the fourth element's copy throws.
+  Fragile::budget = 4;
+  EXPECT_THROW((void)original.set(0, Fragile(-1)), std::runtime_error);
+  Fragile::budget = -1;
+
+  ASSERT_EQ(original.size(), 8);
+  EXPECT_EQ(original[0].value, 0);
+}
+
+TEST(PersistentVectorTest, DestroysEachElementOnce) {
+  LifetimeTracker::reset();
+  {
+    PersistentVector<LifetimeTracker> first;
+    for (int i = 0; i < 100; ++i) {
+      first = first.pushBack(LifetimeTracker());
+    }
+    const auto second = first.set(50, LifetimeTracker()).popBack();
+    auto transient = second.transient();
+    transient.pushBack(LifetimeTracker());
+  }
+
+  EXPECT_EQ(LifetimeTracker::constructions +
+                LifetimeTracker::copyConstructions +
+                LifetimeTracker::moveConstructions,
+            LifetimeTracker::destructions);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,179 @@
+#include "src/stl/RadixSort.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+struct RadixSortTest : ::testing::Test {
+  static Vector<std::uint64_t> randomKeys(std::size_t n,
+                                          std::uint64_t max = UINT64_MAX) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<std::uint64_t> dist(0, max);
+
+    Vector<std::uint64_t> keys;
+    keys.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      keys.push_back(dist(rng));
+    }
+    return keys;
+  }
+
+  template <typename T>
+  static bool isSorted(const Vector<T>& vec) {
+    return std::is_sorted(vec.begin(), vec.end());
+  }
+};
+
+TEST_F(RadixSortTest, SortsSmallInputWithInsertionSort) {
+  Vector<std::uint64_t> underTest{5, 3, 9, 1, 1, 0};
+
+  radixSort(underTest);
+
+  EXPECT_TRUE(isSorted(underTest));
+  EXPECT_EQ(underTest[0], 0);
+  EXPECT_EQ(underTest[5], 9);
+}
+
+TEST_F(RadixSortTest, SortsRandomKeysWithEveryDigitWidth) {
+  Vector<std::uint64_t> expected = randomKeys(10'000);
+  std::sort(expected.begin(), expected.end());
+
+  Vector<std::uint64_t> eightBit = randomKeys(10'000);
+  Vector<std::uint64_t> elevenBit = randomKeys(10'000);
+  Vector<std::uint64_t> sixteenBit = randomKeys(10'000);
+  radixSort<8>(eightBit);
+  radixSort<11>(elevenBit);
+  radixSort<16>(sixteenBit);
+
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), eightBit.begin()));
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), elevenBit.begin()));
+  EXPECT_TRUE(
+      std::equal(expected.begin(), expected.end(), sixteenBit.begin()));
+}
+
+TEST_F(RadixSortTest, SortsNarrowKeysStoredInWideIntegers) {
+  // Only the lowest digit varies; the remaining passes are skipped.
+  Vector<std::uint64_t> underTest = randomKeys(5'000, 255);
+
+  radixSort(underTest);
+
+  EXPECT_TRUE(isSorted(underTest));
+}
+
+TEST_F(RadixSortTest, SortsSignedIntegers) {
+  Vector<std::int32_t> underTest;
+  for (int i = 0; i < 1'000; ++i) {
+    underTest.push_back((i * 7919) % 2001 - 1000);
+  }
+
+  radixSort(underTest);
+
+  EXPECT_TRUE(isSorted(underTest));
+  EXPECT_EQ(underTest[0], -1000);
+}
+
+TEST_F(RadixSortTest, KeyValuePairsAreSortedStably) {
+  Vector<std::pair<std::uint32_t, std::uint32_t>> underTest;
+  for (std::uint32_t i = 0; i < 4'000; ++i) {
+    underTest.emplace_back(i % 10, i);
+  }
+
+  radixSort<11>(underTest);
+
+  for (std::size_t i = 1; i < underTest.size(); ++i) {
+    const auto& prev = underTest[i - 1];
+    const auto& curr = underTest[i];
+    ASSERT_TRUE(prev.first < curr.first ||
+                (prev.first == curr.first && prev.second < curr.second));
+  }
+}
+
+TEST_F(RadixSortTest, ScratchIsReusedAcrossSorts) {
+  RadixSortScratch<std::uint64_t> scratch;
+
+  Vector<std::uint64_t> first = randomKeys(1'000);
+  radixSort(first, scratch);
+  EXPECT_EQ(scratch.capacity(), 1'000);
+
+  Vector<std::uint64_t> second = randomKeys(500);
+  radixSort(second, scratch);
+  EXPECT_EQ(scratch.capacity(), 1'000);
+
+  EXPECT_TRUE(isSorted(first));
+  EXPECT_TRUE(isSorted(second));
+}
+
+TEST_F(RadixSortTest, InPlaceSortMatchesStdSort) {
+  Vector<std::uint64_t> expected = randomKeys(20'000, 1'000'000);
+  Vector<std::uint64_t> underTest = expected;
+  std::sort(expected.begin(), expected.end());
+
+  radixSortInPlace(underTest);
+
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), underTest.begin()));
+}
+
+TEST_F(RadixSortTest, ParallelSortMatchesStdSort) {
+  Vector<std::uint64_t> expected = randomKeys(300'000);
+  Vector<std::uint64_t> underTest = expected;
+  std::sort(expected.begin(), expected.end());
+
+  parallelRadixSort<11>(underTest, 4);
+
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), underTest.begin()));
+}
+
+TEST_F(RadixSortTest, ParallelSortSurvivesFailedThreadStarts) {
+  const Vector<std::uint64_t> keys = randomKeys(300'000);
+  Vector<std::uint64_t> expected = keys;
+  std::sort(expected.begin(), expected.end());
+
+  for (unsigned startable : {0U, 1U, 2U}) {
+    Vector<std::uint64_t> underTest = keys;
+    RadixSortScratch<std::uint64_t> scratch;
+    unsigned spawned = 0;
+    auto spawn = [&](auto& worker, unsigned t) {
+      if (spawned == startable) {
+        throw std::system_error(
+            std::make_error_code(std::errc::resource_unavailable_try_again));
+      }
+      ++spawned;
+      return std::jthread(worker, t);
+    };
+
+    parallelRadixSort<8>(underTest, scratch, 4, spawn);
+
+    EXPECT_TRUE(
+        std::equal(expected.begin(), expected.end(), underTest.begin()))
+        << startable << " threads started";
+  }
+}
+
+TEST_F(RadixSortTest, ParallelSortIsStable) {
+  Vector<std::pair<std::uint16_t, std::uint32_t>> underTest;
+  for (std::uint32_t i = 0; i < 300'000; ++i) {
+    underTest.emplace_back(static_cast<std::uint16_t>(i * 31 % 97), i);
+  }
+
+  parallelRadixSort(underTest, 3);
+
+  for (std::size_t i = 1; i < underTest.size(); ++i) {
+    const auto& prev = underTest[i - 1];
+    const auto& curr = underTest[i];
+    ASSERT_TRUE(prev.first < curr.first ||
+                (prev.first == curr.first && prev.second < curr.second));
+  }
+}
+
+}  // namespace test
+}  // namespace ecx::stl
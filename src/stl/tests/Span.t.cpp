@@ -0,0 +1,100 @@
+#include "src/stl/Span.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <ranges>
+#include <type_traits>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+static_assert(sizeof(Span<int, 8>) == sizeof(int*));
+static_assert(sizeof(Span<int>) == 2 * sizeof(int*));
+static_assert(std::is_trivially_copyable_v<Span<int>>);
+static_assert(std::ranges::contiguous_range<Span<int>>);
+static_assert(std::ranges::borrowed_range<Span<int>>);
+static_assert(std::ranges::view<Span<const int, 4>>);
+// Const-correctness: a const Vector only yields spans of const elements.
+static_assert(std::is_constructible_v<Span<const int>, const Vector<int>&>);
+static_assert(!std::is_constructible_v<Span<int>, const Vector<int>&>);
+// Static extents are only implicitly formed where the size is known.
+static_assert(std::is_convertible_v<int(&)[4], Span<int, 4>>);
+static_assert(!std::is_convertible_v<Span<int>, Span<int, 4>>);
+static_assert(std::is_convertible_v<Span<int, 4>, Span<const int>>);
+
+TEST(SpanTest, ViewsVectorStorage) {
+  Vector<int> storage{1, 2, 3, 4};
+
+  Span underTest = storage;
+  underTest[1] = 20;
+
+  static_assert(std::is_same_v<decltype(underTest), Span<int>>);
+  EXPECT_EQ(underTest.data(), storage.data());
+  EXPECT_EQ(underTest.size(), 4);
+  EXPECT_EQ(underTest.sizeBytes(), 4 * sizeof(int));
+  EXPECT_EQ(storage[1], 20);
+  EXPECT_EQ(std::accumulate(underTest.begin(), underTest.end(), 0), 28);
+}
+
+TEST(SpanTest, StaticExtentFromArrays) {
+  int cArray[3] = {1, 2, 3};
+  std::array<double, 2> stdArray{0.5, 1.5};
+
+  Span fromC = cArray;
+  Span fromStd = stdArray;
+
+  static_assert(decltype(fromC)::kExtent == 3);
+  static_assert(std::is_same_v<decltype(fromStd), Span<double, 2>>);
+  EXPECT_EQ(fromC.back(), 3);
+  EXPECT_EQ(fromStd.front(), 0.5);
+}
+
+TEST(SpanTest, Subspans) {
+  int values[6] = {0, 1, 2, 3, 4, 5};
+  Span<int, 6> underTest = values;
+
+  auto head = underTest.first<2>();
+  auto tail = underTest.last(3);
+  auto middle = underTest.subspan<1, 4>();
+  auto rest = underTest.subspan<2>();
+
+  static_assert(decltype(head)::kExtent == 2);
+  static_assert(decltype(tail)::kExtent == kDynamicExtent);
+  static_assert(decltype(middle)::kExtent == 4);
+  static_assert(decltype(rest)::kExtent == 4);
+  EXPECT_EQ(head[1], 1);
+  EXPECT_EQ(tail[0], 3);
+  EXPECT_EQ(middle.back(), 4);
+  EXPECT_EQ(rest.front(), 2);
+  EXPECT_EQ(underTest.subspan(4).size(), 2);
+}
+
+TEST(SpanTest, WorksWithRangeAlgorithms) {
+  Vector<int> storage{3, 1, 2};
+
+  std::ranges::sort(Span(storage));
+  auto reversed = Span(storage) | std::views::reverse;
+
+  EXPECT_EQ(storage[0], 1);
+  EXPECT_EQ(*reversed.begin(), 3);
+}
+
+TEST(SpanTest, AsBytes) {
+  std::uint32_t value = 0;
+  Span<std::uint32_t, 1> underTest(&value, 1);
+
+  auto bytes = asWritableBytes(underTest);
+  std::ranges::fill(bytes, std::byte{0xff});
+
+  static_assert(decltype(bytes)::kExtent == sizeof(std::uint32_t));
+  EXPECT_EQ(value, 0xffffffffu);
+  EXPECT_EQ(asBytes(underTest)[0], std::byte{0xff});
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,191 @@
+#include "src/stl/Task.hpp"
+
+#include <gtest/gtest.h>
+
+#include <coroutine>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+struct TaskTest : ::testing::Test {
+  // Suspends until resumed by hand, standing in for an event loop.
+  struct ManualEvent {
+    Vector<std::coroutine_handle<>> waiters;
+
+    auto operator co_await() noexcept {
+      struct Awaiter {
+        ManualEvent& event;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> waiter) {
+          event.waiters.push_back(waiter);
+        }
+
+        void await_resume() const noexcept {}
+      };
+      return Awaiter{*this};
+    }
+
+    void resumeAll() {
+      Vector<std::coroutine_handle<>> ready;
+      std::swap(ready, waiters);
+      for (auto waiter : ready) {
+        waiter.resume();
+      }
+    }
+  };
+
+  static Task<int> value(int x) { co_return x; }
+
+  static Task<int> sum(int a, int b) {
+    int x = co_await value(a);
+    int y = co_await value(b);
+    co_return x + y;
+  }
+
+  static Task<int> chain(int depth) {
+    if (depth == 0) {
+      co_return 0;
+    }
+    co_return 1 + co_await chain(depth - 1);
+  }
+
+  static Task<int> fails() {
+    throw std::runtime_error("failed");
+    co_return 0;
+  }
+
+  static Task<int> afterEvent(ManualEvent& event, int x) {
+    co_await event;
+    co_return x;
+  }
+
+  template <typename T>
+  static T runSync(Task<T> task) {
+    task.start();
+    EXPECT_TRUE(task.done());
+    return std::move(task).result();
+  }
+};
+
+TEST_F(TaskTest, IsLazy) {
+  bool ran = false;
+  auto body = [&]() -> Task<> {
+    ran = true;
+    co_return;
+  };
+
+  Task<> underTest = body();
+  EXPECT_FALSE(ran);
+  EXPECT_FALSE(underTest.done());
+
+  underTest.start();
+  EXPECT_TRUE(ran);
+  EXPECT_TRUE(underTest.done());
+}
+
+TEST_F(TaskTest, AwaitingYieldsTheResult) {
+  EXPECT_EQ(runSync(sum(2, 3)), 5);
+}
+
+TEST_F(TaskTest, MoveOnlyResults) {
+  auto body = []() -> Task<std::unique_ptr<std::string>> {
+    co_return std::make_unique<std::string>("value");
+  };
+
+  auto underTest = runSync(body());
+
+  EXPECT_EQ(*underTest, "value");
+}
+
+TEST_F(TaskTest, ExceptionsPropagateToTheAwaiter) {
+  auto outer = []() -> Task<int> { co_return co_await fails() + 1; };
+
+  EXPECT_THROW(runSync(outer()), std::runtime_error);
+}
+
+TEST_F(TaskTest, LongSynchronousChainsComplete) {
+  // Kept shallow enough for unoptimised builds, see Task.
+  EXPECT_EQ(runSync(chain(2'000)), 2'000);
+}
+
+TEST_F(TaskTest, ResumesTheAwaiterAfterAnAsynchronousCompletion) {
+  ManualEvent event;
+  auto outer = [&]() -> Task<int> {
+    co_return co_await afterEvent(event, 7) * 2;
+  };
+
+  Task<int> underTest = outer();
+  underTest.start();
+  EXPECT_FALSE(underTest.done());
+
+  event.resumeAll();
+
+  EXPECT_TRUE(underTest.done());
+  EXPECT_EQ(std::move(underTest).result(), 14);
+}
+
+TEST_F(TaskTest, WhenAllRunsTasksConcurrently) {
+  ManualEvent event;
+  Vector<Task<int>> tasks;
+  for (int i = 0; i < 5; ++i) {
+    tasks.push_back(afterEvent(event, i));
+  }
+
+  Task<Vector<int>> underTest = whenAll(std::move(tasks));
+  underTest.start();
+  // Every task is suspended at once, not one after another.
+  EXPECT_EQ(event.waiters.size(), 5);
+
+  event.resumeAll();
+
+  ASSERT_TRUE(underTest.done());
+  Vector<int> results = std::move(underTest).result();
+  ASSERT_EQ(results.size(), 5);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(results[i], i);
+  }
+}
+
+TEST_F(TaskTest, WhenAllOfSynchronousTasks) {
+  Vector<Task<int>> tasks;
+  tasks.push_back(value(1));
+  tasks.push_back(sum(2, 3));
+
+  Vector<int> results = runSync(whenAll(std::move(tasks)));
+
+  EXPECT_EQ(results[0], 1);
+  EXPECT_EQ(results[1], 5);
+}
+
+TEST_F(TaskTest, WhenAllRethrows) {
+  Vector<Task<int>> tasks;
+  tasks.push_back(value(1));
+  tasks.push_back(fails());
+
+  EXPECT_THROW(runSync(whenAll(std::move(tasks))), std::runtime_error);
+}
+
+TEST_F(TaskTest, WhenAllOfVoidTasks) {
+  int count = 0;
+  auto increment = [&]() -> Task<> {
+    ++count;
+    co_return;
+  };
+  Vector<Task<>> tasks;
+  tasks.push_back(increment());
+  tasks.push_back(increment());
+
+  runSync(whenAll(std::move(tasks)));
+
+  EXPECT_EQ(count, 2);
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -0,0 +1,160 @@
+#include "src/stl/ThinVector.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "src/stl/MemoryResource.hpp"
+#include "src/testutil/LifetimeTracker.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+static_assert(sizeof(ThinVector<int>) == sizeof(void*));
+static_assert(sizeof(ThinVector<std::string>) == sizeof(void*));
+static_assert(sizeof(CompactVector<int>) == 16);
+
+// The behaviour both share, checked on each.
+template <typename VectorT>
+void checkGrowth() {
+  VectorT underTest;
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.capacity(), 0);
+  EXPECT_EQ(underTest.data(), nullptr);
+
+  for (int i = 0; i < 100; ++i) {
+    underTest.push_back(std::to_string(i));
+  }
+  ASSERT_EQ(underTest.size(), 100);
+  EXPECT_GE(underTest.capacity(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(underTest[static_cast<std::size_t>(i)], std::to_string(i));
+  }
+
+  // An argument referring into the vector survives the reallocation.
+  while (underTest.size() < underTest.capacity()) {
+    underTest.emplace_back("x");
+  }
+  underTest.push_back(underTest[0]);
+  EXPECT_EQ(underTest.back(), "0");
+
+  underTest.pop_back();
+  EXPECT_EQ(underTest.back(), "x");
+}
+
+template <typename VectorT>
+void checkCopyAndMove() {
+  VectorT source;
+  for (int i = 0; i < 5; ++i) {
+    source.push_back(i);
+  }
+
+  VectorT copy(source);
+  EXPECT_TRUE(std::ranges::equal(copy, source));
+  EXPECT_EQ(copy.capacity(), 5);
+
+  VectorT assigned{7, 8};
+  assigned = source;
+  EXPECT_TRUE(std::ranges::equal(assigned, source));
+
+  VectorT moved(std::move(copy));
+  EXPECT_TRUE(std::ranges::equal(moved, source));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(copy.data(), nullptr);
+
+  assigned = std::move(moved);
+  EXPECT_TRUE(std::ranges::equal(assigned, source));
+  EXPECT_TRUE(moved.empty());
+}
+
+template <typename VectorT>
+void checkResizeAndShrink() {
+  VectorT underTest(3, 9);
+  underTest.resize(6);
+  const int expected[] = {9, 9, 9, 0, 0, 0};
+  EXPECT_TRUE(std::ranges::equal(underTest, expected));
+
+  underTest.reserve(100);
+  underTest.resize(2);
+  EXPECT_EQ(underTest.capacity(), 100);
+  underTest.shrinkToFit();
+  EXPECT_EQ(underTest.capacity(), 2);
+  EXPECT_EQ(underTest[1], 9);
+
+  underTest.clear();
+  underTest.shrinkToFit();
+  EXPECT_EQ(underTest.capacity(), 0);
+  EXPECT_EQ(underTest.data(), nullptr);
+}
+
+TEST(ThinVectorTest, Growth) { checkGrowth<ThinVector<std::string>>(); }
+
+TEST(ThinVectorTest, CopyAndMove) { checkCopyAndMove<ThinVector<int>>(); }
+
+TEST(ThinVectorTest, ResizeAndShrinkToFit) {
+  checkResizeAndShrink<ThinVector<int>>();
+}
+
+TEST(ThinVectorTest, OverAlignedElements) {
+  struct alignas(64) Line {
+    std::uint8_t bytes[64];
+  };
+  ThinVector<Line> underTest(3);
+  underTest.push_back(Line{{1}});
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(underTest.data()) % 64, 0);
+  EXPECT_EQ(underTest[3].bytes[0], 1);
+}
+
+TEST(ThinVectorTest, ElementsAreDestroyed) {
+  LifetimeTracker::reset();
+  {
+    ThinVector<LifetimeTracker> underTest;
+    for (int i = 0; i < 10; ++i) {
+      underTest.emplace_back();
+    }
+    underTest.pop_back();
+    EXPECT_EQ(LifetimeTracker::destructions -
+                  LifetimeTracker::moveConstructions,
+              1);
+  }
+  EXPECT_EQ(LifetimeTracker::constructions +
+                LifetimeTracker::moveConstructions,
+            LifetimeTracker::destructions);
+}
+
+TEST(ThinVectorTest, AllocatesThroughTheAllocator) {
+  alignas(std::max_align_t) std::byte buffer[1024];
+  MonotonicBufferResource resource(buffer, sizeof(buffer),
+                                   nullMemoryResource());
+  ThinVector<int, PolymorphicAllocator<int>> underTest(&resource);
+  for (int i = 0; i < 50; ++i) {
+    underTest.push_back(i);
+  }
+  const auto* p = reinterpret_cast<const std::byte*>(underTest.data());
+  EXPECT_TRUE(p > buffer && p < buffer + sizeof(buffer));
+  EXPECT_EQ(underTest[49], 49);
+}
+
+TEST(CompactVectorTest, Growth) { checkGrowth<CompactVector<std::string>>(); }
+
+TEST(CompactVectorTest, CopyAndMove) {
+  checkCopyAndMove<CompactVector<int>>();
+}
+
+TEST(CompactVectorTest, ResizeAndShrinkToFit) {
+  checkResizeAndShrink<CompactVector<int>>();
+}
+
+TEST(CompactVectorTest, CapacityIsLimitedTo32Bits) {
+  CompactVector<char> underTest;
+  EXPECT_THROW(underTest.reserve(CompactVector<char>::kMaxSize + 1),
+               std::length_error);
+  EXPECT_TRUE(underTest.empty());
+}
+
+}  // namespace test
+}  // namespace ecx::stl
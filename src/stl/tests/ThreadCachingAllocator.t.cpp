@@ -0,0 +1,127 @@
+#include "src/stl/ThreadCachingAllocator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "src/stl/UniquePointer.hpp"
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+TEST(ThreadCachingAllocatorTest, SizeClassesCoverEveryRequestSize) {
+  using Heap = ThreadCachingHeap;
+
+  for (std::size_t bytes = 1; bytes <= Heap::kMaxSmallSize; ++bytes) {
+    const std::size_t cls = Heap::sizeClass(bytes);
+    ASSERT_LT(cls, Heap::kNumClasses);
+    ASSERT_GE(Heap::classSize(cls), bytes);
+    ASSERT_EQ(Heap::classSize(cls) % Heap::kMinAlign, 0);
+    if (cls > 0) {
+      ASSERT_LT(Heap::classSize(cls - 1), bytes);
+    }
+  }
+}
+
+TEST(ThreadCachingAllocatorTest, FreedObjectIsReusedByTheSameThread) {
+  auto& heap = ThreadCachingHeap::instance();
+
+  void* first = heap.allocate(100);
+  heap.deallocate(first, 100);
+  void* second = heap.allocate(112);
+
+  EXPECT_EQ(first, second);
+  heap.deallocate(second, 112);
+}
+
+TEST(ThreadCachingAllocatorTest, LargeAndOverAlignedRequestsBypassClasses) {
+  auto& heap = ThreadCachingHeap::instance();
+  const std::size_t before = heap.stats().largeAllocations;
+
+  void* large = heap.allocate(ThreadCachingHeap::kMaxSmallSize + 1);
+  void* aligned = heap.allocate(64, 64);
+
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 64, 0);
+  EXPECT_EQ(heap.stats().largeAllocations, before + 2);
+  heap.deallocate(large, ThreadCachingHeap::kMaxSmallSize + 1);
+  heap.deallocate(aligned, 64, 64);
+}
+
+TEST(ThreadCachingAllocatorTest, CrossThreadFreesFlowBackThroughCentralList) {
+  auto& heap = ThreadCachingHeap::instance();
+  const auto before = heap.stats();
+
+  constexpr int kObjects = 4096;
+  Vector<void*> objects;
+  std::thread producer([&] {
+    for (int i = 0; i < kObjects; ++i) {
+      void* p = heap.allocate(48);
+      std::memset(p, 0xab, 48);
+      objects.push_back(p);
+    }
+  });
+  producer.join();
+
+  std::thread consumer([&] {
+    for (void* p : objects) {
+      heap.deallocate(p, 48);
+    }
+  });
+  consumer.join();
+
+  const auto after = heap.stats();
+  EXPECT_GE(after.allocations - before.allocations, kObjects);
+  EXPECT_GE(after.deallocations - before.deallocations, kObjects);
+  EXPECT_GT(after.centralFetches, before.centralFetches);
+  EXPECT_GT(after.centralReleases, before.centralReleases);
+}
+
+TEST(ThreadCachingAllocatorTest, CountsAllocationsAfterThreadCacheExit) {
+  struct AllocatesOnExit {
+    ~AllocatesOnExit() {
+      auto& heap = ThreadCachingHeap::instance();
+      heap.deallocate(heap.allocate(64), 64);
+    }
+  };
+
+  auto& heap = ThreadCachingHeap::instance();
+  const auto before = heap.stats();
+  std::thread([&] {
+    // Constructed before the thread's cache, so destroyed after it.
+    thread_local AllocatesOnExit late;
+    static_cast<void>(late);
+    heap.deallocate(heap.allocate(64), 64);
+  }).join();
+
+  const auto after = heap.stats();
+  EXPECT_EQ(after.allocations - before.allocations, 2);
+  EXPECT_EQ(after.deallocations - before.deallocations, 2);
+  EXPECT_GE(after.centralFetches - before.centralFetches, 2);
+}
+
+TEST(ThreadCachingAllocatorTest, VectorUsesItAsBackend) {
+  Vector<std::string, ThreadCachingAllocator<std::string>> underTest;
+
+  for (int i = 0; i < 1000; ++i) {
+    underTest.push_back(std::to_string(i));
+  }
+
+  EXPECT_EQ(underTest.size(), 1000);
+  EXPECT_EQ(underTest[999], "999");
+  static_assert(sizeof(underTest) == 3 * sizeof(void*));
+}
+
+TEST(ThreadCachingAllocatorTest, AllocateUniqueUsesItAsBackend) {
+  auto underTest =
+      allocateUnique<std::string>(ThreadCachingAllocator<char>(), "hello");
+
+  EXPECT_EQ(*underTest, "hello");
+  static_assert(sizeof(underTest) == sizeof(void*));
+}
+
+}  // namespace test
+}  // namespace ecx::stl
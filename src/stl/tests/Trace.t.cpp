@@ -0,0 +1,148 @@
+#include "src/stl/Trace.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "src/stl/Vector.hpp"
+
+namespace ecx::stl {
+namespace test {
+
+static_assert(ECX_TRACING, "built with the probes enabled");
+
+namespace {
+
+struct Found {
+  std::size_t count = 0;
+  std::set<std::uint32_t> threads;
+  trace::Event last{};
+};
+
+// The events recorded under name, across every test so far.
+Found find(const char* name) {
+  Found found;
+  trace::forEachEvent([&](const trace::Event& event) {
+    if (std::strcmp(event.name, name) == 0) {
+      ++found.count;
+      found.threads.insert(event.threadId);
+      found.last = event;
+    }
+  });
+  return found;
+}
+
+void tracedWork() {
+  ECX_TRACE_SCOPE("test.work");
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+
+}  // namespace
+
+// The rings are global: each test records under names of its own, and
+// counts the events it added, so that the tests pass in any order.
+
+TEST(TraceTest, ScopeRecordsItsDuration) {
+  const std::size_t before = find("test.scope").count;
+
+  {
+    ECX_TRACE_SCOPE("test.scope");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+
+  const Found found = find("test.scope");
+  ASSERT_EQ(found.count, before + 1);
+  EXPECT_FALSE(found.last.instant);
+  EXPECT_GE(found.last.durationUs, 1000.0);
+  EXPECT_LT(found.last.durationUs, 1e6);
+  EXPECT_GE(found.last.startUs, 0.0);
+}
+
+TEST(TraceTest, InstantHasNoDuration) {
+  const std::size_t before = find("test.instant").count;
+
+  ECX_TRACE_INSTANT("test.instant");
+
+  const Found found = find("test.instant");
+  ASSERT_EQ(found.count, before + 1);
+  EXPECT_TRUE(found.last.instant);
+  EXPECT_EQ(found.last.durationUs, 0.0);
+}
+
+TEST(TraceTest, EqualNamesShareAnId) {
+  // Equal strings at distinct addresses, kept by intern() for good.
+  static const char first[] = "test.same";
+  static const char second[] = "test.same";
+
+  EXPECT_EQ(trace::intern(first), trace::intern(second));
+  EXPECT_NE(trace::intern(first), trace::intern("test.other"));
+}
+
+TEST(TraceTest, ThreadsRecordIntoTheirOwnRings) {
+  {
+    std::jthread a(tracedWork);
+    std::jthread b(tracedWork);
+  }
+
+  EXPECT_GE(find("test.work").threads.size(), 2);
+}
+
+TEST(TraceTest, VectorGrowthIsProbed) {
+  const std::size_t reserves = find("Vector::reserve").count;
+  const std::size_t grows = find("Vector::grow").count;
+
+  Vector<int> values;
+  values.reserve(4);
+  values.reserve(2);
+  for (int i = 0; i < 5; ++i) {
+    values.push_back(i);
+  }
+
+  // Only the calls that reallocate: reserve(4), and push_back past 4.
+  EXPECT_EQ(find("Vector::reserve").count, reserves + 1);
+  EXPECT_EQ(find("Vector::grow").count, grows + 1);
+}
+
+TEST(TraceTest, RingKeepsTheNewestEvents) {
+  constexpr std::size_t kExtra = 10;
+  const std::uint64_t dropped = trace::droppedEvents();
+  const std::size_t before = find("test.flood").count;
+
+  std::jthread([] {
+    for (std::size_t i = 0; i < trace::detail::kRingEvents + kExtra; ++i) {
+      ECX_TRACE_INSTANT("test.flood");
+    }
+  }).join();
+
+  EXPECT_EQ(find("test.flood").count, before + trace::detail::kRingEvents);
+  EXPECT_EQ(trace::droppedEvents(), dropped + kExtra);
+}
+
+TEST(TraceTest, ChromeTraceFormat) {
+  tracedWork();
+  ECX_TRACE_INSTANT("test \"quoted\"");
+
+  std::ostringstream out;
+  trace::writeChromeTrace(out);
+  const std::string json = out.str();
+
+  EXPECT_EQ(json.rfind("{\"traceEvents\":[\n", 0), 0);
+  EXPECT_TRUE(json.ends_with("\n],\"displayTimeUnit\":\"ns\"}\n"));
+  EXPECT_NE(json.find("{\"name\":\"test.work\",\"ph\":\"X\",\"dur\":"),
+            std::string::npos);
+  EXPECT_NE(json.find("{\"name\":\"test \\\"quoted\\\"\",\"ph\":\"i\""),
+            std::string::npos);
+  // The stream's own formatting is left as it was.
+  out << 1.5;
+  EXPECT_TRUE(out.str().ends_with("1.5"));
+}
+
+}  // namespace test
+}  // namespace ecx::stl
@@ -2,6 +2,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
 #include "src/testutil/LifetimeTracker.hpp"
 
 namespace ecx::stl {
@@ -79,6 +83,139 @@ TEST(VectorTest, CopyAssignmentSelfAssignmentShouldDoNothing) {
   EXPECT_EQ(underTest[2], 3);
 }
 
+TEST(VectorTest, CopyConstructorAllocatesExactlySize) {
+  Vector<int> original;
+  for (int i = 0; i < 5; ++i) {
+    original.push_back(i);
+  }
+  ASSERT_EQ(original.capacity(), 8);
+
+  const Vector<int> copy(original);
+
+  EXPECT_EQ(copy.capacity(), 5);
+  EXPECT_TRUE(std::ranges::equal(copy, original));
+}
+
+TEST(VectorTest, CopyConstructorCopiesEachElementOnce) {
+  const Vector<LifetimeTracker> original(3);
+  LifetimeTracker::reset();
+
+  const Vector<LifetimeTracker> copy(original);
+
+  EXPECT_EQ(LifetimeTracker::copyConstructions, 3);
+  EXPECT_EQ(LifetimeTracker::constructions, 0);
+  EXPECT_EQ(LifetimeTracker::moveConstructions, 0);
+  EXPECT_EQ(LifetimeTracker::destructions, 0);
+}
+
+TEST(VectorTest, CopyAssignmentToLargerReusesStorage) {
+  Vector<LifetimeTracker> destination(5);
+  const Vector<LifetimeTracker> source(3);
+  const auto* storage = destination.data();
+  LifetimeTracker::reset();
+
+  destination = source;
+
+  EXPECT_EQ(destination.size(), 3);
+  EXPECT_EQ(destination.capacity(), 5);
+  EXPECT_EQ(destination.data(), storage);
+  EXPECT_EQ(LifetimeTracker::copyAssignments, 3);
+  EXPECT_EQ(LifetimeTracker::destructions, 2);
+  EXPECT_EQ(LifetimeTracker::copyConstructions, 0);
+}
+
+TEST(VectorTest, CopyAssignmentWithinCapacityConstructsTail) {
+  Vector<LifetimeTracker> destination(2);
+  destination.reserve(8);
+  const Vector<LifetimeTracker> source(5);
+  const auto* storage = destination.data();
+  LifetimeTracker::reset();
+
+  destination = source;
+
+  EXPECT_EQ(destination.size(), 5);
+  EXPECT_EQ(destination.data(), storage);
+  EXPECT_EQ(LifetimeTracker::copyAssignments, 2);
+  EXPECT_EQ(LifetimeTracker::copyConstructions, 3);
+  EXPECT_EQ(LifetimeTracker::destructions, 0);
+}
+
+TEST(VectorTest, CopyAssignmentBeyondCapacityReallocatesExactly) {
+  Vector<LifetimeTracker> destination(2);
+  const Vector<LifetimeTracker> source(5);
+  LifetimeTracker::reset();
+
+  destination = source;
+
+  EXPECT_EQ(destination.size(), 5);
+  EXPECT_EQ(destination.capacity(), 5);
+  EXPECT_EQ(LifetimeTracker::copyConstructions, 5);
+  EXPECT_EQ(LifetimeTracker::copyAssignments, 0);
+  EXPECT_EQ(LifetimeTracker::destructions, 2);
+}
+
+TEST(VectorTest, CopyAssignmentOfTriviallyCopyable) {
+  Vector<int> underTest{1, 2, 3, 4};
+  const int* storage = underTest.data();
+
+  const Vector<int> shorter{9, 8};
+  underTest = shorter;
+  EXPECT_TRUE(std::ranges::equal(underTest, shorter));
+  EXPECT_EQ(underTest.data(), storage);
+
+  const Vector<int> longer{5, 6, 7, 8, 9, 10};
+  underTest = longer;
+  EXPECT_TRUE(std::ranges::equal(underTest, longer));
+  EXPECT_EQ(underTest.capacity(), 6);
+
+  const Vector<int> empty;
+  underTest = empty;
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.capacity(), 6);
+}
+
+namespace {
+
+// Stateful, and propagated on copy assignment.
+template <typename T>
+struct TaggedAllocator : std::allocator<T> {
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using is_always_equal = std::false_type;
+
+  template <typename U>
+  struct rebind {
+    using other = TaggedAllocator<U>;
+  };
+
+  explicit TaggedAllocator(int tag) : tag(tag) {}
+
+  template <typename U>
+  TaggedAllocator(const TaggedAllocator<U>& other) : tag(other.tag) {}
+
+  friend bool operator==(const TaggedAllocator& lhs,
+                         const TaggedAllocator& rhs) {
+    return lhs.tag == rhs.tag;
+  }
+
+  int tag;
+};
+
+}  // namespace
+
+TEST(VectorTest, CopyAssignmentPropagatesUnequalAllocator) {
+  using TaggedVector = Vector<int, TaggedAllocator<int>>;
+  TaggedVector destination(10, 0, TaggedAllocator<int>(1));
+  const TaggedVector source(3, 7, TaggedAllocator<int>(2));
+
+  destination = source;
+
+  // Storage from allocator 1 is not reused with allocator 2.
+  EXPECT_EQ(destination.getAllocator().tag, 2);
+  EXPECT_EQ(destination.capacity(), 3);
+  EXPECT_TRUE(std::ranges::equal(destination, source));
+}
+
 TEST(VectorTest, MoveConstructorStealsResourcesAndLeavesSourceEmpty) {
   Vector<std::string> source{"hello", "world"};
   Vector<std::string> destination(std::move(source));
@@ -121,6 +258,19 @@ TEST(VectorTest, NonTrivialTypeDestructorsCalledOnResizeShrink) {
   EXPECT_EQ(LifetimeTracker::constructions, LifetimeTracker::destructions);
 }
 
+TEST(VectorTest, ResizeForOverwriteKeepsExistingElements) {
+  Vector<int> underTest{1, 2, 3};
+
+  underTest.resizeForOverwrite(100);
+  EXPECT_EQ(underTest.size(), 100);
+  EXPECT_GE(underTest.capacity(), 100);
+  EXPECT_EQ(underTest[2], 3);
+
+  underTest.resizeForOverwrite(2);
+  EXPECT_EQ(underTest.size(), 2);
+  EXPECT_EQ(underTest[1], 2);
+}
+
 TEST(VectorTest, MoveOnlyTypeCanPushBackAndReserve) {
   // This test will fail to compile if move semantics are wrong
   Vector<std::unique_ptr<int>> underTest;
@@ -168,5 +318,41 @@ TEST(VectorTest, PushBackThriceDoublesCapacity) {
   EXPECT_NE(underTest.data(), nullptr);
 }
 
+TEST(VectorTest, ReallocationDestroysMovedFromElements) {
+  LifetimeTracker::reset();
+  {
+    Vector<LifetimeTracker> underTest(2);
+    underTest.reserve(8);
+
+    EXPECT_EQ(LifetimeTracker::moveConstructions, 2);
+    EXPECT_EQ(LifetimeTracker::destructions, 2);
+  }
+  EXPECT_EQ(LifetimeTracker::constructions +
+                LifetimeTracker::moveConstructions,
+            LifetimeTracker::destructions);
+}
+
+TEST(VectorTest, PushBackOfOwnElementSurvivesReallocation) {
+  Vector<std::string> underTest{"a long string that defeats SSO"};
+
+  underTest.push_back(underTest[0]);
+
+  EXPECT_EQ(underTest.size(), 2);
+  EXPECT_EQ(underTest[1], "a long string that defeats SSO");
+}
+
+TEST(VectorTest, ClearDestroysElementsAndKeepsCapacity) {
+  Vector<int> underTest{1, 2, 3};
+
+  underTest.clear();
+
+  EXPECT_TRUE(underTest.empty());
+  EXPECT_EQ(underTest.capacity(), 3);
+}
+
+TEST(VectorTest, DefaultAllocatorIsOptimisedOut) {
+  static_assert(sizeof(Vector<int>) == 3 * sizeof(void*));
+}
+
 }  // namespace test
 }  // namespace ecx::stl
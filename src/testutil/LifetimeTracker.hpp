@@ -13,6 +13,8 @@ struct LifetimeTracker {
     destructions = 0;
     copyConstructions = 0;
     moveConstructions = 0;
+    copyAssignments = 0;
+    moveAssignments = 0;
   }
 
   LifetimeTracker() { ++constructions; }
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Hardware counters for a benchmark or test region, read as one
+ * perf_event_open group so that they cover exactly the same instructions:
+ *
+ *   PerfCounters counters;
+ *   const PerfSample sample = counters.measure(kIterations, [&] { ... });
+ *   printPerfSample(stdout, "push_back", sample);
+ *
+ * Counters the kernel refuses (no PMU in a VM, perf_event_paranoid, another
+ * OS) are reported as unavailable rather than failing, so the same harness
+ * still gives wall time everywhere. Only user-space events are counted, which
+ * perf_event_paranoid <= 2 permits.
+ */
+enum class PerfEvent {
+  kCycles,
+  kInstructions,
+  kL1dMisses,
+  kLlcMisses,
+  kBranchMisses,
+  kDtlbMisses,
+};
+
+inline constexpr std::size_t kPerfEventCount = 6;
+
+inline constexpr const char* perfEventName(PerfEvent event) noexcept {
+  constexpr const char* kNames[kPerfEventCount] = {
+      "cycles",    "instructions", "L1d-misses",
+      "LLC-misses", "branch-misses", "dTLB-misses",
+  };
+  return kNames[static_cast<std::size_t>(event)];
+}
+
+struct PerfSample {
+  std::uint64_t iterations = 0;
+  double wallNs = 0;
+  // Totals over the region, scaled up if the kernel multiplexed the group.
+  std::array<double, kPerfEventCount> counts{};
+  std::array<bool, kPerfEventCount> available{};
+
+  bool has(PerfEvent event) const noexcept {
+    return available[static_cast<std::size_t>(event)];
+  }
+
+  double perIteration(PerfEvent event) const noexcept {
+    return counts[static_cast<std::size_t>(event)] /
+           static_cast<double>(iterations == 0 ? 1 : iterations);
+  }
+
+  double nsPerIteration() const noexcept {
+    return wallNs / static_cast<double>(iterations == 0 ? 1 : iterations);
+  }
+};
+
+class PerfCounters {
+ public:
+  PerfCounters() { open(); }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  ~PerfCounters() {
+#if defined(__linux__)
+    for (int fd : fds_) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+#endif
+  }
+
+  bool available(PerfEvent event) const noexcept {
+    return fds_[static_cast<std::size_t>(event)] >= 0;
+  }
+
+  bool anyAvailable() const noexcept { return leader_ >= 0; }
+
+  /**
+   * Runs fn once, counting over it; iterations is what the figures are
+   * divided by, e.g. the number of elements fn pushes.
+   */
+  template <typename Fn>
+  PerfSample measure(std::uint64_t iterations, Fn&& fn) {
+    PerfSample sample;
+    sample.iterations = iterations;
+    start();
+    const auto begin = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    stop(sample);
+    sample.wallNs = std::chrono::duration<double, std::nano>(end - begin)
+                        .count();
+    return sample;
+  }
+
+ private:
+  void open() {
+    fds_.fill(-1);
+#if defined(__linux__)
+    const struct {
+      std::uint32_t type;
+      std::uint64_t config;
+    } kEvents[kPerfEventCount] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, cacheMisses(PERF_COUNT_HW_CACHE_L1D)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cacheMisses(PERF_COUNT_HW_CACHE_DTLB)},
+    };
+
+    // The first event that opens leads the group; the rest join it, or are
+    // left out if the PMU cannot schedule them alongside.
+    for (std::size_t i = 0; i < kPerfEventCount; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = kEvents[i].type;
+      attr.config = kEvents[i].config;
+      attr.disabled = leader_ < 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+      // This thread, any CPU.
+      const long fd =
+          ::syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0);
+      if (fd < 0) {
+        continue;
+      }
+      fds_[i] = static_cast<int>(fd);
+      order_[members_++] = i;
+      if (leader_ < 0) {
+        leader_ = fds_[i];
+      }
+    }
+#endif
+  }
+
+#if defined(__linux__)
+  static constexpr std::uint64_t cacheMisses(std::uint64_t cache) noexcept {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+           (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+#endif
+
+  void start() noexcept {
+#if defined(__linux__)
+    if (leader_ >= 0) {
+      ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  void stop(PerfSample& sample) noexcept {
+#if defined(__linux__)
+    if (leader_ < 0) {
+      return;
+    }
+    ::ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // {nr, time_enabled, time_running, values[nr]}, in the order opened.
+    std::uint64_t buffer[3 + kPerfEventCount] = {};
+    if (::read(leader_, buffer, sizeof(buffer)) < 0 || buffer[2] == 0) {
+      return;
+    }
+    const double scale =
+        static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]);
+    for (std::size_t m = 0; m < members_ && m < buffer[0]; ++m) {
+      sample.counts[order_[m]] = static_cast<double>(buffer[3 + m]) * scale;
+      sample.available[order_[m]] = true;
+    }
+#else
+    static_cast<void>(sample);
+#endif
+  }
+
+  std::array<int, kPerfEventCount> fds_{};
+  // The event behind each value of a group read.
+  std::array<std::size_t, kPerfEventCount> order_{};
+  std::size_t members_ = 0;
+  int leader_ = -1;
+};
+
+/**
+ * One line of per-iteration figures, with IPC and "n/a" for the counters
+ * that could not be read.
+ */
+inline void printPerfSample(std::FILE* out, const char* name,
+                            const PerfSample& sample) {
+  std::fprintf(out, "%-20s %8.2f ns/it", name, sample.nsPerIteration());
+  for (std::size_t i = 0; i < kPerfEventCount; ++i) {
+    const auto event = static_cast<PerfEvent>(i);
+    if (sample.has(event)) {
+      std::fprintf(out, "  %s %.2f", perfEventName(event),
+                   sample.perIteration(event));
+    } else {
+      std::fprintf(out, "  %s n/a", perfEventName(event));
+    }
+  }
+  const double cycles = sample.perIteration(PerfEvent::kCycles);
+  if (sample.has(PerfEvent::kInstructions) && cycles > 0) {
+    std::fprintf(out, "  IPC %.2f",
+                 sample.perIteration(PerfEvent::kInstructions) / cycles);
+  }
+  std::fputc('\n', out);
+}